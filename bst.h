@@ -13,6 +13,7 @@
  *    This will contain the class definition of:
  *        BST                 : A class that represents a binary search tree
  *        BST::iterator       : An iterator through BST
+ *        Range               : The elements between two iterators
  * Author
  *    <your names here>
  ************************************************************************/
@@ -30,43 +31,137 @@
 #include <memory>     // for std::allocator
 #include <functional> // for std::less
 #include <utility>    // for std::pair
+#include <cstdint>    // for uintptr_t
+#include <type_traits> // for std::is_same
+#include <memory_resource> // for std::pmr::polymorphic_allocator
+#include <vector>     // for std::vector
+#include <algorithm>  // for std::stable_sort
+#include <iterator>   // for std::iterator_traits and std::distance
+#include <cstddef>    // for std::ptrdiff_t
+#include <thread>     // for std::thread
+#include <mutex>      // for std::mutex
+#include <condition_variable> // for std::condition_variable
+#include <cstdlib>    // for std::atexit
+#include <atomic>     // for std::atomic
+#include <exception>  // for std::exception_ptr
+#include <system_error> // for std::system_error
+#include "pool.h"     // for NodePool
 
 class TestBST; // forward declaration for unit tests
 class TestSet;
 class TestMap;
+class TestPool;
 
 namespace custom
 {
    template <typename TT>
    class set;
-   template <typename KK, typename VV>
+   template <typename KK, typename VV, typename CC, typename AA, bool RR, typename PP>
    class map;
 
+   /*****************************************************************
+    * SORTED UNIQUE
+    * A tag for the caller to promise that a range is already sorted
+    * with no duplicate keys, so a tree can be built without checking
+    *****************************************************************/
+   struct sorted_unique_t
+   {
+      explicit sorted_unique_t() = default;
+   };
+   inline constexpr sorted_unique_t sorted_unique{};
+
+   /*****************************************************************
+    * IS FORWARD ITERATOR
+    * Can we walk a range twice, say to count it before copying it?
+    *****************************************************************/
+   template <class Iterator, class = void>
+   struct isForwardIterator : std::false_type {};
+   template <class Iterator>
+   struct isForwardIterator <Iterator, std::void_t <typename std::iterator_traits <Iterator> ::iterator_category>>
+      : std::is_base_of <std::forward_iterator_tag, typename std::iterator_traits <Iterator> ::iterator_category> {};
+
+   /*****************************************************************
+    * RANGE
+    * The elements from one iterator up to another, for a range-based for.
+    * The end is found once up front, so stepping through compares no keys.
+    *****************************************************************/
+   template <class Iterator>
+   class Range
+   {
+   public:
+      Range(const Iterator& itBegin, const Iterator& itEnd) : itBegin(itBegin), itEnd(itEnd) {}
+      Iterator begin() const { return itBegin; }
+      Iterator end()   const { return itEnd; }
+      bool empty() const { return itBegin == itEnd; }
+   private:
+      Iterator itBegin;
+      Iterator itEnd;
+   };
+
+   /*****************************************************************
+    * SUBTREE SIZE
+    * A ranked tree counts the nodes under each node, itself included,
+    * so it can find the k-th element without walking to it. The nodes
+    * of any other tree get an empty base and are no larger for it.
+    *****************************************************************/
+   template <bool Ranked>
+   struct SubtreeSize
+   {
+      SubtreeSize() : numSubtree(1) {}
+      size_t numSubtree;
+   };
+   template <>
+   struct SubtreeSize <false>
+   {
+   };
+
+   /*****************************************************************
+    * IDENTITY
+    * The default key extractor: a value is its own key
+    *****************************************************************/
+   struct Identity
+   {
+      template <class T>
+      const T& operator () (const T& t) const noexcept { return t; }
+   };
+
    /*****************************************************************
     * BINARY SEARCH TREE
-    * Create a Binary Search Tree
+    * Create a Binary Search Tree. The nodes are ordered by C on the key
+    * that KeyOf pulls out of each value, so a container holding more than
+    * its key (such as a map) can search without building a whole value.
+    * A Ranked tree also keeps subtree sizes for its order statistics.
     *****************************************************************/
-   template <typename T>
+   template <typename T, typename A = std::allocator <T>, typename KeyOf = Identity,
+             typename C = std::less <T>, bool Ranked = false>
    class BST
    {
       friend class ::TestBST; // give unit tests access to the privates
       friend class ::TestSet;
       friend class ::TestMap;
+      friend class ::TestPool;
 
       template <class TT>
       friend class custom::set;
 
-      template <class KK, class VV>
+      template <class KK, class VV, class CC, class AA, bool RR, class PP>
       friend class custom::map;
    public:
+      using allocator_type = A;
+      using key_type = std::decay_t <decltype(KeyOf()(std::declval <const T&> ()))>;
+      using key_compare = C;
+
       //
       // Construct
       //
 
       BST();
+      explicit BST(const A& a);
+      explicit BST(const C& c, const A& a = A());
       BST(const BST& rhs);
-      BST(BST&& rhs);
-      BST(const std::initializer_list<T>& il);
+      BST(const BST& rhs, const A& a);
+      BST(BST&& rhs) noexcept;
+      BST(const std::initializer_list<T>& il, const A& a = A());
       ~BST();
 
       //
@@ -74,23 +169,60 @@ namespace custom
       //
 
       BST& operator = (const BST& rhs);
-      BST& operator = (BST&& rhs);
+      BST& operator = (BST&& rhs) noexcept(isMoveAssignNoexcept);
       BST& operator = (const std::initializer_list<T>& il);
       void swap(BST& rhs);
 
+      // replace the contents with a range in linear time if it is sorted
+      template <class Iterator>
+      void assign(Iterator first, Iterator last, bool keepUnique = false);
+      template <class Iterator>
+      void assign(sorted_unique_t, Iterator first, Iterator last);
+
+      // copy a large tree on several threads. Zero means one per core
+      void assignParallel(const BST& rhs, unsigned numThreads = 0);
+      static constexpr size_t numParallelCopyMin = 65536;
+
       //
       // Iterator
       //
 
       class iterator;
-      iterator   begin() const noexcept;
-      iterator   end()   const noexcept { return iterator(nullptr); }
+      iterator   begin()  const noexcept;
+      iterator   rbegin() const noexcept;
+      iterator   end()    const noexcept { return iterator(nullptr, this); }
 
       //
       // Access
       //
 
-      iterator find(const T& t);
+      iterator find(const key_type& k);
+
+      // with a transparent comparator, anything comparable to a key will do
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator find(const K& k);
+      bool contains(const key_type& k) const { return findNode(k) != nullptr; }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      bool contains(const K& k) const { return findNode(k) != nullptr; }
+
+      // the first element not before k, the first after k, and both
+      iterator lowerBound(const key_type& k) const { return iterator(lowerBoundNode(k), this); }
+      iterator upperBound(const key_type& k) const { return iterator(upperBoundNode(k), this); }
+      std::pair<iterator, iterator> equalRange(const key_type& k) const { return equalRangeNodes(k); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator lowerBound(const K& k) const { return iterator(lowerBoundNode(k), this); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator upperBound(const K& k) const { return iterator(upperBoundNode(k), this); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      std::pair<iterator, iterator> equalRange(const K& k) const { return equalRangeNodes(k); }
+
+      // every element with a key in [lo, hi)
+      Range <iterator> range(const key_type& lo, const key_type& hi) const;
+
+      // order statistics: O(log n) in a Ranked tree, a walk otherwise
+      iterator nth(size_t k) const;
+      size_t rank(const key_type& k) const;
+      size_t countRange(const key_type& lo, const key_type& hi) const;
 
       //
       // Insert
@@ -99,13 +231,71 @@ namespace custom
       std::pair<iterator, bool> insert(const T& t, bool keepUnique = false);
       std::pair<iterator, bool> insert(T&& t, bool keepUnique = false);
 
+      // build the value right in its node
+      template <class ... Args>
+      std::pair<iterator, bool> emplace(Args&& ... args);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceUnique(Args&& ... args);
+
+      // build the value only if nothing with key k is here yet
+      template <class ... Args>
+      std::pair<iterator, bool> tryEmplace(const key_type& k, Args&& ... args);
+
+      // the value probably goes right before hint, so start looking there
+      std::pair<iterator, bool> insert(iterator hint, const T& t, bool keepUnique = false);
+      std::pair<iterator, bool> insert(iterator hint, T&& t, bool keepUnique = false);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceHint(iterator hint, Args&& ... args);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceHintUnique(iterator hint, Args&& ... args);
+
+      // each of a range of values, one at a time
+      template <class Iterator>
+      void insert(Iterator first, Iterator last, bool keepUnique = false);
+
       //
       // Remove
       //
 
       iterator erase(iterator& it);
+      iterator erase(iterator first, iterator last);
       void   clear() noexcept;
 
+      // take out the smallest or the largest element
+      void popFront();
+      void popBack();
+
+      // move nodes between trees without allocating or copying
+      class NodeHandle;
+      NodeHandle extract(iterator it);
+      std::pair<iterator, bool> insert(NodeHandle&& nh, bool keepUnique = false);
+      void merge(BST& source, bool keepUnique = false);
+
+      // cut the tree into the keys before k and the rest, or put two trees
+      // back together when all of left comes before all of right. Both
+      // reuse the nodes and take O(log n). Only a Ranked tree can count the
+      // pieces of a split without walking the smaller one.
+      std::pair<BST, BST> split(const key_type& k);
+      static BST join(BST&& left, BST&& right);
+
+      // set algebra on two trees of unique keys, built from split and join.
+      // Both trees are used up and their nodes reused. Large trees are worked
+      // on by numThreads threads, zero meaning one per core, so combine(kept,
+      // other), which merges the element of rhs into that of lhs when both
+      // have a key, may be called from several threads at once.
+      template <class Combine>
+      static BST setUnion(BST&& lhs, BST&& rhs, Combine combine, unsigned numThreads = 1);
+      static BST setIntersection(BST&& lhs, BST&& rhs, unsigned numThreads = 1);
+      static BST setDifference(BST&& lhs, BST&& rhs, unsigned numThreads = 1);
+
+      // let clear() and the destructor hand a tree of more than
+      // numReclaimMin nodes to a thread that frees it in the background.
+      // flushReclaim() waits until every tree handed off has been freed.
+      void deferReclaim(bool isDeferred = true) noexcept { isReclaimDeferred = isDeferred; }
+      static void flushReclaim();
+      static size_t numReclaimPending() noexcept;
+      static constexpr size_t numReclaimMin = 64;
+
       //
       // Status
       //
@@ -113,54 +303,218 @@ namespace custom
       bool   empty() const noexcept { return size() == 0; }
       size_t size()  const noexcept { return numElements; }
 
+      //
+      // Capacity
+      //
+
+      void reserve(size_t num);
+      void shrink_to_fit();
+      A get_allocator() const noexcept { return A(alloc); }
+      C key_comp() const { return compare; }
+
    private:
 
       class BNode;
 
+      // nodes are allocated with A rebound to BNode. The default allocator
+      // draws from the node pool instead, through the tree's own free list.
+      using NodeAlloc  = typename std::allocator_traits <A> ::template rebind_alloc <BNode>;
+      using NodeTraits = std::allocator_traits <NodeAlloc>;
+      static constexpr bool usePool = std::is_same <NodeAlloc, std::allocator <BNode> > ::value;
+
+      // a move assignment only moves elements one at a time, which may
+      // throw, when the allocators might differ and stay behind
+      static constexpr bool isMoveAssignNoexcept = NodeTraits::propagate_on_container_move_assignment::value ||
+                                                   NodeTraits::is_always_equal::value;
+
+      template <class ... Args>
+      BNode* createNode(Args&& ... args);
+      template <class U>
+      std::pair<iterator, bool> insertValue(U&& t, bool keepUnique, const iterator* pHint = nullptr);
+      std::pair<iterator, bool> insertNode(BNode* pNew, bool keepUnique, const iterator* pHint = nullptr);
+
+      // searching by key
+      static const key_type& keyOf(const T& t) { return KeyOf()(t); }
+      static BNode* findLeftmost(BNode* pNode)
+      {
+         while (pNode != nullptr && pNode->pLeft != nullptr)
+            pNode = pNode->pLeft;
+         return pNode;
+      }
+      static BNode* findRightmost(BNode* pNode)
+      {
+         while (pNode != nullptr && pNode->pRight != nullptr)
+            pNode = pNode->pRight;
+         return pNode;
+      }
+      template <class K>
+      BNode* findNode(const K& k) const;
+      template <class K>
+      BNode* lowerBoundNode(const K& k, BNode* p, BNode* pBound) const;
+      template <class K>
+      BNode* lowerBoundNode(const K& k) const { return lowerBoundNode(k, root, nullptr); }
+      template <class K>
+      BNode* upperBoundNode(const K& k, BNode* p, BNode* pBound) const;
+      template <class K>
+      BNode* upperBoundNode(const K& k) const { return upperBoundNode(k, root, nullptr); }
+      template <class K>
+      std::pair<iterator, iterator> equalRangeNodes(const K& k) const;
+      BNode* findSpot(const key_type& k, bool keepUnique, BNode*& pParent, bool& toLeft) const;
+      BNode* findSpotNear(iterator hint, const key_type& k, bool keepUnique,
+                          BNode*& pParent, bool& toLeft) const;
+      void linkNode(BNode* pParent, bool toLeft, BNode* pNew);
+
+      // building a whole tree at once
+      template <class Iterator>
+      void assignNodes(Iterator first, Iterator last, bool keepUnique, bool isSorted);
+      static constexpr size_t numAssignSortMin = 16;  // fewer go in one at a time
+      template <class Iterator, class MakeNode>
+      void buildBalanced(Iterator it, size_t num, MakeNode makeNode);
+      template <class Iterator, class MakeNode>
+      BNode* buildBalanced(Iterator& it, size_t num, int depth, int depthRed, MakeNode& makeNode);
+      void destroyNode(BNode* pNode) noexcept;
+      static void destroyNode(NodeAlloc& alloc, BNode* pNode) noexcept;
+      void unlinkNode(BNode* pDelete);
+
+      // nodes of cleared trees waiting to be freed by a thread of their own.
+      // Like the pool, one is shared by every tree with this node type.
+      class Reclaimer
+      {
+      public:
+         Reclaimer() : pPending(nullptr), numPending(0), isStopped(false) {}
+         bool add(BNode* pRoot, size_t num);
+         void flush();
+         void stop() noexcept;
+         size_t size() const noexcept { return numPending; }
+      private:
+         void run() noexcept;
+         static size_t freeNodes(BNode*& pRoot, NodeCache <BNode>& cache, size_t num) noexcept;
+         static constexpr size_t numBatch = 4096;   // nodes freed between counts
+
+         std::mutex mutex;                 // guards everything but numPending
+         std::condition_variable cvWork;   // a tree was added, or we are stopping
+         std::condition_variable cvDone;   // every node has been freed
+         BNode* pPending;                  // trees the thread has yet to take
+         std::atomic <size_t> numPending;  // nodes handed off and not yet freed
+         std::thread thread;               // started with the first tree
+         bool isStopped;                   // at exit: free in the caller from now on
+      };
+      static Reclaimer& reclaimer();
+      static void stopReclaimer() noexcept;
+
       // utility functions which need to be done recursively
       void deleteNode(BNode*& pDelete, bool toRight);
-      void deleteBinaryTree(BNode*& pDelete) noexcept;
+      void rotateLeft(BNode* pNode);
+      void rotateRight(BNode* pNode);
+      void balanceErase(BNode* pNode, BNode* pParent);
+      size_t deleteBinaryTree(BNode*& pDelete) noexcept;
       void copyBinaryTree(const BNode* pSrc, BNode*& pDest);
+      template <class MakeNode>
+      void copyBinaryTree(const BNode* pSrc, BNode*& pDest, MakeNode& makeNode);
+
+      // cutting a tree apart and putting it back together. A subtree on its
+      // own has a black root and knows how many black nodes are on every
+      // path down from it, which is what join needs to line two trees up.
+      struct Subtree
+      {
+         BNode* pRoot;
+         int blackHeight;
+      };
+      static int findBlackHeight(const BNode* pNode) noexcept;
+      static Subtree detachSubtree(BNode* pNode, int blackHeight) noexcept;
+      static Subtree join(Subtree left, BNode* pMiddle, Subtree right) noexcept;
+      static void splitAt(BNode* pNode, Subtree& left, Subtree& right) noexcept;
+      static size_t countLeft(const BNode* pLeft, const BNode* pRight, size_t numTotal) noexcept;
+      static Subtree joinPair(Subtree left, Subtree right) noexcept;
+      void splitKey(Subtree tree, const key_type& k, Subtree& left, BNode*& pMatch, Subtree& right) const noexcept;
+
+      // the set operations divide and conquer on the nodes. What they drop
+      // is gathered in one unordered tree and freed at the end.
+      enum class SetOp { unite, intersect, subtract };
+      template <class Combine>
+      static BST setOperation(SetOp op, BST&& lhs, BST&& rhs, Combine& combine, unsigned numThreads);
+      template <class Combine>
+      Subtree setNodes(SetOp op, Subtree lhs, Subtree rhs, Combine& combine, BNode*& pGarbage, int depthFork) const;
+      static void addGarbage(BNode*& pGarbage, BNode* pRoot) noexcept;
+      static constexpr size_t numEraseRangeMin = 8;   // fewer go one at a time
+
+      // copying the subtrees of a large tree on separate threads
+      struct CopyTask
+      {
+         const BNode* pSrc;   // subtree to copy
+         BNode* pParent;      // where the copy will hang
+         bool isLeft;         // which side of pParent
+         BNode* pCopy;        // the finished copy
+      };
+      void copyParallel(const BST& rhs, unsigned numThreads);
+      void copyTop(const BNode* pSrc, BNode*& pDest, int depth, int depthSplit,
+                   std::vector <CopyTask>& tasks);
 
       BNode* root;         // root node of the binary search tree
+      BNode* pLeftmost;    // smallest node, so begin() needs no search
+      BNode* pRightmost;   // largest node, so appending needs no search
+      size_t numAppends;   // how many inserts in a row went past the largest
       size_t numElements;  // number of elements currently in the tree
+      bool isReclaimDeferred; // clear() hands large trees to the reclaimer
+      NodeAlloc alloc;     // where the nodes come from
+      NodeCache <BNode> nodes; // our free list, when the nodes come from the pool
+      C compare;           // orders the keys
    };
 
+   /*****************************************************************
+    * PMR
+    * A BST drawing its nodes from a std::pmr::memory_resource
+    *****************************************************************/
+   namespace pmr
+   {
+      template <typename T, typename KeyOf = Identity, typename C = std::less <T>, bool Ranked = false>
+      using BST = custom::BST <T, std::pmr::polymorphic_allocator <T>, KeyOf, C, Ranked>;
+   }
+
 
    /*****************************************************************
     * BINARY NODE
     * A single node in a binary tree. Note that the node does not know
     * anything about the properties of the tree so no validation can be done.
     *****************************************************************/
-   template <typename T>
-   class BST <T> ::BNode
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   class BST <T, A, KeyOf, C, Ranked> ::BNode : public SubtreeSize <Ranked>
    {
    public:
       //
       // Construct
       //
       BNode()
-         : pLeft(nullptr), pRight(nullptr), pParent(nullptr), data(), isRed(true)
+         : data(), pLeft(nullptr), pRight(nullptr), parentAndColor(colorRed)
       {
       }
       BNode(const T& t)
-         : pLeft(nullptr), pRight(nullptr), pParent(nullptr), data(t), isRed(true)
+         : data(t), pLeft(nullptr), pRight(nullptr), parentAndColor(colorRed)
       {
       }
       BNode(T&& t)
-         : pLeft(nullptr), pRight(nullptr), pParent(nullptr), data(std::move(t)), isRed(true)
+         : data(std::move(t)), pLeft(nullptr), pRight(nullptr), parentAndColor(colorRed)
+      {
+      }
+      template <class ... Args>
+      explicit BNode(std::in_place_t, Args&& ... args)
+         : data(std::forward <Args> (args)...), pLeft(nullptr), pRight(nullptr), parentAndColor(colorRed)
       {
       }
 
+      //
+      // Allocate: nodes come from a pool shared by every tree of this type.
+      // A tree goes through its free list; these are for a node on its own.
+      //
+      static auto& pool();
+      static void* operator new (size_t size);
+      static void operator delete (void* p) noexcept;
+
       //
       // Insert
       //
       void addLeft(BNode* pNode);
       void addRight(BNode* pNode);
-      void addLeft(const T& t);
-      void addRight(const T& t);
-      void addLeft(T&& t);
-      void addRight(T&& t);
 
       //
       // Status
@@ -169,7 +523,20 @@ namespace custom
       bool isLeftChild(BNode* pNode) const { return pLeft == pNode; }
 
       // balance the tree
-      void balance();
+      bool balance();
+      BNode* balanceOnce();
+
+      //
+      // Order statistics: only a Ranked tree has the sizes
+      //
+      static size_t sizeOf(const BNode* p) noexcept { return p ? p->numSubtree : 0; }
+      void fixSize() noexcept
+      {
+         if constexpr (Ranked)
+            this->numSubtree = 1 + sizeOf(pLeft) + sizeOf(pRight);
+      }
+      static BNode* select(BNode* p, size_t k) noexcept;
+      static size_t indexOf(const BNode* p) noexcept;
 
 #ifdef DEBUG
       //
@@ -179,6 +546,7 @@ namespace custom
       int findDepth() const;
       bool verifyRedBlack(int depth) const;
       int computeSize() const;
+      bool verifySize() const;
 #endif // DEBUG
 
       //
@@ -187,36 +555,62 @@ namespace custom
       T data;                  // Actual data stored in the BNode
       BNode* pLeft;            // Left child - smaller
       BNode* pRight;           // Right child - larger
-      BNode* pParent;          // Parent
-      bool isRed;              // Red-black balancing stuff
+
+      //
+      // Parent and color: the color rides in the low bit of the parent
+      // pointer, which is always zero because nodes are pointer-aligned.
+      // This saves a word (and the padding after the bool) in every node.
+      //
+      BNode* getParent() const
+      {
+         return reinterpret_cast <BNode*> (parentAndColor & ~colorRed);
+      }
+      void setParent(BNode* pNode)
+      {
+         assert((reinterpret_cast <uintptr_t> (pNode) & colorRed) == 0);
+         parentAndColor = reinterpret_cast <uintptr_t> (pNode) | (parentAndColor & colorRed);
+      }
+      bool isRed() const { return (parentAndColor & colorRed) != 0; }
+      void setRed(bool fRed)
+      {
+         parentAndColor = (parentAndColor & ~colorRed) | (fRed ? colorRed : 0);
+      }
+
+   private:
+      static constexpr uintptr_t colorRed = 1;
+      uintptr_t parentAndColor; // Parent, with the red-black color in bit 0
    };
 
    /**********************************************************
     * BINARY SEARCH TREE ITERATOR
     * Forward and reverse iterator through a BST
     *********************************************************/
-   template <typename T>
-   class BST <T> ::iterator
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   class BST <T, A, KeyOf, C, Ranked> ::iterator
    {
       friend class ::TestBST; // give unit tests access to the privates
       friend class ::TestSet;
       friend class ::TestMap;
+      friend class ::TestPool;
 
-      template <class KK, class VV>
+      template <class KK, class VV, class CC, class AA, bool RR, class PP>
       friend class custom::map;
    public:
       // constructors and assignment
-      iterator(BNode* p = nullptr)
+      iterator(BNode* p = nullptr, const BST* pTree = nullptr)
       {
          pNode = p;
+         this->pTree = pTree;
       }
       iterator(const iterator& rhs)
       {
          pNode = rhs.pNode;
+         pTree = rhs.pTree;
       }
       iterator& operator = (const iterator& rhs)
       {
          pNode = rhs.pNode;
+         pTree = rhs.pTree;
          return *this;
       }
 
@@ -254,13 +648,77 @@ namespace custom
          return itReturn;
       }
 
-      // must give friend status to remove so it can call getNode() from it
-      friend BST <T> ::iterator BST <T> ::erase(iterator& it);
+      // how far it is from first to last. A Ranked tree works it out from
+      // the subtree sizes; otherwise we walk. Found by argument-dependent
+      // lookup, so "using std::distance; distance(a, b)" picks it up.
+      friend std::ptrdiff_t distance(const iterator& first, const iterator& last)
+      {
+         return countBetween(first.pNode, last.pNode);
+      }
+
+      // the tree may reach into the iterator for its node
+      friend class BST <T, A, KeyOf, C, Ranked>;
 
    private:
+      static std::ptrdiff_t countBetween(const BNode* pFirst, const BNode* pLast);
 
-      // the node
+      // the node, and the tree it came from so end() can step back
       BNode* pNode;
+      const BST* pTree;
+   };
+
+   /**********************************************************
+    * BINARY SEARCH TREE NODE HANDLE
+    * Owns a node taken out of a tree so it can be put into
+    * another without being freed, allocated, or copied
+    *********************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   class BST <T, A, KeyOf, C, Ranked> ::NodeHandle
+   {
+      friend class ::TestBST; // give unit tests access to the privates
+      friend class ::TestSet;
+      friend class ::TestMap;
+      friend class BST <T, A, KeyOf, C, Ranked>;
+   public:
+      NodeHandle() noexcept : pNode(nullptr), alloc() {}
+      NodeHandle(NodeHandle&& rhs) noexcept : pNode(rhs.pNode), alloc(std::move(rhs.alloc))
+      {
+         rhs.pNode = nullptr;
+      }
+      NodeHandle& operator = (NodeHandle&& rhs) noexcept
+      {
+         if (this != &rhs)
+         {
+            if (pNode)
+               destroyNode(alloc, pNode);
+            pNode = rhs.pNode;
+            alloc = std::move(rhs.alloc);
+            rhs.pNode = nullptr;
+         }
+         return *this;
+      }
+     ~NodeHandle()
+      {
+         if (pNode)
+            destroyNode(alloc, pNode);
+      }
+
+      bool empty() const noexcept { return pNode == nullptr; }
+      explicit operator bool () const noexcept { return pNode != nullptr; }
+
+      // the element can be changed, even its key, since it is in no tree
+      T& value() const
+      {
+         assert(pNode != nullptr);
+         return pNode->data;
+      }
+      A get_allocator() const { return A(alloc); }
+
+   private:
+      NodeHandle(BNode* pNode, const NodeAlloc& alloc) : pNode(pNode), alloc(alloc) {}
+
+      BNode* pNode;      // the node we own, if any
+      NodeAlloc alloc;   // what will free it
    };
 
 
@@ -276,9 +734,29 @@ namespace custom
     /*********************************************
      * BST :: DEFAULT CONSTRUCTOR
      ********************************************/
-   template <typename T>
-   BST <T> ::BST()
-      : root(nullptr), numElements(0)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> ::BST()
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numAppends(0), numElements(0), isReclaimDeferred(false), alloc(), compare()
+   {
+   }
+
+   /*********************************************
+    * BST :: ALLOCATOR CONSTRUCTOR
+    * An empty tree drawing its nodes from a given allocator
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> ::BST(const A& a)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numAppends(0), numElements(0), isReclaimDeferred(false), alloc(a), compare()
+   {
+   }
+
+   /*********************************************
+    * BST :: COMPARATOR CONSTRUCTOR
+    * An empty tree ordered by a given comparator
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> ::BST(const C& c, const A& a)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numAppends(0), numElements(0), isReclaimDeferred(false), alloc(a), compare(c)
    {
    }
 
@@ -286,38 +764,64 @@ namespace custom
     * BST :: COPY CONSTRUCTOR
     * Copy one tree to another
     ********************************************/
-   template <typename T>
-   BST <T> ::BST(const BST<T>& rhs)
-      : root(nullptr), numElements(0)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> ::BST(const BST <T, A, KeyOf, C, Ranked>& rhs)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numAppends(0), numElements(0), isReclaimDeferred(false),
+        alloc(NodeTraits::select_on_container_copy_construction(rhs.alloc)),
+        compare(rhs.compare)
    {
-      // call the assignment operator
-      *this = rhs;
+      copyBinaryTree(rhs.root, root);
+      pLeftmost = findLeftmost(root);
+      pRightmost = findRightmost(root);
+      numElements = rhs.numElements;
+   }
+
+   /*********************************************
+    * BST :: COPY CONSTRUCTOR with ALLOCATOR
+    * Copy one tree to another using a given allocator
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> ::BST(const BST <T, A, KeyOf, C, Ranked>& rhs, const A& a)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numAppends(0), numElements(0), isReclaimDeferred(false), alloc(a), compare(rhs.compare)
+   {
+      copyBinaryTree(rhs.root, root);
+      pLeftmost = findLeftmost(root);
+      pRightmost = findRightmost(root);
+      numElements = rhs.numElements;
    }
 
    /*********************************************
     * BST :: MOVE CONSTRUCTOR
     * Move one tree to another
     ********************************************/
-   template <typename T>
-   BST <T> ::BST(BST <T>&& rhs)
-      : root(nullptr), numElements(0)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> ::BST(BST <T, A, KeyOf, C, Ranked>&& rhs) noexcept
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numAppends(0), numElements(0), isReclaimDeferred(false), alloc(std::move(rhs.alloc)),
+        compare(std::move(rhs.compare))
    {
       // move the nodes and set the RHS to empty
       root = rhs.root;
       rhs.root = nullptr;
+      pLeftmost = rhs.pLeftmost;
+      rhs.pLeftmost = nullptr;
+      pRightmost = rhs.pRightmost;
+      rhs.pRightmost = nullptr;
 
       // move the number of elements and set the RHS to empty
       numElements = rhs.numElements;
       rhs.numElements = 0;
+
+      // the spare nodes come along
+      nodes.swap(rhs.nodes);
    }
 
    /*********************************************
     * BST :: INITIALIZER LIST CONSTRUCTOR
     * Create a BST from an initializer list
     ********************************************/
-   template <typename T>
-   BST <T> ::BST(const std::initializer_list<T>& il)
-      : root(nullptr), numElements(0)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> ::BST(const std::initializer_list<T>& il, const A& a)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numAppends(0), numElements(0), isReclaimDeferred(false), alloc(a), compare()
    {
       // just call the assignmnent operator
       *this = il;
@@ -326,8 +830,8 @@ namespace custom
    /*********************************************
     * BST :: DESTRUCTOR
     ********************************************/
-   template <typename T>
-   BST <T> :: ~BST()
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> :: ~BST()
    {
       clear();
    }
@@ -337,11 +841,26 @@ namespace custom
     * BST :: ASSIGNMENT OPERATOR
     * Copy one tree to another
     ********************************************/
-   template <typename T>
-   BST <T>& BST <T> :: operator = (const BST <T>& rhs)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked>& BST <T, A, KeyOf, C, Ranked> :: operator = (const BST <T, A, KeyOf, C, Ranked>& rhs)
    {
+      if (this == &rhs)
+         return *this;
+
+      // take the allocator along if it propagates. Nodes from the old one
+      // cannot be reused since the new one could not free them.
+      if constexpr (NodeTraits::propagate_on_container_copy_assignment::value)
+      {
+         if (alloc != rhs.alloc)
+            clear();
+         alloc = rhs.alloc;
+      }
+
+      compare = rhs.compare;
       copyBinaryTree(rhs.root, this->root);
-      assert(nullptr == this->root || this->root->pParent == nullptr);
+      assert(nullptr == this->root || this->root->getParent() == nullptr);
+      pLeftmost = findLeftmost(root);
+      pRightmost = findRightmost(root);
       this->numElements = rhs.numElements;
 
       return *this;
@@ -351,33 +870,228 @@ namespace custom
     * BST :: ASSIGNMENT OPERATOR with INITIALIZATION LIST
     * Copy nodes onto a BTree
     ********************************************/
-   template <typename T>
-   BST <T>& BST <T> :: operator = (const std::initializer_list<T>& il)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked>& BST <T, A, KeyOf, C, Ranked> :: operator = (const std::initializer_list<T>& il)
    {
       // we cannot preserve the nodes so we must start from scratch
-      deleteBinaryTree(root);
-      numElements = 0;
+      assign(il.begin(), il.end());
+      return *this;
+   }
+
+   /*********************************************
+    * BST :: ASSIGN
+    * Replace the contents of the tree with [first, last). Sorted input
+    * becomes a balanced tree in linear time. Anything else is sorted
+    * first, which beats inserting one element at a time. With
+    * keepUnique, only the first of several equal keys is kept.
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Iterator>
+   void BST <T, A, KeyOf, C, Ranked> ::assign(Iterator first, Iterator last, bool keepUnique)
+   {
+      assignNodes(first, last, keepUnique, false /*isSorted*/);
+   }
 
-      // for each element in the initializer list, add into the BST using insert()
-      for (auto&& element : il)
-         insert(element);
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Iterator>
+   void BST <T, A, KeyOf, C, Ranked> ::assign(sorted_unique_t, Iterator first, Iterator last)
+   {
+      assignNodes(first, last, true /*keepUnique*/, true /*isSorted*/);
+   }
 
+   /*********************************************
+    * BST :: ASSIGN NODES
+    * A short range is inserted one element at a time, which takes fewer
+    * comparisons than checking and sorting it. A longer range we can walk
+    * twice that is already in order is hung straight from the source.
+    * Anything else is copied into nodes which are sorted before they
+    * are hung.
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Iterator>
+   void BST <T, A, KeyOf, C, Ranked> ::assignNodes(Iterator first, Iterator last, bool keepUnique, bool isSorted)
+   {
+      clear();
 
-      return *this;
+      // one pass over the source to see if it is strictly ascending
+      bool isAscending = isSorted;
+      if constexpr (isForwardIterator <Iterator> ::value)
+      {
+         if (!isSorted && size_t(std::distance(first, last)) < numAssignSortMin)
+         {
+            for (; first != last; ++first)
+               insertValue(*first, keepUnique);
+            return;
+         }
+         if (!isSorted)
+         {
+            isAscending = true;
+            for (Iterator itPrev = first, it = first; isAscending && it != last; itPrev = it)
+               if (++it != last)
+                  isAscending = compare(keyOf(*itPrev), keyOf(*it));
+         }
+         if (isAscending)
+         {
+            buildBalanced(first, std::distance(first, last),
+                          [this](const Iterator& it) { return createNode(*it); });
+            return;
+         }
+      }
+
+      // make the nodes, noticing along the way if they are already in order
+      std::vector <BNode*> nodes;
+      if constexpr (isForwardIterator <Iterator> ::value)
+         nodes.reserve(std::distance(first, last));
+      else
+         isAscending = true;
+      try
+      {
+         for (; first != last; ++first)
+         {
+            nodes.push_back(createNode(*first));
+            if (!isSorted && isAscending && nodes.size() > 1)
+               isAscending = compare(keyOf(nodes[nodes.size() - 2]->data), keyOf(nodes.back()->data));
+         }
+      }
+      catch (...)
+      {
+         for (auto pNode : nodes)
+            destroyNode(pNode);
+         throw;
+      }
+
+      // out of order or with duplicates: sort, keeping equal keys in the
+      // order they came, then drop all but the first of each key
+      if (!isSorted && !isAscending)
+      {
+         std::stable_sort(nodes.begin(), nodes.end(), [this](const BNode* pLHS, const BNode* pRHS)
+         {
+            return compare(keyOf(pLHS->data), keyOf(pRHS->data));
+         });
+
+         if (keepUnique)
+         {
+            size_t iDest = 0;
+            for (size_t i = 0; i < nodes.size(); i++)
+               if (iDest != 0 && !compare(keyOf(nodes[iDest - 1]->data), keyOf(nodes[i]->data)))
+                  destroyNode(nodes[i]);
+               else
+                  nodes[iDest++] = nodes[i];
+            nodes.resize(iDest);
+         }
+      }
+
+      buildBalanced(nodes.begin(), nodes.size(),
+                    [](const typename std::vector <BNode*> ::iterator& it) { return *it; });
+   }
+
+   /*********************************************
+    * BST :: BUILD BALANCED
+    * Make an empty tree out of num nodes that are already in order. Every
+    * subtree gets the middle node as its root so the two sides differ in
+    * size by at most one. That fills every level but the last, so coloring
+    * the last level red and the rest black satisfies the red-black rules.
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Iterator, class MakeNode>
+   void BST <T, A, KeyOf, C, Ranked> ::buildBalanced(Iterator it, size_t num, MakeNode makeNode)
+   {
+      assert(root == nullptr && numElements == 0);
+      if (num == 0)
+         return;
+
+      // the deepest level is floor(log2(n))
+      int depthRed = 0;
+      while ((size_t(2) << depthRed) <= num)
+         depthRed++;
+
+      root = buildBalanced(it, num, 0, depthRed, makeNode);
+      root->setParent(nullptr);
+      pLeftmost = findLeftmost(root);
+      pRightmost = findRightmost(root);
+      numAppends = 0;
+      numElements = num;
+   }
+
+   /*********************************************
+    * BST :: BUILD BALANCED
+    * Build a subtree of num nodes in order: the left half, then the
+    * middle, then the right half. Anything built so far is freed if
+    * making a node throws.
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Iterator, class MakeNode>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::buildBalanced(Iterator& it, size_t num,
+                                                                           int depth, int depthRed,
+                                                                           MakeNode& makeNode)
+   {
+      if (num == 0)
+         return nullptr;
+
+      size_t numLeft = num / 2;
+      BNode* pLeft = buildBalanced(it, numLeft, depth + 1, depthRed, makeNode);
+      BNode* pNode = nullptr;
+      try
+      {
+         pNode = makeNode(it);
+         ++it;
+         pNode->addLeft(pLeft);
+         pLeft = nullptr;
+         pNode->addRight(buildBalanced(it, num - numLeft - 1, depth + 1, depthRed, makeNode));
+         pNode->fixSize();
+      }
+      catch (...)
+      {
+         deleteBinaryTree(pNode ? pNode : pLeft);
+         throw;
+      }
+      pNode->setRed(depth == depthRed && depth != 0);
+      return pNode;
    }
 
    /*********************************************
     * BST :: ASSIGN-MOVE OPERATOR
     * Move one tree to another
     ********************************************/
-   template <typename T>
-   BST <T>& BST <T> :: operator = (BST <T>&& rhs)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked>& BST <T, A, KeyOf, C, Ranked> :: operator = (BST <T, A, KeyOf, C, Ranked>&& rhs)
+      noexcept(isMoveAssignNoexcept)
    {
+      if (this == &rhs)
+         return *this;
+
       // clear the old bst
       clear();
+      compare = rhs.compare;
 
-      // swap the trees
-      swap(rhs);
+      // the allocator comes along: steal the nodes
+      if constexpr (NodeTraits::propagate_on_container_move_assignment::value)
+      {
+         alloc = std::move(rhs.alloc);
+         std::swap(rhs.root, root);
+         std::swap(rhs.pLeftmost, pLeftmost);
+         std::swap(rhs.pRightmost, pRightmost);
+         std::swap(rhs.numElements, numElements);
+         nodes.swap(rhs.nodes);
+      }
+
+      // same allocator: the nodes can be stolen too
+      else if (alloc == rhs.alloc)
+      {
+         std::swap(rhs.root, root);
+         std::swap(rhs.pLeftmost, pLeftmost);
+         std::swap(rhs.pRightmost, pRightmost);
+         std::swap(rhs.numElements, numElements);
+         nodes.swap(rhs.nodes);
+      }
+
+      // different allocators: move the elements one at a time into our nodes
+      else
+      {
+         for (iterator it = rhs.begin(); it != rhs.end(); ++it)
+            insert(std::move(it.pNode->data));
+         rhs.clear();
+      }
 
       return *this;
    }
@@ -386,88 +1100,70 @@ namespace custom
     * BST :: SWAP
     * Swap two trees
     ********************************************/
-   template <typename T>
-   void BST <T> ::swap(BST <T>& rhs)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::swap(BST <T, A, KeyOf, C, Ranked>& rhs)
    {
       std::swap(rhs.root, root);
+      std::swap(rhs.pLeftmost, pLeftmost);
+      std::swap(rhs.pRightmost, pRightmost);
       std::swap(rhs.numElements, numElements);
+      std::swap(rhs.compare, compare);
+      nodes.swap(rhs.nodes);
+
+      // without propagation, swapping is only defined for equal allocators
+      if constexpr (NodeTraits::propagate_on_container_swap::value)
+         std::swap(rhs.alloc, alloc);
+      else
+         assert(alloc == rhs.alloc);
    }
 
    /*****************************************************
     * BST :: INSERT
     * Insert a node at a given location in the tree
     ****************************************************/
-   template <typename T>
-   std::pair<typename BST <T> ::iterator, bool> BST <T> ::insert(const T& t, bool keepUnique)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::insert(const T& t, bool keepUnique)
+   {
+      return insertValue(t, keepUnique);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::insert(T&& t, bool keepUnique)
+   {
+      return insertValue(std::move(t), keepUnique);
+   }
+
+   /*****************************************************
+    * BST :: INSERT VALUE
+    * Find the leaf where t belongs and hang a new node there. With
+    * a hint, the search starts next to it instead of at the root.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class U>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::insertValue(U&& t, bool keepUnique,
+                                                                                            const iterator* pHint)
    {
       std::pair<iterator, bool> pairReturn(end(), false);
       try
       {
-         // if we are at a trivial state (empty tree), then create a new root
-         if (root == nullptr)
+         // if the value is already here, then do nothing
+         BNode* pParent;
+         bool toLeft;
+         BNode* pMatch = (pHint == nullptr ?
+                          findSpot(keyOf(t), keepUnique, pParent, toLeft) :
+                          findSpotNear(*pHint, keyOf(t), keepUnique, pParent, toLeft));
+         if (pMatch != nullptr)
          {
-            assert(numElements == 0);
-            root = new BNode(t);
-            root->isRed = false;
-            numElements = 1;
-            pairReturn.first = iterator(root);
-            pairReturn.second = true;
+            pairReturn.first = iterator(pMatch, this);
+            pairReturn.second = false;
             return pairReturn;
          }
 
-         // otherwise, go a searching for the correct spot
-         BNode* node = root;
-         bool done = false;
-         while (!done)
-         {
-            // if the node is a match, then do nothing
-            if (keepUnique && t == node->data)
-            {
-               pairReturn.first = iterator(node);
-               pairReturn.second = false;
-               return pairReturn;
-            }
-
-            // if the center node is larger, go left
-            if (t < node->data)
-            {
-               // if there is a node to the left, follow it
-               if (node->pLeft)
-                  node = node->pLeft;
-               // if we are at the leaf, then create a new node
-               else
-               {
-                  node->addLeft(t);
-                  done = true;
-                  pairReturn.first = iterator(node->pLeft);
-                  pairReturn.second = true;
-               }
-            }
-
-            // if the center node is smaller, go right
-            else
-            {
-               // if there is a node to the right, follow it
-               if (node->pRight)
-                  node = node->pRight;
-               // if we are at the left, then create a new node.
-               else
-               {
-                  node->addRight(t);
-                  done = true;
-                  pairReturn.first = iterator(node->pRight);
-                  pairReturn.second = true;
-               }
-            }
-         }
-         // we just inserted something!
-         assert(root != nullptr);
-         numElements++;
-
-         // if the root moved out from under us, find it again.
-         while (root->pParent != nullptr)
-            root = root->pParent;
-         assert(root->pParent == nullptr);
+         // otherwise, hang a new node off the leaf
+         BNode* pNew = createNode(std::forward <U> (t));
+         linkNode(pParent, toLeft, pNew);
+         pairReturn.first = iterator(pNew, this);
+         pairReturn.second = true;
       }
       catch (...)
       {
@@ -476,322 +1172,1976 @@ namespace custom
       return pairReturn;
    }
 
-   template <typename T>
-   std::pair<typename BST <T> ::iterator, bool> BST <T> ::insert(T&& t, bool keepUnique)
+   /*****************************************************
+    * BST :: EMPLACE
+    * Construct a value in a new node from args and insert it. Since the
+    * key is not known until the value is built, a unique emplace of a
+    * key that is already here builds and discards a node.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class ... Args>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::emplace(Args&& ... args)
    {
-      std::pair<iterator, bool> pairReturn(end(), false);
-      try
-      {
-         // if we are at a trivial state (empty tree), then create a new root
-         if (root == nullptr)
-         {
-            assert(numElements == 0);
-            root = new BNode(std::move(t));
-            root->isRed = false;
-            numElements = 1;
-            pairReturn.first = iterator(root);
-            pairReturn.second = true;
-            return pairReturn;
-         }
+      return insertNode(createNode(std::in_place, std::forward <Args> (args)...), false /*keepUnique*/);
+   }
 
-         // otherwise, go a searching for the correct spot
-         BNode* node = root;
-         bool done = false;
-         while (!done)
-         {
-            // if the node is a match, then do nothing
-            if (keepUnique && t == node->data)
-            {
-               pairReturn.first = iterator(node);
-               pairReturn.second = false;
-               return pairReturn;
-            }
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class ... Args>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::emplaceUnique(Args&& ... args)
+   {
+      return insertNode(createNode(std::in_place, std::forward <Args> (args)...), true /*keepUnique*/);
+   }
 
-            // if the center node is larger, go left
-            if (t < node->data)
-            {
-               // if there is a node to the left, follow it
-               if (node->pLeft)
-                  node = node->pLeft;
-               // if we are at the leaf, then create a new node
-               else
-               {
-                  node->addLeft(std::move(t));
-                  done = true;
-                  pairReturn.first = iterator(node->pLeft);
-                  pairReturn.second = true;
-               }
-            }
+   /*****************************************************
+    * BST :: INSERT RANGE
+    * Insert each value of [first, last) where its key belongs
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Iterator>
+   void BST <T, A, KeyOf, C, Ranked> ::insert(Iterator first, Iterator last, bool keepUnique)
+   {
+      for (; first != last; ++first)
+         insert(*first, keepUnique);
+   }
 
-            // if the center node is smaller, go right
-            else
-            {
-               // if there is a node to the right, follow it
-               if (node->pRight)
-                  node = node->pRight;
-               // if we are at the left, then create a new node.
-               else
-               {
-                  node->addRight(std::move(t));
-                  done = true;
-                  pairReturn.first = iterator(node->pRight);
-                  pairReturn.second = true;
-               }
+   /*****************************************************
+    * BST :: TRY EMPLACE
+    * Like emplaceUnique(), but the caller hands over the key, so we can
+    * look before building anything. The args are those of the node's
+    * constructor: a value, or std::in_place followed by what builds one.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class ... Args>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::tryEmplace(const key_type& k,
+                                                                                          Args&& ... args)
+   {
+      BNode* pParent;
+      bool toLeft;
+      BNode* pMatch = findSpot(k, true /*keepUnique*/, pParent, toLeft);
+      if (pMatch != nullptr)
+         return std::pair<iterator, bool>(iterator(pMatch, this), false);
+
+      // not there: build the value in a new node right where the search ended
+      BNode* pNew = createNode(std::forward <Args> (args)...);
+      linkNode(pParent, toLeft, pNew);
+      return std::pair<iterator, bool>(iterator(pNew, this), true);
+   }
+
+   /*****************************************************
+    * BST :: INSERT with HINT
+    * Insert a value that probably belongs right before hint. When it
+    * does, no search from the root is needed.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::insert(iterator hint, const T& t, bool keepUnique)
+   {
+      return insertValue(t, keepUnique, &hint);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::insert(iterator hint, T&& t, bool keepUnique)
+   {
+      return insertValue(std::move(t), keepUnique, &hint);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class ... Args>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::emplaceHint(iterator hint, Args&& ... args)
+   {
+      return insertNode(createNode(std::in_place, std::forward <Args> (args)...), false /*keepUnique*/, &hint);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class ... Args>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::emplaceHintUnique(iterator hint, Args&& ... args)
+   {
+      return insertNode(createNode(std::in_place, std::forward <Args> (args)...), true /*keepUnique*/, &hint);
+   }
+
+   /*****************************************************
+    * BST :: INSERT NODE
+    * Hang a node that is already built where its key belongs. If
+    * keepUnique finds the key already here, the node is destroyed.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::insertNode(BNode* pNew, bool keepUnique,
+                                                                                           const iterator* pHint)
+   {
+      BNode* pParent;
+      bool toLeft;
+      BNode* pMatch = (pHint == nullptr ?
+                       findSpot(keyOf(pNew->data), keepUnique, pParent, toLeft) :
+                       findSpotNear(*pHint, keyOf(pNew->data), keepUnique, pParent, toLeft));
+      if (pMatch != nullptr)
+      {
+         destroyNode(pNew);
+         return std::pair<iterator, bool>(iterator(pMatch, this), false);
+      }
+
+      linkNode(pParent, toLeft, pNew);
+      return std::pair<iterator, bool>(iterator(pNew, this), true);
+   }
+
+   /*****************************************************
+    * BST :: FIND SPOT
+    * Find the leaf where a value with key k belongs: the new node would
+    * become pParent's left (toLeft) or right child. Equal keys go to the
+    * right so duplicates keep their insertion order.
+    *
+    * Only operator< is used on the way down. When keepUnique is set,
+    * the one node that could hold a match is the last one we went right
+    * at, so a single extra comparison at the bottom tells us if k is
+    * already here. That node is returned, otherwise nullptr.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::findSpot(const key_type& k, bool keepUnique,
+                                                                  BNode*& pParent, bool& toLeft) const
+   {
+      // appending past the largest key needs no search at all. Only bother
+      // to check once the last few inserts did so: the keys are coming in order.
+      if (numAppends >= 2 && pRightmost != nullptr && compare(keyOf(pRightmost->data), k))
+      {
+         pParent = pRightmost;
+         toLeft = false;
+         return nullptr;
+      }
+
+      pParent = nullptr;
+      toLeft = false;
+      BNode* pCandidate = nullptr;   // last node not larger than k
+      for (BNode* node = root; node != nullptr; )
+      {
+         pParent = node;
+         toLeft = compare(k, keyOf(node->data));
+         if (toLeft)
+            node = node->pLeft;
+         else
+         {
+            pCandidate = node;
+            node = node->pRight;
+         }
+      }
+
+      // the candidate is not larger than k. If it is not smaller either,
+      // then it is a match
+      if (keepUnique && pCandidate != nullptr && !compare(keyOf(pCandidate->data), k))
+         return pCandidate;
+      return nullptr;
+   }
+
+   /*****************************************************
+    * BST :: FIND SPOT NEAR
+    * Like findSpot(), but k probably belongs right before hint. If it
+    * falls strictly between hint and the node before it, the new node
+    * hangs off whichever of the two has a free child in between, and no
+    * search is needed. Otherwise we search from the root after all.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::findSpotNear(iterator hint, const key_type& k,
+                                                                          bool keepUnique,
+                                                                          BNode*& pParent, bool& toLeft) const
+   {
+      // the node after k and the node before it
+      BNode* pNext = hint.pNode;
+      BNode* pPrev = pRightmost;
+      if (pNext != nullptr)
+      {
+         iterator itPrev = hint;
+         --itPrev;
+         pPrev = itPrev.pNode;
+      }
+
+      // does k fit in between? An empty tree has nothing on either side.
+      bool fitsNext = (pNext == nullptr ? (root == nullptr || pPrev != nullptr) :
+                                          compare(k, keyOf(pNext->data)));
+      bool fitsPrev = (pPrev == nullptr || compare(keyOf(pPrev->data), k));
+      if (!fitsNext || !fitsPrev)
+         return findSpot(k, keepUnique, pParent, toLeft);
+
+      // with nothing to the left of pNext, k goes there. Otherwise pPrev is
+      // the largest node of pNext's left subtree and k goes to its right.
+      if (pNext != nullptr && pNext->pLeft == nullptr)
+      {
+         pParent = pNext;
+         toLeft = true;
+      }
+      else
+      {
+         assert(pPrev == nullptr || pPrev->pRight == nullptr);
+         pParent = pPrev;
+         toLeft = false;
+      }
+      return nullptr;
+   }
+
+   /*****************************************************
+    * BST :: LINK NODE
+    * Hang a new node where findSpot() said it goes and fix the colors
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::linkNode(BNode* pParent, bool toLeft, BNode* pNew)
+   {
+      // if we are at a trivial state (empty tree), then the new node is the root
+      if (pParent == nullptr)
+      {
+         assert(root == nullptr && numElements == 0);
+         root = pNew;
+         root->setRed(false);
+         pLeftmost = pRightmost = pNew;
+         numAppends = 0;
+         numElements = 1;
+         return;
+      }
+
+      if (toLeft)
+         pParent->addLeft(pNew);
+      else
+         pParent->addRight(pNew);
+
+      // every subtree above the new node just got one larger
+      if constexpr (Ranked)
+         for (BNode* p = pParent; p != nullptr; p = p->getParent())
+            p->numSubtree++;
+
+      if (!toLeft && pParent == pRightmost)
+      {
+         pRightmost = pNew;
+         numAppends++;
+      }
+      else
+         numAppends = 0;
+      if (toLeft && pParent == pLeftmost)
+         pLeftmost = pNew;
+      pNew->balance();
+
+      // we just inserted something!
+      assert(root != nullptr);
+      numElements++;
+
+      // if a rotation at the top moved the root, the new root is right above it
+      if (root->getParent() != nullptr)
+         root = root->getParent();
+      assert(root->getParent() == nullptr);
+   }
+
+   /*************************************************
+    * BST :: ERASE
+    * Remove a given node as specified by the iterator
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator BST <T, A, KeyOf, C, Ranked> ::erase(iterator& it)
+   {
+      // do nothing if there is nothing to do
+      if (it == end())
+         return end();
+
+      // remember where we were. The in-order successor is the next node
+      // no matter how the tree gets shuffled below.
+      iterator itNext(it.pNode, this);
+      ++itNext;
+      BNode* pDelete = it.pNode;
+      unlinkNode(pDelete);
+      destroyNode(pDelete);
+      return itNext;
+   }
+
+   /*************************************************
+    * BST :: POP FRONT and POP BACK
+    * Remove the smallest or the largest element. Both are at hand,
+    * and neither has more than a leaf below it, so apart from the
+    * rebalancing, which is amortized O(1), nothing is searched.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::popFront()
+   {
+      assert(!empty());
+      BNode* pDelete = pLeftmost;
+      unlinkNode(pDelete);
+      destroyNode(pDelete);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::popBack()
+   {
+      assert(!empty());
+      BNode* pDelete = pRightmost;
+      unlinkNode(pDelete);
+      destroyNode(pDelete);
+   }
+
+   /*************************************************
+    * BST :: ERASE RANGE
+    * Remove [first, last). Rather than unlinking one node at a time,
+    * cut the tree just before first and again just before last, free
+    * everything in between at once, and join what is left around last.
+    * Each cut and the join are O(log n), so the rest is the freeing.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator BST <T, A, KeyOf, C, Ranked> ::erase(iterator first, iterator last)
+   {
+      if (first == last)
+         return last;
+
+      // a short range is cheaper to erase one node at a time
+      iterator it = first;
+      for (size_t i = 0; i < numEraseRangeMin && it != last; i++)
+         ++it;
+      if (it == last)
+      {
+         while (first != last)
+            first = erase(first);
+         return last;
+      }
+
+      // cut out first, then last, leaving the nodes between them on their own
+      BNode* pFirst = first.pNode;
+      BNode* pLast = last.pNode;
+      Subtree before;
+      Subtree between;
+      Subtree after;
+      splitAt(pFirst, before, between);
+      if (pLast != nullptr)
+      {
+         splitAt(pLast, between, after);
+         root = join(before, pLast, after).pRoot;
+      }
+      else
+      {
+         root = before.pRoot;
+         pRightmost = findRightmost(root);
+      }
+      if (pFirst == pLeftmost)
+         pLeftmost = pLast;
+
+      size_t numErased = 1 + deleteBinaryTree(between.pRoot);
+      destroyNode(pFirst);
+      assert(numErased <= numElements);
+      numElements -= numErased;
+      numAppends = 0;
+      return last;
+   }
+
+   /*************************************************
+    * BST :: UNLINK NODE
+    * Take a node out of the tree and rebalance, leaving the node
+    * as if it were freshly made so it can be linked in somewhere else
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::unlinkNode(BNode* pDelete)
+   {
+      // the smallest or largest node is going away: its neighbor takes over
+      if (pDelete == pLeftmost)
+      {
+         iterator itNext(pDelete);
+         ++itNext;
+         pLeftmost = itNext.pNode;
+      }
+      if (pDelete == pRightmost)
+      {
+         iterator itPrev(pDelete);
+         --itPrev;
+         pRightmost = itPrev.pNode;
+      }
+
+      // the node that moves into the hole and its parent, needed for balancing
+      BNode* pReplace = nullptr;
+      BNode* pReplaceParent = nullptr;
+      bool removedBlack = !pDelete->isRed();
+
+      // if there is only one child (right) or no children (how sad!)
+      if (pDelete->pLeft == nullptr)
+      {
+         pReplace = pDelete->pRight;
+         pReplaceParent = pDelete->getParent();
+         deleteNode(pDelete, true /* goRight */);
+      }
+
+      // if there is only one child (left)
+      else if (pDelete->pRight == nullptr)
+      {
+         pReplace = pDelete->pLeft;
+         pReplaceParent = pDelete->getParent();
+         deleteNode(pDelete, false /* goRight */);
+      }
+
+      // otherwise, swap places with the in-order successor
+      else
+      {
+         // find the in-order successor (IOS)
+         BNode* pIOS = pDelete->pRight;
+         while (pIOS->pLeft != nullptr)
+            pIOS = pIOS->pLeft;
+
+         // the IOS leaves its old spot, so that is where a black node is lost
+         removedBlack = !pIOS->isRed();
+         pReplace = pIOS->pRight;
+         pReplaceParent = pIOS;
+
+         // the IOS must not have a right node. Now it will take pDelete's place.
+         assert(pIOS->pLeft == nullptr);
+         pIOS->pLeft = pDelete->pLeft;
+         if (pDelete->pLeft)
+            pDelete->pLeft->setParent(pIOS);
+
+         // if the IOS is not direct right sibling, then put it in the place of pDelete
+         if (pDelete->pRight != pIOS)
+         {
+            pReplaceParent = pIOS->getParent();
+
+            // if the IOS has a right sibling, then it takes his place
+            if (pIOS->pRight)
+               pIOS->pRight->setParent(pIOS->getParent());
+            pIOS->getParent()->pLeft = pIOS->pRight;
+
+            // make IOS's right child pDelete's right child
+            assert(pDelete->pRight != nullptr);
+            pIOS->pRight = pDelete->pRight;
+            pDelete->pRight->setParent(pIOS);
+         }
+
+         // hook up pIOS's successor
+         pIOS->setParent(pDelete->getParent());
+         if (pDelete->getParent() && pDelete->getParent()->pLeft == pDelete)
+            pDelete->getParent()->pLeft = pIOS;
+         if (pDelete->getParent() && pDelete->getParent()->pRight == pDelete)
+            pDelete->getParent()->pRight = pIOS;
+
+         // what if that was the root?!?!
+         if (root == pDelete)
+            root = pIOS;
+
+         // the IOS inherits the color of the spot it now occupies
+         pIOS->setRed(pDelete->isRed());
+      }
+
+      // every subtree between the hole and the root lost a node
+      if constexpr (Ranked)
+         for (BNode* p = pReplaceParent; p != nullptr; p = p->getParent())
+            p->fixSize();
+
+      // removing a black node shortens one path: fix it
+      if (removedBlack)
+         balanceErase(pReplace, pReplaceParent);
+
+      numElements--;
+      pDelete->pLeft = pDelete->pRight = nullptr;
+      pDelete->setParent(nullptr);
+      pDelete->setRed(true);
+      pDelete->fixSize();
+   }
+
+   /*************************************************
+    * BST :: EXTRACT
+    * Take a node out of the tree and hand it to the caller
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::NodeHandle BST <T, A, KeyOf, C, Ranked> ::extract(iterator it)
+   {
+      if (it == end())
+         return NodeHandle();
+      unlinkNode(it.pNode);
+      return NodeHandle(it.pNode, alloc);
+   }
+
+   /*************************************************
+    * BST :: INSERT NODE HANDLE
+    * Put an extracted node into the tree. If it was kept out because
+    * of keepUnique, the handle still owns it.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, bool> BST <T, A, KeyOf, C, Ranked> ::insert(NodeHandle&& nh, bool keepUnique)
+   {
+      if (nh.empty())
+         return std::pair<iterator, bool>(end(), false);
+
+      // we will be the ones freeing it
+      assert(alloc == nh.alloc);
+
+      BNode* pParent;
+      bool toLeft;
+      BNode* pMatch = findSpot(keyOf(nh.pNode->data), keepUnique, pParent, toLeft);
+      if (pMatch != nullptr)
+         return std::pair<iterator, bool>(iterator(pMatch, this), false);
+
+      BNode* pNew = nh.pNode;
+      nh.pNode = nullptr;
+      linkNode(pParent, toLeft, pNew);
+      return std::pair<iterator, bool>(iterator(pNew, this), true);
+   }
+
+   /*************************************************
+    * BST :: MERGE
+    * Move every node of source into this tree. With keepUnique, the
+    * nodes whose keys we already have stay behind in source.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::merge(BST& source, bool keepUnique)
+   {
+      if (this == &source)
+         return;
+      assert(alloc == source.alloc);
+
+      for (iterator it = source.begin(); it != source.end(); )
+      {
+         // the successor stays the successor as source gets shuffled
+         BNode* pMove = it.pNode;
+         ++it;
+
+         BNode* pParent;
+         bool toLeft;
+         if (findSpot(keyOf(pMove->data), keepUnique, pParent, toLeft) == nullptr)
+         {
+            source.unlinkNode(pMove);
+            linkNode(pParent, toLeft, pMove);
+         }
+      }
+   }
+
+   /*************************************************
+    * BST :: SPLIT
+    * Move the elements with keys before k into one tree and the rest
+    * into another, leaving this tree empty. The first node of the right
+    * side is cut out and then joined back on as its smallest element.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair<BST <T, A, KeyOf, C, Ranked>, BST <T, A, KeyOf, C, Ranked> > BST <T, A, KeyOf, C, Ranked> ::split(const key_type& k)
+   {
+      std::pair<BST, BST> pairReturn(BST(compare, A(alloc)), BST(compare, A(alloc)));
+      BST& left = pairReturn.first;
+      BST& right = pairReturn.second;
+
+      BNode* pFirst = lowerBoundNode(k);
+      if (pFirst == nullptr)
+      {
+         left.swap(*this);
+         return pairReturn;
+      }
+
+      Subtree before;
+      Subtree after;
+      splitAt(pFirst, before, after);
+      after = join(Subtree{ nullptr, 0 }, pFirst, after);
+
+      left.root = before.pRoot;
+      left.pLeftmost = (left.root != nullptr ? pLeftmost : nullptr);
+      left.pRightmost = findRightmost(left.root);
+      left.numElements = countLeft(before.pRoot, after.pRoot, numElements);
+      right.root = after.pRoot;
+      right.pLeftmost = pFirst;
+      right.pRightmost = pRightmost;
+      right.numElements = numElements - left.numElements;
+
+      root = pLeftmost = pRightmost = nullptr;
+      numElements = numAppends = 0;
+      return pairReturn;
+   }
+
+   /*************************************************
+    * BST :: JOIN
+    * Make one tree out of two, where nothing in left comes after
+    * anything in right. The smallest node of right is taken out and
+    * used to tie the two together.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> BST <T, A, KeyOf, C, Ranked> ::join(BST&& left, BST&& right)
+   {
+      if (right.root == nullptr)
+         return BST(std::move(left));
+      if (left.root == nullptr)
+         return BST(std::move(right));
+      assert(left.alloc == right.alloc);
+
+      BST tree(std::move(left));
+      BNode* pMiddle = right.pLeftmost;
+      assert(!tree.compare(keyOf(pMiddle->data), keyOf(tree.pRightmost->data)));
+      right.unlinkNode(pMiddle);
+
+      tree.root = join(Subtree{ tree.root, findBlackHeight(tree.root) }, pMiddle,
+                       Subtree{ right.root, findBlackHeight(right.root) }).pRoot;
+      tree.pRightmost = (right.pRightmost != nullptr ? right.pRightmost : pMiddle);
+      tree.numElements += right.numElements + 1;
+      tree.numAppends = 0;
+      right.root = right.pLeftmost = right.pRightmost = nullptr;
+      right.numElements = 0;
+      return tree;
+   }
+
+   /*************************************************
+    * BST :: SET UNION, INTERSECTION, DIFFERENCE
+    * The keys in either tree, in both, or in lhs but not rhs
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Combine>
+   BST <T, A, KeyOf, C, Ranked> BST <T, A, KeyOf, C, Ranked> ::setUnion(BST&& lhs, BST&& rhs, Combine combine,
+                                                                   unsigned numThreads)
+   {
+      return setOperation(SetOp::unite, std::move(lhs), std::move(rhs), combine, numThreads);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> BST <T, A, KeyOf, C, Ranked> ::setIntersection(BST&& lhs, BST&& rhs, unsigned numThreads)
+   {
+      auto keep = [](T&, T&) {};
+      return setOperation(SetOp::intersect, std::move(lhs), std::move(rhs), keep, numThreads);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   BST <T, A, KeyOf, C, Ranked> BST <T, A, KeyOf, C, Ranked> ::setDifference(BST&& lhs, BST&& rhs, unsigned numThreads)
+   {
+      auto keep = [](T&, T&) {};
+      return setOperation(SetOp::subtract, std::move(lhs), std::move(rhs), keep, numThreads);
+   }
+
+   /*************************************************
+    * BST :: SET OPERATION
+    * Hand the two trees to setNodes() and make a tree of what comes
+    * back. Every node either ends up in the result or in the garbage,
+    * so the size is what went in less what was thrown out.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Combine>
+   BST <T, A, KeyOf, C, Ranked> BST <T, A, KeyOf, C, Ranked> ::setOperation(SetOp op, BST&& lhs, BST&& rhs,
+                                                                       Combine& combine, unsigned numThreads)
+   {
+      assert(lhs.alloc == rhs.alloc);
+      size_t numTotal = lhs.numElements + rhs.numElements;
+      BST tree(std::move(lhs));
+
+      // fork until there is a thread for each piece, but only for large trees
+      if (numThreads == 0)
+         numThreads = std::thread::hardware_concurrency();
+      int depthFork = 0;
+      if (numTotal >= numParallelCopyMin)
+         while ((size_t(1) << depthFork) < size_t(numThreads))
+            depthFork++;
+
+      BNode* pGarbage = nullptr;
+      Subtree result = tree.setNodes(op, Subtree{ tree.root, findBlackHeight(tree.root) },
+                                     Subtree{ rhs.root, findBlackHeight(rhs.root) },
+                                     combine, pGarbage, depthFork);
+      rhs.root = rhs.pLeftmost = rhs.pRightmost = nullptr;
+      rhs.numElements = 0;
+
+      tree.root = result.pRoot;
+      tree.pLeftmost = findLeftmost(tree.root);
+      tree.pRightmost = findRightmost(tree.root);
+      tree.numElements = numTotal - tree.deleteBinaryTree(pGarbage);
+      tree.numAppends = 0;
+      return tree;
+   }
+
+   /*************************************************
+    * BST :: SET NODES
+    * The join-based divide and conquer. The root of one tree splits the
+    * other by its key. The halves on each side are worked on separately,
+    * the left ones on another thread while depthFork lasts, and joined
+    * back together around the root if it stays. For a union or an
+    * intersection the root comes from lhs; for a difference it comes
+    * from rhs. Splitting the larger tree by the keys of the smaller
+    * costs O(m log(n/m + 1)) in all.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class Combine>
+   typename BST <T, A, KeyOf, C, Ranked> ::Subtree BST <T, A, KeyOf, C, Ranked> ::setNodes(SetOp op, Subtree lhs,
+                                                                                  Subtree rhs, Combine& combine,
+                                                                                  BNode*& pGarbage,
+                                                                                  int depthFork) const
+   {
+      // one side is empty: keep or throw out the other as it is
+      if (lhs.pRoot == nullptr || rhs.pRoot == nullptr)
+      {
+         if (op == SetOp::unite)
+            return lhs.pRoot != nullptr ? lhs : rhs;
+         addGarbage(pGarbage, rhs.pRoot);
+         if (op == SetOp::intersect)
+         {
+            addGarbage(pGarbage, lhs.pRoot);
+            return Subtree{ nullptr, 0 };
+         }
+         return lhs;
+      }
+
+      // take the root of one tree and cut the other by its key
+      bool isPivotLeft = (op != SetOp::subtract);
+      Subtree& pivotTree = isPivotLeft ? lhs : rhs;
+      BNode* pPivot = pivotTree.pRoot;
+      Subtree pivotLeft = detachSubtree(pPivot->pLeft, pivotTree.blackHeight - 1);
+      Subtree pivotRight = detachSubtree(pPivot->pRight, pivotTree.blackHeight - 1);
+      pPivot->pLeft = pPivot->pRight = nullptr;
+      Subtree otherLeft;
+      Subtree otherRight;
+      BNode* pMatch;
+      splitKey(isPivotLeft ? rhs : lhs, keyOf(pPivot->data), otherLeft, pMatch, otherRight);
+
+      // lhs stays on the left of each call, whichever tree the pivot is from
+      Subtree lhsLeft = isPivotLeft ? pivotLeft : otherLeft;
+      Subtree rhsLeft = isPivotLeft ? otherLeft : pivotLeft;
+      Subtree lhsRight = isPivotLeft ? pivotRight : otherRight;
+      Subtree rhsRight = isPivotLeft ? otherRight : pivotRight;
+      Subtree left;
+      Subtree right;
+      bool isForked = false;
+      if (depthFork > 0)
+      {
+         BNode* pGarbageLeft = nullptr;
+         try
+         {
+            std::thread thread([&]()
+            {
+               left = setNodes(op, lhsLeft, rhsLeft, combine, pGarbageLeft, depthFork - 1);
+            });
+            right = setNodes(op, lhsRight, rhsRight, combine, pGarbage, depthFork - 1);
+            thread.join();
+            addGarbage(pGarbage, pGarbageLeft);
+            isForked = true;
+         }
+         catch (const std::system_error&)
+         {
+            // no thread to be had: do the left half here after all
+         }
+      }
+      if (!isForked)
+      {
+         left = setNodes(op, lhsLeft, rhsLeft, combine, pGarbage, depthFork - 1);
+         right = setNodes(op, lhsRight, rhsRight, combine, pGarbage, depthFork - 1);
+      }
+
+      // a union keeps the pivot, merging in its match. An intersection
+      // keeps it only with a match. A difference drops it and its match.
+      if (op == SetOp::unite || (op == SetOp::intersect && pMatch != nullptr))
+      {
+         if (pMatch != nullptr)
+         {
+            combine(pPivot->data, pMatch->data);
+            addGarbage(pGarbage, pMatch);
+         }
+         return join(left, pPivot, right);
+      }
+      addGarbage(pGarbage, pPivot);
+      if (pMatch != nullptr)
+         addGarbage(pGarbage, pMatch);
+      return joinPair(left, right);
+   }
+
+   /*************************************************
+    * BST :: ADD GARBAGE
+    * Throw out a whole subtree. The order does not matter, so what is
+    * already there hangs off the new subtree's leftmost node.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::addGarbage(BNode*& pGarbage, BNode* pRoot) noexcept
+   {
+      if (pRoot == nullptr)
+         return;
+      findLeftmost(pRoot)->pLeft = pGarbage;
+      pGarbage = pRoot;
+   }
+
+   /*****************************************************
+    * BST :: CLEAR
+    * Removes all the BNodes from a tree
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::clear() noexcept
+   {
+      // hand a large tree off to be freed in the background, only the
+      // pool outlives us. With no thread to be had, free it here after all.
+      if constexpr (usePool)
+      {
+         if (isReclaimDeferred && numElements > numReclaimMin)
+         {
+            try
+            {
+               if (reclaimer().add(root, numElements))
+                  root = nullptr;
+            }
+            catch (...)
+            {
+            }
+         }
+      }
+
+      if (root)
+         deleteBinaryTree(root);
+      pLeftmost = pRightmost = nullptr;
+      numElements = 0;
+
+      // an empty tree keeps no spare nodes from the others
+      nodes.release();
+   }
+
+   /*****************************************************
+    * BST :: FLUSH RECLAIM
+    * Wait until every node handed off by a deferred clear() is freed
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::flushReclaim()
+   {
+      if constexpr (usePool)
+         reclaimer().flush();
+   }
+
+   /*****************************************************
+    * BST :: NUM RECLAIM PENDING
+    * How many nodes a deferred clear() has yet to free
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   size_t BST <T, A, KeyOf, C, Ranked> ::numReclaimPending() noexcept
+   {
+      if constexpr (usePool)
+         return reclaimer().size();
+      else
+         return 0;
+   }
+
+   /*****************************************************
+    * BST :: RECLAIMER
+    * The nodes waiting to be freed for this node type. It is never
+    * destroyed so a tree with static storage duration can still defer.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::Reclaimer& BST <T, A, KeyOf, C, Ranked> ::reclaimer()
+   {
+      static Reclaimer* pReclaimer = new Reclaimer;
+      return *pReclaimer;
+   }
+
+   /*****************************************************
+    * BST :: STOP RECLAIMER
+    * Run at exit: free what is still pending, so that every element
+    * is destroyed, and join the thread
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::stopReclaimer() noexcept
+   {
+      reclaimer().stop();
+   }
+
+   /*****************************************************
+    * RECLAIMER :: ADD
+    * Take a whole tree to free on our thread, starting the thread the
+    * first time. The order of the nodes does not matter, so anything
+    * already waiting hangs off the new leftmost node. False once we have
+    * stopped, when the caller must free the tree itself.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   bool BST <T, A, KeyOf, C, Ranked> ::Reclaimer::add(BNode* pRoot, size_t num)
+   {
+      std::unique_lock <std::mutex> lock(mutex);
+      if (isStopped)
+         return false;
+      if (!thread.joinable())
+      {
+         thread = std::thread(&Reclaimer::run, this);
+         std::atexit(&BST::stopReclaimer);
+      }
+
+      findLeftmost(pRoot)->pLeft = pPending;
+      pPending = pRoot;
+      numPending += num;
+      lock.unlock();
+      cvWork.notify_one();
+      return true;
+   }
+
+   /*****************************************************
+    * RECLAIMER :: FLUSH
+    * Wait for the thread to free everything handed to it so far
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::Reclaimer::flush()
+   {
+      std::unique_lock <std::mutex> lock(mutex);
+      cvDone.wait(lock, [this]() { return numPending == 0; });
+   }
+
+   /*****************************************************
+    * RECLAIMER :: STOP
+    * Have the thread finish what is pending and quit. Trees
+    * cleared after this are freed by whoever clears them.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::Reclaimer::stop() noexcept
+   {
+      {
+         std::lock_guard <std::mutex> lock(mutex);
+         isStopped = true;
+      }
+      cvWork.notify_one();
+      if (thread.joinable())
+         thread.join();
+   }
+
+   /*****************************************************
+    * RECLAIMER :: RUN
+    * The thread: take everything pending and free it a batch at a
+    * time, giving the blocks back to the pool after each batch
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::Reclaimer::run() noexcept
+   {
+      NodeCache <BNode> cache;
+      std::unique_lock <std::mutex> lock(mutex);
+      for (;;)
+      {
+         cvWork.wait(lock, [this]() { return pPending != nullptr || isStopped; });
+         if (pPending == nullptr)
+            return;
+
+         BNode* pTree = pPending;
+         pPending = nullptr;
+         lock.unlock();
+         while (pTree)
+         {
+            size_t num = freeNodes(pTree, cache, numBatch);
+            cache.release();
+            numPending -= num;
+         }
+         lock.lock();
+         if (numPending == 0)
+            cvDone.notify_all();
+      }
+   }
+
+   /*****************************************************
+    * RECLAIMER :: FREE NODES
+    * Free up to num nodes. This is deleteBinaryTree() with a budget:
+    * left children are rotated up until the top node has none, then
+    * it is freed and its right child takes its place.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   size_t BST <T, A, KeyOf, C, Ranked> ::Reclaimer::freeNodes(BNode*& pRoot, NodeCache <BNode>& cache,
+                                                              size_t num) noexcept
+   {
+      size_t numFreed = 0;
+      while (numFreed < num && pRoot)
+      {
+         if (pRoot->pLeft)
+         {
+            BNode* pLeft = pRoot->pLeft;      // rotate right
+            pRoot->pLeft = pLeft->pRight;
+            pLeft->pRight = pRoot;
+            pRoot = pLeft;
+         }
+         else
+         {
+            BNode* pRight = pRoot->pRight;
+            pRoot->~BNode();
+            cache.deallocate(pRoot);
+            pRoot = pRight;
+            numFreed++;
+         }
+      }
+      return numFreed;
+   }
+
+   /*****************************************************
+    * BST :: CREATE NODE
+    * Allocate and construct a node from the tree's allocator
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class ... Args>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::createNode(Args&& ... args)
+   {
+      if constexpr (usePool)
+      {
+         void* p = nodes.allocate();
+         try
+         {
+            return ::new (p) BNode(std::forward <Args> (args)...);
+         }
+         catch (...)
+         {
+            nodes.deallocate(p);
+            throw;
+         }
+      }
+      else
+      {
+         BNode* pNode = NodeTraits::allocate(alloc, 1);
+         try
+         {
+            NodeTraits::construct(alloc, pNode, std::forward <Args> (args)...);
+         }
+         catch (...)
+         {
+            NodeTraits::deallocate(alloc, pNode, 1);
+            throw;
+         }
+         return pNode;
+      }
+   }
+
+   /*****************************************************
+    * BST :: DESTROY NODE
+    * Destroy and free a node made by createNode()
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::destroyNode(BNode* pNode) noexcept
+   {
+      if constexpr (usePool)
+      {
+         pNode->~BNode();
+         nodes.deallocate(pNode);
+      }
+      else
+         destroyNode(alloc, pNode);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::destroyNode(NodeAlloc& alloc, BNode* pNode) noexcept
+   {
+      if constexpr (usePool)
+         delete pNode;
+      else
+      {
+         NodeTraits::destroy(alloc, pNode);
+         NodeTraits::deallocate(alloc, pNode, 1);
+      }
+   }
+
+   /*****************************************************
+    * BST :: RESERVE
+    * Make sure num elements fit without going back to the pool
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::reserve(size_t num)
+   {
+      // only the free list can be filled ahead of time
+      if constexpr (usePool)
+         if (num > numElements)
+            nodes.reserve(num - numElements);
+   }
+
+   /*****************************************************
+    * BST :: SHRINK TO FIT
+    * Give our spare nodes back to the pool, and the chunks
+    * no tree is using back to the heap
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::shrink_to_fit()
+   {
+      if constexpr (usePool)
+      {
+         nodes.release();
+         BNode::pool().shrink_to_fit();
+      }
+   }
+
+   /*****************************************************
+    * BST :: BEGIN
+    * Return the first node (left-most) in a binary search tree.
+    * The tree keeps track of it, so there is no walk down.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator custom::BST <T, A, KeyOf, C, Ranked> ::begin() const noexcept
+   {
+      // if the BST is empty, this is the end() iterator
+      return iterator(pLeftmost, this);
+   }
+
+   /*****************************************************
+    * BST :: RBEGIN
+    * Return the last node (right-most) in a binary search tree
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator  BST <T, A, KeyOf, C, Ranked> ::rbegin() const noexcept
+   {
+      return iterator(pRightmost, this);
+   }
+
+   /****************************************************
+    * BST :: FIND
+    * Return the node corresponding to a given key
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator BST <T, A, KeyOf, C, Ranked> ::find(const key_type& k)
+   {
+      return iterator(findNode(k), this);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class K, class CC, class>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator BST <T, A, KeyOf, C, Ranked> ::find(const K& k)
+   {
+      return iterator(findNode(k), this);
+   }
+
+   /****************************************************
+    * BST :: FIND NODE
+    * Find the node with a key equivalent to k, or nullptr. K is either
+    * the key_type or something the comparator can hold up against it.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class K>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::findNode(const K& k) const
+   {
+      // find the first node not smaller than k using only the comparator
+      BNode* pCandidate = lowerBoundNode(k);
+
+      // it is a match if k is not smaller than it either
+      if (pCandidate != nullptr && !compare(k, keyOf(pCandidate->data)))
+         return pCandidate;
+
+      // nothing was found
+      return nullptr;
+   }
+
+   /*****************************************************
+    * BST :: LOWER BOUND NODE
+    * The first node in p's subtree whose key is not less than k. If
+    * there is none, pBound: the first such node after the subtree.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class K>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::lowerBoundNode(const K& k, BNode* p,
+                                                                                     BNode* pBound) const
+   {
+      while (p != nullptr)
+         if (compare(keyOf(p->data), k))
+            p = p->pRight;
+         else
+         {
+            pBound = p;
+            p = p->pLeft;
+         }
+      return pBound;
+   }
+
+   /*****************************************************
+    * BST :: UPPER BOUND NODE
+    * The first node in p's subtree whose key is greater than k, or
+    * pBound if there is none
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class K>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::upperBoundNode(const K& k, BNode* p,
+                                                                                     BNode* pBound) const
+   {
+      while (p != nullptr)
+         if (compare(k, keyOf(p->data)))
+         {
+            pBound = p;
+            p = p->pLeft;
+         }
+         else
+            p = p->pRight;
+      return pBound;
+   }
+
+   /*****************************************************
+    * BST :: EQUAL RANGE NODES
+    * The elements with a key equivalent to k. Both bounds come from one
+    * descent: it goes together until it reaches a match, then the lower
+    * bound is in the match's left subtree and the upper in its right.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class K>
+   std::pair<typename BST <T, A, KeyOf, C, Ranked> ::iterator, typename BST <T, A, KeyOf, C, Ranked> ::iterator>
+   BST <T, A, KeyOf, C, Ranked> ::equalRangeNodes(const K& k) const
+   {
+      BNode* pUpper = nullptr;
+      for (BNode* p = root; p != nullptr; )
+         if (compare(keyOf(p->data), k))
+            p = p->pRight;
+         else if (compare(k, keyOf(p->data)))
+         {
+            pUpper = p;
+            p = p->pLeft;
+         }
+         else
+            return std::pair<iterator, iterator>(iterator(lowerBoundNode(k, p->pLeft, p), this),
+                                                 iterator(upperBoundNode(k, p->pRight, pUpper), this));
+      return std::pair<iterator, iterator>(iterator(pUpper, this), iterator(pUpper, this));
+   }
+
+   /*****************************************************
+    * BST :: RANGE
+    * The elements with a key in [lo, hi)
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   Range <typename BST <T, A, KeyOf, C, Ranked> ::iterator> BST <T, A, KeyOf, C, Ranked> ::range(const key_type& lo,
+                                                                                         const key_type& hi) const
+   {
+      if (!compare(lo, hi))
+         return Range <iterator> (end(), end());
+      return Range <iterator> (lowerBound(lo), lowerBound(hi));
+   }
+
+   /*****************************************************
+    * BST :: NTH
+    * The element with k elements before it, or end() if there are
+    * not that many. A Ranked tree steers by the subtree sizes.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator BST <T, A, KeyOf, C, Ranked> ::nth(size_t k) const
+   {
+      if (k >= numElements)
+         return end();
+
+      if constexpr (Ranked)
+         return iterator(BNode::select(root, k), this);
+      else
+      {
+         iterator it = begin();
+         while (k--)
+            ++it;
+         return it;
+      }
+   }
+
+   /*****************************************************
+    * BST :: RANK
+    * How many elements have a key less than k. A Ranked tree adds up
+    * the left subtrees it passes on the way down.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   size_t BST <T, A, KeyOf, C, Ranked> ::rank(const key_type& k) const
+   {
+      size_t num = 0;
+      if constexpr (Ranked)
+      {
+         for (const BNode* p = root; p != nullptr; )
+            if (compare(keyOf(p->data), k))
+            {
+               num += BNode::sizeOf(p->pLeft) + 1;
+               p = p->pRight;
+            }
+            else
+               p = p->pLeft;
+      }
+      else
+      {
+         for (iterator it = begin(); it != end() && compare(keyOf(*it), k); ++it)
+            num++;
+      }
+      return num;
+   }
+
+   /*****************************************************
+    * BST :: COUNT RANGE
+    * How many elements have a key in [lo, hi)
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   size_t BST <T, A, KeyOf, C, Ranked> ::countRange(const key_type& lo, const key_type& hi) const
+   {
+      if (!compare(lo, hi))
+         return 0;
+      return rank(hi) - rank(lo);
+   }
+
+   /*****************************************************
+    * DELETE BINARY TREE
+    * Delete all the nodes below pThis including pThis.
+    * Rather than recursing, rotate each left child up until
+    * the node on top has none, then delete it and move on
+    * to its right. No stack is needed however deep the tree.
+    * Return how many nodes were deleted.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   size_t BST <T, A, KeyOf, C, Ranked> ::deleteBinaryTree(BNode*& pDelete) noexcept
+   {
+      size_t numDeleted = 0;
+      BNode* pNode = pDelete;
+      while (pNode != nullptr)
+      {
+         if (pNode->pLeft)
+         {
+            BNode* pLeft = pNode->pLeft;         // rotate right
+            pNode->pLeft = pLeft->pRight;
+            pLeft->pRight = pNode;
+            pNode = pLeft;
+         }
+         else
+         {
+            BNode* pRight = pNode->pRight;
+            destroyNode(pNode);
+            pNode = pRight;
+            numDeleted++;
+         }
+      }
+      pDelete = nullptr;
+      return numDeleted;
+   }
+
+   /**********************************************
+    * COPY BINARY TREE
+    * Copy pSrc onto pDest, reusing the nodes already
+    * in pDest and deleting any left over. Both trees are
+    * walked in step using the parent pointers so no stack
+    * is needed however deep the tree.
+    *********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::copyBinaryTree(const BNode* pSrc, BNode*& pDest)
+   {
+      auto makeNode = [this](const T& t) { return createNode(t); };
+      copyBinaryTree(pSrc, pDest, makeNode);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   template <class MakeNode>
+   void BST <T, A, KeyOf, C, Ranked> ::copyBinaryTree(const BNode* pSrc, BNode*& pDest, MakeNode& makeNode)
+   {
+      // if there is no node in pSrc, then do nothing
+      if (nullptr == pSrc)
+      {
+         deleteBinaryTree(pDest);
+         return;
+      }
+
+      // copy the data and color of one node, making it if needed
+      auto copyNode = [&makeNode](const BNode* pSrc, BNode*& pDest)
+      {
+         try
+         {
+            if (nullptr == pDest)
+               pDest = makeNode(pSrc->data);
+            // otherwise, assign the data over
+            else
+               pDest->data = pSrc->data;
+         }
+         catch (...)
+         {
+            throw "ERROR: Unable to allocate a node";
+         }
+         assert(pDest != nullptr);
+         pDest->setRed(pSrc->isRed());
+         if constexpr (Ranked)
+            pDest->numSubtree = pSrc->numSubtree;
+      };
+
+      copyNode(pSrc, pDest);                             // V
+      const BNode* pS = pSrc;
+      BNode* pD = pDest;
+      for (;;)
+      {
+         // go left as far as we can
+         if (pS->pLeft)
+         {
+            copyNode(pS->pLeft, pD->pLeft);              // L
+            pD->pLeft->setParent(pD);
+            pS = pS->pLeft;
+            pD = pD->pLeft;
+            continue;
+         }
+         deleteBinaryTree(pD->pLeft);
+
+         // then go right once, climbing out of every finished subtree
+         for (;;)
+         {
+            if (pS->pRight)
+            {
+               copyNode(pS->pRight, pD->pRight);         // R
+               pD->pRight->setParent(pD);
+               pS = pS->pRight;
+               pD = pD->pRight;
+               break;
+            }
+            deleteBinaryTree(pD->pRight);
+
+            const BNode* pChild;
+            do
+            {
+               if (pS == pSrc)
+                  return;
+               pChild = pS;
+               pS = pS->getParent();
+               pD = pD->getParent();
+            }
+            while (pS->pRight == pChild);
+         }
+      }
+   }
+
+   /**********************************************
+    * BST :: ASSIGN PARALLEL
+    * Copy rhs onto this tree, splitting the work across
+    * numThreads threads. Small trees, and trees whose
+    * allocator we cannot share between threads, are
+    * copied the usual way.
+    *********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::assignParallel(const BST& rhs, unsigned numThreads)
+   {
+      if (numThreads == 0)
+         numThreads = std::thread::hardware_concurrency();
+
+      if constexpr (usePool)
+      {
+         if (this != &rhs && numThreads > 1 && rhs.numElements >= numParallelCopyMin)
+         {
+            copyParallel(rhs, numThreads);
+            return;
+         }
+      }
+
+      *this = rhs;
+   }
+
+   /**********************************************
+    * BST :: COPY PARALLEL
+    * Copy the top few levels here, hand the subtrees
+    * below them out to the threads, then hang the copies
+    * back where they belong. Each thread has a free list
+    * of its own, filled from the pool in batches under the
+    * pool's lock, and gives back what it did not use.
+    *********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::copyParallel(const BST& rhs, unsigned numThreads)
+   {
+      assert(usePool);
+      clear();
+      compare = rhs.compare;
+
+      // a few subtrees per thread so one slow subtree does not hold up the rest
+      int depthSplit = 1;
+      while ((size_t(1) << depthSplit) < size_t(numThreads) * 4)
+         depthSplit++;
+
+      std::vector <CopyTask> tasks;
+      try
+      {
+         copyTop(rhs.root, root, 0, depthSplit, tasks);
+      }
+      catch (...)
+      {
+         deleteBinaryTree(root);
+         throw;
+      }
+
+      std::mutex mutexError;
+      std::atomic <size_t> iNext(0);
+      std::exception_ptr pError;
+      auto work = [&]()
+      {
+         // the spare nodes go back to the pool when we are done
+         NodeCache <BNode> cache;
+         auto makeNode = [&cache](const T& t) -> BNode*
+         {
+            void* p = cache.allocate();
+            try
+            {
+               return ::new (p) BNode(t);
+            }
+            catch (...)
+            {
+               cache.deallocate(p);
+               throw;
             }
+         };
+
+         try
+         {
+            for (size_t i = iNext++; i < tasks.size(); i = iNext++)
+               copyBinaryTree(tasks[i].pSrc, tasks[i].pCopy, makeNode);
+         }
+         catch (...)
+         {
+            std::lock_guard <std::mutex> lock(mutexError);
+            if (!pError)
+               pError = std::current_exception();
+            iNext = tasks.size();
          }
-         // we just inserted something!
-         assert(root != nullptr);
-         numElements++;
+      };
 
-         // if the root moved out from under us, find it again.
-         while (root->pParent != nullptr)
-            root = root->pParent;
-         assert(root->pParent == nullptr);
+      // this thread works too. If a thread cannot be started, make do with fewer
+      std::vector <std::thread> threads;
+      try
+      {
+         for (unsigned i = 1; i < numThreads && i < tasks.size(); i++)
+            threads.emplace_back(work);
       }
       catch (...)
       {
-         throw "ERROR: Unable to allocate a node";
       }
-      return pairReturn;
+      work();
+      for (auto& thread : threads)
+         thread.join();
+
+      // hang the copies, even partial ones so they can be freed
+      for (auto& task : tasks)
+         if (task.isLeft)
+            task.pParent->addLeft(task.pCopy);
+         else
+            task.pParent->addRight(task.pCopy);
+      if (pError)
+      {
+         deleteBinaryTree(root);
+         std::rethrow_exception(pError);
+      }
+
+      pLeftmost = findLeftmost(root);
+      pRightmost = findRightmost(root);
+      numAppends = 0;
+      numElements = rhs.numElements;
+   }
+
+   /**********************************************
+    * BST :: COPY TOP
+    * Copy the nodes above depthSplit, noting each
+    * subtree at depthSplit as a task for the threads
+    *********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::copyTop(const BNode* pSrc, BNode*& pDest, int depth, int depthSplit,
+                                       std::vector <CopyTask>& tasks)
+   {
+      if (pSrc == nullptr)
+         return;
+
+      pDest = createNode(pSrc->data);
+      pDest->setRed(pSrc->isRed());
+      if constexpr (Ranked)
+         pDest->numSubtree = pSrc->numSubtree;
+
+      for (bool isLeft : { true, false })
+      {
+         const BNode* pChild = isLeft ? pSrc->pLeft : pSrc->pRight;
+         if (pChild == nullptr)
+            continue;
+         if (depth + 1 == depthSplit)
+            tasks.push_back(CopyTask{ pChild, pDest, isLeft, nullptr });
+         else
+         {
+            BNode*& pDestChild = isLeft ? pDest->pLeft : pDest->pRight;
+            copyTop(pChild, pDestChild, depth + 1, depthSplit, tasks);
+            pDestChild->setParent(pDest);
+         }
+      }
+   }
+
+   /****************************************************
+    * DELETE NODE
+    * Delete a single node (pDelete) from the tree indicated
+    * by a node (pDelete).
+    *    pDelete     the node to be deleted
+    *    toRight     should the right branch inherit our place?
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::deleteNode(BNode*& pDelete, bool toRight)
+   {
+      // shift everything up
+      BNode* pNext = (toRight ? pDelete->pRight : pDelete->pLeft);
+
+      // if we are not the parent, hook ourselves into the existing tree
+      if (pDelete != root)
+      {
+         if (pDelete->getParent()->pLeft == pDelete)
+         {
+            pDelete->getParent()->pLeft = nullptr;
+            pDelete->getParent()->addLeft(pNext);
+         }
+         else
+         {
+            pDelete->getParent()->pRight = nullptr;
+            pDelete->getParent()->addRight(pNext);
+         }
+      }
+
+      // otherwise, the pNext is the new root
+      else
+      {
+         root = pNext;
+         if (pNext)
+            pNext->setParent(nullptr);
+      }
    }
 
-   /*************************************************
-    * BST :: ERASE
-    * Remove a given node as specified by the iterator
-    ************************************************/
-   template <typename T>
-   typename BST <T> ::iterator BST <T> ::erase(iterator& it)
+   /****************************************************
+    * BST :: ROTATE LEFT
+    * pNode's right child takes pNode's place:
+    *       (n)                 (r)
+    *         +--+      ->   +--+
+    *           (r)        (n)
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::rotateLeft(BNode* pNode)
    {
-      // do nothing if there is nothing to do
-      if (it == end())
-         return end();
+      assert(pNode != nullptr && pNode->pRight != nullptr);
+      BNode* pHead = pNode->pRight;
+      BNode* pParent = pNode->getParent();
 
-      // remember where we were
-      iterator itNext = it;
-      BNode* pDelete = it.pNode;
+      pNode->addRight(pHead->pLeft);
+      pHead->addLeft(pNode);
+      pNode->fixSize();
+      pHead->fixSize();
 
-      // if there is only one child (right) or no children (how sad!)
-      if (pDelete->pLeft == nullptr)
+      if (pParent == nullptr)
       {
-         ++itNext;
-         deleteNode(pDelete, true /* goRight */);
+         root = pHead;
+         pHead->setParent(nullptr);
       }
+      else if (pParent->pLeft == pNode)
+         pParent->addLeft(pHead);
+      else
+         pParent->addRight(pHead);
+   }
 
-      // if there is only one child (left)
-      else if (pDelete->pRight == nullptr)
+   /****************************************************
+    * BST :: ROTATE RIGHT
+    * pNode's left child takes pNode's place:
+    *       (n)               (l)
+    *    +--+        ->         +--+
+    *  (l)                        (n)
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::rotateRight(BNode* pNode)
+   {
+      assert(pNode != nullptr && pNode->pLeft != nullptr);
+      BNode* pHead = pNode->pLeft;
+      BNode* pParent = pNode->getParent();
+
+      pNode->addLeft(pHead->pRight);
+      pHead->addRight(pNode);
+      pNode->fixSize();
+      pHead->fixSize();
+
+      if (pParent == nullptr)
       {
-         ++itNext;
-         deleteNode(pDelete, false /* goRight */);
+         root = pHead;
+         pHead->setParent(nullptr);
       }
-
-      // otherwise, swap places with the in-order successor
+      else if (pParent->pLeft == pNode)
+         pParent->addLeft(pHead);
       else
-      {
-         // find the in-order successor (IOS)
-         BNode* pIOS = pDelete->pRight;
-         while (pIOS->pLeft != nullptr)
-            pIOS = pIOS->pLeft;
+         pParent->addRight(pHead);
+   }
 
-         // the IOS must not have a right node. Now it will take pDelete's place.
-         assert(pIOS->pLeft == nullptr);
-         pIOS->pLeft = pDelete->pLeft;
-         if (pDelete->pLeft)
-            pDelete->pLeft->pParent = pIOS;
+   /****************************************************
+    * BST :: BALANCE ERASE
+    * A black node was removed from above pNode, so every path
+    * through pNode is one black node short. pNode may be nullptr
+    * (an empty leaf) which is why its parent is passed along.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::balanceErase(BNode* pNode, BNode* pParent)
+   {
+      while (pNode != root && (pNode == nullptr || pNode->isRed() == false))
+      {
+         assert(pParent != nullptr);
 
-         // if the IOS is not direct right sibling, then put it in the place of pDelete
-         if (pDelete->pRight != pIOS)
+         // we are on the left, the sibling is on the right
+         if (pParent->pLeft == pNode)
          {
-            // if the IOS has a right sibling, then it takes his place
-            if (pIOS->pRight)
-               pIOS->pRight->pParent = pIOS->pParent;
-            pIOS->pParent->pLeft = pIOS->pRight;
+            BNode* pSibling = pParent->pRight;
+            assert(pSibling != nullptr); // the other side has a black node to spare
 
-            // make IOS's right child pDelete's right child
-            assert(pDelete->pRight != nullptr);
-            pIOS->pRight = pDelete->pRight;
-            pDelete->pRight->pParent = pIOS;
+            // Case 1: red sibling. Rotate so the sibling is black
+            if (pSibling->isRed())
+            {
+               pSibling->setRed(false);
+               pParent->setRed(true);
+               rotateLeft(pParent);
+               pSibling = pParent->pRight;
+            }
+
+            // Case 2: black sibling with black children. Push the problem up
+            if ((pSibling->pLeft  == nullptr || pSibling->pLeft->isRed()  == false) &&
+                (pSibling->pRight == nullptr || pSibling->pRight->isRed() == false))
+            {
+               pSibling->setRed(true);
+               pNode = pParent;
+               pParent = pNode->getParent();
+            }
+            else
+            {
+               // Case 3: only the near nephew is red. Turn it into case 4
+               if (pSibling->pRight == nullptr || pSibling->pRight->isRed() == false)
+               {
+                  pSibling->pLeft->setRed(false);
+                  pSibling->setRed(true);
+                  rotateRight(pSibling);
+                  pSibling = pParent->pRight;
+               }
+
+               // Case 4: the far nephew is red. One rotation finishes the job
+               pSibling->setRed(pParent->isRed());
+               pParent->setRed(false);
+               pSibling->pRight->setRed(false);
+               rotateLeft(pParent);
+               pNode = root;
+            }
          }
 
-         // hook up pIOS's successor
-         pIOS->pParent = pDelete->pParent;
-         if (pDelete->pParent && pDelete->pParent->pLeft == pDelete)
-            pDelete->pParent->pLeft = pIOS;
-         if (pDelete->pParent && pDelete->pParent->pRight == pDelete)
-            pDelete->pParent->pRight = pIOS;
+         // the mirror image: we are on the right, the sibling is on the left
+         else
+         {
+            BNode* pSibling = pParent->pLeft;
+            assert(pSibling != nullptr);
 
-         // what if that was the root?!?!
-         if (root == pDelete)
-            root = pIOS;
+            // Case 1: red sibling
+            if (pSibling->isRed())
+            {
+               pSibling->setRed(false);
+               pParent->setRed(true);
+               rotateRight(pParent);
+               pSibling = pParent->pLeft;
+            }
 
-         itNext = iterator(pIOS);
+            // Case 2: black sibling with black children
+            if ((pSibling->pLeft  == nullptr || pSibling->pLeft->isRed()  == false) &&
+                (pSibling->pRight == nullptr || pSibling->pRight->isRed() == false))
+            {
+               pSibling->setRed(true);
+               pNode = pParent;
+               pParent = pNode->getParent();
+            }
+            else
+            {
+               // Case 3: only the near nephew is red
+               if (pSibling->pLeft == nullptr || pSibling->pLeft->isRed() == false)
+               {
+                  pSibling->pRight->setRed(false);
+                  pSibling->setRed(true);
+                  rotateLeft(pSibling);
+                  pSibling = pParent->pLeft;
+               }
+
+               // Case 4: the far nephew is red
+               pSibling->setRed(pParent->isRed());
+               pParent->setRed(false);
+               pSibling->pLeft->setRed(false);
+               rotateRight(pParent);
+               pNode = root;
+            }
+         }
       }
 
-      numElements--;
-      delete pDelete;
-      return itNext;
+      // a red node (or the root) absorbs the extra black
+      if (pNode != nullptr)
+         pNode->setRed(false);
    }
 
-   /*****************************************************
-    * BST :: CLEAR
-    * Removes all the BNodes from a tree
+   /****************************************************
+    * BST :: FIND BLACK HEIGHT
+    * How many black nodes are on every path down from pNode,
+    * counting pNode itself. Any path will do, so go left.
     ****************************************************/
-   template <typename T>
-   void BST <T> ::clear() noexcept
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   int BST <T, A, KeyOf, C, Ranked> ::findBlackHeight(const BNode* pNode) noexcept
    {
-      if (root)
-         deleteBinaryTree(root);
-      numElements = 0;
+      int blackHeight = 0;
+      for (; pNode != nullptr; pNode = pNode->pLeft)
+         if (!pNode->isRed())
+            blackHeight++;
+      return blackHeight;
    }
 
-   /*****************************************************
-    * BST :: BEGIN
-    * Return the first node (left-most) in a binary search tree
+   /****************************************************
+    * BST :: DETACH SUBTREE
+    * Make the subtree under pNode a tree of its own. A red root
+    * turns black, which adds one to its black height.
     ****************************************************/
-   template <typename T>
-   typename BST <T> ::iterator custom::BST <T> ::begin() const noexcept
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::Subtree BST <T, A, KeyOf, C, Ranked> ::detachSubtree(BNode* pNode,
+                                                                                      int blackHeight) noexcept
    {
-      // if the BST is empty, return the nullptr iterator.
-      if (root == nullptr)
-         return end();
-
-      // otherwise, find the left-most node;
-      BNode* p = root;
-      while (p->pLeft)
-         p = p->pLeft;
-      return iterator(p);
+      if (pNode != nullptr)
+      {
+         pNode->setParent(nullptr);
+         if (pNode->isRed())
+         {
+            pNode->setRed(false);
+            blackHeight++;
+         }
+      }
+      return Subtree{ pNode, blackHeight };
    }
 
-#ifdef NEVER
-   /*****************************************************
-    * BST :: RBEGIN
-    * Return the last node (right-most) in a binary search tree
+   /****************************************************
+    * BST :: JOIN
+    * Make one tree of left, pMiddle and right, where every key in left
+    * comes before pMiddle and every key in right after it. If one side
+    * is taller, go down its inner edge to a black node as tall as the
+    * other side, put pMiddle there in red with the two as its children,
+    * and rebalance from pMiddle. That costs the difference in heights.
+    *
+    *         left                         left
+    *        +--+                         +--+
+    *           ...          ->              ...
+    *             +--+                         +--+
+    *                (c)  +  (m)  +  right        (m)
+    *                                          +--+--+
+    *                                        (c)    right
     ****************************************************/
-   template <typename T>
-   typename BST <T> ::iterator  BST <T> ::rbegin() const noexcept
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::Subtree BST <T, A, KeyOf, C, Ranked> ::join(Subtree left, BNode* pMiddle,
+                                                                             Subtree right) noexcept
    {
-      // if the BST is empty, return the nullptr iterator.
-      if (root == nullptr)
-         return end();
+      assert(left.pRoot == nullptr || (!left.pRoot->isRed() && left.pRoot->getParent() == nullptr));
+      assert(right.pRoot == nullptr || (!right.pRoot->isRed() && right.pRoot->getParent() == nullptr));
+      pMiddle->pLeft = pMiddle->pRight = nullptr;
+      pMiddle->setParent(nullptr);
 
-      // otherwise, find the left-most node;
-      BNode* p = root;
-      while (p->pRight)
-         p = p->pRight;
-      return iterator(p);
+      // just as tall: pMiddle goes on top
+      if (left.blackHeight == right.blackHeight)
+      {
+         pMiddle->addLeft(left.pRoot);
+         pMiddle->addRight(right.pRoot);
+         pMiddle->setRed(false);
+         pMiddle->fixSize();
+         return Subtree{ pMiddle, left.blackHeight + 1 };
+      }
+
+      // otherwise find the spot on the taller side's inner edge
+      bool isLeftTaller = left.blackHeight > right.blackHeight;
+      Subtree& taller = isLeftTaller ? left : right;
+      int blackHeightShort = isLeftTaller ? right.blackHeight : left.blackHeight;
+      BNode* pParent = nullptr;
+      BNode* pNode = taller.pRoot;
+      for (int blackHeight = taller.blackHeight;
+           pNode != nullptr && (pNode->isRed() || blackHeight > blackHeightShort); )
+      {
+         if (!pNode->isRed())
+            blackHeight--;
+         pParent = pNode;
+         pNode = isLeftTaller ? pNode->pRight : pNode->pLeft;
+      }
+      assert(pParent != nullptr);
+
+      // hang pMiddle there with the shorter tree beside it
+      pMiddle->setRed(true);
+      if (isLeftTaller)
+      {
+         pMiddle->addLeft(pNode);
+         pMiddle->addRight(right.pRoot);
+         pParent->addRight(pMiddle);
+      }
+      else
+      {
+         pMiddle->addLeft(left.pRoot);
+         pMiddle->addRight(pNode);
+         pParent->addLeft(pMiddle);
+      }
+      if constexpr (Ranked)
+         for (BNode* p = pMiddle; p != nullptr; p = p->getParent())
+            p->fixSize();
+
+      // pMiddle may be a red child of a red parent
+      int blackHeight = taller.blackHeight + (pMiddle->balance() ? 1 : 0);
+      BNode* pRoot = pMiddle;
+      while (pRoot->getParent() != nullptr)
+         pRoot = pRoot->getParent();
+      return Subtree{ pRoot, blackHeight };
    }
-#endif // NEVER
 
    /****************************************************
-    * BST :: FIND
-    * Return the node corresponding to a given value
+    * BST :: COUNT LEFT
+    * How many of numTotal nodes are in pLeft, the rest being in
+    * pRight. A Ranked tree knows; otherwise walk both trees at once
+    * so only as many steps are taken as the smaller one has nodes.
     ****************************************************/
-   template <typename T>
-   typename BST <T> ::iterator BST<T> ::find(const T& t)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   size_t BST <T, A, KeyOf, C, Ranked> ::countLeft(const BNode* pLeft, const BNode* pRight, size_t numTotal) noexcept
    {
-      // perform a binary search using a non-recursive solution
-      for (BNode* p = root; p != nullptr; p = (t < p->data ? p->pLeft : p->pRight))
-         if (p->data == t)
-            return iterator(p);
-
-      // nothing was found so return the nullptr iterator
-      return end();
+      if constexpr (Ranked)
+         return BNode::sizeOf(pLeft);
+      else
+      {
+         auto leftmost = [](const BNode* p)
+         {
+            while (p != nullptr && p->pLeft != nullptr)
+               p = p->pLeft;
+            return iterator(const_cast <BNode*> (p));
+         };
+         iterator itLeft = leftmost(pLeft);
+         iterator itRight = leftmost(pRight);
+         for (size_t num = 0; ; num++, ++itLeft, ++itRight)
+         {
+            if (itLeft.pNode == nullptr)
+               return num;
+            if (itRight.pNode == nullptr)
+               return numTotal - num;
+         }
+      }
    }
 
-   /*****************************************************
-    * DELETE BINARY TREE
-    * Delete all the nodes below pThis including pThis
-    * using postfix traverse: LRV
+   /****************************************************
+    * BST :: JOIN PAIR
+    * Join two trees with no node to go between them: the
+    * smallest node of right is cut out to play that part
     ****************************************************/
-   template <typename T>
-   void BST <T> ::deleteBinaryTree(BNode*& pDelete) noexcept
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::Subtree BST <T, A, KeyOf, C, Ranked> ::joinPair(Subtree left,
+                                                                                  Subtree right) noexcept
    {
-      if (pDelete == nullptr)
-         return;
-      deleteBinaryTree(pDelete->pLeft);   // L
-      deleteBinaryTree(pDelete->pRight);  // R
-
-      delete pDelete;                     // V
-      pDelete = nullptr;
+      if (left.pRoot == nullptr)
+         return right;
+      if (right.pRoot == nullptr)
+         return left;
+
+      BNode* pMiddle = right.pRoot;
+      while (pMiddle->pLeft != nullptr)
+         pMiddle = pMiddle->pLeft;
+      Subtree empty;
+      splitAt(pMiddle, empty, right);
+      assert(empty.pRoot == nullptr);
+      return join(left, pMiddle, right);
    }
 
-   /**********************************************
-    * COPY BINARY TREE
-    * Copy pSrc->pRight to pDest->pRight and
-    * pSrc->pLeft onto pDest->pLeft
-    *********************************************/
-   template <typename T>
-   void BST <T> ::copyBinaryTree(const BNode* pSrc, BNode*& pDest)
+   /****************************************************
+    * BST :: SPLIT KEY
+    * Cut a tree into the keys before k and those after it. A node
+    * with key k is taken out on its own as pMatch.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::splitKey(Subtree tree, const key_type& k, Subtree& left, BNode*& pMatch,
+                                           Subtree& right) const noexcept
    {
-      // if there is no node in pSrc, then do nothing
-      if (nullptr == pSrc)
+      pMatch = nullptr;
+      BNode* pFirst = lowerBoundNode(k, tree.pRoot, nullptr);
+      if (pFirst == nullptr)
       {
-         deleteBinaryTree(pDest);
+         left = tree;
+         right = Subtree{ nullptr, 0 };
          return;
       }
 
-      assert(pSrc);
-      // if there is not a node for pDest, then allocate one
-      try
-      {
-         if (nullptr == pDest)
-            pDest = new BST::BNode(pSrc->data);    // V
-         // otherwise, assign the data over
-         else
-            pDest->data = pSrc->data;
-      }
-      catch (...)
-      {
-         throw "ERROR: Unable to allocate a node";
-      }
-      assert(pDest != nullptr);
-
-      // copy over the red-black stuff
-      pDest->isRed = pSrc->isRed;
-
-      // handle the children to the right and left
-      copyBinaryTree(pSrc->pLeft, pDest->pLeft);     // L
-      if (pSrc->pLeft)
-         pDest->pLeft->pParent = pDest;
-
-      copyBinaryTree(pSrc->pRight, pDest->pRight);   // R
-      if (pDest->pRight)
-         pDest->pRight->pParent = pDest;
+      splitAt(pFirst, left, right);
+      if (!compare(k, keyOf(pFirst->data)))
+         pMatch = pFirst;
+      else
+         right = join(Subtree{ nullptr, 0 }, pFirst, right);
    }
 
    /****************************************************
-    * DELETE NODE
-    * Delete a single node (pDelete) from the tree indicated
-    * by a node (pDelete).
-    *    pDelete     the node to be deleted
-    *    toRight     should the right branch inherit our place?
+    * BST :: SPLIT AT
+    * Take pNode out of its tree, leaving everything before it in left
+    * and everything after it in right. On the way up from pNode, each
+    * ancestor joins the side it belongs on together with its other
+    * subtree. The heights telescope, so the whole cut is O(log n).
     ****************************************************/
-   template <typename T>
-   void BST <T> ::deleteNode(BNode*& pDelete, bool toRight)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::splitAt(BNode* pNode, Subtree& left, Subtree& right) noexcept
    {
-      // shift everything up
-      BNode* pNext = (toRight ? pDelete->pRight : pDelete->pLeft);
-
-      // if we are not the parent, hook ourselves into the existing tree
-      if (pDelete != root)
+      assert(pNode != nullptr);
+
+      // pNode's own children start the two sides
+      int blackHeight = findBlackHeight(pNode);
+      int blackHeightChild = blackHeight - (pNode->isRed() ? 0 : 1);
+      left = detachSubtree(pNode->pLeft, blackHeightChild);
+      right = detachSubtree(pNode->pRight, blackHeightChild);
+
+      // each ancestor takes its other subtree to one side or the other. An
+      // ancestor is as tall as its child plus itself if it is black.
+      BNode* pChild = pNode;
+      for (BNode* pAncestor = pNode->getParent(); pAncestor != nullptr; )
       {
-         if (pDelete->pParent->pLeft == pDelete)
-         {
-            pDelete->pParent->pLeft = nullptr;
-            pDelete->pParent->addLeft(pNext);
-         }
+         BNode* pNext = pAncestor->getParent();
+         blackHeightChild = blackHeight;
+         blackHeight += (pAncestor->isRed() ? 0 : 1);
+         if (pAncestor->pLeft == pChild)
+            right = join(right, pAncestor, detachSubtree(pAncestor->pRight, blackHeightChild));
          else
-         {
-            pDelete->pParent->pRight = nullptr;
-            pDelete->pParent->addRight(pNext);
-         }
+            left = join(detachSubtree(pAncestor->pLeft, blackHeightChild), pAncestor, left);
+         pChild = pAncestor;
+         pAncestor = pNext;
       }
 
-      // otherwise, the pNext is the new root
-      else
-      {
-         root = pNext;
-         pNext->pParent = nullptr;
-      }
+      // pNode is on its own now
+      pNode->pLeft = pNode->pRight = nullptr;
+      pNode->setParent(nullptr);
+      pNode->setRed(true);
+      pNode->fixSize();
    }
 
    /******************************************************
@@ -807,108 +3157,55 @@ namespace custom
      * BINARY NODE :: ADD LEFT
      * Add a node to the left of the current node
      ******************************************************/
-   template <typename T>
-   void BST <T> ::BNode::addLeft(BNode* pNode)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::BNode::addLeft(BNode* pNode)
    {
       pLeft = pNode;
       if (pNode)
-         pNode->pParent = this;
+         pNode->setParent(this);
    }
 
    /******************************************************
     * BINARY NODE :: ADD RIGHT
     * Add a node to the right of the current node
     ******************************************************/
-   template <typename T>
-   void BST <T> ::BNode::addRight(BNode* pNode)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::BNode::addRight(BNode* pNode)
    {
       pRight = pNode;
       if (pNode)
-         pNode->pParent = this;
-   }
-
-   /******************************************************
-    * BINARY NODE :: ADD LEFT
-    * Add a node to the left of the current node
-    ******************************************************/
-   template <typename T>
-   void BST<T> ::BNode::addLeft(const T& t)
-   {
-      assert(pLeft == nullptr);
-
-      try
-      {
-         BNode* pNode = new BNode(t);
-         addLeft(pNode);
-         pNode->balance();
-      }
-      catch (...)
-      {
-         throw "ERROR: Unable to allocate a node";
-      }
+         pNode->setParent(this);
    }
 
    /******************************************************
-    * BINARY NODE :: ADD LEFT
-    * Add a node to the left of the current node
+    * BINARY NODE :: POOL
+    * All the nodes of this type come from one pool
     ******************************************************/
-   template <typename T>
-   void BST<T> ::BNode::addLeft(T&& t)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   auto& BST <T, A, KeyOf, C, Ranked> ::BNode::pool()
    {
-      assert(pLeft == nullptr);
-
-      try
-      {
-         BNode* pNode = new BNode(std::move(t));
-         addLeft(pNode);
-         pNode->balance();
-      }
-      catch (...)
-      {
-         throw "ERROR: Unable to allocate a node";
-      }
+      return NodeCache <BNode> ::pool();
    }
 
    /******************************************************
-    * BINARY NODE :: ADD RIGHT
-    * Add a node to the right of the current node
+    * BINARY NODE :: NEW
+    * Take a node from the pool rather than from the heap
     ******************************************************/
-   template <typename T>
-   void BST <T> ::BNode::addRight(const T& t)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void* BST <T, A, KeyOf, C, Ranked> ::BNode::operator new (size_t size)
    {
-      assert(pRight == nullptr);
-
-      try
-      {
-         BNode* pNode = new BNode(t);
-         addRight(pNode);
-         pNode->balance();
-      }
-      catch (...)
-      {
-         throw "ERROR: Unable to allocate a node";
-      }
+      assert(size == sizeof(BNode));
+      return pool().allocate();
    }
 
    /******************************************************
-    * BINARY NODE :: ADD RIGHT
-    * Add a node to the right of the current node
+    * BINARY NODE :: DELETE
+    * Give a node back to the pool so the next insert can reuse it
     ******************************************************/
-   template <typename T>
-   void BST <T> ::BNode::addRight(T&& t)
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   void BST <T, A, KeyOf, C, Ranked> ::BNode::operator delete (void* p) noexcept
    {
-      assert(pRight == nullptr);
-
-      try
-      {
-         BNode* pNode = new BNode(std::move(t));
-         addRight(pNode);
-         pNode->balance();
-      }
-      catch (...)
-      {
-         throw "ERROR: Unable to allocate a node";
-      }
+      pool().deallocate(p);
    }
 
 #ifdef DEBUG
@@ -917,52 +3214,52 @@ namespace custom
     * Find the depth of the black nodes. This is useful for
     * verifying that a given red-black tree is valid
     ****************************************************/
-   template <typename T>
-   int BST <T> ::BNode::findDepth() const
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   int BST <T, A, KeyOf, C, Ranked> ::BNode::findDepth() const
    {
       // if there are no children, the depth is ourselves
       if (pRight == nullptr && pLeft == nullptr)
-         return (isRed ? 0 : 1);
+         return (isRed() ? 0 : 1);
 
       // if there is a right child, go that way
       if (pRight != nullptr)
-         return (isRed ? 0 : 1) + pRight->findDepth();
+         return (isRed() ? 0 : 1) + pRight->findDepth();
       else
-         return (isRed ? 0 : 1) + pLeft->findDepth();
+         return (isRed() ? 0 : 1) + pLeft->findDepth();
    }
 
    /****************************************************
     * BINARY NODE :: VERIFY RED BLACK
     * Do all four red-black rules work here?
     ***************************************************/
-   template <typename T>
-   bool BST <T> ::BNode::verifyRedBlack(int depth) const
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   bool BST <T, A, KeyOf, C, Ranked> ::BNode::verifyRedBlack(int depth) const
    {
       bool fReturn = true;
-      depth -= (isRed == false) ? 1 : 0;
+      depth -= (isRed() == false) ? 1 : 0;
 
       // Rule a) Every node is either red or black
-      assert(isRed == true || isRed == false); // this feels silly
+      assert(isRed() == true || isRed() == false); // this feels silly
 
       // Rule b) The root is black
-      if (pParent == nullptr)
-         if (isRed == true)
+      if (getParent() == nullptr)
+         if (isRed() == true)
             fReturn = false;
 
       // Rule c) Red nodes have black children
-      if (isRed == true)
+      if (isRed() == true)
       {
          if (pLeft != nullptr)
-            if (pLeft->isRed == true)
+            if (pLeft->isRed() == true)
                fReturn = false;
 
          if (pRight != nullptr)
-            if (pRight->isRed == true)
+            if (pRight->isRed() == true)
                fReturn = false;
       }
 
       // Rule d) Every path from a leaf to the root has the same # of black nodes
-      if (pLeft == nullptr && pRight && nullptr)
+      if (pLeft == nullptr || pRight == nullptr)
          if (depth != 0)
             fReturn = false;
       if (pLeft != nullptr)
@@ -980,8 +3277,8 @@ namespace custom
     * VERIFY B TREE
     * Verify that the tree is correctly formed
     ******************************************************/
-   template <typename T>
-   std::pair <T, T> BST <T> ::BNode::verifyBTree() const
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::pair <T, T> BST <T, A, KeyOf, C, Ranked> ::BNode::verifyBTree() const
    {
       // largest and smallest values
       std::pair <T, T> extremes;
@@ -989,6 +3286,7 @@ namespace custom
       extremes.second = data;
 
       // check parent
+      const BNode* pParent = getParent();
       if (pParent)
          assert(pParent->pLeft == this || pParent->pRight == this);
 
@@ -996,7 +3294,7 @@ namespace custom
       if (pLeft)
       {
          assert(!(data < pLeft->data));
-         assert(pLeft->pParent == this);
+         assert(pLeft->getParent() == this);
          pLeft->verifyBTree();
          std::pair <T, T> p = pLeft->verifyBTree();
          assert(!(data < p.second));
@@ -1008,7 +3306,7 @@ namespace custom
       if (pRight)
       {
          assert(!(pRight->data < data));
-         assert(pRight->pParent == this);
+         assert(pRight->getParent() == this);
          pRight->verifyBTree();
 
          std::pair <T, T> p = pRight->verifyBTree();
@@ -1024,41 +3322,116 @@ namespace custom
     * COMPUTE SIZE
     * Verify that the BST is as large as we think it is
     ********************************************/
-   template <typename T>
-   int BST <T> ::BNode::computeSize() const
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   int BST <T, A, KeyOf, C, Ranked> ::BNode::computeSize() const
    {
       return 1 +
          (pLeft == nullptr ? 0 : pLeft->computeSize()) +
          (pRight == nullptr ? 0 : pRight->computeSize());
    }
+
+   /*********************************************
+    * VERIFY SIZE
+    * Verify that every node of a Ranked tree knows its subtree size
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   bool BST <T, A, KeyOf, C, Ranked> ::BNode::verifySize() const
+   {
+      if constexpr (Ranked)
+         if (this->numSubtree != 1 + sizeOf(pLeft) + sizeOf(pRight))
+            return false;
+      return (pLeft == nullptr || pLeft->verifySize()) &&
+             (pRight == nullptr || pRight->verifySize());
+   }
 #endif // DEBUG
 
+   /******************************************************
+    * BINARY NODE :: SELECT
+    * The node with k nodes before it in p's subtree
+    ******************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::BNode::select(BNode* p, size_t k) noexcept
+   {
+      static_assert(Ranked, "only a Ranked tree knows its subtree sizes");
+      assert(k < sizeOf(p));
+      for (;;)
+      {
+         size_t numLeft = sizeOf(p->pLeft);
+         if (k < numLeft)
+            p = p->pLeft;
+         else if (k == numLeft)
+            return p;
+         else
+         {
+            k -= numLeft + 1;
+            p = p->pRight;
+         }
+      }
+   }
+
+   /******************************************************
+    * BINARY NODE :: INDEX OF
+    * How many nodes come before p in the whole tree
+    ******************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   size_t BST <T, A, KeyOf, C, Ranked> ::BNode::indexOf(const BNode* p) noexcept
+   {
+      static_assert(Ranked, "only a Ranked tree knows its subtree sizes");
+      size_t index = sizeOf(p->pLeft);
+      for (const BNode* pParent = p->getParent(); pParent != nullptr; p = pParent, pParent = p->getParent())
+         if (pParent->pRight == p)
+            index += sizeOf(pParent->pLeft) + 1;
+      return index;
+   }
+
    /******************************************************
     * BINARY NODE :: BALANCE
-    * Balance the tree from a given location
+    * Balance the tree from a given location. Return true if
+    * the black height of the whole tree went up by one.
+    ******************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   bool BST <T, A, KeyOf, C, Ranked> ::BNode::balance()
+   {
+      // a recolor pushes the problem up to granny, so keep going from there.
+      // If it reaches the root, every path gets one more black node.
+      bool isTaller = false;
+      for (BNode* pNode = this; pNode != nullptr; )
+      {
+         isTaller = isTaller || (pNode->getParent() == nullptr && pNode->isRed());
+         pNode = pNode->balanceOnce();
+      }
+      return isTaller;
+   }
+
+   /******************************************************
+    * BINARY NODE :: BALANCE ONCE
+    * Fix a red-red violation at this node. Return the node
+    * that needs balancing next, if any.
     ******************************************************/
-   template <typename T>
-   void BST <T> ::BNode::balance()
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::BNode* BST <T, A, KeyOf, C, Ranked> ::BNode::balanceOnce()
    {
+      BNode* pParent = getParent();
+
       // Case 1: if we are the root, then color ourselves black and call it a day.
       if (pParent == nullptr)
       {
-         isRed = false;
-         return;
+         setRed(false);
+         return nullptr;
       }
 
       // Case 2: if the parent is black, then there is nothing left to do
-      if (pParent->isRed == false)
+      if (pParent->isRed() == false)
       {
-         return;
+         return nullptr;
       }
 
       // we better have a grandparent.  Otherwise there is a red node at the root
-      assert(pParent->pParent != nullptr);
+      assert(pParent->getParent() != nullptr);
 
       // find my relatives
-      BNode* pGranny = pParent->pParent;
-      BNode* pGreatG = pGranny->pParent;
+      BNode* pGranny = pParent->getParent();
+      BNode* pGreatG = pGranny->getParent();
       BNode* pSibling =
          pParent->isRightChild(this) ? pParent->pLeft : pParent->pRight;
       BNode* pAunt =
@@ -1066,22 +3439,21 @@ namespace custom
 
       // verify things are as they should be
       assert(pGranny != nullptr);          // I should have a grandparent here
-      assert(pGranny->isRed == false);  // if granny is red, we violate red-red!
+      assert(pGranny->isRed() == false);  // if granny is red, we violate red-red!
 
       // Case 3: if the aunt is red, then just recolor
-      if (pAunt != nullptr && pAunt->isRed == true)
+      if (pAunt != nullptr && pAunt->isRed() == true)
       {
-         pGranny->isRed = true;         // grandparent becomes red
-         pParent->isRed = false;        // parent becomes black
-         pAunt->isRed = false;          // aunt becomes black
-         pGranny->balance();            // balance granny!
-         return;
+         pGranny->setRed(true);         // grandparent becomes red
+         pParent->setRed(false);        // parent becomes black
+         pAunt->setRed(false);          // aunt becomes black
+         return pGranny;                // balance granny!
       }
 
 
       // Case 4: if the aunt is black or non-existant, then we need to rotate
-      assert(pParent->isRed == true && pGranny->isRed == false &&
-         (pAunt == nullptr || pAunt->isRed == false));
+      assert(pParent->isRed() == true && pGranny->isRed() == false &&
+         (pAunt == nullptr || pAunt->isRed() == false));
 
       // the new top of the sub-tree
       BNode* pHead = nullptr;
@@ -1092,7 +3464,7 @@ namespace custom
          // verify case 4a is as it should be
          assert(pParent->pLeft == this);
          assert(pGranny->pRight == pAunt);
-         assert(pGranny->isRed == false);
+         assert(pGranny->isRed() == false);
 
          // perform the necessary rotation
          pParent->addRight(pGranny);
@@ -1100,8 +3472,8 @@ namespace custom
          pHead = pParent;
 
          // set the colors
-         pParent->isRed = false;
-         pGranny->isRed = true;
+         pParent->setRed(false);
+         pGranny->setRed(true);
       }
 
       // case 4b: We are mom's right and mom is granny's right
@@ -1110,7 +3482,7 @@ namespace custom
          // verify case 4b is as it should be
          assert(pParent->pRight == this);
          assert(pGranny->pLeft == pAunt);
-         assert(pGranny->isRed == false);
+         assert(pGranny->isRed() == false);
 
          // perform the necessary rotation
          pParent->addLeft(pGranny);
@@ -1118,8 +3490,8 @@ namespace custom
          pHead = pParent;
 
          // set the colors
-         pParent->isRed = false;
-         pGranny->isRed = true;
+         pParent->setRed(false);
+         pGranny->setRed(true);
       }
 
       // Case 4c: We are mom's right and mom is granny's left
@@ -1128,7 +3500,7 @@ namespace custom
          // verify case 4c is as it should be
          assert(pGranny->pRight == pAunt);
          assert(pParent->pLeft == pSibling);
-         assert(pParent->isRed == true);
+         assert(pParent->isRed() == true);
 
          // perform the necessary rotation
          pGranny->addLeft(this->pRight);
@@ -1138,8 +3510,8 @@ namespace custom
          pHead = this;
 
          // set the colors
-         this->isRed = false;
-         pGranny->isRed = true;
+         this->setRed(false);
+         pGranny->setRed(true);
       }
 
       // case 4d: we are mom's left and mom is granny's right
@@ -1158,8 +3530,8 @@ namespace custom
          pHead = this;
 
          // set the colors
-         this->isRed = false;
-         pGranny->isRed = true;
+         this->setRed(false);
+         pGranny->setRed(true);
       }
 
       // else we are really confused!
@@ -1168,13 +3540,20 @@ namespace custom
          assert(false); // !!
       }
 
+      // the rotated nodes have new children: recount them from the bottom up
+      pGranny->fixSize();
+      pParent->fixSize();
+      if (pHead != pParent)
+         pHead->fixSize();
+
       // fix up great granny if she is not nullptr
       if (pGreatG == nullptr)
-         pHead->pParent = nullptr;
+         pHead->setParent(nullptr);
       else if (pGreatG->pRight == pGranny)
          pGreatG->addRight(pHead);
       else if (pGreatG->pLeft == pGranny)
          pGreatG->addLeft(pHead);
+      return nullptr;
    }
 
    /*************************************************
@@ -1189,8 +3568,8 @@ namespace custom
      * BST ITERATOR :: INCREMENT PREFIX
      * advance by one
      *************************************************/
-   template <typename T>
-   typename BST <T> ::iterator& BST <T> ::iterator :: operator ++ ()
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator& BST <T, A, KeyOf, C, Ranked> ::iterator :: operator ++ ()
    {
       // do nothing if we have nothing
       if (nullptr == pNode)
@@ -1213,7 +3592,7 @@ namespace custom
       const BNode* pSave = pNode;
 
       // go up...
-      pNode = pNode->pParent;
+      pNode = pNode->getParent();
 
       // if the parent is the nullptr, we are done!
       if (nullptr == pNode)
@@ -1227,7 +3606,7 @@ namespace custom
       while (nullptr != pNode && pSave == pNode->pRight)
       {
          pSave = pNode;
-         pNode = pNode->pParent;
+         pNode = pNode->getParent();
       }
 
       return *this;
@@ -1237,12 +3616,16 @@ namespace custom
     * BST ITERATOR :: DECREMENT PREFIX
     * advance by one
     *************************************************/
-   template <typename T>
-   typename BST <T> ::iterator& BST <T> ::iterator :: operator -- ()
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   typename BST <T, A, KeyOf, C, Ranked> ::iterator& BST <T, A, KeyOf, C, Ranked> ::iterator :: operator -- ()
    {
-      // do nothing if we have nothing
+      // one before the end is the largest, which the tree keeps at hand
       if (nullptr == pNode)
+      {
+         if (pTree != nullptr)
+            pNode = pTree->pRightmost;
          return *this;
+      }
 
       // if there is a left node, take it
       if (nullptr != pNode->pLeft)
@@ -1261,7 +3644,7 @@ namespace custom
       const BNode* pSave = pNode;
 
       // go up
-      pNode = pNode->pParent;
+      pNode = pNode->getParent();
 
       // if the parent is the nullptr, we are done!
       if (nullptr == pNode)
@@ -1275,12 +3658,42 @@ namespace custom
       while (nullptr != pNode && pSave == pNode->pLeft)
       {
          pSave = pNode;
-         pNode = pNode->pParent;
+         pNode = pNode->getParent();
       }
 
       return *this;
    }
 
+   /**************************************************
+    * BST ITERATOR :: COUNT BETWEEN
+    * How many steps from pFirst to pLast, where nullptr is end(). A
+    * Ranked tree takes the difference of the two positions, climbing
+    * from whichever node is not end() to learn how large the tree is.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, bool Ranked>
+   std::ptrdiff_t BST <T, A, KeyOf, C, Ranked> ::iterator::countBetween(const BNode* pFirst, const BNode* pLast)
+   {
+      if (pFirst == pLast)
+         return 0;
+
+      if constexpr (Ranked)
+      {
+         const BNode* pRoot = (pFirst != nullptr ? pFirst : pLast);
+         while (pRoot->getParent() != nullptr)
+            pRoot = pRoot->getParent();
+         size_t iFirst = (pFirst != nullptr ? BNode::indexOf(pFirst) : BNode::sizeOf(pRoot));
+         size_t iLast  = (pLast  != nullptr ? BNode::indexOf(pLast)  : BNode::sizeOf(pRoot));
+         return std::ptrdiff_t(iLast) - std::ptrdiff_t(iFirst);
+      }
+      else
+      {
+         std::ptrdiff_t num = 0;
+         for (iterator it(const_cast <BNode*> (pFirst)); it.pNode != pLast; ++it)
+            num++;
+         return num;
+      }
+   }
+
 
 } // namespace custom
 
@@ -0,0 +1,1801 @@
+/***********************************************************************
+ * Header:
+ *    BTREE
+ * Summary:
+ *    A B-tree for map to keep its pairs in when there are so many that
+ *    cache misses, not comparisons, are what a lookup costs
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        btree               : A class that represents a B-tree
+ *        btree::iterator     : An iterator through a btree
+ *        KeyBlock            : The keys of a node side by side
+ * Author
+ *    <your names here>
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <memory>     // for std::allocator and std::allocator_traits
+#include <functional> // for std::less
+#include <utility>    // for std::pair, std::move and std::forward
+#include <algorithm>  // for std::move_backward and std::max
+#include <new>        // for placement new and std::launder
+#include <iterator>   // for std::bidirectional_iterator_tag
+#include <cstddef>    // for std::ptrdiff_t
+#include "bst.h"      // for Identity, Range and sorted_unique
+#include "simd.h"     // for searching a node several keys at a time
+
+class TestBTree; // forward declaration for unit tests
+class TestMap;
+class TestSimd;
+
+namespace custom
+{
+   /*****************************************************************
+    * BTREE FANOUT
+    * How many children an internal node has unless told otherwise:
+    * enough values to fill about 256 bytes, four cache lines, and
+    * never fewer than three values
+    *****************************************************************/
+   template <class T>
+   inline constexpr size_t btreeFanout = std::max <size_t> (4, 256 / sizeof(T) + 1);
+
+   /*****************************************************************
+    * KEY BLOCK
+    * A copy of the keys of a node side by side, so a node whose keys
+    * are plain integers can be searched several keys at a time rather
+    * than picking them one by one out of the values. Any other node
+    * gets the empty version and is no bigger for it.
+    *****************************************************************/
+   template <class K, int N, bool hasKeys>
+   struct KeyBlock
+   {
+      K keys[N];
+   };
+
+   template <class K, int N>
+   struct KeyBlock <K, N, false>
+   {
+   };
+
+   /*****************************************************************
+    * B-TREE
+    * Create a B-tree. Each node keeps up to Fanout - 1 values side by
+    * side in order, and an internal node also has a child before, between
+    * and after them. Every leaf is at the same depth. The values are
+    * ordered by C on the key KeyOf pulls out of them, just as in a BST.
+    *
+    * Since the values move around within and between nodes, an insert
+    * or an erase invalidates every iterator, and T must not throw when
+    * it is moved.
+    *****************************************************************/
+   template <typename T, typename A = std::allocator <T>, typename KeyOf = Identity,
+             typename C = std::less <T>, size_t Fanout = btreeFanout <T>>
+   class btree
+   {
+      friend class ::TestBTree; // give unit tests access to the privates
+      friend class ::TestMap;
+      friend class ::TestSimd;
+
+      template <class KK, class VV, class CC, class AA, bool RR, class PP>
+      friend class custom::map;
+
+      static_assert(Fanout >= 4, "a node must hold at least three values to split in two");
+      static_assert(Fanout <= 32768, "the values of a node are counted in a short");
+   public:
+      using allocator_type = A;
+      using key_type = std::decay_t <decltype(KeyOf()(std::declval <const T&> ()))>;
+      using key_compare = C;
+
+      //
+      // Construct
+      //
+
+      btree();
+      explicit btree(const A& a);
+      explicit btree(const C& c, const A& a = A());
+      btree(const btree& rhs);
+      btree(btree&& rhs) noexcept;
+      btree(const std::initializer_list<T>& il, const A& a = A());
+      ~btree();
+
+      //
+      // Assign
+      //
+
+      btree& operator = (const btree& rhs);
+      btree& operator = (btree&& rhs) noexcept(isMoveAssignNoexcept);
+      btree& operator = (const std::initializer_list<T>& il);
+      void swap(btree& rhs);
+
+      // replace the contents with a range. Sorted input is appended,
+      // which needs no search and leaves the nodes one short of full.
+      template <class Iterator>
+      void assign(Iterator first, Iterator last, bool keepUnique = false);
+      template <class Iterator>
+      void assign(sorted_unique_t, Iterator first, Iterator last);
+
+      //
+      // Iterator
+      //
+
+      class iterator;
+      iterator   begin()  const noexcept { return iterator(pLeftmost, 0, this); }
+      iterator   rbegin() const noexcept;
+      iterator   end()    const noexcept { return iterator(nullptr, 0, this); }
+
+      //
+      // Access
+      //
+
+      iterator find(const key_type& k) const { return findPosition(k); }
+      bool contains(const key_type& k) const { return findPosition(k) != end(); }
+
+      // the first element not before k, the first after k, and both
+      iterator lowerBound(const key_type& k) const { return lowerBoundPosition(k); }
+      iterator upperBound(const key_type& k) const { return upperBoundPosition(k); }
+      std::pair<iterator, iterator> equalRange(const key_type& k) const
+      {
+         return std::pair<iterator, iterator>(lowerBoundPosition(k), upperBoundPosition(k));
+      }
+
+      // with a transparent comparator, anything comparable to a key will do
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator find(const K& k) const { return findPosition(k); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      bool contains(const K& k) const { return findPosition(k) != end(); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator lowerBound(const K& k) const { return lowerBoundPosition(k); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator upperBound(const K& k) const { return upperBoundPosition(k); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      std::pair<iterator, iterator> equalRange(const K& k) const
+      {
+         return std::pair<iterator, iterator>(lowerBoundPosition(k), upperBoundPosition(k));
+      }
+
+      // every element with a key in [lo, hi)
+      Range <iterator> range(const key_type& lo, const key_type& hi) const;
+
+      //
+      // Insert
+      //
+
+      std::pair<iterator, bool> insert(const T& t, bool keepUnique = false);
+      std::pair<iterator, bool> insert(T&& t, bool keepUnique = false);
+
+      // the arguments are those a BST node takes: a value, or
+      // std::in_place followed by what builds one
+      template <class ... Args>
+      std::pair<iterator, bool> emplace(Args&& ... args);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceUnique(Args&& ... args);
+
+      // the hint only matters when it is end() and the value goes last
+      std::pair<iterator, bool> insert(iterator hint, const T& t, bool keepUnique = false);
+      std::pair<iterator, bool> insert(iterator hint, T&& t, bool keepUnique = false);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceHint(iterator hint, Args&& ... args);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceHintUnique(iterator hint, Args&& ... args);
+
+      // each of a range of values, one at a time
+      template <class Iterator>
+      void insert(Iterator first, Iterator last, bool keepUnique = false);
+
+      // build the value only if nothing with key k is here yet
+      template <class ... Args>
+      std::pair<iterator, bool> tryEmplace(const key_type& k, Args&& ... args);
+
+      //
+      // Remove
+      //
+
+      iterator erase(iterator it);
+      iterator erase(iterator first, iterator last);
+      void   clear() noexcept;
+
+      // take out the smallest or the largest element
+      void popFront() { erase(begin()); }
+      void popBack()  { erase(rbegin()); }
+
+      // move a value between trees without copying it. Values do not
+      // have nodes of their own here, so the handle allocates one slot.
+      class NodeHandle;
+      NodeHandle extract(iterator it);
+      std::pair<iterator, bool> insert(NodeHandle&& nh, bool keepUnique = false);
+
+      //
+      // Status
+      //
+
+      bool   empty() const noexcept { return size() == 0; }
+      size_t size()  const noexcept { return numElements; }
+
+      A get_allocator() const noexcept { return A(alloc); }
+      C key_comp() const { return compare; }
+
+   private:
+
+      class LeafNode;
+      class InternalNode;
+
+      // leaves and internal nodes are allocated with A rebound to each,
+      // and a value in a node handle with A itself
+      using ValueTraits    = std::allocator_traits <A>;
+      using LeafAlloc      = typename std::allocator_traits <A> ::template rebind_alloc <LeafNode>;
+      using LeafTraits     = std::allocator_traits <LeafAlloc>;
+      using InternalAlloc  = typename std::allocator_traits <A> ::template rebind_alloc <InternalNode>;
+      using InternalTraits = std::allocator_traits <InternalAlloc>;
+
+      // only a move between allocators that differ moves values one at a time
+      static constexpr bool isMoveAssignNoexcept = LeafTraits::propagate_on_container_move_assignment::value ||
+                                                   LeafTraits::is_always_equal::value;
+
+      // a node other than the root is rebalanced when it drops below about
+      // half full: below what the smaller side of a split is left with
+      static constexpr int numMaxValues = int(Fanout) - 1;
+      static constexpr int numMinValues = (numMaxValues - 1) / 2;
+
+      // integer keys in their natural order are also kept in a KeyBlock,
+      // which every change to the values of a node must bring up to date
+      static constexpr bool hasKeyBlock = simd::isSearchable <key_type, C> ::value;
+      static void syncKeys(LeafNode* pNode, int iBegin, int iEnd) noexcept;
+
+      // searching by key, within a node and down the tree
+      static const key_type& keyOf(const T& t) { return KeyOf()(t); }
+      template <class K>
+      int lowerBoundIndex(const LeafNode* pNode, const K& k) const;
+      template <class K>
+      int upperBoundIndex(const LeafNode* pNode, const K& k) const;
+      template <class K>
+      iterator findPosition(const K& k) const;
+      template <class K>
+      iterator lowerBoundPosition(const K& k) const;
+      template <class K>
+      iterator upperBoundPosition(const K& k) const;
+      iterator findSpot(const key_type& k, bool keepUnique, const iterator* pHint,
+                        LeafNode*& pLeaf, int& index) const;
+
+      // building a value from the arguments a BST node would take
+      template <class ... Args>
+      static void constructValue(T* p, Args&& ... args);
+      template <class ... Args>
+      static void constructValue(T* p, std::in_place_t, Args&& ... args);
+      template <class ... Args>
+      static T makeValue(Args&& ... args);
+      template <class ... Args>
+      static T makeValue(std::in_place_t, Args&& ... args);
+
+      // adding values and splitting full nodes
+      template <class U>
+      std::pair<iterator, bool> insertValue(U&& t, bool keepUnique, const iterator* pHint);
+      template <class ... Args>
+      iterator insertAt(LeafNode* pLeaf, int index, Args&& ... args);
+      template <class ... Args>
+      static void insertIntoNode(LeafNode* pNode, int index, Args&& ... args);
+      static void insertChild(InternalNode* pNode, int index, T&& t, LeafNode* pChild) noexcept;
+      LeafNode* splitNode(LeafNode* pNode, bool isAppend);
+
+      // taking values out and refilling nodes that got too empty. The
+      // position it tracks moves along with the values it refers to.
+      static void removeFromNode(LeafNode* pNode, int index) noexcept;
+      void rebalance(LeafNode* pNode, iterator& itTrack) noexcept;
+      static void borrowFromLeft(LeafNode* pNode, iterator& itTrack) noexcept;
+      static void borrowFromRight(LeafNode* pNode, iterator& itTrack) noexcept;
+      void mergeChildren(InternalNode* pParent, int index, iterator& itTrack) noexcept;
+
+      // whole nodes and whole trees
+      LeafNode* newLeaf();
+      InternalNode* newInternal();
+      void freeNode(LeafNode* pNode) noexcept;
+      void deleteTree(LeafNode* pNode) noexcept;
+      LeafNode* copyTree(const LeafNode* pSrc);
+      void copyFrom(const btree& rhs);
+      static LeafNode* findLeftmost(LeafNode* pNode) noexcept;
+      static LeafNode* findRightmost(LeafNode* pNode) noexcept;
+
+#ifdef DEBUG
+      //
+      // Verify
+      //
+      bool verify() const;
+      int verifyNode(const LeafNode* pNode, const T* pLow, const T* pHigh, size_t& num) const;
+#endif // DEBUG
+
+      LeafNode* root;         // top of the tree, a leaf when it is small
+      LeafNode* pLeftmost;    // leaf with the smallest value, for begin()
+      LeafNode* pRightmost;   // leaf with the largest value, for appending
+      size_t numElements;     // number of elements currently in the tree
+      LeafAlloc alloc;        // where the nodes come from
+      C compare;              // orders the keys
+   };
+
+
+   /*****************************************************************
+    * B-TREE LEAF NODE
+    * Up to Fanout - 1 values in order, stored in place. Every node
+    * knows its parent and which of the parent's children it is.
+    *****************************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   class btree <T, A, KeyOf, C, Fanout> ::LeafNode
+      : public KeyBlock <typename btree <T, A, KeyOf, C, Fanout> ::key_type,
+                         btree <T, A, KeyOf, C, Fanout> ::numMaxValues,
+                         btree <T, A, KeyOf, C, Fanout> ::hasKeyBlock>
+   {
+   public:
+      explicit LeafNode(bool isLeaf = true) : pParent(nullptr), position(0), count(0), isLeaf(isLeaf) {}
+
+      // the values themselves. Only the first count are alive.
+      T* values() noexcept { return std::launder(reinterpret_cast <T*> (storage)); }
+      const T* values() const noexcept { return std::launder(reinterpret_cast <const T*> (storage)); }
+      T& value(int i) noexcept { return values()[i]; }
+      const T& value(int i) const noexcept { return values()[i]; }
+
+      InternalNode* asInternal() noexcept
+      {
+         assert(!isLeaf);
+         return static_cast <InternalNode*> (this);
+      }
+      const InternalNode* asInternal() const noexcept
+      {
+         assert(!isLeaf);
+         return static_cast <const InternalNode*> (this);
+      }
+
+      InternalNode* pParent;    // nullptr for the root
+      unsigned short position;  // index of this node among its parent's children
+      unsigned short count;     // number of values
+      bool isLeaf;              // false for an InternalNode
+      alignas(T) unsigned char storage[numMaxValues * sizeof(T)];
+   };
+
+   /*****************************************************************
+    * B-TREE INTERNAL NODE
+    * A leaf with a child around each value: everything in children[i]
+    * comes before value(i), and everything in children[i + 1] after it
+    *****************************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   class btree <T, A, KeyOf, C, Fanout> ::InternalNode : public btree <T, A, KeyOf, C, Fanout> ::LeafNode
+   {
+   public:
+      InternalNode() : LeafNode(false)
+      {
+         for (auto& pChild : children)
+            pChild = nullptr;
+      }
+
+      // hang a child in a slot, telling it where it is
+      void setChild(int i, LeafNode* pChild) noexcept
+      {
+         children[i] = pChild;
+         pChild->pParent = this;
+         pChild->position = (unsigned short)i;
+      }
+
+      LeafNode* children[numMaxValues + 1];
+   };
+
+   /**********************************************************
+    * B-TREE ITERATOR
+    * Forward and reverse iterator through a btree: a node and
+    * the index of a value in it
+    *********************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   class btree <T, A, KeyOf, C, Fanout> ::iterator
+   {
+      friend class ::TestBTree; // give unit tests access to the privates
+      friend class ::TestMap;
+
+      template <class KK, class VV, class CC, class AA, bool RR, class PP>
+      friend class custom::map;
+   public:
+      using iterator_category = std::bidirectional_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const T*;
+      using reference = const T&;
+
+      // constructors and assignment
+      iterator(LeafNode* pNode = nullptr, int index = 0, const btree* pTree = nullptr)
+         : pNode(pNode), index(index), pTree(pTree) {}
+
+      // compare
+      bool operator == (const iterator& rhs) const
+      {
+         return pNode == rhs.pNode && index == rhs.index;
+      }
+      bool operator != (const iterator& rhs) const
+      {
+         return !(*this == rhs);
+      }
+
+      // de-reference. Cannot change because it will invalidate the btree
+      const T& operator * () const
+      {
+         return pNode->value(index);
+      }
+
+      // increment and decrement
+      iterator& operator ++ ();
+      iterator  operator ++ (int postfix)
+      {
+         iterator itReturn = *this;
+         ++(*this);
+         return itReturn;
+      }
+      iterator& operator -- ();
+      iterator  operator -- (int postfix)
+      {
+         iterator itReturn = *this;
+         --(*this);
+         return itReturn;
+      }
+
+      // the tree may reach into the iterator for its position
+      friend class btree <T, A, KeyOf, C, Fanout>;
+
+   private:
+      void climbPastEnd() noexcept;
+
+      // the node, the value in it, and the tree so end() can step back
+      LeafNode* pNode;
+      int index;
+      const btree* pTree;
+   };
+
+
+   /**********************************************************
+    * B-TREE NODE HANDLE
+    * Owns a value taken out of a tree so it can be put into
+    * another without being copied
+    *********************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   class btree <T, A, KeyOf, C, Fanout> ::NodeHandle
+   {
+      friend class ::TestBTree; // give unit tests access to the privates
+      friend class btree <T, A, KeyOf, C, Fanout>;
+   public:
+      NodeHandle() noexcept : pValue(nullptr), alloc() {}
+      NodeHandle(NodeHandle&& rhs) noexcept : pValue(rhs.pValue), alloc(std::move(rhs.alloc))
+      {
+         rhs.pValue = nullptr;
+      }
+      NodeHandle& operator = (NodeHandle&& rhs) noexcept
+      {
+         if (this != &rhs)
+         {
+            reset();
+            pValue = rhs.pValue;
+            alloc = std::move(rhs.alloc);
+            rhs.pValue = nullptr;
+         }
+         return *this;
+      }
+     ~NodeHandle()
+      {
+         reset();
+      }
+
+      bool empty() const noexcept { return pValue == nullptr; }
+      explicit operator bool () const noexcept { return pValue != nullptr; }
+
+      // the element can be changed, even its key, since it is in no tree
+      T& value() const
+      {
+         assert(pValue != nullptr);
+         return *pValue;
+      }
+      A get_allocator() const { return alloc; }
+
+   private:
+      NodeHandle(T* pValue, const A& alloc) : pValue(pValue), alloc(alloc) {}
+      void reset() noexcept
+      {
+         if (pValue)
+         {
+            ValueTraits::destroy(alloc, pValue);
+            ValueTraits::deallocate(alloc, pValue, 1);
+            pValue = nullptr;
+         }
+      }
+
+      T* pValue;   // the value we own, if any
+      A alloc;     // what will free it
+   };
+
+
+   /*********************************************
+    *********************************************
+    *********************************************
+    ******************* BTREE *******************
+    *********************************************
+    *********************************************
+    *********************************************/
+
+
+   /*********************************************
+    * BTREE :: DEFAULT CONSTRUCTOR
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout> ::btree()
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numElements(0), alloc(), compare()
+   {
+   }
+
+   /*********************************************
+    * BTREE :: ALLOCATOR CONSTRUCTOR
+    * An empty tree drawing its nodes from a given allocator
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout> ::btree(const A& a)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numElements(0), alloc(a), compare()
+   {
+   }
+
+   /*********************************************
+    * BTREE :: COMPARATOR CONSTRUCTOR
+    * An empty tree ordered by a given comparator
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout> ::btree(const C& c, const A& a)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numElements(0), alloc(a), compare(c)
+   {
+   }
+
+   /*********************************************
+    * BTREE :: COPY CONSTRUCTOR
+    * Copy one tree to another, node for node
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout> ::btree(const btree& rhs)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numElements(0),
+        alloc(LeafTraits::select_on_container_copy_construction(rhs.alloc)),
+        compare(rhs.compare)
+   {
+      copyFrom(rhs);
+   }
+
+   /*********************************************
+    * BTREE :: MOVE CONSTRUCTOR
+    * Move one tree to another
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout> ::btree(btree&& rhs) noexcept
+      : root(rhs.root), pLeftmost(rhs.pLeftmost), pRightmost(rhs.pRightmost), numElements(rhs.numElements),
+        alloc(std::move(rhs.alloc)), compare(std::move(rhs.compare))
+   {
+      rhs.root = rhs.pLeftmost = rhs.pRightmost = nullptr;
+      rhs.numElements = 0;
+   }
+
+   /*********************************************
+    * BTREE :: INITIALIZER LIST CONSTRUCTOR
+    * Create a btree from an initializer list
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout> ::btree(const std::initializer_list<T>& il, const A& a)
+      : root(nullptr), pLeftmost(nullptr), pRightmost(nullptr), numElements(0), alloc(a), compare()
+   {
+      assign(il.begin(), il.end());
+   }
+
+   /*********************************************
+    * BTREE :: DESTRUCTOR
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout> :: ~btree()
+   {
+      clear();
+   }
+
+   /*********************************************
+    * BTREE :: ASSIGNMENT OPERATOR
+    * Copy one tree to another
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout>& btree <T, A, KeyOf, C, Fanout> :: operator = (const btree& rhs)
+   {
+      if (this == &rhs)
+         return *this;
+
+      // the old nodes go back to the old allocator before it is replaced
+      clear();
+      if constexpr (LeafTraits::propagate_on_container_copy_assignment::value)
+         alloc = rhs.alloc;
+      compare = rhs.compare;
+      copyFrom(rhs);
+      return *this;
+   }
+
+   /*********************************************
+    * BTREE :: ASSIGN-MOVE OPERATOR
+    * Move one tree to another
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout>& btree <T, A, KeyOf, C, Fanout> :: operator = (btree&& rhs)
+      noexcept(isMoveAssignNoexcept)
+   {
+      if (this == &rhs)
+         return *this;
+
+      clear();
+      compare = rhs.compare;
+
+      // the allocator comes along, or is the same anyway: steal the nodes
+      if (LeafTraits::propagate_on_container_move_assignment::value || alloc == rhs.alloc)
+      {
+         if constexpr (LeafTraits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+         std::swap(rhs.root, root);
+         std::swap(rhs.pLeftmost, pLeftmost);
+         std::swap(rhs.pRightmost, pRightmost);
+         std::swap(rhs.numElements, numElements);
+      }
+
+      // different allocators: move the elements one at a time into our nodes
+      else
+      {
+         for (iterator it = rhs.begin(); it != rhs.end(); ++it)
+            insert(end(), std::move(it.pNode->value(it.index)));
+         rhs.clear();
+      }
+
+      return *this;
+   }
+
+   /*********************************************
+    * BTREE :: ASSIGNMENT OPERATOR with INITIALIZATION LIST
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   btree <T, A, KeyOf, C, Fanout>& btree <T, A, KeyOf, C, Fanout> :: operator = (const std::initializer_list<T>& il)
+   {
+      assign(il.begin(), il.end());
+      return *this;
+   }
+
+   /*********************************************
+    * BTREE :: SWAP
+    * Swap two trees
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::swap(btree& rhs)
+   {
+      std::swap(rhs.root, root);
+      std::swap(rhs.pLeftmost, pLeftmost);
+      std::swap(rhs.pRightmost, pRightmost);
+      std::swap(rhs.numElements, numElements);
+      std::swap(rhs.compare, compare);
+
+      // without propagation, swapping is only defined for equal allocators
+      if constexpr (LeafTraits::propagate_on_container_swap::value)
+         std::swap(rhs.alloc, alloc);
+      else
+         assert(alloc == rhs.alloc);
+   }
+
+   /*********************************************
+    * BTREE :: ASSIGN
+    * Replace the contents of the tree with [first, last). Each value
+    * is offered at the end first, so ascending input is appended
+    * without a search. With keepUnique, only the first of several
+    * equal keys is kept.
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class Iterator>
+   void btree <T, A, KeyOf, C, Fanout> ::assign(Iterator first, Iterator last, bool keepUnique)
+   {
+      clear();
+      for (; first != last; ++first)
+         insert(end(), *first, keepUnique);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class Iterator>
+   void btree <T, A, KeyOf, C, Fanout> ::assign(sorted_unique_t, Iterator first, Iterator last)
+   {
+      clear();
+      for (; first != last; ++first)
+      {
+         assert(pRightmost == nullptr || compare(keyOf(pRightmost->value(pRightmost->count - 1)), keyOf(*first)));
+         insertAt(pRightmost, pRightmost ? pRightmost->count : 0, *first);
+      }
+   }
+
+   /*********************************************
+    * BTREE :: RBEGIN
+    * The largest element, or end() when there is none
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::rbegin() const noexcept
+   {
+      if (pRightmost == nullptr)
+         return end();
+      return iterator(pRightmost, pRightmost->count - 1, this);
+   }
+
+   /*****************************************************
+    * BTREE :: LOWER BOUND INDEX and UPPER BOUND INDEX
+    * A search within one node: the first value not before
+    * k, or the first after k. A node with a KeyBlock counts
+    * the keys before k, all at once if the node is large
+    * enough to be worth it. Any other does a binary search.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class K>
+   int btree <T, A, KeyOf, C, Fanout> ::lowerBoundIndex(const LeafNode* pNode, const K& k) const
+   {
+      if constexpr (hasKeyBlock && std::is_same <K, key_type> ::value)
+         return simd::countLess(pNode->keys, int(pNode->count), k, numMaxValues);
+
+      int iLow = 0;
+      int iHigh = pNode->count;
+      while (iLow < iHigh)
+      {
+         int iMiddle = (iLow + iHigh) / 2;
+         if (compare(keyOf(pNode->value(iMiddle)), k))
+            iLow = iMiddle + 1;
+         else
+            iHigh = iMiddle;
+      }
+      return iLow;
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class K>
+   int btree <T, A, KeyOf, C, Fanout> ::upperBoundIndex(const LeafNode* pNode, const K& k) const
+   {
+      if constexpr (hasKeyBlock && std::is_same <K, key_type> ::value)
+         return simd::countNotGreater(pNode->keys, int(pNode->count), k, numMaxValues);
+
+      int iLow = 0;
+      int iHigh = pNode->count;
+      while (iLow < iHigh)
+      {
+         int iMiddle = (iLow + iHigh) / 2;
+         if (compare(k, keyOf(pNode->value(iMiddle))))
+            iHigh = iMiddle;
+         else
+            iLow = iMiddle + 1;
+      }
+      return iLow;
+   }
+
+   /****************************************************
+    * BTREE :: FIND POSITION
+    * Where a value with a key equivalent to k is, or end().
+    * The search stops at the first node that has one.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class K>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::findPosition(const K& k) const
+   {
+      for (LeafNode* pNode = root; pNode != nullptr; )
+      {
+         int i = lowerBoundIndex(pNode, k);
+         if (i < pNode->count && !compare(k, keyOf(pNode->value(i))))
+            return iterator(pNode, i, this);
+         if (pNode->isLeaf)
+            break;
+         pNode = pNode->asInternal()->children[i];
+      }
+      return end();
+   }
+
+   /****************************************************
+    * BTREE :: LOWER BOUND POSITION and UPPER BOUND POSITION
+    * The first element not before k, or the first after k. The
+    * deepest node that has one holds the answer, so each node
+    * on the way down may replace the candidate.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class K>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::lowerBoundPosition(const K& k) const
+   {
+      iterator itBound = end();
+      for (LeafNode* pNode = root; pNode != nullptr; )
+      {
+         int i = lowerBoundIndex(pNode, k);
+         if (i < pNode->count)
+            itBound = iterator(pNode, i, this);
+         if (pNode->isLeaf)
+            break;
+         pNode = pNode->asInternal()->children[i];
+      }
+      return itBound;
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class K>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::upperBoundPosition(const K& k) const
+   {
+      iterator itBound = end();
+      for (LeafNode* pNode = root; pNode != nullptr; )
+      {
+         int i = upperBoundIndex(pNode, k);
+         if (i < pNode->count)
+            itBound = iterator(pNode, i, this);
+         if (pNode->isLeaf)
+            break;
+         pNode = pNode->asInternal()->children[i];
+      }
+      return itBound;
+   }
+
+   /*****************************************************
+    * BTREE :: RANGE
+    * The elements with a key in [lo, hi)
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   Range <typename btree <T, A, KeyOf, C, Fanout> ::iterator> btree <T, A, KeyOf, C, Fanout> ::range(const key_type& lo,
+                                                                                              const key_type& hi) const
+   {
+      if (!compare(lo, hi))
+         return Range <iterator> (end(), end());
+      return Range <iterator> (lowerBound(lo), lowerBound(hi));
+   }
+
+   /*****************************************************
+    * BTREE :: FIND SPOT
+    * Find the leaf and index where a value with key k belongs, after
+    * any values with an equal key so duplicates keep their insertion
+    * order. When keepUnique is set and k is already here, that value
+    * is returned instead, otherwise end(). A hint of end() for a key
+    * past the largest goes straight to the end of the last leaf.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::findSpot(const key_type& k, bool keepUnique,
+                                                                                        const iterator* pHint,
+                                                                                        LeafNode*& pLeaf, int& index) const
+   {
+      if (pHint != nullptr && pHint->pNode == nullptr && pRightmost != nullptr &&
+          compare(keyOf(pRightmost->value(pRightmost->count - 1)), k))
+      {
+         pLeaf = pRightmost;
+         index = pRightmost->count;
+         return end();
+      }
+
+      pLeaf = nullptr;
+      index = 0;
+      for (LeafNode* pNode = root; pNode != nullptr; )
+      {
+         // the value just before where k goes is not larger than k. If
+         // it is not smaller either, it is a match.
+         int i = upperBoundIndex(pNode, k);
+         if (keepUnique && i > 0 && !compare(keyOf(pNode->value(i - 1)), k))
+            return iterator(pNode, i - 1, this);
+         if (pNode->isLeaf)
+         {
+            pLeaf = pNode;
+            index = i;
+            break;
+         }
+         pNode = pNode->asInternal()->children[i];
+      }
+      return end();
+   }
+
+   /*****************************************************
+    * BTREE :: CONSTRUCT VALUE and MAKE VALUE
+    * Build a T from what a BST node's constructor would take: a
+    * T to copy or move, or std::in_place and the T's arguments.
+    * The first builds it in a slot, the second on its own.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   void btree <T, A, KeyOf, C, Fanout> ::constructValue(T* p, Args&& ... args)
+   {
+      ::new (static_cast <void*> (p)) T(std::forward <Args> (args)...);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   void btree <T, A, KeyOf, C, Fanout> ::constructValue(T* p, std::in_place_t, Args&& ... args)
+   {
+      ::new (static_cast <void*> (p)) T(std::forward <Args> (args)...);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   T btree <T, A, KeyOf, C, Fanout> ::makeValue(Args&& ... args)
+   {
+      return T(std::forward <Args> (args)...);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   T btree <T, A, KeyOf, C, Fanout> ::makeValue(std::in_place_t, Args&& ... args)
+   {
+      return T(std::forward <Args> (args)...);
+   }
+
+   /*****************************************************
+    * BTREE :: INSERT
+    * Insert a value where its key belongs
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::insert(const T& t, bool keepUnique)
+   {
+      return insertValue(t, keepUnique, nullptr);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::insert(T&& t, bool keepUnique)
+   {
+      return insertValue(std::move(t), keepUnique, nullptr);
+   }
+
+   /*****************************************************
+    * BTREE :: INSERT with HINT
+    * A hint of end() for a value past the largest skips the search
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::insert(iterator hint, const T& t,
+                                                                                                    bool keepUnique)
+   {
+      return insertValue(t, keepUnique, &hint);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::insert(iterator hint, T&& t,
+                                                                                                    bool keepUnique)
+   {
+      return insertValue(std::move(t), keepUnique, &hint);
+   }
+
+   /*****************************************************
+    * BTREE :: INSERT VALUE
+    * Find the leaf where t belongs and put it there
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class U>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::insertValue(U&& t, bool keepUnique,
+                                                                                                         const iterator* pHint)
+   {
+      LeafNode* pLeaf;
+      int index;
+      iterator itMatch = findSpot(keyOf(t), keepUnique, pHint, pLeaf, index);
+      if (itMatch != end())
+         return std::pair<iterator, bool>(itMatch, false);
+      return std::pair<iterator, bool>(insertAt(pLeaf, index, std::forward <U> (t)), true);
+   }
+
+   /*****************************************************
+    * BTREE :: EMPLACE
+    * Build a value from args and insert it. The key is not known until
+    * the value is built, so it is built on the side and moved in.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::emplace(Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), false /*keepUnique*/, nullptr);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::emplaceUnique(Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), true /*keepUnique*/, nullptr);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::emplaceHint(iterator hint, Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), false /*keepUnique*/, &hint);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::emplaceHintUnique(iterator hint,
+                                                                                                               Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), true /*keepUnique*/, &hint);
+   }
+
+   /*****************************************************
+    * BTREE :: INSERT RANGE
+    * Insert each value of [first, last) where its key belongs
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class Iterator>
+   void btree <T, A, KeyOf, C, Fanout> ::insert(Iterator first, Iterator last, bool keepUnique)
+   {
+      for (; first != last; ++first)
+         insert(*first, keepUnique);
+   }
+
+   /*****************************************************
+    * BTREE :: TRY EMPLACE
+    * Like emplaceUnique(), but the caller hands over the key, so the
+    * value is only built if it is going in, and right in its slot
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::tryEmplace(const key_type& k,
+                                                                                                        Args&& ... args)
+   {
+      LeafNode* pLeaf;
+      int index;
+      iterator itMatch = findSpot(k, true /*keepUnique*/, nullptr, pLeaf, index);
+      if (itMatch != end())
+         return std::pair<iterator, bool>(itMatch, false);
+      return std::pair<iterator, bool>(insertAt(pLeaf, index, std::forward <Args> (args)...), true);
+   }
+
+   /*****************************************************
+    * BTREE :: INSERT AT
+    * Build a value from args at index of a leaf, splitting the leaf
+    * first if it is full. When the value goes at the very end of the
+    * tree, the full leaf keeps all but its last value, which moves up,
+    * so ascending input leaves the nodes one short of full rather
+    * than half full.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::insertAt(LeafNode* pLeaf, int index,
+                                                                                         Args&& ... args)
+   {
+      // the first value gets the first leaf
+      if (pLeaf == nullptr)
+      {
+         assert(root == nullptr);
+         pLeaf = newLeaf();
+         try
+         {
+            insertIntoNode(pLeaf, 0, std::forward <Args> (args)...);
+         }
+         catch (...)
+         {
+            freeNode(pLeaf);
+            throw;
+         }
+         root = pLeftmost = pRightmost = pLeaf;
+         numElements = 1;
+         return iterator(pLeaf, 0, this);
+      }
+
+      if (pLeaf->count == numMaxValues)
+      {
+         bool isAppend = (pLeaf == pRightmost && index == pLeaf->count);
+         int numLeft = isAppend ? numMaxValues - 1 : numMaxValues / 2;
+         LeafNode* pSibling = splitNode(pLeaf, isAppend);
+         if (index > numLeft)
+         {
+            pLeaf = pSibling;
+            index -= numLeft + 1;
+         }
+      }
+
+      insertIntoNode(pLeaf, index, std::forward <Args> (args)...);
+      numElements++;
+      return iterator(pLeaf, index, this);
+   }
+
+   /*****************************************************
+    * BTREE :: SYNC KEYS
+    * Copy the keys of values iBegin through iEnd of a node into
+    * its KeyBlock after they moved. Nothing to do without one.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::syncKeys(LeafNode* pNode, int iBegin, int iEnd) noexcept
+   {
+      if constexpr (hasKeyBlock)
+         for (int i = iBegin; i < iEnd; i++)
+            pNode->keys[i] = keyOf(pNode->value(i));
+   }
+
+   /*****************************************************
+    * BTREE :: INSERT INTO NODE
+    * Build a value at index in a node with room, shifting the ones
+    * after it over. If building it throws, they shift back.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   template <class ... Args>
+   void btree <T, A, KeyOf, C, Fanout> ::insertIntoNode(LeafNode* pNode, int index, Args&& ... args)
+   {
+      assert(pNode->count < numMaxValues);
+      T* pValues = pNode->values();
+      int num = pNode->count;
+      if (index < num)
+      {
+         ::new (static_cast <void*> (pValues + num)) T(std::move(pValues[num - 1]));
+         std::move_backward(pValues + index, pValues + num - 1, pValues + num);
+         pValues[index].~T();
+      }
+
+      try
+      {
+         constructValue(pValues + index, std::forward <Args> (args)...);
+      }
+      catch (...)
+      {
+         if (index < num)
+         {
+            ::new (static_cast <void*> (pValues + index)) T(std::move(pValues[index + 1]));
+            std::move(pValues + index + 2, pValues + num + 1, pValues + index + 1);
+            pValues[num].~T();
+         }
+         throw;
+      }
+      pNode->count++;
+      syncKeys(pNode, index, pNode->count);
+   }
+
+   /*****************************************************
+    * BTREE :: INSERT CHILD
+    * Put t at index in an internal node with room, with pChild as
+    * the child just after it
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::insertChild(InternalNode* pNode, int index, T&& t, LeafNode* pChild) noexcept
+   {
+      insertIntoNode(pNode, index, std::move(t));
+      for (int i = pNode->count; i > index + 1; i--)
+         pNode->setChild(i, pNode->children[i - 1]);
+      pNode->setChild(index + 1, pChild);
+   }
+
+   /*****************************************************
+    * BTREE :: SPLIT NODE
+    * Split a full node in two. The values after the middle one go to a
+    * new sibling on the right, and the middle one moves up to the parent
+    * between them. A full parent is split first, and a split root gets
+    * a new root above it, which is the only way the tree grows taller.
+    * An append keeps all but the last value on the left instead.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::LeafNode* btree <T, A, KeyOf, C, Fanout> ::splitNode(LeafNode* pNode, bool isAppend)
+   {
+      assert(pNode->count == numMaxValues);
+      int numLeft = isAppend ? numMaxValues - 1 : numMaxValues / 2;
+      int numRight = numMaxValues - numLeft - 1;
+
+      // get every node we need before anything moves
+      LeafNode* pSibling = pNode->isLeaf ? newLeaf() : newInternal();
+      try
+      {
+         if (pNode->pParent == nullptr)
+         {
+            InternalNode* pRoot = newInternal();
+            pRoot->setChild(0, pNode);
+            root = pRoot;
+         }
+         else if (pNode->pParent->count == numMaxValues)
+            splitNode(pNode->pParent, isAppend);
+      }
+      catch (...)
+      {
+         freeNode(pSibling);
+         throw;
+      }
+
+      // the right part moves to the sibling, children and all
+      T* pValues = pNode->values();
+      for (int i = 0; i < numRight; i++)
+      {
+         ::new (static_cast <void*> (pSibling->values() + i)) T(std::move(pValues[numLeft + 1 + i]));
+         pValues[numLeft + 1 + i].~T();
+      }
+      if (!pNode->isLeaf)
+      {
+         for (int i = 0; i <= numRight; i++)
+         {
+            pSibling->asInternal()->setChild(i, pNode->asInternal()->children[numLeft + 1 + i]);
+            pNode->asInternal()->children[numLeft + 1 + i] = nullptr;
+         }
+      }
+      pSibling->count = (unsigned short)numRight;
+      syncKeys(pSibling, 0, numRight);
+
+      // the middle one goes up
+      insertChild(pNode->pParent, pNode->position, std::move(pValues[numLeft]), pSibling);
+      pValues[numLeft].~T();
+      pNode->count = (unsigned short)numLeft;
+
+      if (pNode == pRightmost)
+         pRightmost = pSibling;
+      return pSibling;
+   }
+
+   /*****************************************************
+    * BTREE :: ERASE
+    * Remove one element, returning the one after it. A value in an
+    * internal node is replaced by the one just before it, which is
+    * always the last of a leaf, so it is always a leaf that loses a
+    * value and may need refilling.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::erase(iterator it)
+   {
+      if (it.pNode == nullptr)
+         return end();
+
+      LeafNode* pLeaf = it.pNode;
+      int index = it.index;
+      iterator itTrack(pLeaf, index, this);
+      bool isInternal = !pLeaf->isLeaf;
+      if (isInternal)
+      {
+         // the predecessor takes its place. The next one is after that.
+         pLeaf = findRightmost(pLeaf->asInternal()->children[index]);
+         index = pLeaf->count - 1;
+         it.pNode->value(it.index) = std::move(pLeaf->value(index));
+         syncKeys(it.pNode, it.index, it.index + 1);
+      }
+
+      // the values after it in the leaf shift down. The one that lands
+      // in its slot, or the end of the leaf, is next.
+      removeFromNode(pLeaf, index);
+      numElements--;
+      if (!isInternal)
+         itTrack = iterator(pLeaf, index, this);
+
+      rebalance(pLeaf, itTrack);
+      if (itTrack.pNode != nullptr)
+      {
+         if (isInternal)
+            ++itTrack;
+         else
+            itTrack.climbPastEnd();
+      }
+      return itTrack;
+   }
+
+   /*****************************************************
+    * BTREE :: ERASE RANGE
+    * Remove [first, last): O(k log n) for k values, since they go
+    * one at a time, each erase rebalancing as it would on its own.
+    * The positions shift as values move around, so we count first.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator btree <T, A, KeyOf, C, Fanout> ::erase(iterator first, iterator last)
+   {
+      if (first == begin() && last == end())
+      {
+         clear();
+         return end();
+      }
+
+      // count first: the positions shift as we go, but not the number
+      size_t num = 0;
+      for (iterator it = first; it != last; ++it)
+         num++;
+      while (num-- > 0)
+         first = erase(first);
+      return first;
+   }
+
+   /*************************************************
+    * BTREE :: EXTRACT
+    * Move a value out of the tree into a handle of its own
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::NodeHandle btree <T, A, KeyOf, C, Fanout> ::extract(iterator it)
+   {
+      if (it == end())
+         return NodeHandle();
+
+      A allocValue(alloc);
+      T* pValue = ValueTraits::allocate(allocValue, 1);
+      ::new (static_cast <void*> (pValue)) T(std::move(it.pNode->value(it.index)));
+      erase(it);
+      return NodeHandle(pValue, allocValue);
+   }
+
+   /*************************************************
+    * BTREE :: INSERT NODE HANDLE
+    * Move the value of a handle into the tree. If it was kept out
+    * because of keepUnique, the handle still owns it.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   std::pair<typename btree <T, A, KeyOf, C, Fanout> ::iterator, bool> btree <T, A, KeyOf, C, Fanout> ::insert(NodeHandle&& nh,
+                                                                                                    bool keepUnique)
+   {
+      if (nh.empty())
+         return std::pair<iterator, bool>(end(), false);
+
+      LeafNode* pLeaf;
+      int index;
+      iterator itMatch = findSpot(keyOf(*nh.pValue), keepUnique, nullptr, pLeaf, index);
+      if (itMatch != end())
+         return std::pair<iterator, bool>(itMatch, false);
+
+      iterator it = insertAt(pLeaf, index, std::move(*nh.pValue));
+      nh.reset();
+      return std::pair<iterator, bool>(it, true);
+   }
+
+   /*****************************************************
+    * BTREE :: REMOVE FROM NODE
+    * Take the value at index out of a node, shifting those
+    * after it down
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::removeFromNode(LeafNode* pNode, int index) noexcept
+   {
+      T* pValues = pNode->values();
+      std::move(pValues + index + 1, pValues + pNode->count, pValues + index);
+      pValues[pNode->count - 1].~T();
+      pNode->count--;
+      syncKeys(pNode, index, pNode->count);
+   }
+
+   /*****************************************************
+    * BTREE :: REBALANCE
+    * Refill a node that has fewer than numMinValues, about half:
+    * borrow one through the parent from a sibling that can spare it,
+    * or else merge with a sibling. A merge takes a value from the
+    * parent, which may then need refilling too. A root left with no
+    * values gives way to its only child, or to nothing.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::rebalance(LeafNode* pNode, iterator& itTrack) noexcept
+   {
+      while (pNode != root && pNode->count < numMinValues)
+      {
+         InternalNode* pParent = pNode->pParent;
+         int position = pNode->position;
+         LeafNode* pLeft = position > 0 ? pParent->children[position - 1] : nullptr;
+         LeafNode* pRight = position < pParent->count ? pParent->children[position + 1] : nullptr;
+
+         if (pLeft != nullptr && pLeft->count > numMinValues)
+         {
+            borrowFromLeft(pNode, itTrack);
+            break;
+         }
+         if (pRight != nullptr && pRight->count > numMinValues)
+         {
+            borrowFromRight(pNode, itTrack);
+            break;
+         }
+         mergeChildren(pParent, pLeft != nullptr ? position - 1 : position, itTrack);
+         pNode = pParent;
+      }
+
+      if (root->count == 0)
+      {
+         LeafNode* pOld = root;
+         if (root->isLeaf)
+         {
+            root = pLeftmost = pRightmost = nullptr;
+            itTrack = end();
+         }
+         else
+         {
+            root = root->asInternal()->children[0];
+            root->pParent = nullptr;
+            root->position = 0;
+         }
+         freeNode(pOld);
+      }
+   }
+
+   /*****************************************************
+    * BTREE :: BORROW FROM LEFT
+    * The separator in the parent comes down to the front of the
+    * node, and the last value of the left sibling goes up in its
+    * place, along with its last child
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::borrowFromLeft(LeafNode* pNode, iterator& itTrack) noexcept
+   {
+      InternalNode* pParent = pNode->pParent;
+      int iSeparator = pNode->position - 1;
+      LeafNode* pLeft = pParent->children[iSeparator];
+      int iLast = pLeft->count - 1;
+
+      insertIntoNode(pNode, 0, std::move(pParent->value(iSeparator)));
+      if (!pNode->isLeaf)
+      {
+         InternalNode* pInternal = pNode->asInternal();
+         for (int i = pNode->count; i > 0; i--)
+            pInternal->setChild(i, pInternal->children[i - 1]);
+         pInternal->setChild(0, pLeft->asInternal()->children[iLast + 1]);
+         pLeft->asInternal()->children[iLast + 1] = nullptr;
+      }
+      pParent->value(iSeparator) = std::move(pLeft->value(iLast));
+      syncKeys(pParent, iSeparator, iSeparator + 1);
+      removeFromNode(pLeft, iLast);
+
+      if (itTrack.pNode == pNode)
+         itTrack.index++;
+      else if (itTrack.pNode == pParent && itTrack.index == iSeparator)
+         itTrack = iterator(pNode, 0, itTrack.pTree);
+      else if (itTrack.pNode == pLeft && itTrack.index == iLast)
+         itTrack = iterator(pParent, iSeparator, itTrack.pTree);
+   }
+
+   /*****************************************************
+    * BTREE :: BORROW FROM RIGHT
+    * The separator in the parent comes down to the end of the
+    * node, and the first value of the right sibling goes up in its
+    * place, along with its first child
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::borrowFromRight(LeafNode* pNode, iterator& itTrack) noexcept
+   {
+      InternalNode* pParent = pNode->pParent;
+      int iSeparator = pNode->position;
+      LeafNode* pRight = pParent->children[iSeparator + 1];
+      int iEnd = pNode->count;
+
+      insertIntoNode(pNode, iEnd, std::move(pParent->value(iSeparator)));
+      if (!pNode->isLeaf)
+      {
+         InternalNode* pInternal = pRight->asInternal();
+         pNode->asInternal()->setChild(iEnd + 1, pInternal->children[0]);
+         for (int i = 0; i < pRight->count; i++)
+            pInternal->setChild(i, pInternal->children[i + 1]);
+         pInternal->children[pRight->count] = nullptr;
+      }
+      pParent->value(iSeparator) = std::move(pRight->value(0));
+      syncKeys(pParent, iSeparator, iSeparator + 1);
+      removeFromNode(pRight, 0);
+
+      if (itTrack.pNode == pParent && itTrack.index == iSeparator)
+         itTrack = iterator(pNode, iEnd, itTrack.pTree);
+      else if (itTrack.pNode == pRight && itTrack.index == 0)
+         itTrack = iterator(pParent, iSeparator, itTrack.pTree);
+      else if (itTrack.pNode == pRight)
+         itTrack.index--;
+   }
+
+   /*****************************************************
+    * BTREE :: MERGE CHILDREN
+    * Children index and index + 1 of a parent become one node: the
+    * left one takes the separator and then everything of the right
+    * one, which is freed
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::mergeChildren(InternalNode* pParent, int index, iterator& itTrack) noexcept
+   {
+      LeafNode* pLeft = pParent->children[index];
+      LeafNode* pRight = pParent->children[index + 1];
+      int numLeft = pLeft->count;
+      assert(numLeft + 1 + pRight->count <= numMaxValues);
+
+      T* pValues = pLeft->values();
+      ::new (static_cast <void*> (pValues + numLeft)) T(std::move(pParent->value(index)));
+      for (int i = 0; i < pRight->count; i++)
+      {
+         ::new (static_cast <void*> (pValues + numLeft + 1 + i)) T(std::move(pRight->value(i)));
+         pRight->value(i).~T();
+      }
+      if (!pLeft->isLeaf)
+         for (int i = 0; i <= pRight->count; i++)
+            pLeft->asInternal()->setChild(numLeft + 1 + i, pRight->asInternal()->children[i]);
+      pLeft->count = (unsigned short)(numLeft + 1 + pRight->count);
+      pRight->count = 0;
+      syncKeys(pLeft, numLeft, pLeft->count);
+
+      // the parent loses the separator and the child after it
+      removeFromNode(pParent, index);
+      for (int i = index + 1; i <= pParent->count; i++)
+         pParent->setChild(i, pParent->children[i + 1]);
+      pParent->children[pParent->count + 1] = nullptr;
+
+      if (itTrack.pNode == pParent && itTrack.index == index)
+         itTrack = iterator(pLeft, numLeft, itTrack.pTree);
+      else if (itTrack.pNode == pParent && itTrack.index > index)
+         itTrack.index--;
+      else if (itTrack.pNode == pRight)
+         itTrack = iterator(pLeft, numLeft + 1 + itTrack.index, itTrack.pTree);
+
+      if (pRight == pRightmost)
+         pRightmost = pLeft;
+      freeNode(pRight);
+   }
+
+   /*****************************************************
+    * BTREE :: CLEAR
+    * Remove all the elements and free all the nodes
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::clear() noexcept
+   {
+      if (root != nullptr)
+         deleteTree(root);
+      root = pLeftmost = pRightmost = nullptr;
+      numElements = 0;
+   }
+
+   /*****************************************************
+    * BTREE :: NEW LEAF and NEW INTERNAL
+    * An empty node from the allocator
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::LeafNode* btree <T, A, KeyOf, C, Fanout> ::newLeaf()
+   {
+      LeafNode* pNode = LeafTraits::allocate(alloc, 1);
+      LeafTraits::construct(alloc, pNode, true /*isLeaf*/);
+      return pNode;
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::InternalNode* btree <T, A, KeyOf, C, Fanout> ::newInternal()
+   {
+      InternalAlloc allocInternal(alloc);
+      InternalNode* pNode = InternalTraits::allocate(allocInternal, 1);
+      InternalTraits::construct(allocInternal, pNode);
+      return pNode;
+   }
+
+   /*****************************************************
+    * BTREE :: FREE NODE
+    * Give a node back to the allocator. Its values must
+    * already be destroyed or moved out.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::freeNode(LeafNode* pNode) noexcept
+   {
+      if (pNode->isLeaf)
+      {
+         LeafTraits::destroy(alloc, pNode);
+         LeafTraits::deallocate(alloc, pNode, 1);
+      }
+      else
+      {
+         InternalAlloc allocInternal(alloc);
+         InternalNode* pInternal = pNode->asInternal();
+         InternalTraits::destroy(allocInternal, pInternal);
+         InternalTraits::deallocate(allocInternal, pInternal, 1);
+      }
+   }
+
+   /*****************************************************
+    * BTREE :: DELETE TREE
+    * Destroy every value under a node and free the nodes. A child
+    * that is not there yet, as in a copy cut short, is skipped.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::deleteTree(LeafNode* pNode) noexcept
+   {
+      for (int i = 0; i < pNode->count; i++)
+         pNode->value(i).~T();
+      if (!pNode->isLeaf)
+         for (int i = 0; i <= pNode->count; i++)
+            if (pNode->asInternal()->children[i] != nullptr)
+               deleteTree(pNode->asInternal()->children[i]);
+      freeNode(pNode);
+   }
+
+   /*****************************************************
+    * BTREE :: COPY TREE
+    * Copy a node and everything under it. Anything copied so
+    * far is freed if a copy throws.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::LeafNode* btree <T, A, KeyOf, C, Fanout> ::copyTree(const LeafNode* pSrc)
+   {
+      LeafNode* pDest = pSrc->isLeaf ? newLeaf() : newInternal();
+      try
+      {
+         for (int i = 0; i < pSrc->count; i++)
+         {
+            ::new (static_cast <void*> (pDest->values() + i)) T(pSrc->value(i));
+            pDest->count++;
+         }
+         syncKeys(pDest, 0, pDest->count);
+         if (!pSrc->isLeaf)
+            for (int i = 0; i <= pSrc->count; i++)
+               pDest->asInternal()->setChild(i, copyTree(pSrc->asInternal()->children[i]));
+      }
+      catch (...)
+      {
+         deleteTree(pDest);
+         throw;
+      }
+      return pDest;
+   }
+
+   /*****************************************************
+    * BTREE :: COPY FROM
+    * Fill an empty tree with a copy of rhs, node for node
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::copyFrom(const btree& rhs)
+   {
+      assert(root == nullptr);
+      if (rhs.root == nullptr)
+         return;
+      root = copyTree(rhs.root);
+      pLeftmost = findLeftmost(root);
+      pRightmost = findRightmost(root);
+      numElements = rhs.numElements;
+   }
+
+   /*****************************************************
+    * BTREE :: FIND LEFTMOST and FIND RIGHTMOST
+    * The first or last leaf under a node
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::LeafNode* btree <T, A, KeyOf, C, Fanout> ::findLeftmost(LeafNode* pNode) noexcept
+   {
+      while (pNode != nullptr && !pNode->isLeaf)
+         pNode = pNode->asInternal()->children[0];
+      return pNode;
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::LeafNode* btree <T, A, KeyOf, C, Fanout> ::findRightmost(LeafNode* pNode) noexcept
+   {
+      while (pNode != nullptr && !pNode->isLeaf)
+         pNode = pNode->asInternal()->children[pNode->count];
+      return pNode;
+   }
+
+#ifdef DEBUG
+   /*****************************************************
+    * BTREE :: VERIFY
+    * Is the tree correctly formed: every node in order and
+    * between the values around it in its parent, not empty
+    * and not overfull, every leaf at the same depth, and the
+    * cached leaves and count right? Every node holds at least
+    * numMinValues but those down the right edge of the tree,
+    * the root included: an append leaves them with as few as one.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   bool btree <T, A, KeyOf, C, Fanout> ::verify() const
+   {
+      if (root == nullptr)
+         return pLeftmost == nullptr && pRightmost == nullptr && numElements == 0;
+
+      size_t num = 0;
+      return root->pParent == nullptr &&
+             verifyNode(root, nullptr, nullptr, num) >= 0 &&
+             num == numElements &&
+             pLeftmost == findLeftmost(root) &&
+             pRightmost == findRightmost(root);
+   }
+
+   /*****************************************************
+    * BTREE :: VERIFY NODE
+    * Check a node and everything under it, counting the values.
+    * The depth of its leaves comes back, or -1 if anything is wrong.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   int btree <T, A, KeyOf, C, Fanout> ::verifyNode(const LeafNode* pNode, const T* pLow, const T* pHigh,
+                                                   size_t& num) const
+   {
+      if (pNode->count < 1 || pNode->count > numMaxValues)
+         return -1;
+      if (pHigh != nullptr && pNode->count < numMinValues)
+         return -1;
+      for (int i = 0; i < pNode->count; i++)
+      {
+         const T* pValue = &pNode->value(i);
+         if ((i > 0 && compare(keyOf(*pValue), keyOf(pNode->value(i - 1)))) ||
+             (pLow  != nullptr && compare(keyOf(*pValue), keyOf(*pLow))) ||
+             (pHigh != nullptr && compare(keyOf(*pHigh), keyOf(*pValue))))
+            return -1;
+         if constexpr (hasKeyBlock)
+            if (pNode->keys[i] != keyOf(*pValue))
+               return -1;
+      }
+      num += pNode->count;
+      if (pNode->isLeaf)
+         return 0;
+
+      int depth = -1;
+      for (int i = 0; i <= pNode->count; i++)
+      {
+         const LeafNode* pChild = pNode->asInternal()->children[i];
+         if (pChild == nullptr || pChild->pParent != pNode || pChild->position != i)
+            return -1;
+         int depthChild = verifyNode(pChild,
+                                     i == 0 ? pLow : &pNode->value(i - 1),
+                                     i == pNode->count ? pHigh : &pNode->value(i),
+                                     num);
+         if (depthChild < 0 || (depth >= 0 && depthChild != depth))
+            return -1;
+         depth = depthChild;
+      }
+      return depth + 1;
+   }
+#endif // DEBUG
+
+   /*********************************************
+    *********************************************
+    *********************************************
+    *************** BTREE ITERATOR **************
+    *********************************************
+    *********************************************
+    *********************************************/
+
+
+   /**************************************************
+    * BTREE ITERATOR :: INCREMENT PREFIX
+    * After a value in an internal node comes the first leaf of
+    * the child after it. After a value in a leaf comes the next
+    * one there, or, past the end of the leaf, the first value
+    * above it that is not behind us.
+    *************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator& btree <T, A, KeyOf, C, Fanout> ::iterator :: operator ++ ()
+   {
+      if (pNode == nullptr)
+         return *this;
+
+      if (!pNode->isLeaf)
+      {
+         pNode = findLeftmost(pNode->asInternal()->children[index + 1]);
+         index = 0;
+         return *this;
+      }
+
+      index++;
+      climbPastEnd();
+      return *this;
+   }
+
+   /**************************************************
+    * BTREE ITERATOR :: CLIMB PAST END
+    * An index one past the last value of a node means the value
+    * after the node, which is in the parent just after this child.
+    * Past the end of the root is end().
+    *************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   void btree <T, A, KeyOf, C, Fanout> ::iterator ::climbPastEnd() noexcept
+   {
+      while (pNode != nullptr && index == pNode->count)
+      {
+         index = pNode->position;
+         pNode = pNode->pParent;
+      }
+      if (pNode == nullptr)
+         index = 0;
+   }
+
+   /**************************************************
+    * BTREE ITERATOR :: DECREMENT PREFIX
+    * The mirror image of increment. Stepping back from end()
+    * lands on the largest element.
+    *************************************************/
+   template <typename T, typename A, typename KeyOf, typename C, size_t Fanout>
+   typename btree <T, A, KeyOf, C, Fanout> ::iterator& btree <T, A, KeyOf, C, Fanout> ::iterator :: operator -- ()
+   {
+      if (pNode == nullptr)
+      {
+         if (pTree != nullptr)
+            *this = pTree->rbegin();
+         return *this;
+      }
+
+      if (!pNode->isLeaf)
+      {
+         pNode = findRightmost(pNode->asInternal()->children[index]);
+         index = pNode->count - 1;
+         return *this;
+      }
+
+      if (index > 0)
+      {
+         index--;
+         return *this;
+      }
+
+      // the first of a leaf: climb until we are not the first child
+      while (pNode->pParent != nullptr && pNode->position == 0)
+         pNode = pNode->pParent;
+      if (pNode->pParent == nullptr)
+      {
+         pNode = nullptr;
+         index = 0;
+         return *this;
+      }
+      index = pNode->position - 1;
+      pNode = pNode->pParent;
+      return *this;
+   }
+
+}; // namespace custom
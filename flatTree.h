@@ -0,0 +1,1192 @@
+/***********************************************************************
+ * Header:
+ *    FLAT TREE
+ * Summary:
+ *    A sorted array for map to keep its pairs in when it is built once
+ *    and then mostly read: no nodes, no pointers to chase, and a
+ *    lookup is a binary search over one contiguous block
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        flat_tree           : A class that keeps its values sorted side by side
+ *        flat_tree::iterator : An iterator through a flat_tree
+ * Author
+ *    <your names here>
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <memory>     // for std::allocator and std::allocator_traits
+#include <functional> // for std::less
+#include <utility>    // for std::pair, std::move and std::forward
+#include <algorithm>  // for std::stable_sort, std::inplace_merge and std::unique
+#include <new>        // for placement new
+#include <iterator>   // for std::random_access_iterator_tag and std::distance
+#include <cstddef>    // for std::ptrdiff_t
+#include "bst.h"      // for Identity, Range, sorted_unique and isForwardIterator
+
+class TestFlatTree; // forward declaration for unit tests
+
+namespace custom
+{
+   /*****************************************************************
+    * FLAT TREE
+    * Create a flat tree. The values are kept in one array, ordered by
+    * C on the key KeyOf pulls out of them, just as in a BST. A lookup
+    * is a binary search that picks a half without a branch. An insert
+    * or an erase in the middle moves everything after it, so a range
+    * goes in all at once: appended, sorted, and merged with the rest.
+    *
+    * An insert or an erase invalidates every iterator, as a vector's
+    * does, and T must not throw when it is moved.
+    *****************************************************************/
+   template <typename T, typename A = std::allocator <T>, typename KeyOf = Identity,
+             typename C = std::less <T>>
+   class flat_tree
+   {
+      friend class ::TestFlatTree; // give unit tests access to the privates
+
+      template <class KK, class VV, class CC, class AA, bool RR, class PP>
+      friend class custom::map;
+   public:
+      using allocator_type = A;
+      using key_type = std::decay_t <decltype(KeyOf()(std::declval <const T&> ()))>;
+      using key_compare = C;
+
+      //
+      // Construct
+      //
+
+      flat_tree();
+      explicit flat_tree(const A& a);
+      explicit flat_tree(const C& c, const A& a = A());
+      flat_tree(const flat_tree& rhs);
+      flat_tree(const flat_tree& rhs, const A& a);
+      flat_tree(flat_tree&& rhs) noexcept;
+      flat_tree(const std::initializer_list<T>& il, const A& a = A());
+      ~flat_tree();
+
+      //
+      // Assign
+      //
+
+      flat_tree& operator = (const flat_tree& rhs);
+      flat_tree& operator = (flat_tree&& rhs) noexcept(isMoveAssignNoexcept);
+      flat_tree& operator = (const std::initializer_list<T>& il);
+      void swap(flat_tree& rhs);
+
+      // replace the contents with a range, sorted all at once
+      template <class Iterator>
+      void assign(Iterator first, Iterator last, bool keepUnique = false);
+      template <class Iterator>
+      void assign(sorted_unique_t, Iterator first, Iterator last);
+
+      //
+      // Iterator
+      //
+
+      class iterator;
+      iterator begin()  const noexcept { return iterator(pValues); }
+      iterator rbegin() const noexcept { return numElements ? iterator(pValues + numElements - 1) : end(); }
+      iterator end()    const noexcept { return iterator(pValues + numElements); }
+
+      //
+      // Access
+      //
+
+      iterator find(const key_type& k) const { return findPosition(k); }
+      bool contains(const key_type& k) const { return findPosition(k) != end(); }
+
+      // the first element not before k, the first after k, and both
+      iterator lowerBound(const key_type& k) const { return iterator(pValues + lowerBoundIndex(k)); }
+      iterator upperBound(const key_type& k) const { return iterator(pValues + upperBoundIndex(k)); }
+      std::pair<iterator, iterator> equalRange(const key_type& k) const
+      {
+         return std::pair<iterator, iterator>(lowerBound(k), upperBound(k));
+      }
+
+      // with a transparent comparator, anything comparable to a key will do
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator find(const K& k) const { return findPosition(k); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      bool contains(const K& k) const { return findPosition(k) != end(); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator lowerBound(const K& k) const { return iterator(pValues + lowerBoundIndex(k)); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      iterator upperBound(const K& k) const { return iterator(pValues + upperBoundIndex(k)); }
+      template <class K, class CC = C, class = typename CC::is_transparent>
+      std::pair<iterator, iterator> equalRange(const K& k) const
+      {
+         return std::pair<iterator, iterator>(lowerBound(k), upperBound(k));
+      }
+
+      // every element with a key in [lo, hi)
+      Range <iterator> range(const key_type& lo, const key_type& hi) const;
+
+      // order statistics come free with an array
+      iterator nth(size_t k) const { return k < numElements ? iterator(pValues + k) : end(); }
+      size_t rank(const key_type& k) const { return lowerBoundIndex(k); }
+      size_t countRange(const key_type& lo, const key_type& hi) const;
+
+      //
+      // Insert
+      //
+
+      std::pair<iterator, bool> insert(const T& t, bool keepUnique = false);
+      std::pair<iterator, bool> insert(T&& t, bool keepUnique = false);
+
+      // the arguments are those a BST node takes: a value, or
+      // std::in_place followed by what builds one
+      template <class ... Args>
+      std::pair<iterator, bool> emplace(Args&& ... args);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceUnique(Args&& ... args);
+
+      // a hint that is right, just after where the value goes, skips the search
+      std::pair<iterator, bool> insert(iterator hint, const T& t, bool keepUnique = false);
+      std::pair<iterator, bool> insert(iterator hint, T&& t, bool keepUnique = false);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceHint(iterator hint, Args&& ... args);
+      template <class ... Args>
+      std::pair<iterator, bool> emplaceHintUnique(iterator hint, Args&& ... args);
+
+      // build the value only if nothing with key k is here yet
+      template <class ... Args>
+      std::pair<iterator, bool> tryEmplace(const key_type& k, Args&& ... args);
+
+      // many values at once: appended, sorted, then merged with the rest
+      template <class Iterator>
+      void insert(Iterator first, Iterator last, bool keepUnique = false);
+
+      // move in the values of source, leaving behind those kept out by keepUnique
+      void merge(flat_tree& source, bool keepUnique = false);
+
+      //
+      // Remove
+      //
+
+      iterator erase(iterator it);
+      iterator erase(iterator first, iterator last);
+      void   clear() noexcept;
+
+      // take out the smallest or the largest element
+      void popFront() { erase(begin()); }
+      void popBack()  { erase(rbegin()); }
+
+      // move a value between trees without copying it. Values do not
+      // have nodes of their own here, so the handle allocates one slot.
+      class NodeHandle;
+      NodeHandle extract(iterator it);
+      std::pair<iterator, bool> insert(NodeHandle&& nh, bool keepUnique = false);
+
+      //
+      // Status
+      //
+
+      bool   empty()    const noexcept { return numElements == 0; }
+      size_t size()     const noexcept { return numElements; }
+      size_t capacity() const noexcept { return numCapacity; }
+
+      // room for num values without moving them again, or no spare room
+      void reserve(size_t num);
+      void shrink_to_fit();
+
+      A get_allocator() const noexcept { return alloc; }
+      C key_comp() const { return compare; }
+
+   private:
+
+      using Traits = std::allocator_traits <A>;
+
+      // only a move between allocators that differ moves values one at a time
+      static constexpr bool isMoveAssignNoexcept = Traits::propagate_on_container_move_assignment::value ||
+                                                   Traits::is_always_equal::value;
+
+      // searching by key
+      static const key_type& keyOf(const T& t) { return KeyOf()(t); }
+      template <class K>
+      size_t lowerBoundIndex(const K& k) const { return lowerBoundIndex(k, numElements); }
+      template <class K>
+      size_t upperBoundIndex(const K& k) const { return upperBoundIndex(k, numElements); }
+      template <class K>
+      size_t lowerBoundIndex(const K& k, size_t num) const;
+      template <class K>
+      size_t upperBoundIndex(const K& k, size_t num) const;
+      template <class K>
+      iterator findPosition(const K& k) const;
+      iterator findSpot(const key_type& k, bool keepUnique, const iterator* pHint, size_t& index) const;
+      size_t indexOf(const iterator& it) const noexcept { return size_t(it.p - pValues); }
+
+      // building a value from the arguments a BST node would take
+      template <class ... Args>
+      static void constructValue(T* p, Args&& ... args);
+      template <class ... Args>
+      static void constructValue(T* p, std::in_place_t, Args&& ... args);
+      template <class ... Args>
+      static T makeValue(Args&& ... args);
+      template <class ... Args>
+      static T makeValue(std::in_place_t, Args&& ... args);
+
+      // adding and removing values, moving the ones after them
+      template <class U>
+      std::pair<iterator, bool> insertValue(U&& t, bool keepUnique, const iterator* pHint);
+      template <class ... Args>
+      iterator insertAt(size_t index, Args&& ... args);
+      void sortFrom(size_t numSorted, bool keepUnique);
+      void eraseAt(size_t iBegin, size_t iEnd) noexcept;
+
+      // the array itself
+      void reallocate(size_t num);
+      void copyFrom(const flat_tree& rhs);
+      void deallocate() noexcept;
+      static void relocate(T* pDest, T* pSrc, size_t num) noexcept;
+
+#ifdef DEBUG
+      //
+      // Verify
+      //
+      bool verify() const;
+#endif // DEBUG
+
+      T* pValues;           // the values, in order. nullptr with no capacity
+      size_t numElements;   // number of elements currently in the tree
+      size_t numCapacity;   // number of values there is room for
+      A alloc;              // where the array comes from
+      C compare;            // orders the keys
+   };
+
+   /**********************************************************
+    * FLAT TREE ITERATOR
+    * Forward and reverse iterator through a flat_tree: just a
+    * pointer into the array, so it can jump as well as step
+    *********************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   class flat_tree <T, A, KeyOf, C> ::iterator
+   {
+      friend class ::TestFlatTree; // give unit tests access to the privates
+      friend class flat_tree <T, A, KeyOf, C>;
+   public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type        = T;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const T*;
+      using reference         = const T&;
+
+      iterator(const T* p = nullptr) : p(p) {}
+
+      bool operator == (const iterator& rhs) const { return p == rhs.p; }
+      bool operator != (const iterator& rhs) const { return p != rhs.p; }
+      bool operator <  (const iterator& rhs) const { return p <  rhs.p; }
+      bool operator >  (const iterator& rhs) const { return p >  rhs.p; }
+      bool operator <= (const iterator& rhs) const { return p <= rhs.p; }
+      bool operator >= (const iterator& rhs) const { return p >= rhs.p; }
+
+      const T& operator * () const { return *p; }
+      const T* operator -> () const { return p; }
+      const T& operator [] (difference_type n) const { return p[n]; }
+
+      iterator& operator ++ ()    { ++p; return *this; }
+      iterator  operator ++ (int) { iterator itReturn = *this; ++p; return itReturn; }
+      iterator& operator -- ()    { --p; return *this; }
+      iterator  operator -- (int) { iterator itReturn = *this; --p; return itReturn; }
+
+      iterator& operator += (difference_type n) { p += n; return *this; }
+      iterator& operator -= (difference_type n) { p -= n; return *this; }
+      iterator  operator +  (difference_type n) const { return iterator(p + n); }
+      iterator  operator -  (difference_type n) const { return iterator(p - n); }
+      difference_type operator - (const iterator& rhs) const { return p - rhs.p; }
+      friend iterator operator + (difference_type n, const iterator& it) { return iterator(it.p + n); }
+
+      // O(1). Call it unqualified, as map does, or through std::distance
+      friend std::ptrdiff_t distance(const iterator& first, const iterator& last)
+      {
+         return last.p - first.p;
+      }
+
+   private:
+      const T* p;
+   };
+
+   /**********************************************************
+    * FLAT TREE NODE HANDLE
+    * Owns a value taken out of a tree so it can be put into
+    * another without being copied
+    *********************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   class flat_tree <T, A, KeyOf, C> ::NodeHandle
+   {
+      friend class ::TestFlatTree; // give unit tests access to the privates
+      friend class flat_tree <T, A, KeyOf, C>;
+   public:
+      NodeHandle() noexcept : pValue(nullptr), alloc() {}
+      NodeHandle(NodeHandle&& rhs) noexcept : pValue(rhs.pValue), alloc(std::move(rhs.alloc))
+      {
+         rhs.pValue = nullptr;
+      }
+      NodeHandle& operator = (NodeHandle&& rhs) noexcept
+      {
+         if (this != &rhs)
+         {
+            reset();
+            pValue = rhs.pValue;
+            alloc = std::move(rhs.alloc);
+            rhs.pValue = nullptr;
+         }
+         return *this;
+      }
+     ~NodeHandle()
+      {
+         reset();
+      }
+
+      bool empty() const noexcept { return pValue == nullptr; }
+      explicit operator bool () const noexcept { return pValue != nullptr; }
+
+      // the element can be changed, even its key, since it is in no tree
+      T& value() const
+      {
+         assert(pValue != nullptr);
+         return *pValue;
+      }
+      A get_allocator() const { return alloc; }
+
+   private:
+      NodeHandle(T* pValue, const A& alloc) : pValue(pValue), alloc(alloc) {}
+      void reset() noexcept
+      {
+         if (pValue)
+         {
+            Traits::destroy(alloc, pValue);
+            Traits::deallocate(alloc, pValue, 1);
+            pValue = nullptr;
+         }
+      }
+
+      T* pValue;   // the value we own, if any
+      A alloc;     // what will free it
+   };
+
+
+   /*********************************************
+    *********************************************
+    *********************************************
+    ***************** FLAT TREE *****************
+    *********************************************
+    *********************************************
+    *********************************************/
+
+
+   /*********************************************
+    * FLAT TREE :: DEFAULT CONSTRUCTOR
+    * Nothing is allocated until the first value
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> ::flat_tree()
+      : pValues(nullptr), numElements(0), numCapacity(0), alloc(), compare()
+   {
+   }
+
+   /*********************************************
+    * FLAT TREE :: ALLOCATOR CONSTRUCTOR
+    * An empty tree drawing its array from a given allocator
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> ::flat_tree(const A& a)
+      : pValues(nullptr), numElements(0), numCapacity(0), alloc(a), compare()
+   {
+   }
+
+   /*********************************************
+    * FLAT TREE :: COMPARATOR CONSTRUCTOR
+    * An empty tree ordered by a given comparator
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> ::flat_tree(const C& c, const A& a)
+      : pValues(nullptr), numElements(0), numCapacity(0), alloc(a), compare(c)
+   {
+   }
+
+   /*********************************************
+    * FLAT TREE :: COPY CONSTRUCTOR
+    * Copy one tree to another, into an array just big enough
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> ::flat_tree(const flat_tree& rhs)
+      : pValues(nullptr), numElements(0), numCapacity(0),
+        alloc(Traits::select_on_container_copy_construction(rhs.alloc)),
+        compare(rhs.compare)
+   {
+      copyFrom(rhs);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> ::flat_tree(const flat_tree& rhs, const A& a)
+      : pValues(nullptr), numElements(0), numCapacity(0), alloc(a), compare(rhs.compare)
+   {
+      copyFrom(rhs);
+   }
+
+   /*********************************************
+    * FLAT TREE :: MOVE CONSTRUCTOR
+    * Move one tree to another
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> ::flat_tree(flat_tree&& rhs) noexcept
+      : pValues(rhs.pValues), numElements(rhs.numElements), numCapacity(rhs.numCapacity),
+        alloc(std::move(rhs.alloc)), compare(std::move(rhs.compare))
+   {
+      rhs.pValues = nullptr;
+      rhs.numElements = rhs.numCapacity = 0;
+   }
+
+   /*********************************************
+    * FLAT TREE :: INITIALIZER LIST CONSTRUCTOR
+    * Create a flat tree from an initializer list
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> ::flat_tree(const std::initializer_list<T>& il, const A& a)
+      : pValues(nullptr), numElements(0), numCapacity(0), alloc(a), compare()
+   {
+      assign(il.begin(), il.end());
+   }
+
+   /*********************************************
+    * FLAT TREE :: DESTRUCTOR
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C> :: ~flat_tree()
+   {
+      deallocate();
+   }
+
+   /*********************************************
+    * FLAT TREE :: ASSIGNMENT OPERATOR
+    * Copy one tree to another. The array is reused if it is big enough.
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C>& flat_tree <T, A, KeyOf, C> :: operator = (const flat_tree& rhs)
+   {
+      if (this == &rhs)
+         return *this;
+
+      // the old array goes back to the old allocator before it is replaced
+      clear();
+      if constexpr (Traits::propagate_on_container_copy_assignment::value)
+      {
+         deallocate();
+         alloc = rhs.alloc;
+      }
+      compare = rhs.compare;
+      copyFrom(rhs);
+      return *this;
+   }
+
+   /*********************************************
+    * FLAT TREE :: ASSIGN-MOVE OPERATOR
+    * Move one tree to another
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C>& flat_tree <T, A, KeyOf, C> :: operator = (flat_tree&& rhs)
+      noexcept(isMoveAssignNoexcept)
+   {
+      if (this == &rhs)
+         return *this;
+
+      compare = rhs.compare;
+
+      // the allocator comes along, or is the same anyway: steal the array
+      if (Traits::propagate_on_container_move_assignment::value || alloc == rhs.alloc)
+      {
+         deallocate();
+         if constexpr (Traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+         std::swap(rhs.pValues, pValues);
+         std::swap(rhs.numElements, numElements);
+         std::swap(rhs.numCapacity, numCapacity);
+      }
+
+      // different allocators: move the elements one at a time into our array
+      else
+      {
+         clear();
+         reserve(rhs.numElements);
+         for (size_t i = 0; i < rhs.numElements; i++)
+            insertAt(i, std::move(rhs.pValues[i]));
+         rhs.clear();
+      }
+
+      return *this;
+   }
+
+   /*********************************************
+    * FLAT TREE :: ASSIGNMENT OPERATOR with INITIALIZATION LIST
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   flat_tree <T, A, KeyOf, C>& flat_tree <T, A, KeyOf, C> :: operator = (const std::initializer_list<T>& il)
+   {
+      assign(il.begin(), il.end());
+      return *this;
+   }
+
+   /*********************************************
+    * FLAT TREE :: SWAP
+    * Swap two trees
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::swap(flat_tree& rhs)
+   {
+      std::swap(rhs.pValues, pValues);
+      std::swap(rhs.numElements, numElements);
+      std::swap(rhs.numCapacity, numCapacity);
+      std::swap(rhs.compare, compare);
+
+      // without propagation, swapping is only defined for equal allocators
+      if constexpr (Traits::propagate_on_container_swap::value)
+         std::swap(rhs.alloc, alloc);
+      else
+         assert(alloc == rhs.alloc);
+   }
+
+   /*********************************************
+    * FLAT TREE :: ASSIGN
+    * Replace the contents of the tree with [first, last). With
+    * keepUnique, only the first of several equal keys is kept.
+    * Input already sorted and unique is simply copied in.
+    ********************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class Iterator>
+   void flat_tree <T, A, KeyOf, C> ::assign(Iterator first, Iterator last, bool keepUnique)
+   {
+      clear();
+      insert(first, last, keepUnique);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class Iterator>
+   void flat_tree <T, A, KeyOf, C> ::assign(sorted_unique_t, Iterator first, Iterator last)
+   {
+      clear();
+      if constexpr (isForwardIterator <Iterator> ::value)
+         reserve(size_t(std::distance(first, last)));
+      for (; first != last; ++first)
+      {
+         assert(numElements == 0 || compare(keyOf(pValues[numElements - 1]), keyOf(*first)));
+         insertAt(numElements, *first);
+      }
+   }
+
+   /*****************************************************
+    * FLAT TREE :: LOWER BOUND INDEX and UPPER BOUND INDEX
+    * The first value not before k, or the first after k, among
+    * the first num. The answer is somewhere in num values
+    * starting at pBase. Each
+    * step keeps the half that has it by moving pBase or not,
+    * which is a conditional move rather than a branch, so the
+    * loop runs the same log n steps whatever the keys are.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class K>
+   size_t flat_tree <T, A, KeyOf, C> ::lowerBoundIndex(const K& k, size_t num) const
+   {
+      if (num == 0)
+         return 0;
+
+      const T* pBase = pValues;
+      while (num > 1)
+      {
+         size_t half = num / 2;
+         pBase = compare(keyOf(pBase[half]), k) ? pBase + half : pBase;
+         num -= half;
+      }
+      return size_t(pBase - pValues) + (compare(keyOf(*pBase), k) ? 1 : 0);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class K>
+   size_t flat_tree <T, A, KeyOf, C> ::upperBoundIndex(const K& k, size_t num) const
+   {
+      if (num == 0)
+         return 0;
+
+      const T* pBase = pValues;
+      while (num > 1)
+      {
+         size_t half = num / 2;
+         pBase = compare(k, keyOf(pBase[half])) ? pBase : pBase + half;
+         num -= half;
+      }
+      return size_t(pBase - pValues) + (compare(k, keyOf(*pBase)) ? 0 : 1);
+   }
+
+   /****************************************************
+    * FLAT TREE :: FIND POSITION
+    * Where a value with a key equivalent to k is, or end()
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class K>
+   typename flat_tree <T, A, KeyOf, C> ::iterator flat_tree <T, A, KeyOf, C> ::findPosition(const K& k) const
+   {
+      size_t i = lowerBoundIndex(k);
+      if (i < numElements && !compare(k, keyOf(pValues[i])))
+         return iterator(pValues + i);
+      return end();
+   }
+
+   /*****************************************************
+    * FLAT TREE :: RANGE and COUNT RANGE
+    * The elements with a key in [lo, hi), and how many there are
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   Range <typename flat_tree <T, A, KeyOf, C> ::iterator> flat_tree <T, A, KeyOf, C> ::range(const key_type& lo,
+                                                                                          const key_type& hi) const
+   {
+      if (!compare(lo, hi))
+         return Range <iterator> (end(), end());
+      return Range <iterator> (lowerBound(lo), lowerBound(hi));
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   size_t flat_tree <T, A, KeyOf, C> ::countRange(const key_type& lo, const key_type& hi) const
+   {
+      if (!compare(lo, hi))
+         return 0;
+      return lowerBoundIndex(hi) - lowerBoundIndex(lo);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: FIND SPOT
+    * Find the index where a value with key k belongs, after any
+    * values with an equal key so duplicates keep their insertion
+    * order. When keepUnique is set and k is already here, that value
+    * is returned instead, otherwise end(). A hint just after where k
+    * goes, end() when it goes last, is taken without a search.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   typename flat_tree <T, A, KeyOf, C> ::iterator flat_tree <T, A, KeyOf, C> ::findSpot(const key_type& k, bool keepUnique,
+                                                                                    const iterator* pHint,
+                                                                                    size_t& index) const
+   {
+      if (pHint != nullptr)
+      {
+         size_t iHint = indexOf(*pHint);
+         if (iHint <= numElements &&
+             (iHint == 0 || compare(keyOf(pValues[iHint - 1]), k)) &&
+             (iHint == numElements || compare(k, keyOf(pValues[iHint]))))
+         {
+            index = iHint;
+            return end();
+         }
+      }
+
+      // the value just before where k goes is not larger than k. If
+      // it is not smaller either, it is a match.
+      index = upperBoundIndex(k);
+      if (keepUnique && index > 0 && !compare(keyOf(pValues[index - 1]), k))
+         return iterator(pValues + index - 1);
+      return end();
+   }
+
+   /*****************************************************
+    * FLAT TREE :: CONSTRUCT VALUE and MAKE VALUE
+    * Build a T from what a BST node's constructor would take: a
+    * T to copy or move, or std::in_place and the T's arguments.
+    * The first builds it in a slot, the second on its own.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   void flat_tree <T, A, KeyOf, C> ::constructValue(T* p, Args&& ... args)
+   {
+      ::new (static_cast <void*> (p)) T(std::forward <Args> (args)...);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   void flat_tree <T, A, KeyOf, C> ::constructValue(T* p, std::in_place_t, Args&& ... args)
+   {
+      ::new (static_cast <void*> (p)) T(std::forward <Args> (args)...);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   T flat_tree <T, A, KeyOf, C> ::makeValue(Args&& ... args)
+   {
+      return T(std::forward <Args> (args)...);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   T flat_tree <T, A, KeyOf, C> ::makeValue(std::in_place_t, Args&& ... args)
+   {
+      return T(std::forward <Args> (args)...);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: INSERT
+    * Insert a value where its key belongs
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::insert(const T& t, bool keepUnique)
+   {
+      return insertValue(t, keepUnique, nullptr);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::insert(T&& t, bool keepUnique)
+   {
+      return insertValue(std::move(t), keepUnique, nullptr);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: INSERT with HINT
+    * A hint just after where the value goes skips the search
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::insert(iterator hint, const T& t,
+                                                                                                bool keepUnique)
+   {
+      return insertValue(t, keepUnique, &hint);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::insert(iterator hint, T&& t,
+                                                                                                bool keepUnique)
+   {
+      return insertValue(std::move(t), keepUnique, &hint);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: INSERT VALUE
+    * Find the index where t belongs and put it there
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class U>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::insertValue(U&& t, bool keepUnique,
+                                                                                                     const iterator* pHint)
+   {
+      size_t index;
+      iterator itMatch = findSpot(keyOf(t), keepUnique, pHint, index);
+      if (itMatch != end())
+         return std::pair<iterator, bool>(itMatch, false);
+      return std::pair<iterator, bool>(insertAt(index, std::forward <U> (t)), true);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: EMPLACE
+    * Build a value from args and insert it. The key is not known until
+    * the value is built, so it is built on the side and moved in.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::emplace(Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), false /*keepUnique*/, nullptr);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::emplaceUnique(Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), true /*keepUnique*/, nullptr);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::emplaceHint(iterator hint, Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), false /*keepUnique*/, &hint);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::emplaceHintUnique(iterator hint,
+                                                                                                           Args&& ... args)
+   {
+      return insertValue(makeValue(std::forward <Args> (args)...), true /*keepUnique*/, &hint);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: TRY EMPLACE
+    * Like emplaceUnique(), but the caller hands over the key, so the
+    * value is only built if it is going in, and right in its slot
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::tryEmplace(const key_type& k,
+                                                                                                    Args&& ... args)
+   {
+      size_t index;
+      iterator itMatch = findSpot(k, true /*keepUnique*/, nullptr, index);
+      if (itMatch != end())
+         return std::pair<iterator, bool>(itMatch, false);
+      return std::pair<iterator, bool>(insertAt(index, std::forward <Args> (args)...), true);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: INSERT RANGE
+    * Append [first, last), then sort what was appended and merge it
+    * with what was here: O(n + m log m) rather than a shift of the
+    * whole array for each of the m new values. If copying one in
+    * throws, those already appended are taken back out.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class Iterator>
+   void flat_tree <T, A, KeyOf, C> ::insert(Iterator first, Iterator last, bool keepUnique)
+   {
+      size_t numSorted = numElements;
+      if constexpr (isForwardIterator <Iterator> ::value)
+         reserve(numElements + size_t(std::distance(first, last)));
+      try
+      {
+         for (; first != last; ++first)
+            insertAt(numElements, *first);
+      }
+      catch (...)
+      {
+         eraseAt(numSorted, numElements);
+         throw;
+      }
+      sortFrom(numSorted, keepUnique);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: MERGE
+    * Move the values of source into this tree. Since both are
+    * sorted, the ones that go are appended in order and merged in
+    * one pass. With keepUnique, one whose key is already here
+    * stays in source.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::merge(flat_tree& source, bool keepUnique)
+   {
+      if (&source == this || source.empty())
+         return;
+
+      size_t numSorted = numElements;
+      reserve(numElements + source.numElements);
+      size_t numKept = 0;
+      for (size_t i = 0; i < source.numElements; i++)
+      {
+         // only the values that were here are in order to search
+         T& t = source.pValues[i];
+         size_t iMatch = keepUnique ? lowerBoundIndex(keyOf(t), numSorted) : numSorted;
+         if (iMatch < numSorted && !compare(keyOf(t), keyOf(pValues[iMatch])))
+         {
+            if (numKept != i)
+               source.pValues[numKept] = std::move(t);
+            numKept++;
+         }
+         else
+            insertAt(numElements, std::move(t));
+      }
+      source.eraseAt(numKept, source.numElements);
+      sortFrom(numSorted, keepUnique);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: INSERT AT
+    * Build a value at index, moving the ones after it over. A full
+    * array is replaced by one twice the size, and the new value is
+    * built there before anything moves, so if building it throws,
+    * nothing has changed.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   template <class ... Args>
+   typename flat_tree <T, A, KeyOf, C> ::iterator flat_tree <T, A, KeyOf, C> ::insertAt(size_t index, Args&& ... args)
+   {
+      assert(index <= numElements);
+      if (numElements == numCapacity)
+      {
+         size_t numNew = std::max <size_t> (numCapacity * 2, 4);
+         T* pNew = Traits::allocate(alloc, numNew);
+         try
+         {
+            constructValue(pNew + index, std::forward <Args> (args)...);
+         }
+         catch (...)
+         {
+            Traits::deallocate(alloc, pNew, numNew);
+            throw;
+         }
+         relocate(pNew, pValues, index);
+         relocate(pNew + index + 1, pValues + index, numElements - index);
+         if (pValues)
+            Traits::deallocate(alloc, pValues, numCapacity);
+         pValues = pNew;
+         numCapacity = numNew;
+      }
+      else
+      {
+         size_t num = numElements - index;
+         T* pSlot = pValues + index;
+         if (num > 0)
+         {
+            ::new (static_cast <void*> (pSlot + num)) T(std::move(pSlot[num - 1]));
+            std::move_backward(pSlot, pSlot + num - 1, pSlot + num);
+            pSlot->~T();
+         }
+
+         try
+         {
+            constructValue(pSlot, std::forward <Args> (args)...);
+         }
+         catch (...)
+         {
+            if (num > 0)
+            {
+               ::new (static_cast <void*> (pSlot)) T(std::move(pSlot[1]));
+               std::move(pSlot + 2, pSlot + num + 1, pSlot + 1);
+               pSlot[num].~T();
+            }
+            throw;
+         }
+      }
+      numElements++;
+      return iterator(pValues + index);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: SORT FROM
+    * The first numSorted values are in order and the rest were
+    * just appended. Sort those, keeping equal keys in the order they
+    * came, merge the two runs, and with keepUnique drop all but the
+    * first of equal keys, which is the one that was here before.
+    * Input that is already in order past the end costs one pass.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::sortFrom(size_t numSorted, bool keepUnique)
+   {
+      auto isBefore = [this](const T& lhs, const T& rhs) { return compare(keyOf(lhs), keyOf(rhs)); };
+      T* pMiddle = pValues + numSorted;
+      T* pEnd = pValues + numElements;
+      if (pMiddle == pEnd)
+         return;
+
+      if (!std::is_sorted(pMiddle, pEnd, isBefore))
+         std::stable_sort(pMiddle, pEnd, isBefore);
+
+      // only the part that moved needs checking for repeats
+      T* pCheck = numSorted > 0 ? pMiddle - 1 : pMiddle;
+      if (numSorted > 0 && isBefore(*pMiddle, pMiddle[-1]))
+      {
+         std::inplace_merge(pValues, pMiddle, pEnd, isBefore);
+         pCheck = pValues;
+      }
+
+      if (keepUnique)
+      {
+         T* pUnique = std::unique(pCheck, pEnd, [&isBefore](const T& lhs, const T& rhs)
+         {
+            return !isBefore(lhs, rhs);
+         });
+         eraseAt(size_t(pUnique - pValues), numElements);
+      }
+   }
+
+   /*****************************************************
+    * FLAT TREE :: ERASE
+    * Remove one element, returning the one after it
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   typename flat_tree <T, A, KeyOf, C> ::iterator flat_tree <T, A, KeyOf, C> ::erase(iterator it)
+   {
+      if (it == end())
+         return end();
+
+      size_t index = indexOf(it);
+      eraseAt(index, index + 1);
+      return iterator(pValues + index);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: ERASE RANGE
+    * Remove [first, last) with a single move of what follows
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   typename flat_tree <T, A, KeyOf, C> ::iterator flat_tree <T, A, KeyOf, C> ::erase(iterator first, iterator last)
+   {
+      size_t iBegin = indexOf(first);
+      eraseAt(iBegin, indexOf(last));
+      return iterator(pValues + iBegin);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: ERASE AT
+    * Remove the values at [iBegin, iEnd), moving the ones
+    * after them down
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::eraseAt(size_t iBegin, size_t iEnd) noexcept
+   {
+      assert(iBegin <= iEnd && iEnd <= numElements);
+      if (iBegin == iEnd)
+         return;
+
+      T* pNewEnd = std::move(pValues + iEnd, pValues + numElements, pValues + iBegin);
+      for (T* p = pNewEnd; p != pValues + numElements; ++p)
+         p->~T();
+      numElements -= iEnd - iBegin;
+   }
+
+   /*****************************************************
+    * FLAT TREE :: CLEAR
+    * Destroy every value. The array stays for the next ones.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::clear() noexcept
+   {
+      eraseAt(0, numElements);
+   }
+
+   /*************************************************
+    * FLAT TREE :: EXTRACT
+    * Move a value out of the tree into a handle of its own
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   typename flat_tree <T, A, KeyOf, C> ::NodeHandle flat_tree <T, A, KeyOf, C> ::extract(iterator it)
+   {
+      if (it == end())
+         return NodeHandle();
+
+      A allocValue(alloc);
+      T* pValue = Traits::allocate(allocValue, 1);
+      ::new (static_cast <void*> (pValue)) T(std::move(pValues[indexOf(it)]));
+      erase(it);
+      return NodeHandle(pValue, allocValue);
+   }
+
+   /*************************************************
+    * FLAT TREE :: INSERT NODE HANDLE
+    * Move the value of a handle into the tree. If it was kept out
+    * because of keepUnique, the handle still owns it.
+    ************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   std::pair<typename flat_tree <T, A, KeyOf, C> ::iterator, bool> flat_tree <T, A, KeyOf, C> ::insert(NodeHandle&& nh,
+                                                                                                bool keepUnique)
+   {
+      if (nh.empty())
+         return std::pair<iterator, bool>(end(), false);
+
+      size_t index;
+      iterator itMatch = findSpot(keyOf(*nh.pValue), keepUnique, nullptr, index);
+      if (itMatch != end())
+         return std::pair<iterator, bool>(itMatch, false);
+
+      iterator it = insertAt(index, std::move(*nh.pValue));
+      nh.reset();
+      return std::pair<iterator, bool>(it, true);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: RESERVE and SHRINK TO FIT
+    * Make room for num values so the array does not move again
+    * until there are more, or give back what is not used
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::reserve(size_t num)
+   {
+      if (num > numCapacity)
+         reallocate(num);
+   }
+
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::shrink_to_fit()
+   {
+      if (numElements == 0)
+         deallocate();
+      else if (numElements < numCapacity)
+         reallocate(numElements);
+   }
+
+   /*****************************************************
+    * FLAT TREE :: REALLOCATE
+    * Move the values into an array with room for num of them
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::reallocate(size_t num)
+   {
+      assert(num >= numElements && num > 0);
+      T* pNew = Traits::allocate(alloc, num);
+      relocate(pNew, pValues, numElements);
+      if (pValues)
+         Traits::deallocate(alloc, pValues, numCapacity);
+      pValues = pNew;
+      numCapacity = num;
+   }
+
+   /*****************************************************
+    * FLAT TREE :: RELOCATE
+    * Move num values into raw memory, leaving their old slots raw
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::relocate(T* pDest, T* pSrc, size_t num) noexcept
+   {
+      for (size_t i = 0; i < num; i++)
+      {
+         ::new (static_cast <void*> (pDest + i)) T(std::move(pSrc[i]));
+         pSrc[i].~T();
+      }
+   }
+
+   /*****************************************************
+    * FLAT TREE :: COPY FROM
+    * Fill an empty tree with a copy of rhs. If a copy throws,
+    * the ones made so far are destroyed.
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::copyFrom(const flat_tree& rhs)
+   {
+      assert(numElements == 0);
+      if (rhs.numElements == 0)
+         return;
+
+      reserve(rhs.numElements);
+      try
+      {
+         for (; numElements < rhs.numElements; numElements++)
+            ::new (static_cast <void*> (pValues + numElements)) T(rhs.pValues[numElements]);
+      }
+      catch (...)
+      {
+         clear();
+         throw;
+      }
+   }
+
+   /*****************************************************
+    * FLAT TREE :: DEALLOCATE
+    * Destroy every value and give back the array
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   void flat_tree <T, A, KeyOf, C> ::deallocate() noexcept
+   {
+      clear();
+      if (pValues)
+         Traits::deallocate(alloc, pValues, numCapacity);
+      pValues = nullptr;
+      numCapacity = 0;
+   }
+
+#ifdef DEBUG
+   /*****************************************************
+    * FLAT TREE :: VERIFY
+    * Are the values in order, and is the array as big as it says?
+    ****************************************************/
+   template <typename T, typename A, typename KeyOf, typename C>
+   bool flat_tree <T, A, KeyOf, C> ::verify() const
+   {
+      if ((pValues == nullptr) != (numCapacity == 0) || numElements > numCapacity)
+         return false;
+      for (size_t i = 1; i < numElements; i++)
+         if (compare(keyOf(pValues[i]), keyOf(pValues[i - 1])))
+            return false;
+      return true;
+   }
+#endif // DEBUG
+
+} // namespace custom
@@ -0,0 +1,658 @@
+/***********************************************************************
+ * Header:
+ *    FROZEN MAP
+ * Summary:
+ *    A read-only snapshot of a map, for tables that are built once and
+ *    then searched over and over. The keys are laid out the way a
+ *    breadth-first walk would visit a perfectly balanced tree of them:
+ *    the root in slot 1, and the children of slot k in slots 2k and
+ *    2k+1. This is the Eytzinger layout. The top of the tree is packed
+ *    into the first few cache lines, and the descendants of a slot a few
+ *    levels down sit side by side, so they can be fetched before the
+ *    search gets to them.
+ *
+ *    This will contain the class definition of:
+ *        frozen_map           : A map that can no longer change
+ *        frozen_map::iterator : An iterator through a frozen_map
+ * Author
+ *    <your names here>
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>     // for uintptr_t
+#include <functional>  // for std::less
+#include <memory>      // for std::allocator and std::allocator_traits
+#include <stdexcept>   // for std::out_of_range
+#include <utility>     // for std::move and std::swap
+#include <iterator>    // for std::forward_iterator_tag, std::distance and std::make_move_iterator
+#include <deque>       // for std::deque, to gather a range read only once
+#include "pair.h"      // for pair
+#include "bst.h"       // for sorted_unique and isForwardIterator
+
+#ifdef _MSC_VER
+#include <intrin.h>    // for _mm_prefetch
+#endif // _MSC_VER
+
+class TestFrozenMap; // forward declaration for unit tests
+
+namespace custom
+{
+   template <class K, class V, class C, class A, bool Ranked, class Policy>
+   class map;
+
+   /*****************************************************************
+    * FROZEN MAP
+    * A map that can be searched and walked but no longer changed. It
+    * is built in O(n) from pairs in order, either from a map with
+    * map::freeze() or from any sorted range.
+    *
+    * A search goes down from slot 1 to 2k or 2k+1 without a branch,
+    * adding the result of the comparison to 2k. At each step it
+    * prefetches the cache line holding the descendants of k a few
+    * levels down: at least its grandchildren, and the great-grandchildren
+    * for 8 byte keys. The keys are kept apart from the pairs, so that a
+    * line holds as many of them as it can.
+    *****************************************************************/
+   template <class K, class V, class C = std::less <K>,
+             class A = std::allocator <custom::pair <K, V, C> > >
+   class frozen_map
+   {
+      friend class ::TestFrozenMap; // give unit tests access to the privates
+
+      template <class KK, class VV, class CC, class AA, bool RR, class PP>
+      friend class custom::map;
+   public:
+      using Pairs = custom::pair <K, V, C>;
+      using allocator_type = A;
+      using key_compare = C;
+
+      //
+      // Construct
+      //
+
+      explicit frozen_map(const A& a = A());
+      template <class Iterator>
+      frozen_map(sorted_unique_t, Iterator first, Iterator last, const A& a = A());
+      frozen_map(const frozen_map& rhs);
+      frozen_map(frozen_map&& rhs) noexcept;
+     ~frozen_map();
+
+      //
+      // Assign
+      //
+
+      frozen_map& operator = (const frozen_map& rhs);
+      frozen_map& operator = (frozen_map&& rhs) noexcept(isMoveAssignNoexcept);
+      void swap(frozen_map& rhs);
+
+      //
+      // Iterator: the pairs in order
+      //
+
+      class iterator;
+      iterator begin() const noexcept { return iterator(this, firstSlot(numElements)); }
+      iterator end()   const noexcept { return iterator(this, 0); }
+
+      //
+      // Access
+      //
+
+      const V& at(const K& k) const;
+      iterator find(const K& k) const { return iterator(this, findSlot(k)); }
+      iterator lower_bound(const K& k) const { return iterator(this, lowerBoundSlot(k)); }
+      iterator upper_bound(const K& k) const { return iterator(this, upperBoundSlot(k)); }
+      size_t count(const K& k) const { return findSlot(k) != 0 ? 1 : 0; }
+      bool contains(const K& k) const { return findSlot(k) != 0; }
+
+      // with a transparent comparator, anything comparable to a key will do
+      template <class KK, class CC = C, class = typename CC::is_transparent>
+      iterator find(const KK& k) const { return iterator(this, findSlot(k)); }
+      template <class KK, class CC = C, class = typename CC::is_transparent>
+      iterator lower_bound(const KK& k) const { return iterator(this, lowerBoundSlot(k)); }
+      template <class KK, class CC = C, class = typename CC::is_transparent>
+      iterator upper_bound(const KK& k) const { return iterator(this, upperBoundSlot(k)); }
+      template <class KK, class CC = C, class = typename CC::is_transparent>
+      bool contains(const KK& k) const { return findSlot(k) != 0; }
+
+      //
+      // Status
+      //
+
+      bool   empty() const noexcept { return numElements == 0; }
+      size_t size()  const noexcept { return numElements; }
+
+      A get_allocator() const noexcept { return alloc; }
+      C key_comp() const { return compare; }
+
+   private:
+
+      using Traits = std::allocator_traits <A>;
+      using KeyAlloc = typename Traits::template rebind_alloc <K>;
+      using KeyTraits = std::allocator_traits <KeyAlloc>;
+
+      // only a move between allocators that differ has to copy the pairs
+      static constexpr bool isMoveAssignNoexcept = Traits::propagate_on_container_move_assignment::value ||
+                                                   Traits::is_always_equal::value;
+
+      // how many keys a prefetch reaches ahead: those in one cache
+      // line, so a power of two no more than 64 bytes, but at least the
+      // four grandchildren
+      static constexpr size_t numAhead()
+      {
+         size_t num = 4;
+         while (num * 2 * sizeof(K) <= 64)
+            num *= 2;
+         return num;
+      }
+      static constexpr size_t numPerLine = numAhead();
+
+      // walking the layout in order
+      static size_t firstSlot(size_t num) noexcept;
+      static size_t nextSlot(size_t k, size_t num) noexcept;
+      static size_t lastLeftTurn(size_t k) noexcept;
+      static void prefetch(const void* p) noexcept;
+
+      // searching it
+      template <class KK>
+      size_t lowerBoundSlot(const KK& k) const;
+      template <class KK>
+      size_t upperBoundSlot(const KK& k) const;
+      template <class KK>
+      size_t findSlot(const KK& k) const;
+
+      // building and tearing down
+      template <class Iterator>
+      frozen_map(Iterator first, size_t num, const C& c, const A& a);
+      template <class Iterator>
+      void build(Iterator first, size_t num);
+      void allocate(size_t num);
+      void destroy(size_t k) noexcept;
+      void deallocate() noexcept;
+
+#ifdef DEBUG
+      //
+      // Verify
+      //
+      bool verify() const;
+#endif // DEBUG
+
+      K* pKeys;             // the keys from slot 1 in Eytzinger order. Slot 0 starts a cache line
+      Pairs* pPairs;        // the pairs, each in the same slot as its key
+      size_t numElements;   // number of pairs
+      size_t numShift;      // how far pKeys is past the start of its allocation
+      A alloc;              // where the arrays come from
+      C compare;            // orders the keys
+   };
+
+   /**********************************************************
+    * FROZEN MAP ITERATOR
+    * Forward iterator through a frozen_map in order: from a slot
+    * to the leftmost slot of its right subtree, or back up to the
+    * ancestor it is left of
+    *********************************************************/
+   template <class K, class V, class C, class A>
+   class frozen_map <K, V, C, A> ::iterator
+   {
+      friend class ::TestFrozenMap; // give unit tests access to the privates
+      friend class frozen_map <K, V, C, A>;
+   public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type        = Pairs;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const Pairs*;
+      using reference         = const Pairs&;
+
+      iterator() : pMap(nullptr), k(0) {}
+
+      bool operator == (const iterator& rhs) const { return k == rhs.k; }
+      bool operator != (const iterator& rhs) const { return k != rhs.k; }
+
+      const Pairs& operator * () const { return pMap->pPairs[k]; }
+      const Pairs* operator -> () const { return pMap->pPairs + k; }
+
+      iterator& operator ++ ()
+      {
+         k = nextSlot(k, pMap->numElements);
+         return *this;
+      }
+      iterator operator ++ (int)
+      {
+         iterator itReturn = *this;
+         ++(*this);
+         return itReturn;
+      }
+
+   private:
+      iterator(const frozen_map* pMap, size_t k) : pMap(pMap), k(k) {}
+
+      const frozen_map* pMap;   // the map we walk through
+      size_t k;                 // the slot we are on, 0 at the end
+   };
+
+
+   /*********************************************
+    *********************************************
+    *********************************************
+    **************** FROZEN MAP *****************
+    *********************************************
+    *********************************************
+    *********************************************/
+
+
+   /*********************************************
+    * FROZEN MAP :: DEFAULT CONSTRUCTOR
+    * Nothing to search, and nothing allocated
+    ********************************************/
+   template <class K, class V, class C, class A>
+   frozen_map <K, V, C, A> ::frozen_map(const A& a)
+      : pKeys(nullptr), pPairs(nullptr), numElements(0), numShift(0), alloc(a), compare()
+   {
+   }
+
+   /*********************************************
+    * FROZEN MAP :: SORTED RANGE CONSTRUCTOR
+    * [first, last) must be in order with no key twice. The size has
+    * to be known before the layout, so a range that can only be read
+    * once is gathered up first, in a deque so none are copied twice.
+    ********************************************/
+   template <class K, class V, class C, class A>
+   template <class Iterator>
+   frozen_map <K, V, C, A> ::frozen_map(sorted_unique_t, Iterator first, Iterator last, const A& a)
+      : pKeys(nullptr), pPairs(nullptr), numElements(0), numShift(0), alloc(a), compare()
+   {
+      if constexpr (isForwardIterator <Iterator> ::value)
+         build(first, size_t(std::distance(first, last)));
+      else
+      {
+         std::deque <Pairs, A> pairs(first, last, alloc);
+         build(std::make_move_iterator(pairs.begin()), pairs.size());
+      }
+   }
+
+   /*********************************************
+    * FROZEN MAP :: BUILD CONSTRUCTOR
+    * num pairs in order from first, for map::freeze()
+    ********************************************/
+   template <class K, class V, class C, class A>
+   template <class Iterator>
+   frozen_map <K, V, C, A> ::frozen_map(Iterator first, size_t num, const C& c, const A& a)
+      : pKeys(nullptr), pPairs(nullptr), numElements(0), numShift(0), alloc(a), compare(c)
+   {
+      build(first, num);
+   }
+
+   /*********************************************
+    * FROZEN MAP :: COPY CONSTRUCTOR
+    * The same layout, slot for slot
+    ********************************************/
+   template <class K, class V, class C, class A>
+   frozen_map <K, V, C, A> ::frozen_map(const frozen_map& rhs)
+      : pKeys(nullptr), pPairs(nullptr), numElements(0), numShift(0),
+        alloc(Traits::select_on_container_copy_construction(rhs.alloc)), compare(rhs.compare)
+   {
+      build(rhs.begin(), rhs.numElements);
+   }
+
+   /*********************************************
+    * FROZEN MAP :: MOVE CONSTRUCTOR
+    * Take the arrays of another frozen map
+    ********************************************/
+   template <class K, class V, class C, class A>
+   frozen_map <K, V, C, A> ::frozen_map(frozen_map&& rhs) noexcept
+      : pKeys(rhs.pKeys), pPairs(rhs.pPairs), numElements(rhs.numElements), numShift(rhs.numShift),
+        alloc(std::move(rhs.alloc)), compare(std::move(rhs.compare))
+   {
+      rhs.pKeys = nullptr;
+      rhs.pPairs = nullptr;
+      rhs.numElements = rhs.numShift = 0;
+   }
+
+   /*********************************************
+    * FROZEN MAP :: DESTRUCTOR
+    ********************************************/
+   template <class K, class V, class C, class A>
+   frozen_map <K, V, C, A> :: ~frozen_map()
+   {
+      deallocate();
+   }
+
+   /*********************************************
+    * FROZEN MAP :: ASSIGNMENT OPERATOR
+    * Build a copy on the side, then trade places with it
+    ********************************************/
+   template <class K, class V, class C, class A>
+   frozen_map <K, V, C, A>& frozen_map <K, V, C, A> :: operator = (const frozen_map& rhs)
+   {
+      if (this == &rhs)
+         return *this;
+
+      A a = Traits::propagate_on_container_copy_assignment::value ? rhs.alloc : alloc;
+      frozen_map copy(rhs.begin(), rhs.numElements, rhs.compare, a);
+      deallocate();
+      if constexpr (Traits::propagate_on_container_copy_assignment::value)
+         alloc = copy.alloc;
+      compare = copy.compare;
+      std::swap(pKeys, copy.pKeys);
+      std::swap(pPairs, copy.pPairs);
+      std::swap(numElements, copy.numElements);
+      std::swap(numShift, copy.numShift);
+      return *this;
+   }
+
+   /*********************************************
+    * FROZEN MAP :: ASSIGN-MOVE OPERATOR
+    * Steal the arrays when the allocators allow, copy otherwise
+    ********************************************/
+   template <class K, class V, class C, class A>
+   frozen_map <K, V, C, A>& frozen_map <K, V, C, A> :: operator = (frozen_map&& rhs)
+      noexcept(isMoveAssignNoexcept)
+   {
+      if (this == &rhs)
+         return *this;
+
+      // allocators that stay put and differ: copy the pairs into ours
+      if constexpr (!isMoveAssignNoexcept)
+      {
+         if (alloc != rhs.alloc)
+            return *this = static_cast <const frozen_map&> (rhs);
+      }
+
+      deallocate();
+      if constexpr (Traits::propagate_on_container_move_assignment::value)
+         alloc = std::move(rhs.alloc);
+      compare = rhs.compare;
+      std::swap(pKeys, rhs.pKeys);
+      std::swap(pPairs, rhs.pPairs);
+      std::swap(numElements, rhs.numElements);
+      std::swap(numShift, rhs.numShift);
+      return *this;
+   }
+
+   /*********************************************
+    * FROZEN MAP :: SWAP
+    * Swap two frozen maps
+    ********************************************/
+   template <class K, class V, class C, class A>
+   void frozen_map <K, V, C, A> ::swap(frozen_map& rhs)
+   {
+      std::swap(rhs.pKeys, pKeys);
+      std::swap(rhs.pPairs, pPairs);
+      std::swap(rhs.numElements, numElements);
+      std::swap(rhs.numShift, numShift);
+      std::swap(rhs.compare, compare);
+
+      // without propagation, swapping is only defined for equal allocators
+      if constexpr (Traits::propagate_on_container_swap::value)
+         std::swap(rhs.alloc, alloc);
+      else
+         assert(alloc == rhs.alloc);
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: AT
+    * The value of k, which must be there
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   const V& frozen_map <K, V, C, A> ::at(const K& k) const
+   {
+      size_t i = findSlot(k);
+      if (i == 0)
+         throw std::out_of_range("invalid frozen_map<K, T> key");
+      return pPairs[i].second;
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: FIRST SLOT
+    * The leftmost slot of a layout of num keys: the smallest key,
+    * or 0 when there are none
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   size_t frozen_map <K, V, C, A> ::firstSlot(size_t num) noexcept
+   {
+      if (num == 0)
+         return 0;
+      size_t k = 1;
+      while (2 * k <= num)
+         k *= 2;
+      return k;
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: NEXT SLOT
+    * The slot after k in order: the leftmost of its right subtree,
+    * or, without one, the ancestor whose left subtree k ends. That is
+    * 0 after the largest key, which is only ever right of its parents.
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   size_t frozen_map <K, V, C, A> ::nextSlot(size_t k, size_t num) noexcept
+   {
+      if (2 * k + 1 <= num)
+      {
+         k = 2 * k + 1;
+         while (2 * k <= num)
+            k *= 2;
+         return k;
+      }
+      return lastLeftTurn(k);
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: LAST LEFT TURN
+    * Each right turn down the tree added a 1 to the bottom of k. Take
+    * off the trailing 1s, then the 0 of the last left turn, and we are
+    * at the slot that turn was taken from
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   size_t frozen_map <K, V, C, A> ::lastLeftTurn(size_t k) noexcept
+   {
+#ifdef _MSC_VER
+      while (k & 1)
+         k >>= 1;
+      return k >> 1;
+#else
+      return k >> (__builtin_ctzll(~(unsigned long long)k) + 1);
+#endif // _MSC_VER
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: PREFETCH
+    * Ask for the cache line holding p without waiting for it
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   void frozen_map <K, V, C, A> ::prefetch(const void* p) noexcept
+   {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+      _mm_prefetch((const char*)p, _MM_HINT_T0);
+#elif !defined(_MSC_VER)
+      __builtin_prefetch(p);
+#endif
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: LOWER BOUND SLOT
+    * Go down from the root, left when k is not larger than the key
+    * and right when it is, with no branch: the comparison is added
+    * to 2k. Once below a leaf, the slot we want is where we last went
+    * left. The line ahead is asked for by address, since it may be
+    * past the end of the array, where a prefetch does no harm.
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   template <class KK>
+   size_t frozen_map <K, V, C, A> ::lowerBoundSlot(const KK& k) const
+   {
+      size_t i = 1;
+      while (i <= numElements)
+      {
+         prefetch(reinterpret_cast <const void*> (reinterpret_cast <uintptr_t> (pKeys) +
+                                                  i * numPerLine * sizeof(K)));
+         i = 2 * i + size_t(compare(pKeys[i], k));
+      }
+      return lastLeftTurn(i);
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: UPPER BOUND SLOT
+    * The same, going right when k is not smaller than the key
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   template <class KK>
+   size_t frozen_map <K, V, C, A> ::upperBoundSlot(const KK& k) const
+   {
+      size_t i = 1;
+      while (i <= numElements)
+      {
+         prefetch(reinterpret_cast <const void*> (reinterpret_cast <uintptr_t> (pKeys) +
+                                                  i * numPerLine * sizeof(K)));
+         i = 2 * i + size_t(!compare(k, pKeys[i]));
+      }
+      return lastLeftTurn(i);
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: FIND SLOT
+    * The slot holding k, or 0 when it is not here
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   template <class KK>
+   size_t frozen_map <K, V, C, A> ::findSlot(const KK& k) const
+   {
+      size_t i = lowerBoundSlot(k);
+      return (i != 0 && !compare(k, pKeys[i])) ? i : 0;
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: BUILD
+    * Walk the slots in order and fill each with the next pair: O(n),
+    * since the walk goes down and back up each edge once. If copying a
+    * pair throws, the ones already in are destroyed the same way.
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   template <class Iterator>
+   void frozen_map <K, V, C, A> ::build(Iterator first, size_t num)
+   {
+      if (num == 0)
+         return;
+      allocate(num);
+
+      size_t numBuilt = 0;
+      try
+      {
+         for (size_t k = firstSlot(num); k != 0; k = nextSlot(k, num), ++first, numBuilt++)
+         {
+            Traits::construct(alloc, pPairs + k, *first);
+            try
+            {
+               KeyAlloc allocKeys(alloc);
+               KeyTraits::construct(allocKeys, pKeys + k, pPairs[k].first);
+            }
+            catch (...)
+            {
+               Traits::destroy(alloc, pPairs + k);
+               throw;
+            }
+         }
+      }
+      catch (...)
+      {
+         for (size_t k = firstSlot(num); numBuilt > 0; k = nextSlot(k, num), numBuilt--)
+            destroy(k);
+         KeyAlloc allocKeys(alloc);
+         KeyTraits::deallocate(allocKeys, pKeys - numShift, num + 1 + numPerLine);
+         Traits::deallocate(alloc, pPairs, num + 1);
+         pKeys = nullptr;
+         pPairs = nullptr;
+         numElements = numShift = 0;
+         throw;
+      }
+      numElements = num;
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: ALLOCATE
+    * Room for num keys and pairs from slot 1. The keys get a line
+    * more than they need, so that slot 0 can start a cache line and
+    * the descendants a prefetch asks for share one.
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   void frozen_map <K, V, C, A> ::allocate(size_t num)
+   {
+      KeyAlloc allocKeys(alloc);
+      K* pKeysNew = KeyTraits::allocate(allocKeys, num + 1 + numPerLine);
+      try
+      {
+         pPairs = Traits::allocate(alloc, num + 1);
+      }
+      catch (...)
+      {
+         KeyTraits::deallocate(allocKeys, pKeysNew, num + 1 + numPerLine);
+         throw;
+      }
+
+      numShift = 0;
+      while (numShift < numPerLine && reinterpret_cast <uintptr_t> (pKeysNew + numShift) % 64 != 0)
+         numShift++;
+      if (numShift == numPerLine)
+         numShift = 0;
+      pKeys = pKeysNew + numShift;
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: DESTROY
+    * Destroy the key and the pair in slot k
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   void frozen_map <K, V, C, A> ::destroy(size_t k) noexcept
+   {
+      KeyAlloc allocKeys(alloc);
+      KeyTraits::destroy(allocKeys, pKeys + k);
+      Traits::destroy(alloc, pPairs + k);
+   }
+
+   /*****************************************************
+    * FROZEN MAP :: DEALLOCATE
+    * Destroy every key and pair and give back the arrays
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   void frozen_map <K, V, C, A> ::deallocate() noexcept
+   {
+      if (pKeys == nullptr)
+         return;
+      for (size_t k = 1; k <= numElements; k++)
+         destroy(k);
+      KeyAlloc allocKeys(alloc);
+      KeyTraits::deallocate(allocKeys, pKeys - numShift, numElements + 1 + numPerLine);
+      Traits::deallocate(alloc, pPairs, numElements + 1);
+      pKeys = nullptr;
+      pPairs = nullptr;
+      numElements = numShift = 0;
+   }
+
+#ifdef DEBUG
+   /*****************************************************
+    * FROZEN MAP :: VERIFY
+    * Each key is after every key in its left subtree and before every
+    * key in its right one, which is the same as the walk in order
+    * being strictly increasing, and each key matches its pair
+    ****************************************************/
+   template <class K, class V, class C, class A>
+   bool frozen_map <K, V, C, A> ::verify() const
+   {
+      if (numElements == 0)
+         return pKeys == nullptr && pPairs == nullptr;
+
+      size_t num = 0;
+      size_t kPrev = 0;
+      for (size_t k = firstSlot(numElements); k != 0; kPrev = k, k = nextSlot(k, numElements), num++)
+      {
+         if (compare(pKeys[k], pPairs[k].first) || compare(pPairs[k].first, pKeys[k]))
+            return false;
+         if (kPrev != 0 && !compare(pKeys[kPrev], pKeys[k]))
+            return false;
+      }
+      return num == numElements;
+   }
+#endif // DEBUG
+
+} // namespace custom
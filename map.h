@@ -13,6 +13,8 @@
  *    This will contain the class definition of:
  *        map                 : A class that represents a map
  *        map::iterator       : An iterator through a map
+ *        flat_map            : A map kept in a sorted array
+ *        map::freeze         : A read-only copy of a map, for searching
  * Author
  *    Andre Regino & Marco Varela
  ************************************************************************/
@@ -21,6 +23,15 @@
 
 #include "pair.h"     // for pair
 #include "bst.h"      // no nested class necessary for this assignment
+#include "btree.h"    // for btree, which a map can keep its pairs in instead
+#include "flatTree.h" // for flat_tree, a sorted array for maps that are mostly read
+#include "frozenMap.h" // for frozen_map, a read-only copy laid out for searching
+#include <memory>     // for std::allocator
+#include <memory_resource> // for std::pmr::polymorphic_allocator
+#include <stdexcept>  // for std::out_of_range
+#include <type_traits> // for std::enable_if_t
+#include <iterator>   // for std::bidirectional_iterator_tag
+#include <cstddef>    // for std::ptrdiff_t
 
 #ifndef debug
 #ifdef DEBUG
@@ -31,23 +42,97 @@
 #endif // !debug
 
 class TestMap;
+class TestBTree;
+class TestFlatTree;
 
 namespace custom
 {
 
+/*****************************************************************
+ * SELECT FIRST
+ * The map's key extractor: the nodes hold a pair but are searched
+ * by the key alone, so a lookup never has to build a V
+ *****************************************************************/
+struct SelectFirst
+{
+   template <class P>
+   const auto& operator () (const P& p) const noexcept { return p.first; }
+};
+
+/*****************************************************************
+ * TREE POLICIES
+ * Which tree a map keeps its pairs in. The red-black tree has one
+ * pair per node and does everything, order statistics and set
+ * algebra included. The B-tree packs up to Fanout - 1 pairs into
+ * each node, zero meaning about 256 bytes' worth, so a lookup
+ * touches a few contiguous blocks instead of one node per level.
+ * A node of integer keys in their natural order is searched without
+ * branches. A node of at least simd::numVectorMin (64) keys, which
+ * takes a Fanout of 65 or more, compares several keys at a time with
+ * SSE4.2 or AVX2 when the CPU has them. Smaller nodes, the default
+ * included, are faster searched one key at a time.
+ * Its inserts and erases invalidate iterators, as a vector's do.
+ * The flat tree is one sorted array: the fastest to search and to
+ * walk, and to fill all at once, but an insert or erase in the
+ * middle moves everything after it. Its iterators are invalidated
+ * the same way.
+ *****************************************************************/
+struct red_black_policy
+{
+   template <class T, class A, class KeyOf, class C, bool Ranked>
+   using tree = BST <T, A, KeyOf, C, Ranked>;
+};
+
+template <size_t Fanout = 0>
+struct btree_policy
+{
+   template <class T, class A, class KeyOf, class C, bool Ranked>
+   using tree = btree <T, A, KeyOf, C, (Fanout != 0 ? Fanout : btreeFanout <T>)>;
+};
+
+struct flat_policy
+{
+   template <class T, class A, class KeyOf, class C, bool Ranked>
+   using tree = flat_tree <T, A, KeyOf, C>;
+};
+
 /*****************************************************************
  * MAP
- * Create a Map, similar to a Binary Search Tree
+ * Create a Map, similar to a Binary Search Tree. The keys are ordered
+ * by C. When C is transparent (it has an is_transparent member, like
+ * std::less<>), the lookups take anything C can compare with a K.
+ * A Ranked map counts its subtrees, so nth, rank and distance are O(log n).
+ * Policy picks the tree underneath; see the tree policies above.
  *****************************************************************/
-template <class K, class V>
+template <class K, class V, class C = std::less <K>,
+          class A = std::allocator <custom::pair <K, V, C> >, bool Ranked = false,
+          class Policy = red_black_policy>
 class map
 {
    friend class ::TestMap;
-
-   template <class KK, class VV>
-   friend void swap(map<KK, VV>& lhs, map<KK, VV>& rhs); 
+   friend class ::TestBTree;
+   friend class ::TestFlatTree;
+
+   static_assert(!Ranked || std::is_same <Policy, red_black_policy> ::value,
+                 "only the red-black tree keeps subtree sizes");
+
+   template <class KK, class VV, class CC, class AA, bool RR, class PP>
+   friend void swap(map<KK, VV, CC, AA, RR, PP>& lhs, map<KK, VV, CC, AA, RR, PP>& rhs); 
+   template <class KK, class VV, class CC, class AA, bool RR, class PP, class Combine>
+   friend map<KK, VV, CC, AA, RR, PP> map_union(map<KK, VV, CC, AA, RR, PP> lhs, map<KK, VV, CC, AA, RR, PP> rhs,
+                                            Combine combine, unsigned numThreads);
+   template <class KK, class VV, class CC, class AA, bool RR, class PP>
+   friend map<KK, VV, CC, AA, RR, PP> map_union(map<KK, VV, CC, AA, RR, PP> lhs, map<KK, VV, CC, AA, RR, PP> rhs);
+   template <class KK, class VV, class CC, class AA, bool RR, class PP>
+   friend map<KK, VV, CC, AA, RR, PP> map_intersection(map<KK, VV, CC, AA, RR, PP> lhs, map<KK, VV, CC, AA, RR, PP> rhs,
+                                                   unsigned numThreads);
+   template <class KK, class VV, class CC, class AA, bool RR, class PP>
+   friend map<KK, VV, CC, AA, RR, PP> map_difference(map<KK, VV, CC, AA, RR, PP> lhs, map<KK, VV, CC, AA, RR, PP> rhs,
+                                                 unsigned numThreads);
 public:
-   using Pairs = custom::pair<K, V>;
+   using Pairs = custom::pair<K, V, C>;
+   using allocator_type = A;
+   using key_compare = C;
 
    // 
    // Construct
@@ -55,18 +140,34 @@ public:
    map() 
    {
    }
-   map(const map &  rhs) 
+   explicit map(const A& a) : bst(a)
+   {
+   }
+   explicit map(const C& c, const A& a = A()) : bst(c, a)
+   {
+   }
+   map(const map &  rhs) : bst(rhs.bst)
    { 
    }
-   map(map && rhs) 
+   map(const map& rhs, const A& a) : bst(rhs.bst, a)
+   {
+   }
+   map(map && rhs) noexcept : bst(std::move(rhs.bst))
    { 
    }
    template <class Iterator>
-   map(Iterator first, Iterator last) 
+   map(Iterator first, Iterator last, const A& a = A()) : bst(a)
+   {
+      bst.assign(first, last, true /*keepUnique*/);
+   }
+   template <class Iterator>
+   map(sorted_unique_t, Iterator first, Iterator last, const A& a = A()) : bst(a)
    {
+      bst.assign(sorted_unique, first, last);
    }
-   map(const std::initializer_list <Pairs>& il) 
+   map(const std::initializer_list <Pairs>& il, const A& a = A()) : bst(a)
    {
+      bst.assign(il.begin(), il.end(), true /*keepUnique*/);
    }
   ~map()         
    {
@@ -77,14 +178,23 @@ public:
    //
    map & operator = (const map & rhs) 
    {
+      bst = rhs.bst;
       return *this;
    }
-   map & operator = (map && rhs)
+   map & operator = (map && rhs) noexcept(std::is_nothrow_move_assignable <Tree> ::value)
    {
+      bst = std::move(rhs.bst);
       return *this;
    }
    map & operator = (const std::initializer_list <Pairs> & il)
    {
+      bst.assign(il.begin(), il.end(), true /*keepUnique*/);
+      return *this;
+   }
+   // copy a large map on several threads. Zero means one per core
+   map & assign_parallel(const map & rhs, unsigned numThreads = 0)
+   {
+      bst.assignParallel(rhs.bst, numThreads);
       return *this;
    }
    
@@ -94,11 +204,11 @@ public:
    class iterator;
    iterator begin() 
    { 
-      return iterator();
+      return iterator(bst.begin());
    }
    iterator end() 
    { 
-      return iterator();    
+      return iterator(bst.end());
    }
 
    // 
@@ -110,7 +220,82 @@ public:
          V & at (const K& k);
    iterator find(const K & k)
    {
-      return iterator();
+      return iterator(bst.find(k));
+   }
+   template <class KK, class CC = C, class = typename CC::is_transparent>
+   iterator find(const KK & k)
+   {
+      return iterator(bst.find(k));
+   }
+   size_t count(const K & k) const
+   {
+      return bst.contains(k) ? 1 : 0;
+   }
+   template <class KK, class CC = C, class = typename CC::is_transparent>
+   size_t count(const KK & k) const
+   {
+      return bst.contains(k) ? 1 : 0;
+   }
+   bool contains(const K & k) const
+   {
+      return bst.contains(k);
+   }
+   template <class KK, class CC = C, class = typename CC::is_transparent>
+   bool contains(const KK & k) const
+   {
+      return bst.contains(k);
+   }
+
+   // each of these is a single descent from the root
+   iterator lower_bound(const K & k)
+   {
+      return iterator(bst.lowerBound(k));
+   }
+   template <class KK, class CC = C, class = typename CC::is_transparent>
+   iterator lower_bound(const KK & k)
+   {
+      return iterator(bst.lowerBound(k));
+   }
+   iterator upper_bound(const K & k)
+   {
+      return iterator(bst.upperBound(k));
+   }
+   template <class KK, class CC = C, class = typename CC::is_transparent>
+   iterator upper_bound(const KK & k)
+   {
+      return iterator(bst.upperBound(k));
+   }
+   custom::pair<iterator, iterator> equal_range(const K & k)
+   {
+      auto pairReturn = bst.equalRange(k);
+      return custom::pair<iterator, iterator>(iterator(pairReturn.first), iterator(pairReturn.second));
+   }
+   template <class KK, class CC = C, class = typename CC::is_transparent>
+   custom::pair<iterator, iterator> equal_range(const KK & k)
+   {
+      auto pairReturn = bst.equalRange(k);
+      return custom::pair<iterator, iterator>(iterator(pairReturn.first), iterator(pairReturn.second));
+   }
+
+   // every pair with a key in [lo, hi): for (auto & p : m.range(lo, hi))
+   Range <iterator> range(const K & lo, const K & hi)
+   {
+      auto rangeTree = bst.range(lo, hi);
+      return Range <iterator> (iterator(rangeTree.begin()), iterator(rangeTree.end()));
+   }
+
+   // order statistics: O(log n) when Ranked, a walk otherwise
+   iterator nth(size_t k)
+   {
+      return iterator(bst.nth(k));
+   }
+   size_t rank(const K & k) const
+   {
+      return bst.rank(k);
+   }
+   size_t count_range(const K & lo, const K & hi) const
+   {
+      return bst.countRange(lo, hi);
    }
 
    //
@@ -118,19 +303,78 @@ public:
    //
    custom::pair<typename map::iterator, bool> insert(Pairs && rhs)
    {
-      return make_pair(iterator(), true);
+      auto pairReturn = bst.insert(std::move(rhs), true /*keepUnique*/);
+      return custom::pair<iterator, bool>(iterator(pairReturn.first), pairReturn.second);
    }
    custom::pair<typename map::iterator, bool> insert(const Pairs & rhs)
    {
-      return make_pair(iterator(), true);
+      auto pairReturn = bst.insert(rhs, true /*keepUnique*/);
+      return custom::pair<iterator, bool>(iterator(pairReturn.first), pairReturn.second);
    }
 
+   // a flat map sorts the whole range in at once, the trees take one at a time
    template <class Iterator>
    void insert(Iterator first, Iterator last)
    {
+      bst.insert(first, last, true /*keepUnique*/);
    }
    void insert(const std::initializer_list <Pairs>& il)
    {
+      insert(il.begin(), il.end());
+   }
+
+   template <class ... Args>
+   custom::pair<typename map::iterator, bool> emplace(Args&& ... args)
+   {
+      // a key and a value: build each of them right in the pair
+      if constexpr (sizeof...(Args) == 2)
+      {
+         auto pairReturn = bst.emplaceUnique(std::in_place, std::forward <Args> (args)...);
+         return custom::pair<iterator, bool>(iterator(pairReturn.first), pairReturn.second);
+      }
+      else
+      {
+         auto pairReturn = bst.emplaceUnique(std::forward <Args> (args)...);
+         return custom::pair<iterator, bool>(iterator(pairReturn.first), pairReturn.second);
+      }
+   }
+   // the pair probably goes right before hint: in-order inserts use end()
+   iterator insert(iterator hint, const Pairs & rhs)
+   {
+      return iterator(bst.insert(hint.it, rhs, true /*keepUnique*/).first);
+   }
+   iterator insert(iterator hint, Pairs && rhs)
+   {
+      return iterator(bst.insert(hint.it, std::move(rhs), true /*keepUnique*/).first);
+   }
+   template <class ... Args>
+   iterator emplace_hint(iterator hint, Args&& ... args)
+   {
+      if constexpr (sizeof...(Args) == 2)
+         return iterator(bst.emplaceHintUnique(hint.it, std::in_place, std::forward <Args> (args)...).first);
+      else
+         return iterator(bst.emplaceHintUnique(hint.it, std::forward <Args> (args)...).first);
+   }
+
+   template <class ... Args>
+   custom::pair<typename map::iterator, bool> try_emplace(const K& k, Args&& ... args)
+   {
+      return tryEmplace(k, std::forward <Args> (args)...);
+   }
+   template <class ... Args>
+   custom::pair<typename map::iterator, bool> try_emplace(K&& k, Args&& ... args)
+   {
+      return tryEmplace(std::move(k), std::forward <Args> (args)...);
+   }
+   template <class M>
+   custom::pair<typename map::iterator, bool> insert_or_assign(const K& k, M&& m)
+   {
+      return insertOrAssign(k, std::forward <M> (m));
+   }
+   template <class M>
+   custom::pair<typename map::iterator, bool> insert_or_assign(K&& k, M&& m)
+   {
+      return insertOrAssign(std::move(k), std::forward <M> (m));
    }
 
    //
@@ -138,28 +382,122 @@ public:
    //
    void clear() noexcept
    {
+      bst.clear();
+   }
+   // let clear() and the destructor hand a large tree to a thread that
+   // frees it in the background. flush_reclaim() waits for it to finish.
+   void defer_reclaim(bool isDeferred = true) noexcept
+   {
+      bst.deferReclaim(isDeferred);
+   }
+   static void flush_reclaim()
+   {
+      Tree::flushReclaim();
+   }
+   size_t erase(const K& k)
+   {
+      return eraseKey(k);
+   }
+   template <class KK, class CC = C, class = typename CC::is_transparent,
+             class = std::enable_if_t <!std::is_convertible <const KK&, iterator> ::value> >
+   size_t erase(const KK& k)
+   {
+      return eraseKey(k);
    }
-   size_t erase(const K& k);
    iterator erase(iterator it);
    iterator erase(iterator first, iterator last);
 
+   //
+   // Node handles: move pairs between maps without copying them
+   //
+   class node_type;
+   struct insert_return_type;
+   node_type extract(iterator pos);
+   node_type extract(const K& k);
+   insert_return_type insert(node_type&& nh);
+   void merge(map& source)
+   {
+      bst.merge(source.bst, true /*keepUnique*/);
+   }
+   void merge(map&& source)
+   {
+      merge(source);
+   }
+
+   // cut into the keys before k and the rest, or put two maps back
+   // together when every key of left comes before every key of right
+   custom::pair<map, map> split(const K& k)
+   {
+      auto pairTrees = bst.split(k);
+      return custom::pair<map, map>(map(std::move(pairTrees.first)), map(std::move(pairTrees.second)));
+   }
+   static map join(map&& left, map&& right)
+   {
+      return map(Tree::join(std::move(left.bst), std::move(right.bst)));
+   }
+
+   // a read-only copy in Eytzinger order, built in O(n), for a table
+   // that is done changing and will now be searched many times
+   frozen_map <K, V, C, A> freeze() const
+   {
+      return frozen_map <K, V, C, A> (bst.begin(), bst.size(), bst.key_comp(), get_allocator());
+   }
+
    //
    // Status
    //
    bool empty() const noexcept 
    { 
-      return true; 
+      return bst.empty();
    }
    size_t size() const noexcept 
    { 
-      return 99;
+      return bst.size();
+   }
+
+   //
+   // Capacity
+   //
+   void reserve(size_t num)
+   {
+      bst.reserve(num);
+   }
+   void shrink_to_fit()
+   {
+      bst.shrink_to_fit();
+   }
+   A get_allocator() const noexcept
+   {
+      return bst.get_allocator();
+   }
+   C key_comp() const
+   {
+      return bst.key_comp();
    }
 
 
 private:
 
    // the students DO NOT need to use a nested class
-   BST < pair <K, V >> bst;
+   using Tree = typename Policy::template tree <Pairs, A, SelectFirst, C, Ranked>;
+   Tree bst;
+
+   // the pair an iterator is on. Only the value may be changed through it.
+   static Pairs& pairOf(const typename Tree::iterator& it)
+   {
+      return const_cast <Pairs&> (*it);
+   }
+
+   explicit map(Tree&& tree) : bst(std::move(tree))
+   {
+   }
+
+   template <class KK>
+   size_t eraseKey(const KK& k);
+   template <class KK, class ... Args>
+   custom::pair<iterator, bool> tryEmplace(KK&& k, Args&& ... args);
+   template <class KK, class M>
+   custom::pair<iterator, bool> insertOrAssign(KK&& k, M&& m);
 };
 
 
@@ -168,23 +506,29 @@ private:
  * Forward and reverse iterator through a Map, just call
  * through to BSTIterator
  *********************************************************/
-template <typename K, typename V>
-class map <K, V> :: iterator
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+class map <K, V, C, A, Ranked, Policy> :: iterator
 {
    friend class ::TestMap;
-   template <class KK, class VV>
+   template <class KK, class VV, class CC, class AA, bool RR, class PP>
    friend class custom::map; 
 public:
+   using iterator_category = std::bidirectional_iterator_tag;
+   using value_type        = Pairs;
+   using difference_type   = std::ptrdiff_t;
+   using pointer           = const Pairs *;
+   using reference         = const Pairs &;
+
    //
    // Construct
    //
    iterator()
    {
    }
-   iterator(const typename BST < pair <K, V> > :: iterator & rhs)
+   iterator(const typename Tree :: iterator & rhs) : it(rhs)
    { 
    }
-   iterator(const iterator & rhs) 
+   iterator(const iterator & rhs) : it(rhs.it)
    { 
    }
 
@@ -193,6 +537,7 @@ public:
    //
    iterator & operator = (const iterator & rhs)
    {
+      it = rhs.it;
       return *this;
    }
 
@@ -201,19 +546,19 @@ public:
    //
    bool operator == (const iterator & rhs) const 
    { 
-      return true;
+      return it == rhs.it;
    }
    bool operator != (const iterator & rhs) const 
    { 
-      return true;
+      return it != rhs.it;
    }
 
    // 
    // Access
    //
-   const pair <K, V> & operator * () const
+   const Pairs & operator * () const
    {
-      return *(new pair<K, V>);
+      return *it;
    }
 
    //
@@ -221,25 +566,78 @@ public:
    //
    iterator & operator ++ ()
    {
+      ++it;
       return *this;
    }
    iterator operator ++ (int postfix)
    {
-      return *this;
+      iterator itReturn = *this;
+      ++it;
+      return itReturn;
    }
    iterator & operator -- ()
    {
+      --it;
       return *this;
    }
    iterator  operator -- (int postfix)
    {
-      return *this;
+      iterator itReturn = *this;
+      --it;
+      return itReturn;
+   }
+
+   // O(log n) in a Ranked map. Call it unqualified after
+   // "using std::distance;" so argument-dependent lookup finds it
+   friend std::ptrdiff_t distance(const iterator & first, const iterator & last)
+   {
+      return distance(first.it, last.it);
    }
 
 private:
 
    // Member variable
-   typename BST < pair <K, V >>  :: iterator it;   
+   typename Tree :: iterator it;
+};
+
+/**********************************************************
+ * MAP NODE TYPE
+ * A pair taken out of a map with extract(). It can go into
+ * another map with insert() without being copied or reallocated.
+ *********************************************************/
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+class map <K, V, C, A, Ranked, Policy> ::node_type : public map <K, V, C, A, Ranked, Policy> ::Tree::NodeHandle
+{
+public:
+   node_type() noexcept
+   {
+   }
+   node_type(typename Tree::NodeHandle&& nh) noexcept : Tree::NodeHandle(std::move(nh))
+   {
+   }
+
+   // the key can be changed since the pair is in no map
+   K& key() const
+   {
+      return this->value().first;
+   }
+   V& mapped() const
+   {
+      return this->value().second;
+   }
+};
+
+/**********************************************************
+ * MAP INSERT RETURN TYPE
+ * What became of a node handle given to insert(). When the key
+ * was already there, node still owns the pair.
+ *********************************************************/
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+struct map <K, V, C, A, Ranked, Policy> ::insert_return_type
+{
+   iterator position;
+   bool inserted;
+   node_type node;
 };
 
 
@@ -247,80 +645,228 @@ private:
  * MAP :: SUBSCRIPT
  * Retrieve an element from the map
  ****************************************************/
-template <typename K, typename V>
-V& map <K, V> :: operator [] (const K& key)
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+V& map <K, V, C, A, Ranked, Policy> :: operator [] (const K& key)
 {
-   return *(new V);
+   // look for the key, adding it with a default value if it is not there
+   return pairOf(tryEmplace(key).first.it).second;
 }
 
 /*****************************************************
  * MAP :: SUBSCRIPT
  * Retrieve an element from the map
  ****************************************************/
-template <typename K, typename V>
-const V& map <K, V> :: operator [] (const K& key) const
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+const V& map <K, V, C, A, Ranked, Policy> :: operator [] (const K& key) const
 {
-   return *(new V);
+   return at(key);
 }
 
 /*****************************************************
  * MAP :: AT
  * Retrieve an element from the map
  ****************************************************/
-template <typename K, typename V>
-V& map <K, V> ::at(const K& key)
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+V& map <K, V, C, A, Ranked, Policy> ::at(const K& key)
 {
-   return *(new V);
+   auto it = bst.find(key);
+   if (it == bst.end())
+      throw std::out_of_range("invalid map<K, T> key");
+   return pairOf(it).second;
 }
 
 /*****************************************************
  * MAP :: AT
  * Retrieve an element from the map
  ****************************************************/
-template <typename K, typename V>
-const V& map <K, V> ::at(const K& key) const
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+const V& map <K, V, C, A, Ranked, Policy> ::at(const K& key) const
+{
+   auto it = const_cast <Tree&> (bst).find(key);
+   if (it == bst.end())
+      throw std::out_of_range("invalid map<K, T> key");
+   return pairOf(it).second;
+}
+
+/*****************************************************
+ * MAP :: TRY EMPLACE
+ * Add a pair built in place from k and args, but only if k is not
+ * already here. Nothing is built when it is.
+ ****************************************************/
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+template <class KK, class ... Args>
+custom::pair<typename map <K, V, C, A, Ranked, Policy> ::iterator, bool> map <K, V, C, A, Ranked, Policy> ::tryEmplace(KK&& k, Args&& ... args)
 {
-   return *(new V);
+   // build the pair only if the key is not there
+   auto pairReturn = bst.tryEmplace(k, std::in_place, std::in_place,
+                                    std::forward <KK> (k), std::forward <Args> (args)...);
+   return custom::pair<iterator, bool>(iterator(pairReturn.first), pairReturn.second);
+}
+
+/*****************************************************
+ * MAP :: INSERT OR ASSIGN
+ * Assign m to the value of k, adding k if it is not already here
+ ****************************************************/
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+template <class KK, class M>
+custom::pair<typename map <K, V, C, A, Ranked, Policy> ::iterator, bool> map <K, V, C, A, Ranked, Policy> ::insertOrAssign(KK&& k, M&& m)
+{
+   // m is only used to build the pair if the key is not there
+   auto pairReturn = bst.tryEmplace(k, std::in_place, std::in_place,
+                                    std::forward <KK> (k), std::forward <M> (m));
+   if (!pairReturn.second)
+      pairOf(pairReturn.first).second = std::forward <M> (m);
+   return custom::pair<iterator, bool>(iterator(pairReturn.first), pairReturn.second);
 }
 
 /*****************************************************
  * SWAP
  * Swap two maps
  ****************************************************/
-template <typename K, typename V>
-void swap(map <K, V>& lhs, map <K, V>& rhs)
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+void swap(map <K, V, C, A, Ranked, Policy>& lhs, map <K, V, C, A, Ranked, Policy>& rhs)
 {
+   lhs.bst.swap(rhs.bst);
 }
 
 /*****************************************************
- * ERASE
- * Erase one element
+ * MAP UNION, INTERSECTION, DIFFERENCE
+ * The pairs whose keys are in either map, in both, or in lhs
+ * but not rhs. The maps are taken by value and their nodes
+ * reused, so move them in unless a copy is wanted. For a key in
+ * both, union keeps combine(lhs value, rhs value), or without
+ * a combine the value from lhs, and the others keep lhs's pair. Maps of
+ * 65536 pairs or more are worked on by numThreads threads, zero
+ * meaning one per core, so combine must be safe to call from
+ * several threads at once and must not throw.
  ****************************************************/
-template <typename K, typename V>
-size_t map<K, V>::erase(const K& k)
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy, class Combine>
+map <K, V, C, A, Ranked, Policy> map_union(map <K, V, C, A, Ranked, Policy> lhs, map <K, V, C, A, Ranked, Policy> rhs,
+                                   Combine combine, unsigned numThreads = 0)
 {
-   return size_t(99);
+   using Pairs = typename map <K, V, C, A, Ranked, Policy> ::Pairs;
+   auto combinePairs = [&combine](Pairs& kept, Pairs& other)
+   {
+      kept.second = combine(std::move(kept.second), std::move(other.second));
+   };
+   return map <K, V, C, A, Ranked, Policy> (map <K, V, C, A, Ranked, Policy> ::Tree::setUnion(std::move(lhs.bst), std::move(rhs.bst),
+                                                                           combinePairs, numThreads));
+}
+
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+map <K, V, C, A, Ranked, Policy> map_union(map <K, V, C, A, Ranked, Policy> lhs, map <K, V, C, A, Ranked, Policy> rhs)
+{
+   using Pairs = typename map <K, V, C, A, Ranked, Policy> ::Pairs;
+   auto keep = [](Pairs&, Pairs&) {};
+   return map <K, V, C, A, Ranked, Policy> (map <K, V, C, A, Ranked, Policy> ::Tree::setUnion(std::move(lhs.bst), std::move(rhs.bst),
+                                                                           keep, 0));
+}
+
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+map <K, V, C, A, Ranked, Policy> map_intersection(map <K, V, C, A, Ranked, Policy> lhs, map <K, V, C, A, Ranked, Policy> rhs,
+                                          unsigned numThreads = 0)
+{
+   return map <K, V, C, A, Ranked, Policy> (map <K, V, C, A, Ranked, Policy> ::Tree::setIntersection(std::move(lhs.bst),
+                                                                                  std::move(rhs.bst), numThreads));
+}
+
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+map <K, V, C, A, Ranked, Policy> map_difference(map <K, V, C, A, Ranked, Policy> lhs, map <K, V, C, A, Ranked, Policy> rhs,
+                                        unsigned numThreads = 0)
+{
+   return map <K, V, C, A, Ranked, Policy> (map <K, V, C, A, Ranked, Policy> ::Tree::setDifference(std::move(lhs.bst),
+                                                                                std::move(rhs.bst), numThreads));
+}
+
+/*****************************************************
+ * MAP :: EXTRACT
+ * Take a pair out of the map without freeing it
+ ****************************************************/
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+typename map <K, V, C, A, Ranked, Policy> ::node_type map <K, V, C, A, Ranked, Policy> ::extract(iterator pos)
+{
+   return node_type(bst.extract(pos.it));
+}
+
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+typename map <K, V, C, A, Ranked, Policy> ::node_type map <K, V, C, A, Ranked, Policy> ::extract(const K& k)
+{
+   return node_type(bst.extract(bst.find(k)));
+}
+
+/*****************************************************
+ * MAP :: INSERT NODE
+ * Put an extracted pair into the map, unless its key is already here
+ ****************************************************/
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+typename map <K, V, C, A, Ranked, Policy> ::insert_return_type map <K, V, C, A, Ranked, Policy> ::insert(node_type&& nh)
+{
+   if (nh.empty())
+      return insert_return_type{ end(), false, node_type() };
+
+   auto pairReturn = bst.insert(std::move(nh), true /*keepUnique*/);
+   if (pairReturn.second)
+      return insert_return_type{ iterator(pairReturn.first), true, node_type() };
+   return insert_return_type{ iterator(pairReturn.first), false, std::move(nh) };
+}
+
+/*****************************************************
+ * ERASE KEY
+ * Erase the element with a given key, if there is one
+ ****************************************************/
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+template <class KK>
+size_t map<K, V, C, A, Ranked, Policy>::eraseKey(const KK& k)
+{
+   auto it = bst.find(k);
+   if (it == bst.end())
+      return size_t(0);
+   bst.erase(it);
+   return size_t(1);
 }
 
 /*****************************************************
  * ERASE
- * Erase several elements
+ * Erase several elements. The tree cuts the whole range
+ * out at once rather than unlinking one node at a time.
  ****************************************************/
-template <typename K, typename V>
-typename map<K, V>::iterator map<K, V>::erase(map<K, V>::iterator first, map<K, V>::iterator last)
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+typename map<K, V, C, A, Ranked, Policy>::iterator map<K, V, C, A, Ranked, Policy>::erase(map<K, V, C, A, Ranked, Policy>::iterator first, map<K, V, C, A, Ranked, Policy>::iterator last)
 {
-   return iterator();
+   return iterator(bst.erase(first.it, last.it));
 }
 
 /*****************************************************
  * ERASE
  * Erase one element
  ****************************************************/
-template <typename K, typename V>
-typename map<K, V>::iterator map<K, V>::erase(map<K, V>::iterator it)
+template <typename K, typename V, typename C, typename A, bool Ranked, class Policy>
+typename map<K, V, C, A, Ranked, Policy>::iterator map<K, V, C, A, Ranked, Policy>::erase(map<K, V, C, A, Ranked, Policy>::iterator it)
 {
-   return iterator();
+   return iterator(bst.erase(it.it));
 }
 
-}; //  namespace custom
+/*****************************************************************
+ * PMR
+ * A map drawing its nodes from a std::pmr::memory_resource. Since
+ * every node lives in the resource, a map in a monotonic arena can
+ * simply be abandoned along with the arena.
+ *****************************************************************/
+namespace pmr
+{
+   template <class K, class V, class C = std::less <K>, bool Ranked = false>
+   using map = custom::map <K, V, C, std::pmr::polymorphic_allocator <custom::pair <K, V, C> >, Ranked>;
+}
+
+/*****************************************************************
+ * FLAT MAP
+ * A map kept in one sorted array, for tables that are built once
+ * and then read. Its lookups, inserts and erases are a map's, so
+ * switching between the two is a matter of a typedef. Splitting,
+ * joining and the set operations are left to the red-black tree.
+ *****************************************************************/
+template <class K, class V, class C = std::less <K>,
+          class A = std::allocator <custom::pair <K, V, C> > >
+using flat_map = custom::map <K, V, C, A, false, flat_policy>;
 
+}; //  namespace custom
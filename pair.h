@@ -10,6 +10,7 @@
 #pragma once
 
 #include <iostream>  // for ISTREAM and OSTREAM
+#include <utility>   // for std::forward and std::in_place_t
 
 namespace custom
 {
@@ -50,6 +51,10 @@ public:
    // Move Constructor: call the T1, T2 move constructors
    pair(pair <T1, T2> && rhs, const C& c = C())
        : first(std::move(rhs.first)), second(std::move(rhs.second)), compare(c) {}
+   // In-place Constructor: T1 from the key, T2 built from the rest
+   template <class K, class ... Args>
+   pair(std::in_place_t, K && first, Args && ... args)
+       : first(std::forward<K>(first)), second(std::forward<Args>(args)...), compare() {}
 
    //
    // Assignment Operators
@@ -0,0 +1,506 @@
+/***********************************************************************
+ * Header:
+ *    POOL
+ * Summary:
+ *    A fixed-size block allocator for the nodes of our node-based
+ *    containers. Blocks are carved out of large chunks, and freed blocks
+ *    go onto a free list so the next allocation can reuse them. Each
+ *    container keeps a free list of its own and goes to the shared pool,
+ *    under its lock, only a batch at a time.
+ *
+ *    This will contain the class definition of:
+ *        NodePool            : A pool of equally-sized blocks
+ *        NodeCache           : One container's free list of blocks
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>    // for size_t
+#include <new>        // for operator new and std::align_val_t
+#include <vector>     // for std::vector
+#include <algorithm>  // for std::upper_bound
+#include <mutex>      // for std::mutex
+#include <utility>    // for std::swap
+
+class TestPool; // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * POOL SLOT
+ * A block on a free list is re-used to point to the next free block
+ *****************************************************************/
+struct PoolSlot
+{
+   PoolSlot* pNext;
+};
+
+/*****************************************************************
+ * NODE POOL
+ * Hand out blocks of SIZE bytes aligned on ALIGN. Each block is either
+ * in use by the client, on the free list, or not yet carved out of the
+ * newest chunk. Every call takes the lock, so one pool can be shared by
+ * containers on different threads.
+ *****************************************************************/
+template <size_t SIZE, size_t ALIGN>
+class NodePool
+{
+   friend class ::TestPool;
+public:
+   //
+   // Construct
+   //
+   NodePool() : pFree(nullptr), pBump(nullptr), pBumpEnd(nullptr),
+                numFree(0), numInUse(0),
+                numSlotsNext(numSlotsMin) {}
+   NodePool(const NodePool& rhs) = delete;
+   NodePool& operator = (const NodePool& rhs) = delete;
+  ~NodePool()
+   {
+      for (auto& chunk : chunks)
+         freeChunk(chunk);
+   }
+
+   //
+   // Allocate and free a single block
+   //
+   void* allocate();
+   void deallocate(void* p) noexcept;
+
+   //
+   // Allocate and free a list of num blocks under one lock
+   //
+   PoolSlot* allocateList(size_t num);
+   void deallocateList(PoolSlot* pFirst, PoolSlot* pLast, size_t num) noexcept;
+
+   //
+   // Capacity
+   //
+   void reserve(size_t num);
+   void shrink_to_fit();
+
+   //
+   // Status
+   //
+   size_t size() const
+   {
+      std::lock_guard <std::mutex> lock(mutex);
+      return numInUse;
+   }
+   size_t available() const
+   {
+      std::lock_guard <std::mutex> lock(mutex);
+      return numAvailable();
+   }
+   size_t capacity() const
+   {
+      std::lock_guard <std::mutex> lock(mutex);
+      return numInUse + numAvailable();
+   }
+
+   // every node type gets its own pool, shared by all the containers
+   // using that node type. It is never destroyed so containers with static
+   // storage duration can still give their nodes back at exit. A block in
+   // a container's free list counts as in use here.
+   static NodePool& global()
+   {
+      static NodePool* pPool = new NodePool;
+      return *pPool;
+   }
+
+private:
+
+   using Slot = PoolSlot;
+
+   // a contiguous run of blocks from operator new
+   struct Chunk
+   {
+      char*  pBegin;
+      size_t numSlots;
+   };
+
+   // every block must be able to hold a Slot and keep the alignment
+   static constexpr size_t alignSlot = (ALIGN > alignof(Slot) ? ALIGN : alignof(Slot));
+   static constexpr size_t sizeSlot  =
+      ((SIZE > sizeof(Slot) ? SIZE : sizeof(Slot)) + alignSlot - 1) / alignSlot * alignSlot;
+
+   // the first chunk holds this many blocks, each new chunk doubles it
+   // until the maximum is reached
+   static constexpr size_t numSlotsMin = 64;
+   static constexpr size_t numSlotsMax = 65536;
+
+   size_t numBump() const noexcept { return (pBumpEnd - pBump) / sizeSlot; }
+   size_t numAvailable() const noexcept { return numFree + numBump(); }
+   void* take();
+   void pushFree(Slot* pSlot) noexcept
+   {
+      pSlot->pNext = pFree;
+      pFree = pSlot;
+      numFree++;
+   }
+   void addChunk(size_t numSlots);
+   static void freeChunk(const Chunk& chunk) noexcept;
+
+   std::vector <Chunk> chunks; // every chunk we own, sorted by address
+   Slot*  pFree;               // head of the free list
+   char*  pBump;               // next never-used block in the newest chunk
+   char*  pBumpEnd;            // end of the newest chunk
+   size_t numFree;             // number of blocks on the free list
+   size_t numInUse;            // number of blocks handed out
+   size_t numSlotsNext;        // size of the next chunk when we run out
+   mutable std::mutex mutex;   // held by every public method
+};
+
+/*********************************************
+ * NODE POOL :: ALLOCATE
+ * Take a block off the free list, or carve a new one from the newest chunk
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void* NodePool <SIZE, ALIGN> ::allocate()
+{
+   std::lock_guard <std::mutex> lock(mutex);
+   return take();
+}
+
+/*********************************************
+ * NODE POOL :: TAKE
+ * Allocate with the lock already held
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void* NodePool <SIZE, ALIGN> ::take()
+{
+   // recycle a freed block first: it is likely still in the cache
+   if (pFree != nullptr)
+   {
+      Slot* pSlot = pFree;
+      pFree = pFree->pNext;
+      numFree--;
+      numInUse++;
+      return pSlot;
+   }
+
+   // out of room, get a chunk twice as large as the last one
+   if (pBump == pBumpEnd)
+   {
+      addChunk(numSlotsNext);
+      numSlotsNext = (numSlotsNext * 2 < numSlotsMax ? numSlotsNext * 2 : numSlotsMax);
+   }
+
+   assert(pBump + sizeSlot <= pBumpEnd);
+   void* p = pBump;
+   pBump += sizeSlot;
+   numInUse++;
+   return p;
+}
+
+/*********************************************
+ * NODE POOL :: DEALLOCATE
+ * Put a block back on the free list
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void NodePool <SIZE, ALIGN> ::deallocate(void* p) noexcept
+{
+   if (p == nullptr)
+      return;
+
+   std::lock_guard <std::mutex> lock(mutex);
+   assert(numInUse > 0);
+   pushFree(static_cast <Slot*> (p));
+   numInUse--;
+}
+
+/*********************************************
+ * NODE POOL :: ALLOCATE LIST
+ * Hand out num blocks linked through their first word. If more
+ * than a chunk is missing, one chunk big enough is added at once.
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+PoolSlot* NodePool <SIZE, ALIGN> ::allocateList(size_t num)
+{
+   std::lock_guard <std::mutex> lock(mutex);
+   if (num > numAvailable() + numSlotsNext)
+      addChunk(num - numAvailable());
+
+   Slot* pFirst = nullptr;
+   for (size_t i = 0; i < num; i++)
+   {
+      Slot* pSlot = static_cast <Slot*> (take());
+      pSlot->pNext = pFirst;
+      pFirst = pSlot;
+   }
+   return pFirst;
+}
+
+/*********************************************
+ * NODE POOL :: DEALLOCATE LIST
+ * Put a list of num blocks back, from pFirst to pLast, all at once
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void NodePool <SIZE, ALIGN> ::deallocateList(PoolSlot* pFirst, PoolSlot* pLast, size_t num) noexcept
+{
+   if (pFirst == nullptr)
+      return;
+
+   std::lock_guard <std::mutex> lock(mutex);
+   assert(numInUse >= num);
+   pLast->pNext = pFree;
+   pFree = pFirst;
+   numFree += num;
+   numInUse -= num;
+}
+
+/*********************************************
+ * NODE POOL :: RESERVE
+ * Make sure the next num allocations do not need to go to operator new
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void NodePool <SIZE, ALIGN> ::reserve(size_t num)
+{
+   std::lock_guard <std::mutex> lock(mutex);
+   if (num <= numAvailable())
+      return;
+
+   addChunk(num - numAvailable());
+}
+
+/*********************************************
+ * NODE POOL :: SHRINK TO FIT
+ * Give back every chunk that has no block in use
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void NodePool <SIZE, ALIGN> ::shrink_to_fit()
+{
+   std::lock_guard <std::mutex> lock(mutex);
+   if (chunks.empty())
+      return;
+
+   // count the unused blocks in each chunk: the free list plus the bump area
+   std::vector <size_t> numUnused(chunks.size(), 0);
+   auto findChunk = [this](const char* p) -> size_t
+   {
+      auto it = std::upper_bound(chunks.begin(), chunks.end(), p,
+         [](const char* p, const Chunk& chunk) { return p < chunk.pBegin; });
+      assert(it != chunks.begin());
+      return (it - chunks.begin()) - 1;
+   };
+   for (Slot* pSlot = pFree; pSlot; pSlot = pSlot->pNext)
+      numUnused[findChunk(reinterpret_cast <char*> (pSlot))]++;
+   if (pBump != pBumpEnd)
+      numUnused[findChunk(pBump)] += numBump();
+
+   // nothing to do if every chunk has at least one block in use
+   bool fRelease = false;
+   for (size_t i = 0; i < chunks.size(); i++)
+      fRelease = fRelease || numUnused[i] == chunks[i].numSlots;
+   if (!fRelease)
+      return;
+
+   // rebuild the free list without the blocks in released chunks
+   Slot* pFreeOld = pFree;
+   pFree = nullptr;
+   numFree = 0;
+   while (pFreeOld)
+   {
+      Slot* pNext = pFreeOld->pNext;
+      size_t iChunk = findChunk(reinterpret_cast <char*> (pFreeOld));
+      if (numUnused[iChunk] != chunks[iChunk].numSlots)
+         pushFree(pFreeOld);
+      pFreeOld = pNext;
+   }
+   if (pBump != pBumpEnd && numUnused[findChunk(pBump)] == chunks[findChunk(pBump)].numSlots)
+      pBump = pBumpEnd = nullptr;
+
+   // finally give the chunks back
+   size_t iDest = 0;
+   for (size_t i = 0; i < chunks.size(); i++)
+      if (numUnused[i] == chunks[i].numSlots)
+         freeChunk(chunks[i]);
+      else
+         chunks[iDest++] = chunks[i];
+   chunks.resize(iDest);
+}
+
+/*********************************************
+ * NODE POOL :: ADD CHUNK
+ * Allocate a new chunk of numSlots blocks and make it the bump area
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void NodePool <SIZE, ALIGN> ::addChunk(size_t numSlots)
+{
+   assert(numSlots > 0);
+
+   // blocks left in the old bump area go on the free list
+   for (; pBump != pBumpEnd; pBump += sizeSlot)
+      pushFree(reinterpret_cast <Slot*> (pBump));
+
+   Chunk chunk;
+   chunk.numSlots = numSlots;
+   chunk.pBegin = static_cast <char*> (alignSlot > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ?
+      ::operator new(numSlots * sizeSlot, std::align_val_t(alignSlot)) :
+      ::operator new(numSlots * sizeSlot));
+
+   // keep the chunks sorted so shrink_to_fit() can find a block's owner.
+   // If there is no room to note the chunk, it must not leak.
+   try
+   {
+      chunks.insert(std::upper_bound(chunks.begin(), chunks.end(), chunk,
+         [](const Chunk& lhs, const Chunk& rhs) { return lhs.pBegin < rhs.pBegin; }),
+         chunk);
+   }
+   catch (...)
+   {
+      freeChunk(chunk);
+      throw;
+   }
+
+   pBump = chunk.pBegin;
+   pBumpEnd = chunk.pBegin + numSlots * sizeSlot;
+}
+
+/*********************************************
+ * NODE POOL :: FREE CHUNK
+ * Return a chunk to operator delete
+ ********************************************/
+template <size_t SIZE, size_t ALIGN>
+void NodePool <SIZE, ALIGN> ::freeChunk(const Chunk& chunk) noexcept
+{
+   if (alignSlot > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      ::operator delete(chunk.pBegin, std::align_val_t(alignSlot));
+   else
+      ::operator delete(chunk.pBegin);
+}
+
+/*****************************************************************
+ * NODE CACHE
+ * The free list of one container. Freed nodes go here and are handed
+ * out again by the same container without a lock. Only when it runs
+ * dry does it go to the pool, for a batch that doubles each time up to
+ * numBatchMax, so a small container holds few spare blocks. The
+ * blocks still belong to the pool, so a node may be freed by another
+ * container than the one that made it.
+ *****************************************************************/
+template <class Node>
+class NodeCache
+{
+   friend class ::TestPool;
+public:
+   //
+   // Construct
+   //
+   NodeCache() noexcept : pFree(nullptr), pLast(nullptr), numFree(0), numBatch(1) {}
+   NodeCache(const NodeCache& rhs) = delete;
+   NodeCache& operator = (const NodeCache& rhs) = delete;
+  ~NodeCache()
+   {
+      release();
+   }
+   void swap(NodeCache& rhs) noexcept
+   {
+      std::swap(pFree, rhs.pFree);
+      std::swap(pLast, rhs.pLast);
+      std::swap(numFree, rhs.numFree);
+      std::swap(numBatch, rhs.numBatch);
+   }
+
+   //
+   // Allocate and free a single block
+   //
+   void* allocate();
+   void deallocate(void* p) noexcept;
+
+   //
+   // Capacity
+   //
+   void reserve(size_t num);
+   void release() noexcept;
+   size_t available() const noexcept { return numFree; }
+
+   // where the blocks come from: one pool for every node of this type
+   static auto& pool() { return NodePool <sizeof(Node), alignof(Node)> ::global(); }
+
+private:
+   static constexpr size_t numBatchMax = 256;
+
+   PoolSlot* pFree;    // head of our free list
+   PoolSlot* pLast;    // its tail, so it can go back to the pool in O(1)
+   size_t numFree;     // number of blocks on it
+   size_t numBatch;    // how many to take from the pool next time
+};
+
+/*********************************************
+ * NODE CACHE :: ALLOCATE
+ * Take a block off our list, refilling it from the pool when empty
+ ********************************************/
+template <class Node>
+void* NodeCache <Node> ::allocate()
+{
+   if (pFree == nullptr)
+   {
+      reserve(numBatch);
+      numBatch = (numBatch * 2 < numBatchMax ? numBatch * 2 : numBatchMax);
+   }
+
+   PoolSlot* pSlot = pFree;
+   pFree = pFree->pNext;
+   if (pFree == nullptr)
+      pLast = nullptr;
+   numFree--;
+   return pSlot;
+}
+
+/*********************************************
+ * NODE CACHE :: DEALLOCATE
+ * Keep a freed block for our next allocation
+ ********************************************/
+template <class Node>
+void NodeCache <Node> ::deallocate(void* p) noexcept
+{
+   if (p == nullptr)
+      return;
+
+   PoolSlot* pSlot = static_cast <PoolSlot*> (p);
+   pSlot->pNext = pFree;
+   if (pFree == nullptr)
+      pLast = pSlot;
+   pFree = pSlot;
+   numFree++;
+}
+
+/*********************************************
+ * NODE CACHE :: RESERVE
+ * Make sure num blocks are on our list
+ ********************************************/
+template <class Node>
+void NodeCache <Node> ::reserve(size_t num)
+{
+   if (num <= numFree)
+      return;
+
+   PoolSlot* pFirst = pool().allocateList(num - numFree);
+   PoolSlot* pEnd = pFirst;
+   while (pEnd->pNext)
+      pEnd = pEnd->pNext;
+   pEnd->pNext = pFree;
+   if (pFree == nullptr)
+      pLast = pEnd;
+   pFree = pFirst;
+   numFree = num;
+}
+
+/*********************************************
+ * NODE CACHE :: RELEASE
+ * Give every block on our list back to the pool
+ ********************************************/
+template <class Node>
+void NodeCache <Node> ::release() noexcept
+{
+   pool().deallocateList(pFree, pLast, numFree);
+   pFree = pLast = nullptr;
+   numFree = 0;
+}
+
+} // namespace custom
@@ -0,0 +1,325 @@
+/***********************************************************************
+ * Header:
+ *    SIMD
+ * Summary:
+ *    Searching a small sorted block of integer keys several keys at a
+ *    time. Where a key goes in a sorted block is just how many keys are
+ *    smaller than it, so instead of a binary search with a hard-to-predict
+ *    branch at every step, every key is compared at once and the results
+ *    are added up. That only pays off for a large block; a small one is
+ *    counted one key at a time, still without a branch.
+ *
+ *    This will contain the definition of:
+ *        simd::Level           : Which instructions a search may use
+ *        simd::numVectorMin    : The smallest block worth searching that way
+ *        simd::isSearchable    : Can these keys be searched this way?
+ *        simd::countLess       : How many keys are smaller than k
+ *        simd::countNotGreater : How many keys are not larger than k
+ *        simd::matchGroup      : Which of 16 hash table control bytes match
+ * Author
+ *    <your names here>
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>     // for int64_t and INT64_MIN
+#include <type_traits> // for std::is_integral and std::is_signed
+#include <functional>  // for std::less
+#include <algorithm>   // for std::min
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CUSTOM_SIMD_X86
+#include <immintrin.h> // for the SSE4.2 and AVX2 intrinsics
+#ifdef _MSC_VER
+#include <intrin.h>    // for __cpuid
+#define CUSTOM_SIMD_TARGET(x)
+#else
+#define CUSTOM_SIMD_TARGET(x) __attribute__((target(x)))
+#endif // _MSC_VER
+#endif // x86
+
+namespace custom
+{
+namespace simd
+{
+   /*****************************************************************
+    * LEVEL
+    * The instructions a search may use, from least to most capable
+    *****************************************************************/
+   enum class Level { scalar, sse42, avx2 };
+
+   /*****************************************************************
+    * IS SEARCHABLE
+    * Keys that are 4 or 8 byte integers in their natural order can
+    * be compared several at a time. Anything else is searched one
+    * comparison at a time by its own comparator.
+    *****************************************************************/
+   template <class K, class C>
+   struct isSearchable : std::integral_constant <bool,
+      std::is_integral <K> ::value && !std::is_same <K, bool> ::value &&
+      (sizeof(K) == 4 || sizeof(K) == 8) &&
+      (std::is_same <C, std::less <K> > ::value || std::is_same <C, std::less <> > ::value)>
+   {
+   };
+
+   /*****************************************************************
+    * SUPPORTED
+    * The most capable level this CPU can run, asked once
+    *****************************************************************/
+   inline Level supported() noexcept
+   {
+#ifdef CUSTOM_SIMD_X86
+#ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 0);
+      int numIds = info[0];
+      __cpuid(info, 1);
+      bool hasSse42 = (info[2] & (1 << 20)) != 0;
+      bool hasAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                    (_xgetbv(0) & 6) == 6;
+      bool hasAvx2 = false;
+      if (hasAvx && numIds >= 7)
+      {
+         __cpuidex(info, 7, 0);
+         hasAvx2 = (info[1] & (1 << 5)) != 0;
+      }
+#else
+      __builtin_cpu_init();
+      bool hasSse42 = __builtin_cpu_supports("sse4.2");
+      bool hasAvx2 = __builtin_cpu_supports("avx2");
+#endif // _MSC_VER
+      if (hasAvx2)
+         return Level::avx2;
+      if (hasSse42)
+         return Level::sse42;
+#endif // CUSTOM_SIMD_X86
+      return Level::scalar;
+   }
+
+   /*****************************************************************
+    * ACTIVE
+    * The level the searches use: the best supported, unless turned
+    * down with setLevel(), say to compare against the scalar search
+    *****************************************************************/
+   inline Level active = supported();
+
+   inline void setLevel(Level level) noexcept
+   {
+      active = std::min(level, supported());
+   }
+
+   /*****************************************************************
+    * NUM VECTOR MIN
+    * A block of fewer keys than this is faster counted one key at a
+    * time: broadcasting the key, adding up the lanes and finishing the
+    * tail cost more than comparing several keys at once saves. On a
+    * B-tree of 8 byte keys, AVX2 loses by a third at 10 keys a node,
+    * ties at 32 and wins by a quarter at 64.
+    *****************************************************************/
+   constexpr int numVectorMin = 64;
+
+   /*****************************************************************
+    * COUNT SCALAR
+    * How many keys are smaller than k, or larger when isGreater,
+    * one at a time but without a branch
+    *****************************************************************/
+   template <class K, bool isGreater>
+   inline int countScalar(const K* pKeys, int num, K k) noexcept
+   {
+      int count = 0;
+      for (int i = 0; i < num; i++)
+         count += isGreater ? int(k < pKeys[i]) : int(pKeys[i] < k);
+      return count;
+   }
+
+#ifdef CUSTOM_SIMD_X86
+   /*****************************************************************
+    * COUNT SSE4.2
+    * Two 8 byte keys or four 4 byte keys at a time. The compare is
+    * signed, so unsigned keys get their top bit flipped first, which
+    * keeps their order. Each lane subtracts its all-ones matches.
+    *****************************************************************/
+   template <class K, bool isGreater>
+   CUSTOM_SIMD_TARGET("sse4.2")
+   inline int countSse42(const K* pKeys, int num, K k) noexcept
+   {
+      constexpr int width = 16 / sizeof(K);
+      __m128i bias;
+      __m128i key;
+      if constexpr (sizeof(K) == 8)
+      {
+         bias = _mm_set1_epi64x(std::is_signed <K> ::value ? 0 : INT64_MIN);
+         key = _mm_xor_si128(_mm_set1_epi64x((long long)k), bias);
+      }
+      else
+      {
+         bias = _mm_set1_epi32(std::is_signed <K> ::value ? 0 : INT32_MIN);
+         key = _mm_xor_si128(_mm_set1_epi32((int)k), bias);
+      }
+
+      __m128i total = _mm_setzero_si128();
+      int i = 0;
+      for (; i + width <= num; i += width)
+      {
+         __m128i keys = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(pKeys + i)), bias);
+         if constexpr (sizeof(K) == 8)
+            total = _mm_sub_epi64(total, isGreater ? _mm_cmpgt_epi64(keys, key) : _mm_cmpgt_epi64(key, keys));
+         else
+            total = _mm_sub_epi32(total, isGreater ? _mm_cmpgt_epi32(keys, key) : _mm_cmpgt_epi32(key, keys));
+      }
+
+      alignas(16) K lanes[width];
+      _mm_store_si128((__m128i*)lanes, total);
+      int count = 0;
+      for (int lane = 0; lane < width; lane++)
+         count += int(lanes[lane]);
+      return count + countScalar <K, isGreater> (pKeys + i, num - i, k);
+   }
+
+   /*****************************************************************
+    * COUNT AVX2
+    * The same, four 8 byte keys or eight 4 byte keys at a time
+    *****************************************************************/
+   template <class K, bool isGreater>
+   CUSTOM_SIMD_TARGET("avx2")
+   inline int countAvx2(const K* pKeys, int num, K k) noexcept
+   {
+      constexpr int width = 32 / sizeof(K);
+      __m256i bias;
+      __m256i key;
+      if constexpr (sizeof(K) == 8)
+      {
+         bias = _mm256_set1_epi64x(std::is_signed <K> ::value ? 0 : INT64_MIN);
+         key = _mm256_xor_si256(_mm256_set1_epi64x((long long)k), bias);
+      }
+      else
+      {
+         bias = _mm256_set1_epi32(std::is_signed <K> ::value ? 0 : INT32_MIN);
+         key = _mm256_xor_si256(_mm256_set1_epi32((int)k), bias);
+      }
+
+      __m256i total = _mm256_setzero_si256();
+      int i = 0;
+      for (; i + width <= num; i += width)
+      {
+         __m256i keys = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(pKeys + i)), bias);
+         if constexpr (sizeof(K) == 8)
+            total = _mm256_sub_epi64(total, isGreater ? _mm256_cmpgt_epi64(keys, key) : _mm256_cmpgt_epi64(key, keys));
+         else
+            total = _mm256_sub_epi32(total, isGreater ? _mm256_cmpgt_epi32(keys, key) : _mm256_cmpgt_epi32(key, keys));
+      }
+
+      alignas(32) K lanes[width];
+      _mm256_store_si256((__m256i*)lanes, total);
+      int count = 0;
+      for (int lane = 0; lane < width; lane++)
+         count += int(lanes[lane]);
+      return count + countSse42 <K, isGreater> (pKeys + i, num - i, k);
+   }
+#endif // CUSTOM_SIMD_X86
+
+   /*****************************************************************
+    * COUNT
+    * Hand a block that can hold numBlock keys to the most capable
+    * search turned on, or count it one key at a time if it is small
+    *****************************************************************/
+   template <class K, bool isGreater>
+   inline int count(const K* pKeys, int num, K k, int numBlock) noexcept
+   {
+#ifdef CUSTOM_SIMD_X86
+      if (numBlock >= numVectorMin && active == Level::avx2)
+         return countAvx2 <K, isGreater> (pKeys, num, k);
+      if (numBlock >= numVectorMin && active == Level::sse42)
+         return countSse42 <K, isGreater> (pKeys, num, k);
+#endif // CUSTOM_SIMD_X86
+      return countScalar <K, isGreater> (pKeys, num, k);
+   }
+
+   /*****************************************************************
+    * COUNT LESS and COUNT NOT GREATER
+    * In num sorted keys, where k would go before or after any keys
+    * equal to it: the lower and the upper bound. Without a block
+    * size, the search turned on is used whatever num is.
+    *****************************************************************/
+   template <class K>
+   inline int countLess(const K* pKeys, int num, K k, int numBlock = numVectorMin) noexcept
+   {
+      return count <K, false> (pKeys, num, k, numBlock);
+   }
+
+   template <class K>
+   inline int countNotGreater(const K* pKeys, int num, K k, int numBlock = numVectorMin) noexcept
+   {
+      return num - count <K, true> (pKeys, num, k, numBlock);
+   }
+
+   /*****************************************************************
+    * GROUP
+    * The control bytes of a hash table, looked at 16 at a time. A
+    * byte with its top bit set marks an empty slot, any other holds
+    * 7 bits of the hash of the key in its slot.
+    *****************************************************************/
+   constexpr int groupWidth = 16;
+
+   /*****************************************************************
+    * MATCH GROUP SCALAR
+    * One bit for each of the 16 bytes that is tag, and one in empties
+    * for each that is empty, a byte at a time
+    *****************************************************************/
+   inline uint32_t matchGroupScalar(const int8_t* pGroup, int8_t tag, uint32_t& empties) noexcept
+   {
+      uint32_t matches = 0;
+      empties = 0;
+      for (int i = 0; i < groupWidth; i++)
+      {
+         matches |= uint32_t(pGroup[i] == tag) << i;
+         empties |= uint32_t(pGroup[i] < 0) << i;
+      }
+      return matches;
+   }
+
+#ifdef CUSTOM_SIMD_X86
+   /*****************************************************************
+    * MATCH GROUP SSE2
+    * All 16 at once: compare every byte with the tag, and gather the
+    * top bit of every byte for the empty ones. SSE4.2 implies SSE2.
+    *****************************************************************/
+   CUSTOM_SIMD_TARGET("sse2")
+   inline uint32_t matchGroupSse2(const int8_t* pGroup, int8_t tag, uint32_t& empties) noexcept
+   {
+      __m128i group = _mm_loadu_si128((const __m128i*)pGroup);
+      empties = uint32_t(_mm_movemask_epi8(group));
+      return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+   }
+#endif // CUSTOM_SIMD_X86
+
+   /*****************************************************************
+    * MATCH GROUP
+    * Hand the group to the most capable match turned on
+    *****************************************************************/
+   inline uint32_t matchGroup(const int8_t* pGroup, int8_t tag, uint32_t& empties) noexcept
+   {
+#ifdef CUSTOM_SIMD_X86
+      if (active != Level::scalar)
+         return matchGroupSse2(pGroup, tag, empties);
+#endif // CUSTOM_SIMD_X86
+      return matchGroupScalar(pGroup, tag, empties);
+   }
+
+   /*****************************************************************
+    * LOWEST BIT
+    * The index of the lowest bit set in a mask that is not zero
+    *****************************************************************/
+   inline int lowestBit(uint32_t mask) noexcept
+   {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return int(index);
+#else
+      return __builtin_ctz(mask);
+#endif // _MSC_VER
+   }
+
+} // namespace simd
+} // namespace custom
@@ -20,6 +20,28 @@
 #include <iostream>
 #include <string>
 #include <functional> // for std::less and std::greater
+#include <cstdlib>    // for std::rand and std::srand
+#include <cmath>      // for std::log2
+#include <vector>     // for std::vector
+#include <algorithm>  // for std::sort and std::lower_bound
+#include <memory_resource> // for std::pmr::memory_resource
+#include <iterator>   // for std::back_inserter
+#include <atomic>     // for std::atomic
+#include <thread>     // for std::thread
+
+ /***********************************************
+  * WHERE DESTROYED
+  * An element that notes which thread destroyed it
+  ***********************************************/
+struct WhereDestroyed
+{
+   WhereDestroyed(int value) : value(value) {}
+   ~WhereDestroyed() { idLast = std::this_thread::get_id(); }
+   bool operator < (const WhereDestroyed& rhs) const { return value < rhs.value; }
+
+   int value;
+   inline static std::thread::id idLast;
+};
 
  /***********************************************
   * TEST BST
@@ -38,11 +60,16 @@ public:
       test_constructCopy_empty();
       test_constructCopy_one();
       test_constructCopy_standard();
+      test_constructCopy_deepChain();
       test_constructMove_empty();
       test_constructMove_one();
       test_constructMove_standard();
+      test_constructMove_noexcept();
       test_constructInitializer_empty();
       test_constructInitializer_standard();
+      test_assignRange_sorted();
+      test_assignRange_unsortedUnique();
+      test_assignRange_unsortedUniqueLong();
 
       // Assign
       test_assign_emptyToEmpty();
@@ -51,6 +78,9 @@ public:
       test_assign_oneToStandard();
       test_assign_standardToOne();
       test_assign_standardToStandard();
+      test_assignParallel_small();
+      test_assignParallel_large();
+      test_assignParallel_otherThread();
       test_assignMove_emptyToEmpty();
       test_assignMove_standardToEmpty();
       test_assignMove_emptyToStandard();
@@ -68,6 +98,10 @@ public:
       test_begin_empty();
       test_begin_standard();
       test_end_standard();
+      test_rbegin_standard();
+      test_end_decrement();
+      test_popFront_popBack();
+      test_leftmost_randomChurn();
       test_iterator_increment_standardToParent();
       test_iterator_increment_standardToChild();
       test_iterator_increment_standardToGrandma();
@@ -81,6 +115,13 @@ public:
       test_find_standardBegin();
       test_find_standardLast();
       test_find_standardMissing();
+      test_find_comparisons();
+      test_find_byKey();
+      test_lowerBound_standard();
+      test_upperBound_standard();
+      test_equalRange_duplicates();
+      test_equalRange_missing();
+      test_range_noComparisons();
 
       // Insert
       test_insert_oneLeft();
@@ -91,6 +132,12 @@ public:
       test_insertMove_oneRight();
       test_insertMove_duplicate();
       test_insertMove_keepUnique();
+      test_emplace_one();
+      test_emplace_keepUnique();
+      test_insertHint_exact();
+      test_insertHint_wrong();
+      test_insertHint_end();
+      test_insert_inOrder();
       test_insert_case1();
       test_insert_case2();
       test_insert_case3();
@@ -109,8 +156,45 @@ public:
       test_erase_noChildren();
       test_erase_oneChild();
       test_erase_twoChildren();
+      test_erase_blackLeaf();
+      test_erase_randomChurn();
+      test_eraseRange_middle();
+      test_eraseRange_toEnd();
+      test_eraseRange_random();
       test_clear_empty();
       test_clear_standard();
+      test_clear_deferred();
+      test_clear_deferredThread();
+      test_clear_deferredSmall();
+      test_destructor_deferred();
+
+      // Node handles
+      test_extract_standard();
+      test_extract_end();
+      test_insertNode_otherTree();
+      test_insertNode_duplicate();
+      test_merge_overlap();
+
+      // Split and join
+      test_split_standard();
+      test_split_pastEnd();
+      test_join_uneven();
+      test_splitJoin_random();
+
+      // Set operations
+      test_setUnion_standard();
+      test_setIntersection_standard();
+      test_setDifference_standard();
+      test_setOperations_random();
+      test_setUnion_parallel();
+
+      // Order statistics
+      test_nth_ranked();
+      test_nth_unranked();
+      test_rank_ranked();
+      test_countRange_ranked();
+      test_distance_ranked();
+      test_ranked_randomChurn();
 
       // Status
       test_empty_empty();
@@ -118,6 +202,16 @@ public:
       test_size_empty();
       test_size_standard();
 
+      // Node
+      test_node_size();
+      test_node_parentAndColor();
+
+      // Allocator
+      test_allocator_pmrNodes();
+      test_allocator_copy();
+      test_allocator_move();
+      test_allocator_moveAssignUnequal();
+
       report("BST");
    }
    
@@ -179,7 +273,7 @@ public:
       //            (50b)
       custom::BST <Spy> bstSrc;
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
+      p50->setRed(false);
       bstSrc.root = p50;
       bstSrc.numElements = 1;
       Spy::reset();
@@ -200,10 +294,10 @@ public:
       if (bstSrc.root)
       {
          assertUnit(bstSrc.root->data == Spy(50));
-         assertUnit(bstSrc.root->isRed == false);
+         assertUnit(bstSrc.root->isRed() == false);
          assertUnit(bstSrc.root->pLeft == nullptr);
          assertUnit(bstSrc.root->pRight == nullptr);
-         assertUnit(bstSrc.root->pParent == nullptr);
+         assertUnit(bstSrc.root->getParent() == nullptr);
       }
       //            (50b)
       assertUnit(bstDest.numElements == 1);
@@ -211,10 +305,10 @@ public:
       if (bstDest.root)
       {
          assertUnit(bstDest.root->data == Spy(50));
-         assertUnit(bstDest.root->isRed == false);
+         assertUnit(bstDest.root->isRed() == false);
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->getParent() == nullptr);
       }
       // teardown
       if (bstSrc.root)
@@ -269,6 +363,50 @@ public:
       teardownStandardFixture(bstDest);
    }
 
+   // copy and destroy a degenerate tree far too deep for recursion
+   void test_constructCopy_deepChain()
+   {  // setup
+      //   (N-1)
+      //   +--+
+      //  (0)
+      //   +--+
+      //     (N-2)
+      //      +--+
+      //     (1)  ...
+      const int num = 10000000;
+      custom::BST <int> bstSrc;
+      bstSrc.root = new custom::BST <int> ::BNode(num - 1);
+      custom::BST <int> ::BNode* pNode = bstSrc.root;
+      for (int lo = 0, hi = num - 2, i = 1; i < num; i++)
+      {
+         auto pNew = new custom::BST <int> ::BNode(i % 2 ? lo++ : hi--);
+         if (i % 2)
+            pNode->addLeft(pNew);
+         else
+            pNode->addRight(pNew);
+         pNode = pNew;
+      }
+      bstSrc.pRightmost = bstSrc.root;
+      bstSrc.numElements = num;
+      {
+         // exercise
+         custom::BST <int> bstDest(bstSrc);
+         // verify
+         assertUnit(bstDest.size() == num);
+         assertUnit(bstDest.root != bstSrc.root);
+         assertUnit(bstDest.pRightmost == bstDest.root);
+         int expected = 0;
+         bool inOrder = true;
+         for (auto it = bstDest.begin(); it != bstDest.end(); ++it)
+            inOrder = inOrder && *it == expected++;
+         assertUnit(inOrder);
+         assertUnit(expected == num);
+      }  // exercise: destroy the copy
+      // teardown
+      bstSrc.clear();
+      assertUnit(bstSrc.root == nullptr);
+   }
+
    /***************************************
     * MOVE CONSTRUCTOR
     ***************************************/
@@ -302,7 +440,7 @@ public:
       //            (50b)
       custom::BST <Spy> bstSrc;
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
+      p50->setRed(false);
       bstSrc.root = p50;
       bstSrc.numElements = 1;
       Spy::reset();
@@ -331,10 +469,10 @@ public:
       if (bstDest.root)
       {
          assertUnit(bstDest.root->data == Spy(50));
-         assertUnit(bstDest.root->isRed == false);
+         assertUnit(bstDest.root->isRed() == false);
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->getParent() == nullptr);
       }
       // teardown
       if (bstDest.root)
@@ -378,6 +516,16 @@ public:
       teardownStandardFixture(bstDest);
    }
 
+   // moving never throws, so containers of trees may move them
+   void test_constructMove_noexcept()
+   {  // verify
+      assertUnit(std::is_nothrow_move_constructible <custom::BST <Spy> > ::value);
+      assertUnit(std::is_nothrow_move_assignable <custom::BST <Spy> > ::value);
+      assertUnit(std::is_nothrow_move_constructible <custom::pmr::BST <Spy> > ::value);
+      // a polymorphic allocator stays behind, so the elements may have to move one at a time
+      assertUnit(!std::is_nothrow_move_assignable <custom::pmr::BST <Spy> > ::value);
+   }
+
    // create a BST with an empty initializer list.
    void test_constructInitializer_empty()
    {  // setup
@@ -427,6 +575,91 @@ public:
       teardownStandardFixture(bstDest);
    }
 
+   // sorted input of every size is built balanced, with one comparison
+   // per element once it is too long to insert one at a time
+   void test_assignRange_sorted()
+   {
+      for (size_t num = 0; num < 100; num++)
+      {  // setup
+         std::vector <Spy> v;
+         for (size_t i = 0; i < num; i++)
+            v.push_back(Spy(int(i * 2)));
+         custom::BST <Spy> bst;
+         Spy::reset();
+         // exercise
+         bst.assign(v.begin(), v.end());
+         // verify
+         assertUnit(size_t(Spy::numCopy()) == num);
+         if (num >= custom::BST <Spy> ::numAssignSortMin)
+            assertUnit(size_t(Spy::numLessthan()) == num - 1);
+         assertUnit(bst.size() == num);
+         if (num == 0)
+            assertEmptyFixture(bst);
+         else
+         {
+            assertUnit(bst.root->getParent() == nullptr);
+            assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+            assertUnit(size_t(bst.root->computeSize()) == num);
+            assertUnit(bst.pRightmost != nullptr && bst.pRightmost->data.get() == int(num - 1) * 2);
+            int expected = 0;
+            for (auto it = bst.begin(); it != bst.end(); ++it, expected += 2)
+               assertUnit((*it).get() == expected);
+            assertUnit(expected == int(num) * 2);
+         }
+      }  // teardown
+   }
+
+   // out of order input with duplicates is sorted and, if asked, made unique
+   void test_assignRange_unsortedUnique()
+   {  // setup
+      std::vector <int> v{ 5, 3, 9, 3, 1, 5, 7, 9, 9 };
+      custom::BST <int> bst;
+      bst.insert(100);
+      // exercise
+      bst.assign(v.begin(), v.end(), true /*keepUnique*/);
+      // verify
+      assertUnit(bst.size() == 5);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 5);
+      std::vector <int> vActual;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         vActual.push_back(*it);
+      assertUnit(vActual == std::vector <int>({ 1, 3, 5, 7, 9 }));
+      assertUnit(bst.pRightmost && bst.pRightmost->data == 9);
+      // exercise
+      bst.assign(v.begin(), v.end());
+      // verify
+      assertUnit(bst.size() == 9);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+   }  // teardown
+
+   // a range too long to insert one at a time is sorted, then made unique
+   void test_assignRange_unsortedUniqueLong()
+   {  // setup
+      std::vector <int> v{ 5, 3, 9, 3, 1, 5, 7, 9, 9 };
+      v.insert(v.end(), v.begin(), v.end());
+      assert(v.size() >= custom::BST <int> ::numAssignSortMin);
+      custom::BST <int> bst;
+      bst.insert(100);
+      // exercise
+      bst.assign(v.begin(), v.end(), true /*keepUnique*/);
+      // verify
+      assertUnit(bst.size() == 5);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 5);
+      std::vector <int> vActual;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         vActual.push_back(*it);
+      assertUnit(vActual == std::vector <int>({ 1, 3, 5, 7, 9 }));
+      assertUnit(bst.pRightmost && bst.pRightmost->data == 9);
+      // exercise
+      bst.assign(v.begin(), v.end());
+      // verify
+      assertUnit(bst.size() == 18);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 18);
+   }  // teardown
+
 
 
    /***************************************
@@ -651,7 +884,7 @@ public:
       //                (99) = bstDest
       custom::BST <Spy> bstDest;
       custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
-      p99->isRed = false;
+      p99->setRed(false);
       bstDest.root = p99;
       bstDest.numElements = 1;
       Spy::reset();
@@ -693,7 +926,7 @@ public:
       //                (99) = bstSrc
       custom::BST <Spy> bstSrc;
       custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
-      p99->isRed = false;
+      p99->setRed(false);
       bstSrc.root = p99;
       bstSrc.numElements = 1;
       //                (50b) = bstSrc
@@ -724,8 +957,8 @@ public:
       if (bstSrc.root)
       {
          assertUnit(bstSrc.root->data == Spy(99));
-         assertUnit(bstSrc.root->isRed == false);
-         assertUnit(bstSrc.root->pParent == nullptr);
+         assertUnit(bstSrc.root->isRed() == false);
+         assertUnit(bstSrc.root->getParent() == nullptr);
          assertUnit(bstSrc.root->pLeft == nullptr);
          assertUnit(bstSrc.root->pRight == nullptr);
       }
@@ -734,8 +967,8 @@ public:
       if (bstDest.root)
       {
          assertUnit(bstDest.root->data == Spy(99));
-         assertUnit(bstDest.root->isRed == false);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->isRed() == false);
+         assertUnit(bstDest.root->getParent() == nullptr);
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
       }
@@ -795,6 +1028,91 @@ public:
    }
 
 
+   // a tree too small to be worth the threads is copied as usual
+   void test_assignParallel_small()
+   {  // setup
+      custom::BST <Spy> bstSrc;
+      setupStandardFixture(bstSrc);
+      custom::BST <Spy> bstDest;
+      setupStandardFixture(bstDest);
+      Spy::reset();
+      // exercise
+      bstDest.assignParallel(bstSrc, 4);
+      // verify
+      assertUnit(Spy::numAssign() == 7);      // assign [2][30][40][50][60][70][80]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertStandardFixture(bstSrc);
+      assertStandardFixture(bstDest);
+      // teardown
+      teardownStandardFixture(bstSrc);
+      teardownStandardFixture(bstDest);
+   }
+
+   // a large tree copied on several threads has the same shape and colors
+   void test_assignParallel_large()
+   {  // setup
+      custom::BST <int> bstSrc;
+      std::srand(12);
+      while (bstSrc.size() < 100000)
+         bstSrc.insert(std::rand() % 1000000, true /*keepUnique*/);
+      custom::BST <int> bstDest;
+      bstDest.insert(-1);
+      // exercise
+      bstDest.assignParallel(bstSrc, 4);
+      // verify
+      assertUnit(bstDest.size() == bstSrc.size());
+      assertUnit(bstDest.root != bstSrc.root);
+      assertUnit(bstDest.root->getParent() == nullptr);
+      assertUnit(bstDest.pRightmost && bstDest.pRightmost->data == bstSrc.pRightmost->data);
+      bool same = true;
+      auto itSrc = bstSrc.begin();
+      for (auto itDest = bstDest.begin(); itDest != bstDest.end(); ++itDest, ++itSrc)
+      {
+         const auto* pS = itSrc.pNode;
+         const auto* pD = itDest.pNode;
+         same = same && pS != pD && pS->data == pD->data && pS->isRed() == pD->isRed() &&
+            (pS->pLeft == nullptr) == (pD->pLeft == nullptr) &&
+            (pS->pRight == nullptr) == (pD->pRight == nullptr) &&
+            (pS->getParent() == nullptr) == (pD->getParent() == nullptr) &&
+            (pD->getParent() == nullptr || pD->getParent()->data == pS->getParent()->data) &&
+            (pD->pLeft == nullptr || pD->pLeft->getParent() == pD) &&
+            (pD->pRight == nullptr || pD->pRight->getParent() == pD);
+      }
+      assertUnit(same);
+      assertUnit(itSrc == bstSrc.end());
+      assertUnit(bstDest.root->verifyRedBlack(bstDest.root->findDepth()));
+   }  // teardown
+
+   // another thread can fill its own tree of the same type during a parallel copy
+   void test_assignParallel_otherThread()
+   {  // setup
+      custom::BST <int> bstSrc;
+      for (int i = 0; i < 100000; i++)
+         bstSrc.insert(i);
+      custom::BST <int> bstDest;
+      size_t numInUse = custom::BST <int> ::BNode::pool().size();
+      bool isValidOther = false;
+      // exercise
+      std::thread thread([&isValidOther]()
+      {
+         custom::BST <int> bstOther;
+         for (int i = 0; i < 50000; i++)
+            bstOther.insert(i * 7919 % 50000);
+         isValidOther = bstOther.size() == 50000 &&
+                        bstOther.root->verifyRedBlack(bstOther.root->findDepth());
+      });
+      bstDest.assignParallel(bstSrc, 4);
+      thread.join();
+      // verify
+      assertUnit(isValidOther);
+      assertUnit(bstDest.size() == 100000);
+      assertUnit(bstDest.root->verifyRedBlack(bstDest.root->findDepth()));
+      assertUnit(custom::BST <int> ::BNode::pool().size() ==
+                 numInUse + 100000 + bstDest.nodes.available());  // the workers kept no spares
+   }  // teardown
+
    /***************************************
     * Assignment-Move
     *    BST::operator=(BST &&)
@@ -897,7 +1215,7 @@ public:
       //                (99) = bstDest
       custom::BST <Spy> bstDest;
       custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
-      p99->isRed = false;
+      p99->setRed(false);
       bstDest.root = p99;
       bstDest.numElements = 1;
       Spy::reset();
@@ -932,7 +1250,7 @@ public:
       //                (99) = bstSrc
       custom::BST <Spy> bstSrc;
       custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
-      p99->isRed = false;
+      p99->setRed(false);
       bstSrc.root = p99;
       bstSrc.numElements = 1;
       //                (50b) = bstDest
@@ -963,8 +1281,8 @@ public:
       if (bstDest.root)
       {
          assertUnit(bstDest.root->data == Spy(99));
-         assertUnit(bstDest.root->isRed == false);
-         assertUnit(bstDest.root->pParent == nullptr);
+         assertUnit(bstDest.root->isRed() == false);
+         assertUnit(bstDest.root->getParent() == nullptr);
          assertUnit(bstDest.root->pLeft == nullptr);
          assertUnit(bstDest.root->pRight == nullptr);
       }
@@ -1051,7 +1369,7 @@ public:
       //                (99) = bstDest
       custom::BST <Spy> bstDest;
       custom::BST <Spy>::BNode* p99 = new custom::BST<Spy>::BNode(Spy(99));
-      p99->isRed = false;
+      p99->setRed(false);
       bstDest.root = p99;
       bstDest.numElements = 1;
       Spy::reset();
@@ -1265,6 +1583,80 @@ public:
       assertEmptyFixture(bst);
    }  // teardown
 
+   // a deferred clear leaves the freeing to the reclaimer's thread
+   void test_clear_deferred()
+   {  // setup
+      custom::BST <Spy> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(Spy(i));
+      bst.deferReclaim();
+      Spy::reset();
+      // exercise
+      bst.clear();
+      // verify
+      assertEmptyFixture(bst);
+      // exercise
+      custom::BST <Spy> ::flushReclaim();
+      // verify
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(Spy::numDelete() == 100);
+      assertUnit(custom::BST <Spy> ::numReclaimPending() == 0);
+   }  // teardown
+
+   // the elements of a deferred tree are destroyed on another thread
+   void test_clear_deferredThread()
+   {  // setup
+      custom::BST <WhereDestroyed> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(WhereDestroyed(i));
+      bst.deferReclaim();
+      WhereDestroyed::idLast = std::this_thread::get_id();
+      // exercise
+      bst.clear();
+      custom::BST <WhereDestroyed> ::flushReclaim();
+      // verify
+      assertUnit(WhereDestroyed::idLast != std::this_thread::get_id());
+      assertUnit(custom::BST <WhereDestroyed> ::numReclaimPending() == 0);
+      assertUnit(bst.root == nullptr);
+      assertUnit(bst.numElements == 0);
+   }  // teardown
+
+   // a small tree is not worth handing off
+   void test_clear_deferredSmall()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      bst.deferReclaim();
+      Spy::reset();
+      // exercise
+      bst.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 7);  // destroy  [20][30][40][50][60][70][80]
+      assertUnit(custom::BST <Spy> ::numReclaimPending() == 0);
+      assertEmptyFixture(bst);
+   }  // teardown
+
+   // a deferring tree going out of scope leaves its nodes to the reclaimer
+   void test_destructor_deferred()
+   {  // setup
+      {
+         custom::BST <Spy> bst;
+         for (int i = 0; i < 100; i++)
+            bst.insert(Spy(i));
+         bst.deferReclaim();
+         Spy::reset();
+      }  // exercise
+      custom::BST <Spy> ::flushReclaim();
+      // verify
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(custom::BST <Spy> ::numReclaimPending() == 0);
+   }
+
    /***************************************
     * Iterator
     *     BST::begin()
@@ -1367,6 +1759,141 @@ public:
       teardownStandardFixture(bst);
    }
 
+   // rbegin() from the standard fixture is the largest without a walk
+   void test_rbegin_standard()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST<Spy>::iterator it;
+      Spy::reset();
+      // exercise
+      it = bst.rbegin();
+      // verify
+      assertUnit(Spy::numLessthan() == 0);    // does not look at any element
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it.pNode == bst.root->pRight->pRight);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // step back from end() to the largest, and walk the whole tree backwards
+   void test_end_decrement()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      auto it = bst.end();
+      Spy::reset();
+      // exercise
+      --it;
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(it.pNode == bst.root->pRight->pRight);
+      int expected = 80;
+      for (; it != bst.end(); --it, expected -= 10)
+         assertUnit((*it).get() == expected);
+      assertUnit(expected == 10);
+      auto itLast = bst.find(Spy(80));
+      ++itLast;
+      --itLast;
+      assertUnit(itLast.pNode == bst.root->pRight->pRight);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // take from both ends until the tree is empty
+   void test_popFront_popBack()
+   {  // setup
+      custom::BST <Spy> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(Spy((i * 37) % 100));
+      bool valid = true;
+      int lo = 0;
+      int hi = 99;
+      Spy::reset();
+      // exercise
+      for (int i = 0; i < 50; i++)
+      {
+         valid = valid && (*bst.begin()).get() == lo && (*bst.rbegin()).get() == hi;
+         bst.popFront();
+         bst.popBack();
+         lo++;
+         hi--;
+         valid = valid && (bst.empty() || bst.root->verifyRedBlack(bst.root->findDepth()));
+      }
+      // verify
+      assertUnit(valid);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(bst.empty());
+      assertUnit(bst.root == nullptr);
+      assertUnit(bst.begin() == bst.end());
+      assertUnit(bst.rbegin() == bst.end());
+   }  // teardown
+
+   // the smallest node is kept track of through every way of changing the tree
+   void test_leftmost_randomChurn()
+   {  // setup
+      std::srand(2020);
+      custom::BST <int> bst;
+      bool valid = true;
+      auto check = [&valid](const custom::BST <int>& tree)
+      {
+         const custom::BST <int> ::BNode* pNode = tree.root;
+         while (pNode != nullptr && pNode->pLeft != nullptr)
+            pNode = pNode->pLeft;
+         valid = valid && tree.begin().pNode == pNode &&
+                 tree.rbegin().pNode == findRightmostNode(tree.root);
+      };
+      // exercise
+      for (int round = 0; round < 300; round++)
+      {
+         int value = std::rand() % 200;
+         switch (std::rand() % 6)
+         {
+            case 0:
+            case 1:
+               bst.insert(value);
+               break;
+            case 2:
+            {
+               auto it = bst.find(value);
+               bst.erase(it);
+               break;
+            }
+            case 3:
+               if (!bst.empty())
+                  bst.popFront();
+               break;
+            case 4:
+               bst.erase(bst.begin(), bst.lowerBound(value));
+               break;
+            default:
+            {
+               auto pairTrees = bst.split(value);
+               check(pairTrees.first);
+               check(pairTrees.second);
+               bst = custom::BST <int> ::join(std::move(pairTrees.first), std::move(pairTrees.second));
+            }
+         }
+         check(bst);
+      }
+      // verify
+      assertUnit(valid);
+   }  // teardown
+
    // increment where the next node is the parent
    void test_iterator_increment_standardToParent()
    {  // setup
@@ -1695,8 +2222,8 @@ public:
       // exercise
       it = bst.find(s);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][30][20]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][20] and confirm [20]
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1738,8 +2265,8 @@ public:
       // exercise
       it = bst.find(s);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][70][80]
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][70]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][70][80] and confirm [80]
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1781,8 +2308,8 @@ public:
       // exercise
       it = bst.find(s);
       // verify
-      assertUnit(Spy::numEquals() == 3);      // check [50][30][40]
-      assertUnit(Spy::numLessthan() == 3);    // compare [50][30][40]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][40] and reject [50]
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1800,94 +2327,262 @@ public:
 
 
 
-   /***************************************
-    * Insert
-    *    BST::insert(const T &)
-    ***************************************/
-
-   // insert an element to the right of a single-element tree
-   void test_insert_oneRight()
+   // a lookup costs one operator< per level plus one, and never operator==
+   void test_find_comparisons()
    {  // setup
-      //            (50b)
       custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
-      bst.root = p50;
-      bst.numElements = 1;
-      Spy s(60);
-      Spy::reset();
+      for (int i = 0; i < 1000; i++)
+         bst.insert(Spy((i * 7919) % 1000));
+      int height = computeHeight(bst.root);
+      bool fewComparisons = true;
       // exercise
-      auto pairBST = bst.insert(s);
-      // verify
-      assertUnit(Spy::numLessthan() == 1);    // compare [50]
-      assertUnit(Spy::numCopy() == 1);        // copy-create [60]
-      assertUnit(Spy::numAlloc() == 1);       // allocate [60]
-      assertUnit(Spy::numEquals() == 0);
-      assertUnit(Spy::numDestructor() == 0);
-      assertUnit(Spy::numDelete() == 0);
-      assertUnit(Spy::numAssign() == 0);
-      assertUnit(Spy::numDefault() == 0);
-      assertUnit(Spy::numNondefault() == 0);
-      assertUnit(Spy::numCopyMove() == 0);
-      assertUnit(Spy::numAssignMove() == 0);
-      assertUnit(pairBST.first != bst.end());
-      assertUnit(pairBST.second == true);
-      if (pairBST.first != bst.end())
-         assertUnit(*(pairBST.first) == Spy(60));
-      //           (50b)
-      //             +----+
-      //                 (60r)
-      assertUnit(bst.size() == 2);
-      assertUnit(bst.numElements == 2);
-      assertUnit(bst.root == p50);
-
-      assertUnit(p50 != nullptr);
-      if (p50)
+      for (int i = 0; i < 1000; i++)
       {
-         assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
-         assertUnit(p50->pLeft == nullptr);
-         assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         Spy s(i);
+         Spy::reset();
+         auto it = bst.find(s);
+         fewComparisons = fewComparisons && it != bst.end() && *it == s;
+         fewComparisons = fewComparisons && Spy::numLessthan() <= height + 1;
+         fewComparisons = fewComparisons && Spy::numEquals() == 1; // the *it == s above
       }
-      if (p50 && p50->pRight)
+      for (int i = 0; i < 1000; i++)
       {
-         assertUnit(p50->pRight->data == Spy(60));
-         assertUnit(p50->pRight->isRed == true);
-         assertUnit(p50->pRight->pLeft == nullptr);
-         assertUnit(p50->pRight->pRight == nullptr);
-         assertUnit(p50->pRight->pParent == p50);
+         Spy s(i);
+         Spy::reset();
+         auto pairBST = bst.insert(s, true /* keepUnique */);
+         fewComparisons = fewComparisons && pairBST.second == false;
+         fewComparisons = fewComparisons && Spy::numLessthan() <= height + 1;
+         fewComparisons = fewComparisons && Spy::numEquals() == 0;
       }
-      // teardown
-      if (p50 && p50->pRight && p50->pRight != p50)
-         delete p50->pRight;
-      if (p50)
-         delete p50;
-      bst.root = nullptr;
-      bst.numElements = 0;
-   }
+      // verify
+      assertUnit(fewComparisons);
+      assertUnit(bst.size() == 1000);
+   }  // teardown
 
-   // insert an element to the left of a single-element tree
-   void test_insert_oneLeft()
+   // a tree with a key extractor is searched by the key alone
+   void test_find_byKey()
    {  // setup
-      //            (50b)
-      custom::BST <Spy> bst;
-      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
-      bst.root = p50;
-      bst.numElements = 1;
-      Spy s(40);
+      struct KeyOfFirst
+      {
+         const int& operator () (const std::pair <int, Spy>& p) const { return p.first; }
+      };
+      custom::BST <std::pair <int, Spy>, std::allocator <std::pair <int, Spy> >,
+                   KeyOfFirst, std::less <int> > bst;
+      for (int i = 0; i < 7; i++)
+         bst.insert(std::make_pair((i * 3) % 7, Spy(i)), true /* keepUnique */);
       Spy::reset();
       // exercise
-      auto pairBST = bst.insert(s);
+      auto itFound = bst.find(5);
+      auto itMissing = bst.find(9);
+      auto pairBST = bst.insert(std::make_pair(5, Spy()), true /* keepUnique */);
       // verify
-      assertUnit(Spy::numLessthan() == 1);    // compare [50]
-      assertUnit(Spy::numCopy() == 1);        // copy-create [40]
-      assertUnit(Spy::numAlloc() == 1);       // allocate [40]
+      assertUnit(itFound != bst.end());
+      assertUnit((*itFound).first == 5);
+      assertUnit((*itFound).second.get() == 4);
+      assertUnit(itMissing == bst.end());
+      assertUnit(pairBST.second == false);
+      assertUnit(pairBST.first == itFound);
       assertUnit(Spy::numEquals() == 0);
-      assertUnit(Spy::numDestructor() == 0);
-      assertUnit(Spy::numDelete() == 0);
-      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numLessthan() == 0);    // only the int keys are compared
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(bst.size() == 7);
+   }  // teardown
+
+   /***************************************
+    * BOUNDS
+    *    BST::lowerBound(const key_type &)
+    *    BST::upperBound(const key_type &)
+    *    BST::equalRange(const key_type &)
+    *    BST::range(const key_type &, const key_type &)
+    ***************************************/
+
+   // the first element not before the key
+   void test_lowerBound_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy::reset();
+      // exercise
+      auto it40 = bst.lowerBound(Spy(40));
+      auto it45 = bst.lowerBound(Spy(45));
+      // verify
+      assertUnit(Spy::numLessthan() <= 6);
+      assertUnit(it40 != bst.end() && *it40 == Spy(40));
+      assertUnit(it45 != bst.end() && *it45 == Spy(50));
+      assertUnit(bst.lowerBound(Spy(10)) == bst.begin());
+      assertUnit(bst.lowerBound(Spy(90)) == bst.end());
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // the first element after the key
+   void test_upperBound_standard()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      // exercise
+      auto it40 = bst.upperBound(Spy(40));
+      auto it45 = bst.upperBound(Spy(45));
+      // verify
+      assertUnit(it40 != bst.end() && *it40 == Spy(50));
+      assertUnit(it45 != bst.end() && *it45 == Spy(50));
+      assertUnit(bst.upperBound(Spy(10)) == bst.begin());
+      assertUnit(bst.upperBound(Spy(80)) == bst.end());
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // all the copies of a key, wherever they ended up in the tree
+   void test_equalRange_duplicates()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 20; i++)
+         bst.insert(i % 5);
+      // exercise
+      auto pairRange = bst.equalRange(3);
+      // verify
+      int num = 0;
+      for (auto it = pairRange.first; it != pairRange.second; ++it)
+         num += (*it == 3 ? 1 : 100);
+      assertUnit(num == 4);
+      assertUnit(pairRange.first == bst.lowerBound(3));
+      assertUnit(pairRange.second == bst.upperBound(3));
+      assertUnit(pairRange.second != bst.end() && *pairRange.second == 4);
+   }  // teardown
+
+   // a missing key gives an empty range where it would go
+   void test_equalRange_missing()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      // exercise
+      auto pairRange = bst.equalRange(Spy(55));
+      auto pairEnd = bst.equalRange(Spy(99));
+      // verify
+      assertUnit(pairRange.first == pairRange.second);
+      assertUnit(pairRange.first != bst.end() && *pairRange.first == Spy(60));
+      assertUnit(pairEnd.first == bst.end() && pairEnd.second == bst.end());
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // walking a range compares no keys
+   void test_range_noComparisons()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      auto range = bst.range(Spy(25), Spy(70));
+      Spy::reset();
+      std::vector <int> values;
+      // exercise
+      for (const Spy& s : range)
+         values.push_back(s.get());
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(values == std::vector <int> ({ 30, 40, 50, 60 }));
+      assertUnit(bst.range(Spy(70), Spy(25)).empty());
+      assertUnit(bst.range(Spy(41), Spy(49)).empty());
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   /***************************************
+    * Insert
+    *    BST::insert(const T &)
+    ***************************************/
+
+   // insert an element to the right of a single-element tree
+   void test_insert_oneRight()
+   {  // setup
+      //            (50b)
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      p50->setRed(false);
+      bst.root = p50;
+      bst.numElements = 1;
+      Spy s(60);
+      Spy::reset();
+      // exercise
+      auto pairBST = bst.insert(s);
+      // verify
+      assertUnit(Spy::numLessthan() == 1);    // compare [50]
+      assertUnit(Spy::numCopy() == 1);        // copy-create [60]
+      assertUnit(Spy::numAlloc() == 1);       // allocate [60]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(pairBST.first != bst.end());
+      assertUnit(pairBST.second == true);
+      if (pairBST.first != bst.end())
+         assertUnit(*(pairBST.first) == Spy(60));
+      //           (50b)
+      //             +----+
+      //                 (60r)
+      assertUnit(bst.size() == 2);
+      assertUnit(bst.numElements == 2);
+      assertUnit(bst.root == p50);
+
+      assertUnit(p50 != nullptr);
+      if (p50)
+      {
+         assertUnit(p50->data == Spy(50));
+         assertUnit(p50->isRed() == false);
+         assertUnit(p50->pLeft == nullptr);
+         assertUnit(p50->pRight != nullptr);
+         assertUnit(p50->getParent() == nullptr);
+      }
+      if (p50 && p50->pRight)
+      {
+         assertUnit(p50->pRight->data == Spy(60));
+         assertUnit(p50->pRight->isRed() == true);
+         assertUnit(p50->pRight->pLeft == nullptr);
+         assertUnit(p50->pRight->pRight == nullptr);
+         assertUnit(p50->pRight->getParent() == p50);
+      }
+      // teardown
+      if (p50 && p50->pRight && p50->pRight != p50)
+         delete p50->pRight;
+      if (p50)
+         delete p50;
+      bst.root = nullptr;
+      bst.numElements = 0;
+   }
+
+   // insert an element to the left of a single-element tree
+   void test_insert_oneLeft()
+   {  // setup
+      //            (50b)
+      custom::BST <Spy> bst;
+      custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
+      p50->setRed(false);
+      bst.root = p50;
+      bst.numElements = 1;
+      Spy s(40);
+      Spy::reset();
+      // exercise
+      auto pairBST = bst.insert(s);
+      // verify
+      assertUnit(Spy::numLessthan() == 1);    // compare [50]
+      assertUnit(Spy::numCopy() == 1);        // copy-create [40]
+      assertUnit(Spy::numAlloc() == 1);       // allocate [40]
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
@@ -1908,19 +2603,19 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft != nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p50 && p50->pLeft)
       {
          assertUnit(p50->pLeft->data == Spy(40));
-         assertUnit(p50->pLeft->isRed == true);
+         assertUnit(p50->pLeft->isRed() == true);
          assertUnit(p50->pLeft->pLeft == nullptr);
          assertUnit(p50->pLeft->pRight == nullptr);
-         assertUnit(p50->pLeft->pParent == p50);
+         assertUnit(p50->pLeft->getParent() == p50);
       }
 
       // teardown
@@ -1938,7 +2633,7 @@ public:
       //            (50b)
       custom::BST <Spy> bst;
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
+      p50->setRed(false);
       bst.root = p50;
       bst.numElements = 1;
       Spy s(50);
@@ -1972,19 +2667,19 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p50 && p50->pRight)
       {
          assertUnit(p50->pRight->data == Spy(50));
-         assertUnit(p50->pRight->isRed == true);
+         assertUnit(p50->pRight->isRed() == true);
          assertUnit(p50->pRight->pLeft == nullptr);
          assertUnit(p50->pRight->pRight == nullptr);
-         assertUnit(p50->pRight->pParent == p50);
+         assertUnit(p50->pRight->getParent() == p50);
       }
 
       // teardown
@@ -2011,8 +2706,8 @@ public:
       // exercise
       auto pairBST = bst.insert(s, true /* keepUnique */);
       // verify
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
-      assertUnit(Spy::numEquals() == 3);      // compare [50][30][40]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][40] and confirm [40]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2048,7 +2743,7 @@ public:
       //            (50b)
       custom::BST <Spy> bst;
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
+      p50->setRed(false);
       bst.root = p50;
       bst.numElements = 1;
       Spy s(60);
@@ -2082,18 +2777,18 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
       if (p50 && p50->pRight)
       {
          assertUnit(p50->pRight->data == Spy(60));
-         assertUnit(p50->pRight->isRed == true);
+         assertUnit(p50->pRight->isRed() == true);
          assertUnit(p50->pRight->pLeft == nullptr);
          assertUnit(p50->pRight->pRight == nullptr);
-         assertUnit(p50->pRight->pParent == p50);
+         assertUnit(p50->pRight->getParent() == p50);
       }
       // teardown
       if (p50 && p50->pRight && p50->pRight != p50)
@@ -2110,7 +2805,7 @@ public:
       //            (50b)
       custom::BST <Spy> bst;
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
+      p50->setRed(false);
       bst.root = p50;
       bst.numElements = 1;
       Spy s(40);
@@ -2146,19 +2841,19 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft != nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p50 && p50->pLeft)
       {
          assertUnit(p50->pLeft->data == Spy(40));
-         assertUnit(p50->pLeft->isRed == true);
+         assertUnit(p50->pLeft->isRed() == true);
          assertUnit(p50->pLeft->pLeft == nullptr);
          assertUnit(p50->pLeft->pRight == nullptr);
-         assertUnit(p50->pLeft->pParent == p50);
+         assertUnit(p50->pLeft->getParent() == p50);
       }
 
       // teardown
@@ -2176,7 +2871,7 @@ public:
       //            (50b)
       custom::BST <Spy> bst;
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
+      p50->setRed(false);
       bst.root = p50;
       bst.numElements = 1;
       Spy s(50);
@@ -2211,19 +2906,19 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight != nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p50 && p50->pRight)
       {
          assertUnit(p50->pRight->data == Spy(50));
-         assertUnit(p50->pRight->isRed == true);
+         assertUnit(p50->pRight->isRed() == true);
          assertUnit(p50->pRight->pLeft == nullptr);
          assertUnit(p50->pRight->pRight == nullptr);
-         assertUnit(p50->pRight->pParent == p50);
+         assertUnit(p50->pRight->getParent() == p50);
       }
 
       // teardown
@@ -2250,8 +2945,8 @@ public:
       // exercise
       auto pairBST = bst.insert(std::move(s), true /* keepUnique */);
       // verify
-      assertUnit(Spy::numLessthan() == 2);    // compare [50][30]
-      assertUnit(Spy::numEquals() == 3);      // compare [50][30][40]
+      assertUnit(Spy::numLessthan() == 4);    // compare [50][30][40] and confirm [40]
+      assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDestructor() == 0);
@@ -2276,6 +2971,163 @@ public:
       teardownStandardFixture(bst);
    }
 
+   /***************************************
+    * Emplace
+    *    BST::emplace(Args &&...)
+    ***************************************/
+
+   // the value is built right in its node
+   void test_emplace_one()
+   {  // setup
+      custom::BST <Spy> bst;
+      Spy::reset();
+      // exercise
+      auto pairBST = bst.emplace(50);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [50] in place
+      assertUnit(Spy::numAlloc() == 1);       // allocate [50]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(pairBST.second == true);
+      assertUnit(pairBST.first != bst.end());
+      assertUnit(bst.size() == 1);
+      assertUnit(bst.root != nullptr);
+      if (bst.root)
+      {
+         assertUnit(bst.root->data.get() == 50);
+         assertUnit(bst.root->isRed() == false);
+      }
+   }  // teardown
+
+   // a duplicate is built, found out, and thrown away
+   void test_emplace_keepUnique()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy::reset();
+      // exercise
+      auto pairBST = bst.emplaceUnique(40);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [40]
+      assertUnit(Spy::numDestructor() == 1);  // and throw it away
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(pairBST.second == false);
+      assertUnit(pairBST.first != bst.end());
+      if (pairBST.first != bst.end())
+         assertUnit((*pairBST.first).get() == 40);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   /***************************************
+    * Insert with a hint
+    *    BST::insert(iterator, const T &)
+    ***************************************/
+
+   // a good hint means only the two neighbors are compared
+   void test_insertHint_exact()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      auto itHint = bst.find(Spy(60));
+      Spy s(55);
+      Spy::reset();
+      // exercise
+      auto pairBST = bst.insert(itHint, s);
+      // verify
+      assertUnit(Spy::numLessthan() == 2);    // compare [60] and [50]
+      assertUnit(Spy::numCopy() == 1);        // copy [55]
+      assertUnit(pairBST.second == true);
+      assertUnit(pairBST.first != bst.end());
+      if (bst.root && bst.root->pRight && bst.root->pRight->pLeft)
+      {
+         assertUnit(pairBST.first.pNode == bst.root->pRight->pLeft->pLeft);
+         assertUnit(pairBST.first.pNode->getParent() == bst.root->pRight->pLeft);
+      }
+      assertUnit(bst.size() == 8);
+      // teardown
+      bst.clear();
+   }
+
+   // a bad hint still puts the value in the right place
+   void test_insertHint_wrong()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      auto itHint = bst.find(Spy(20));
+      // exercise
+      auto pairBST = bst.insert(itHint, Spy(65));
+      auto pairDuplicate = bst.insert(itHint, Spy(40), true /* keepUnique */);
+      // verify
+      assertUnit(pairBST.second == true);
+      assertUnit(pairDuplicate.second == false);
+      assertUnit(pairDuplicate.first == bst.find(Spy(40)));
+      std::vector <int> values;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         values.push_back((*it).get());
+      assertUnit(values == std::vector <int> ({ 20, 30, 40, 50, 60, 65, 70, 80 }));
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      // teardown
+      bst.clear();
+   }
+
+   // end() is the hint for appending
+   void test_insertHint_end()
+   {  // setup
+      custom::BST <Spy> bst;
+      bst.insert(Spy(10));
+      bst.insert(Spy(20));
+      Spy s(30);
+      Spy::reset();
+      // exercise
+      auto pairBST = bst.insert(bst.end(), s);
+      // verify
+      assertUnit(Spy::numLessthan() == 1);    // compare [20]
+      assertUnit(pairBST.second == true);
+      assertUnit(bst.pRightmost == pairBST.first.pNode);
+      assertUnit(bst.size() == 3);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+   }  // teardown
+
+   // keys arriving in order are appended without searching
+   void test_insert_inOrder()
+   {  // setup
+      custom::BST <Spy> bst;
+      for (int i = 0; i < 3; i++)
+         bst.insert(Spy(i));
+      Spy::reset();
+      // exercise
+      for (int i = 3; i < 1000; i++)
+         bst.insert(Spy(i));
+      // verify
+      assertUnit(Spy::numLessthan() == 997);  // one comparison each
+      assertUnit(bst.size() == 1000);
+      assertUnit(bst.pRightmost != nullptr);
+      if (bst.pRightmost)
+         assertUnit(bst.pRightmost->data.get() == 999);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(computeHeight(bst.root) <= 2 * 10);
+      // teardown
+   }
+
 
    /***************************************
     * Insert Balancing
@@ -2308,10 +3160,10 @@ public:
       if (bst.root)
       { 
          assertUnit(bst.root->data == Spy(50));
-         assertUnit(bst.root->isRed == false);
+         assertUnit(bst.root->isRed() == false);
          assertUnit(bst.root->pLeft == nullptr);
          assertUnit(bst.root->pRight == nullptr);
-         assertUnit(bst.root->pParent == nullptr);
+         assertUnit(bst.root->getParent() == nullptr);
       }
       // teardown
       delete bst.root;
@@ -2325,7 +3177,7 @@ public:
       //            (50b)
       custom::BST <Spy> bst;
       custom::BST<Spy>::BNode *p50 = new custom::BST<Spy>::BNode(Spy(50));
-      p50->isRed = false;
+      p50->setRed(false);
       bst.root = p50;
       bst.numElements = 1;
       Spy s(30);
@@ -2355,19 +3207,19 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft != nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p50 && p50->pLeft)
       {
-         assertUnit(p50->pLeft->isRed == true);
+         assertUnit(p50->pLeft->isRed() == true);
          assertUnit(p50->pLeft->data == Spy(30));
          assertUnit(p50->pLeft->pLeft == nullptr);
          assertUnit(p50->pLeft->pLeft == nullptr);
-         assertUnit(p50->pLeft->pParent == bst.root);
+         assertUnit(p50->pLeft->getParent() == bst.root);
       }
 
       // teardown
@@ -2391,10 +3243,12 @@ public:
 
       p50->pLeft  = p30;
       p50->pRight = p70;
-      p70->pParent = p30->pParent = p50;
+      p70->setParent(p50);
+      p30->setParent(p50);
 
-      p50->isRed = false;
-      p30->isRed = p70->isRed = true;
+      p50->setRed(false);
+      p30->setRed(true);
+      p70->setRed(true);
 
       custom::BST <Spy> bst;
       bst.root = p50;
@@ -2431,37 +3285,37 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == p30);
          assertUnit(p50->pRight == p70);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p30)
       {
          assertUnit(p30->data == Spy(30));
-         assertUnit(p30->isRed == false);
+         assertUnit(p30->isRed() == false);
          assertUnit(p30->pLeft != nullptr);
          assertUnit(p30->pRight == nullptr);
-         assertUnit(p30->pParent == p50);
+         assertUnit(p30->getParent() == p50);
       }
 
       if (p70)
       {
          assertUnit(p70->data == Spy(70));
-         assertUnit(p70->isRed == false);
+         assertUnit(p70->isRed() == false);
          assertUnit(p70->pLeft == nullptr);
          assertUnit(p70->pRight == nullptr);
-         assertUnit(p70->pParent == p50);
+         assertUnit(p70->getParent() == p50);
       }
 
       if (p30 && p30->pLeft)
       {
          assertUnit(p30->pLeft->data == Spy(20));
-         assertUnit(p30->pLeft->isRed == true);
+         assertUnit(p30->pLeft->isRed() == true);
          assertUnit(p30->pLeft->pLeft == nullptr);
          assertUnit(p30->pLeft->pRight == nullptr);
-         assertUnit(p30->pLeft->pParent == p30);
+         assertUnit(p30->pLeft->getParent() == p30);
       }
       // teardown
       if (p30->pLeft && p30->pLeft != p30)
@@ -2486,10 +3340,10 @@ public:
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
 
       p50->pLeft   = p30;
-      p30->pParent = p50;
+      p30->setParent(p50);
 
-      p50->isRed = false;
-      p30->isRed = true;
+      p50->setRed(false);
+      p30->setRed(true);
 
       custom::BST <Spy> bst;
       bst.root = p50;
@@ -2524,28 +3378,28 @@ public:
       if (p30)
       {
          assertUnit(p30->data == Spy(30));
-         assertUnit(p30->isRed == false);
+         assertUnit(p30->isRed() == false);
          assertUnit(p30->pLeft != nullptr);
          assertUnit(p30->pRight == p50);
-         assertUnit(p30->pParent == nullptr);
+         assertUnit(p30->getParent() == nullptr);
       }
 
       if (p30 && p30->pLeft)
       {
          assertUnit(p30->pLeft->data == Spy(10));
-         assertUnit(p30->pLeft->isRed == true);
+         assertUnit(p30->pLeft->isRed() == true);
          assertUnit(p30->pLeft->pLeft == nullptr);
          assertUnit(p30->pLeft->pRight == nullptr);
-         assertUnit(p30->pLeft->pParent == p30);
+         assertUnit(p30->pLeft->getParent() == p30);
       }
 
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == true);
+         assertUnit(p50->isRed() == true);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == p30);
+         assertUnit(p50->getParent() == p30);
       }
 
       // teardown
@@ -2569,10 +3423,10 @@ public:
       custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
 
       p50->pRight = p70;
-      p70->pParent = p50;
+      p70->setParent(p50);
 
-      p50->isRed = false;
-      p70->isRed = true;
+      p50->setRed(false);
+      p70->setRed(true);
 
       custom::BST <Spy> bst;
       bst.root = p50;
@@ -2607,28 +3461,28 @@ public:
       if (p70)
       {
          assertUnit(p70->data == Spy(70));
-         assertUnit(p70->isRed == false);
+         assertUnit(p70->isRed() == false);
          assertUnit(p70->pLeft == p50);
          assertUnit(p70->pRight != nullptr);
-         assertUnit(p70->pParent == nullptr);
+         assertUnit(p70->getParent() == nullptr);
       }
 
       if (p70->pRight)
       {
          assertUnit(p70->pRight->data == Spy(90));
-         assertUnit(p70->pRight->isRed == true);
+         assertUnit(p70->pRight->isRed() == true);
          assertUnit(p70->pRight->pLeft == nullptr);
          assertUnit(p70->pRight->pRight == nullptr);
-         assertUnit(p70->pRight->pParent == p70);
+         assertUnit(p70->pRight->getParent() == p70);
       }
 
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == true);
+         assertUnit(p50->isRed() == true);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == p70);
+         assertUnit(p50->getParent() == p70);
       }
       
       // teardown
@@ -2652,10 +3506,10 @@ public:
       custom::BST<Spy>::BNode* p50 = new custom::BST<Spy>::BNode(Spy(50));
 
       p50->pLeft = p30;
-      p30->pParent = p50;
+      p30->setParent(p50);
 
-      p30->isRed = true;
-      p50->isRed = false;
+      p30->setRed(true);
+      p50->setRed(false);
 
       custom::BST <Spy> bst;
       bst.root = p50;
@@ -2690,28 +3544,28 @@ public:
       if (bst.root)
       {
          assertUnit(bst.root->data == Spy(40));
-         assertUnit(bst.root->isRed == false);
+         assertUnit(bst.root->isRed() == false);
          assertUnit(bst.root->pLeft == p30);
          assertUnit(bst.root->pRight == p50);
-         assertUnit(bst.root->pParent == nullptr);
+         assertUnit(bst.root->getParent() == nullptr);
       }
 
       if (p30)
       {
          assertUnit(p30->data == Spy(30));
-         assertUnit(p30->isRed == true);
+         assertUnit(p30->isRed() == true);
          assertUnit(p30->pLeft == nullptr);
          assertUnit(p30->pRight == nullptr);
-         assertUnit(p30->pParent == bst.root);
+         assertUnit(p30->getParent() == bst.root);
       }
 
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == true);
+         assertUnit(p50->isRed() == true);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == bst.root);
+         assertUnit(p50->getParent() == bst.root);
       }
 
       // teardown
@@ -2733,10 +3587,10 @@ public:
       custom::BST<Spy>::BNode* p70 = new custom::BST<Spy>::BNode(Spy(70));
 
       p50->pRight = p70;
-      p70->pParent = p50;
+      p70->setParent(p50);
 
-      p70->isRed = true;
-      p50->isRed = false;
+      p70->setRed(true);
+      p50->setRed(false);
 
       custom::BST <Spy> bst;
       bst.root = p50;
@@ -2771,29 +3625,29 @@ public:
       if (bst.root)
       {
          assertUnit(bst.root->data == Spy(60));
-         assertUnit(bst.root->isRed == false);
+         assertUnit(bst.root->isRed() == false);
          assertUnit(bst.root->pLeft == p50);
          assertUnit(bst.root->pRight == p70);
-         assertUnit(bst.root->pParent == nullptr);
+         assertUnit(bst.root->getParent() == nullptr);
       }
 
       if (p50)
       {
 
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == true);
+         assertUnit(p50->isRed() == true);
          assertUnit(p50->pLeft == nullptr);
          assertUnit(p50->pRight == nullptr);
-         assertUnit(p50->pParent == bst.root);
+         assertUnit(p50->getParent() == bst.root);
       }
 
       if (p70)
       {
          assertUnit(p70->data == Spy(70));
-         assertUnit(p70->isRed == true);
+         assertUnit(p70->isRed() == true);
          assertUnit(p70->pLeft == nullptr);
          assertUnit(p70->pRight == nullptr);
-         assertUnit(p70->pParent == bst.root);
+         assertUnit(p70->getParent() == bst.root);
       }
       // teardown
       if (p50)
@@ -2820,11 +3674,14 @@ public:
       p50->pLeft  = p30;
       p50->pRight = p70;
       p30->pLeft  = p20;
-      p70->pParent = p30->pParent = p50;
-      p20->pParent = p30;
+      p70->setParent(p50);
+      p30->setParent(p50);
+      p20->setParent(p30);
 
-      p20->isRed = true;
-      p30->isRed = p70->isRed = p50->isRed = false;
+      p20->setRed(true);
+      p30->setRed(false);
+      p70->setRed(false);
+      p50->setRed(false);
 
       custom::BST <Spy> bst;
       bst.root = p50;
@@ -2861,46 +3718,46 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == p20);
          assertUnit(p50->pRight == p70);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p20)
       {
          assertUnit(p20->data == Spy(20));
-         assertUnit(p20->isRed == false);
+         assertUnit(p20->isRed() == false);
          assertUnit(p20->pLeft != nullptr);
          assertUnit(p20->pRight == p30);
-         assertUnit(p20->pParent == p50);
+         assertUnit(p20->getParent() == p50);
       }
 
       if (p70)
       {
          assertUnit(p70->data == Spy(70));
-         assertUnit(p70->isRed == false);
+         assertUnit(p70->isRed() == false);
          assertUnit(p70->pLeft == nullptr);
          assertUnit(p70->pRight == nullptr);
-         assertUnit(p70->pParent == p50);
+         assertUnit(p70->getParent() == p50);
       }
 
       if (p30)
       {
          assertUnit(p30->data == Spy(30));
-         assertUnit(p30->isRed == true);
+         assertUnit(p30->isRed() == true);
          assertUnit(p30->pLeft == nullptr);
          assertUnit(p30->pRight == nullptr);
-         assertUnit(p30->pParent == p20);
+         assertUnit(p30->getParent() == p20);
       }
 
       if (p20 && p20->pLeft)
       {
          assertUnit(p20->pLeft->data == Spy(10));
-         assertUnit(p20->pLeft->isRed == true);
+         assertUnit(p20->pLeft->isRed() == true);
          assertUnit(p20->pLeft->pLeft == nullptr);
          assertUnit(p20->pLeft->pRight == nullptr);
-         assertUnit(p20->pLeft->pParent == p20);
+         assertUnit(p20->pLeft->getParent() == p20);
       }
 
       // teardown
@@ -2934,11 +3791,14 @@ public:
       p50->pLeft = p30;
       p50->pRight = p70;
       p70->pRight = p80;
-      p70->pParent = p30->pParent = p50;
-      p80->pParent = p70;
+      p70->setParent(p50);
+      p30->setParent(p50);
+      p80->setParent(p70);
 
-      p80->isRed = true;
-      p30->isRed = p70->isRed = p50->isRed = false;
+      p80->setRed(true);
+      p30->setRed(false);
+      p70->setRed(false);
+      p50->setRed(false);
 
       custom::BST <Spy> bst;
       bst.root = p50;
@@ -2975,46 +3835,46 @@ public:
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == p30);
          assertUnit(p50->pRight == p80);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p30)
       {
          assertUnit(p30->data == Spy(30));
-         assertUnit(p30->isRed == false);
+         assertUnit(p30->isRed() == false);
          assertUnit(p30->pLeft == nullptr);
          assertUnit(p30->pRight == nullptr);
-         assertUnit(p30->pParent == p50);
+         assertUnit(p30->getParent() == p50);
       }
 
       if (p80)
       {
          assertUnit(p80->data == Spy(80));
-         assertUnit(p80->isRed == false);
+         assertUnit(p80->isRed() == false);
          assertUnit(p80->pLeft == p70);
          assertUnit(p80->pRight != nullptr);
-         assertUnit(p80->pParent == p50);
+         assertUnit(p80->getParent() == p50);
       }
 
       if (p70)
       {
          assertUnit(p70->data == Spy(70));
-         assertUnit(p70->isRed == true);
+         assertUnit(p70->isRed() == true);
          assertUnit(p70->pLeft == nullptr);
          assertUnit(p70->pRight == nullptr);
-         assertUnit(p70->pParent == p80);
+         assertUnit(p70->getParent() == p80);
       }
 
       if (p80 && p80->pRight)
       {
          assertUnit(p80->pRight->data == Spy(90));
-         assertUnit(p80->pRight->isRed == true);
+         assertUnit(p80->pRight->isRed() == true);
          assertUnit(p80->pRight->pLeft == nullptr);
          assertUnit(p80->pRight->pRight == nullptr);
-         assertUnit(p80->pRight->pParent == p80);
+         assertUnit(p80->pRight->getParent() == p80);
       }
 
       // teardown
@@ -3056,12 +3916,20 @@ public:
       p50->pRight = p60;
       p70->pLeft  = p20;
       p70->pRight = p80;
-      p30->pParent = p60->pParent = p50;
-      p10->pParent = p50->pParent = p20;
-      p20->pParent = p80->pParent = p70;
-
-      p20->isRed = p30->isRed = p60->isRed = true;
-      p10->isRed = p50->isRed = p70->isRed = p80->isRed = false;
+      p30->setParent(p50);
+      p60->setParent(p50);
+      p10->setParent(p20);
+      p50->setParent(p20);
+      p20->setParent(p70);
+      p80->setParent(p70);
+
+      p20->setRed(true);
+      p30->setRed(true);
+      p60->setRed(true);
+      p10->setRed(false);
+      p50->setRed(false);
+      p70->setRed(false);
+      p80->setRed(false);
 
       custom::BST <Spy> bst;
       bst.root = p70;
@@ -3100,73 +3968,73 @@ public:
       if (p10)
       {
          assertUnit(p10->data == Spy(10));
-         assertUnit(p10->isRed == false);
+         assertUnit(p10->isRed() == false);
          assertUnit(p10->pLeft == nullptr);
          assertUnit(p10->pRight == nullptr);
-         assertUnit(p10->pParent == p20);
+         assertUnit(p10->getParent() == p20);
       }
 
       if (p20)
       {
          assertUnit(p20->data == Spy(20));
-         assertUnit(p20->isRed == true);
+         assertUnit(p20->isRed() == true);
          assertUnit(p20->pLeft == p10);
          assertUnit(p20->pRight == p30);
-         assertUnit(p20->pParent == p50);
+         assertUnit(p20->getParent() == p50);
       }
 
       if (p30)
       {
          assertUnit(p30->data == Spy(30));
-         assertUnit(p30->isRed == false);
+         assertUnit(p30->isRed() == false);
          assertUnit(p30->pLeft == nullptr);
          assertUnit(p30->pRight != nullptr);
-         assertUnit(p30->pParent == p20);
+         assertUnit(p30->getParent() == p20);
       }
 
       if (p30 && p30->pRight)
       {
          assertUnit(p30->pRight->data == Spy(40));
-         assertUnit(p30->pRight->isRed == true);
+         assertUnit(p30->pRight->isRed() == true);
          assertUnit(p30->pRight->pLeft == nullptr);
          assertUnit(p30->pRight->pRight == nullptr);
-         assertUnit(p30->pRight->pParent == p30);
+         assertUnit(p30->pRight->getParent() == p30);
       }
 
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == p20);
          assertUnit(p50->pRight == p70);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p60)
       {
          assertUnit(p60->data == Spy(60));
-         assertUnit(p60->isRed == false);
+         assertUnit(p60->isRed() == false);
          assertUnit(p60->pLeft == nullptr);
          assertUnit(p60->pRight == nullptr);
-         assertUnit(p60->pParent == p70);
+         assertUnit(p60->getParent() == p70);
       }
 
       if (p70)
       {
          assertUnit(p70->data == Spy(70));
-         assertUnit(p70->isRed == true);
+         assertUnit(p70->isRed() == true);
          assertUnit(p70->pLeft == p60);
          assertUnit(p70->pRight == p80);
-         assertUnit(p70->pParent == p50);
+         assertUnit(p70->getParent() == p50);
       }
 
       if (p80)
       {
          assertUnit(p80->data == Spy(80));
-         assertUnit(p80->isRed == false);
+         assertUnit(p80->isRed() == false);
          assertUnit(p80->pLeft == nullptr);
          assertUnit(p80->pRight == nullptr);
-         assertUnit(p80->pParent == p70);
+         assertUnit(p80->getParent() == p70);
       }
       // teardown
       if (p30 && p30->pRight && p30->pRight != p30)
@@ -3213,12 +4081,20 @@ public:
       p50->pRight = p70;
       p80->pLeft  = p50;
       p80->pRight = p90;
-      p40->pParent = p70->pParent = p50;
-      p50->pParent = p90->pParent = p80;
-      p20->pParent = p80->pParent = p30;
-
-      p40->isRed = p70->isRed = p80->isRed = true;
-      p20->isRed = p30->isRed = p50->isRed = p90->isRed = false;
+      p40->setParent(p50);
+      p70->setParent(p50);
+      p50->setParent(p80);
+      p90->setParent(p80);
+      p20->setParent(p30);
+      p80->setParent(p30);
+
+      p40->setRed(true);
+      p70->setRed(true);
+      p80->setRed(true);
+      p20->setRed(false);
+      p30->setRed(false);
+      p50->setRed(false);
+      p90->setRed(false);
 
       custom::BST <Spy> bst;
       bst.root = p30;
@@ -3257,73 +4133,73 @@ public:
       if (p20)
       {
          assertUnit(p20->data == Spy(20));
-         assertUnit(p20->isRed == false);
+         assertUnit(p20->isRed() == false);
          assertUnit(p20->pLeft == nullptr);
          assertUnit(p20->pRight == nullptr);
-         assertUnit(p20->pParent == p30);
+         assertUnit(p20->getParent() == p30);
       }
 
       if (p30)
       {
          assertUnit(p30->data == Spy(30));
-         assertUnit(p30->isRed == true);
+         assertUnit(p30->isRed() == true);
          assertUnit(p30->pLeft == p20);
          assertUnit(p30->pRight == p40);
-         assertUnit(p30->pParent == p50);
+         assertUnit(p30->getParent() == p50);
       }
 
       if (p40)
       {
          assertUnit(p40->data == Spy(40));
-         assertUnit(p40->isRed == false);
+         assertUnit(p40->isRed() == false);
          assertUnit(p40->pLeft == nullptr);
          assertUnit(p40->pRight == nullptr);
-         assertUnit(p40->pParent == p30);
+         assertUnit(p40->getParent() == p30);
       }
 
       if (p50)
       {
          assertUnit(p50->data == Spy(50));
-         assertUnit(p50->isRed == false);
+         assertUnit(p50->isRed() == false);
          assertUnit(p50->pLeft == p30);
          assertUnit(p50->pRight == p80);
-         assertUnit(p50->pParent == nullptr);
+         assertUnit(p50->getParent() == nullptr);
       }
 
       if (p70 && p70->pLeft)
       {
          assertUnit(p70->pLeft->data == Spy(60));
-         assertUnit(p70->pLeft->isRed == true);
+         assertUnit(p70->pLeft->isRed() == true);
          assertUnit(p70->pLeft->pLeft == nullptr);
          assertUnit(p70->pLeft->pRight == nullptr);
-         assertUnit(p70->pLeft->pParent == p70);
+         assertUnit(p70->pLeft->getParent() == p70);
       }
 
       if (p70)
       {
          assertUnit(p70->data == Spy(70));
-         assertUnit(p70->isRed == false);
+         assertUnit(p70->isRed() == false);
          assertUnit(p70->pLeft != nullptr);
          assertUnit(p70->pRight == nullptr);
-         assertUnit(p70->pParent == p80);
+         assertUnit(p70->getParent() == p80);
       }
 
       if (p80)
       {
          assertUnit(p80->data == Spy(80));
-         assertUnit(p80->isRed == true);
+         assertUnit(p80->isRed() == true);
          assertUnit(p80->pLeft == p70);
          assertUnit(p80->pRight == p90);
-         assertUnit(p80->pParent == p50);
+         assertUnit(p80->getParent() == p50);
       }
 
       if (p90)
       {
          assertUnit(p90->data == Spy(90));
-         assertUnit(p90->isRed == false);
+         assertUnit(p90->isRed() == false);
          assertUnit(p90->pLeft == nullptr);
          assertUnit(p90->pRight == nullptr);
-         assertUnit(p90->pParent == p80);
+         assertUnit(p90->getParent() == p80);
       }
 
       // teardown
@@ -3443,7 +4319,7 @@ public:
       assertUnit(bst.root->pRight->pLeft == nullptr);
       assertUnit(bst.numElements == 6);
       bst.root->pRight->pLeft = new custom::BST<Spy>::BNode(Spy(60));
-      bst.root->pRight->pLeft->pParent = bst.root->pRight;
+      bst.root->pRight->pLeft->setParent(bst.root->pRight);
       bst.numElements = 7;
       assertStandardFixture(bst);
       // teardown
@@ -3466,10 +4342,15 @@ public:
       auto p40 = new custom::BST<int>::BNode(40);
       auto p60 = new custom::BST<int>::BNode(60);
       auto p50 = new custom::BST<int>::BNode(50);
-      bst.root = p10->pParent = p60->pParent = p50;
-      p50->pLeft = p30->pParent = p10;
+      bst.root = p50;
+      p10->setParent(p50);
+      p60->setParent(p50);
+      p50->pLeft = p10;
+      p30->setParent(p10);
       p50->pRight = p60;
-      p10->pRight = p20->pParent = p40->pParent = p30;
+      p10->pRight = p30;
+      p20->setParent(p30);
+      p40->setParent(p30);
       p30->pLeft = p20;
       p30->pRight = p40;
       bst.numElements = 6;
@@ -3489,10 +4370,10 @@ public:
       assertUnit(p50->pRight == p60);
       assertUnit(p30->pLeft == p20);
       assertUnit(p30->pRight = p40);
-      assertUnit(p30->pParent == p50);
-      assertUnit(p20->pParent == p30);
-      assertUnit(p40->pParent == p30);
-      assertUnit(p60->pParent == p50);
+      assertUnit(p30->getParent() == p50);
+      assertUnit(p20->getParent() == p30);
+      assertUnit(p40->getParent() == p30);
+      assertUnit(p60->getParent() == p50);
       assertUnit(p20->data == 20);
       assertUnit(p30->data == 30);
       assertUnit(p40->data == 40);
@@ -3528,12 +4409,19 @@ public:
       auto p60 = new custom::BST<int>::BNode(60);
       auto p70 = new custom::BST<int>::BNode(70);
       auto p80 = new custom::BST<int>::BNode(80);
-      bst.root = p20->pParent = p80->pParent = p70;
-      p10->pParent = p50->pParent = p70->pLeft = p20;
+      bst.root = p70;
+      p20->setParent(p70);
+      p80->setParent(p70);
+      p10->setParent(p20);
+      p50->setParent(p20);
+      p70->pLeft = p20;
       p70->pRight = p80;
       p20->pLeft = p10;
-      p20->pRight = p30->pParent = p60->pParent = p50;
-      p50->pLeft = p40->pParent = p30;
+      p20->pRight = p50;
+      p30->setParent(p50);
+      p60->setParent(p50);
+      p50->pLeft = p30;
+      p40->setParent(p30);
       p50->pRight = p60;
       p30->pRight = p40;
       bst.numElements = 8;
@@ -3557,12 +4445,12 @@ public:
       assertUnit(p30->pRight = p50);
       assertUnit(p50->pLeft == p40);
       assertUnit(p50->pRight = p60);
-      assertUnit(p30->pParent == p70);
-      assertUnit(p80->pParent == p70);
-      assertUnit(p10->pParent == p30);
-      assertUnit(p50->pParent == p30);
-      assertUnit(p40->pParent == p50);
-      assertUnit(p60->pParent == p50);
+      assertUnit(p30->getParent() == p70);
+      assertUnit(p80->getParent() == p70);
+      assertUnit(p10->getParent() == p30);
+      assertUnit(p50->getParent() == p30);
+      assertUnit(p40->getParent() == p50);
+      assertUnit(p60->getParent() == p50);
       assertUnit(p10->data == 10);
       assertUnit(p30->data == 30);
       assertUnit(p40->data == 40);
@@ -3582,13 +4470,968 @@ public:
       bst.root = nullptr;
    }
 
-   /**************************************************************
-    * SETUP STANDARD FIXTURE
-    *                (50b)
-    *          +-------+-------+
-    *        (30b)           (70b)
-    *     +----+----+     +----+----+
-    *   (20r)     (40r) (60r)     (80r)
+   // remove a black leaf, forcing a rotation to restore the black depth
+   void test_erase_blackLeaf()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //      [[30b]]           (70b)
+      //                          +----+
+      //                             (80r)
+      custom::BST <int> bst;
+      auto p30 = new custom::BST<int>::BNode(30);
+      auto p50 = new custom::BST<int>::BNode(50);
+      auto p70 = new custom::BST<int>::BNode(70);
+      auto p80 = new custom::BST<int>::BNode(80);
+      bst.root = p50;
+      p30->setParent(p50);
+      p70->setParent(p50);
+      p50->pLeft = p30;
+      p50->pRight = p70;
+      p80->setParent(p70);
+      p70->pRight = p80;
+      p30->setRed(false);
+      p50->setRed(false);
+      p70->setRed(false);
+      p80->setRed(true);
+      bst.numElements = 4;
+      auto it = custom::BST <int> ::iterator(p30);
+      // exercise
+      auto itReturn = bst.erase(it);
+      // verify
+      //                (70b)
+      //          +-------+-------+
+      //       [[50b]]          (80b)
+      assertUnit(itReturn == custom::BST <int> ::iterator(p50));
+      assertUnit(bst.numElements == 3);
+      assertUnit(bst.root == p70);
+      assertUnit(p70->getParent() == nullptr);
+      assertUnit(p70->pLeft == p50);
+      assertUnit(p70->pRight == p80);
+      assertUnit(p50->getParent() == p70);
+      assertUnit(p50->pLeft == nullptr);
+      assertUnit(p50->pRight == nullptr);
+      assertUnit(p80->getParent() == p70);
+      assertUnit(p80->pLeft == nullptr);
+      assertUnit(p80->pRight == nullptr);
+      assertUnit(p70->isRed() == false);
+      assertUnit(p50->isRed() == false);
+      assertUnit(p80->isRed() == false);
+      // teardown
+      delete p50;
+      delete p70;
+      delete p80;
+      bst.numElements = 0;
+      bst.root = nullptr;
+   }
+
+   // a long random mix of inserts and erases must stay a red-black tree
+   void test_erase_randomChurn()
+   {  // setup
+      custom::BST <int> bst;
+      std::vector <int> values;
+      std::srand(235);
+      bool valid = true;
+      bool balanced = true;
+      // exercise
+      for (int i = 0; i < 4000; i++)
+      {
+         // grow for a while, then churn at about one erase per insert
+         if (values.empty() || std::rand() % 100 < (i < 1000 ? 70 : 50))
+         {
+            int value = std::rand() % 1000;
+            bst.insert(value);
+            values.push_back(value);
+         }
+         else
+         {
+            size_t index = std::rand() % values.size();
+            auto it = bst.find(values[index]);
+            bst.erase(it);
+            values[index] = values.back();
+            values.pop_back();
+         }
+
+         // verify after every operation
+         if (bst.root)
+         {
+            valid = valid && bst.root->verifyRedBlack(bst.root->findDepth());
+            double limit = 2.0 * std::log2((double)bst.numElements + 1.0);
+            balanced = balanced && (double)computeHeight(bst.root) <= limit;
+         }
+      }
+      // verify
+      assertUnit(valid);
+      assertUnit(balanced);
+      assertUnit(bst.numElements == values.size());
+      if (bst.root)
+      {
+         assertUnit(bst.root->getParent() == nullptr);
+         assertUnit(bst.root->computeSize() == (int)values.size());
+      }
+   }  // teardown
+
+   /***************************************
+    * ERASE RANGE
+    *    BST::erase(iterator, iterator)
+    ***************************************/
+
+   // cut a block out of the middle without comparing a single key
+   void test_eraseRange_middle()
+   {  // setup
+      custom::BST <Spy> bst;
+      for (int i = 0; i < 200; i++)
+         bst.insert(Spy(i));
+      auto itFirst = bst.find(Spy(50));
+      auto itLast = bst.find(Spy(150));
+      size_t numSpare = bst.nodes.available();
+      Spy::reset();
+      // exercise
+      auto itReturn = bst.erase(itFirst, itLast);
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(bst.nodes.available() == numSpare + 100);  // kept for the next inserts
+      assertUnit(itReturn == itLast);
+      assertUnit(bst.size() == 100);
+      assertUnit(bst.root->getParent() == nullptr);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 100);
+      assertUnit(bst.pRightmost && bst.pRightmost->data == Spy(199));
+      int expected = 0;
+      bool ordered = true;
+      for (auto it = bst.begin(); it != bst.end(); ++it, expected++)
+         ordered = ordered && (*it).get() == (expected < 50 ? expected : expected + 100);
+      assertUnit(ordered);
+   }  // teardown
+
+   // drop everything from a point on: the largest node moves
+   void test_eraseRange_toEnd()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      // exercise
+      auto itReturn = bst.erase(bst.find(300), bst.end());
+      // verify
+      assertUnit(itReturn == bst.end());
+      assertUnit(bst.size() == 300);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 300);
+      assertUnit(bst.pRightmost && bst.pRightmost->data == 299);
+      bst.insert(1000);
+      assertUnit(bst.pRightmost && bst.pRightmost->data == 1000);
+   }  // teardown
+
+   // random ranges out of random trees, duplicates and all, stay valid
+   void test_eraseRange_random()
+   {  // setup
+      using RankedBST = custom::BST <int, std::allocator <int>, custom::Identity, std::less <int>, true>;
+      std::srand(1723);
+      bool valid = true;
+      bool same = true;
+      // exercise
+      for (int round = 0; round < 200; round++)
+      {
+         RankedBST bst;
+         std::vector <int> values;
+         int num = std::rand() % 300;
+         for (int i = 0; i < num; i++)
+         {
+            int value = std::rand() % 200;
+            bst.insert(value);
+            values.push_back(value);
+         }
+         std::sort(values.begin(), values.end());
+
+         for (int cut = 0; cut < 3 && !values.empty(); cut++)
+         {
+            size_t iFirst = std::rand() % (values.size() + 1);
+            size_t iLast = iFirst + std::rand() % (values.size() - iFirst + 1);
+            bst.erase(bst.nth(iFirst), bst.nth(iLast));
+            values.erase(values.begin() + iFirst, values.begin() + iLast);
+
+            valid = valid && bst.size() == values.size();
+            if (bst.root)
+               valid = valid && bst.root->getParent() == nullptr &&
+                       bst.root->verifyRedBlack(bst.root->findDepth()) &&
+                       bst.root->verifySize() && bst.root->computeSize() == (int)values.size() &&
+                       bst.pRightmost == findRightmostNode(bst.root);
+            else
+               valid = valid && bst.pRightmost == nullptr;
+            size_t i = 0;
+            for (auto it = bst.begin(); it != bst.end(); ++it, i++)
+               same = same && i < values.size() && *it == values[i];
+         }
+      }
+      // verify
+      assertUnit(valid);
+      assertUnit(same);
+   }  // teardown
+
+   template <class Node>
+   static Node* findRightmostNode(Node* pNode)
+   {
+      while (pNode != nullptr && pNode->pRight != nullptr)
+         pNode = pNode->pRight;
+      return pNode;
+   }
+
+   /***************************************
+    * NODE HANDLES
+    *    BST::extract(iterator)
+    *    BST::insert(NodeHandle &&)
+    *    BST::merge(BST &)
+    ***************************************/
+
+   // take a node with two children out of the tree
+   void test_extract_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      auto it = bst.find(Spy(30));
+      auto pNode30 = it.pNode;
+      size_t numPool = custom::BST <Spy> ::BNode::pool().size();
+      Spy::reset();
+      {
+         // exercise
+         auto nh = bst.extract(it);
+         // verify
+         for (int i = 0; i < NUM_MARKERS; i++)
+            assertUnit(Spy::counters[i] == 0);
+         assertUnit(custom::BST <Spy> ::BNode::pool().size() == numPool);
+         assertUnit(!nh.empty());
+         assertUnit(nh.pNode == pNode30);
+         assertUnit(nh.value() == Spy(30));
+         assertUnit(pNode30->pLeft == nullptr && pNode30->pRight == nullptr);
+         assertUnit(pNode30->getParent() == nullptr);
+         assertUnit(bst.size() == 6);
+         assertUnit(bst.find(Spy(30)) == bst.end());
+         assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+         assertUnit(bst.root->computeSize() == 6);
+         Spy::reset();
+      }  // teardown: the handle frees the node
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(custom::BST <Spy> ::BNode::pool().size() == numPool - 1);
+      teardownStandardFixture(bst);
+   }
+
+   // extracting end() gives an empty handle
+   void test_extract_end()
+   {  // setup
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      // exercise
+      auto nh = bst.extract(bst.end());
+      // verify
+      assertUnit(nh.empty());
+      assertUnit(!nh);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // move a node from one tree into another
+   void test_insertNode_otherTree()
+   {  // setup
+      custom::BST <Spy> bstSrc;
+      setupStandardFixture(bstSrc);
+      custom::BST <Spy> bstDest;
+      bstDest.insert(Spy(10));
+      auto nh = bstSrc.extract(bstSrc.find(Spy(80)));
+      auto pNode80 = nh.pNode;
+      size_t numPool = custom::BST <Spy> ::BNode::pool().size();
+      Spy::reset();
+      // exercise
+      auto pairReturn = bstDest.insert(std::move(nh));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(custom::BST <Spy> ::BNode::pool().size() == numPool);
+      assertUnit(pairReturn.second == true);
+      assertUnit(pairReturn.first.pNode == pNode80);
+      assertUnit(nh.empty());
+      assertUnit(bstDest.size() == 2);
+      assertUnit(bstDest.pRightmost == pNode80);
+      assertUnit(bstDest.root->verifyRedBlack(bstDest.root->findDepth()));
+      assertUnit(bstSrc.size() == 6);
+      assertUnit(bstSrc.pRightmost && bstSrc.pRightmost->data == Spy(70));
+      // teardown
+      teardownStandardFixture(bstSrc);
+   }
+
+   // a unique tree turns the node away and the handle keeps it
+   void test_insertNode_duplicate()
+   {  // setup
+      custom::BST <Spy> bstSrc;
+      setupStandardFixture(bstSrc);
+      custom::BST <Spy> bstDest;
+      auto pairExisting = bstDest.insert(Spy(40));
+      auto nh = bstSrc.extract(bstSrc.find(Spy(40)));
+      Spy::reset();
+      // exercise
+      auto pairReturn = bstDest.insert(std::move(nh), true /*keepUnique*/);
+      // verify
+      assertUnit(pairReturn.second == false);
+      assertUnit(pairReturn.first == pairExisting.first);
+      assertUnit(!nh.empty());
+      assertUnit(bstDest.size() == 1);
+      assertUnit(Spy::numDestructor() == 0);
+      // teardown
+      teardownStandardFixture(bstSrc);
+   }
+
+   // merge moves every node whose key is not already here
+   void test_merge_overlap()
+   {  // setup
+      custom::BST <Spy> bst;
+      custom::BST <Spy> bstSrc;
+      for (int i = 1; i <= 50; i++)
+         bst.insert(Spy(i));
+      for (int i = 40; i <= 100; i++)
+         bstSrc.insert(Spy(i));
+      size_t numPool = custom::BST <Spy> ::BNode::pool().size();
+      Spy::reset();
+      // exercise
+      bst.merge(bstSrc, true /*keepUnique*/);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(custom::BST <Spy> ::BNode::pool().size() == numPool);
+      assertUnit(bst.size() == 100);
+      assertUnit(bstSrc.size() == 11);   // [40] .. [50] stay behind
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 100);
+      assertUnit(bstSrc.root->verifyRedBlack(bstSrc.root->findDepth()));
+      assertUnit(bstSrc.root->computeSize() == 11);
+      assertUnit(bst.pRightmost && bst.pRightmost->data == Spy(100));
+      assertUnit(bstSrc.pRightmost && bstSrc.pRightmost->data == Spy(50));
+      int expected = 1;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit((*it).get() == expected++);
+   }  // teardown
+
+   /***************************************
+    * SPLIT AND JOIN
+    *    BST::split(const key_type &)
+    *    BST::join(BST &&, BST &&)
+    ***************************************/
+
+   // cut the standard tree at a key it holds
+   void test_split_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      auto pNode50 = bst.root;
+      Spy key(50);
+      size_t numPool = custom::BST <Spy> ::BNode::pool().size();
+      Spy::reset();
+      // exercise
+      auto pairTrees = bst.split(key);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(custom::BST <Spy> ::BNode::pool().size() == numPool);
+      assertUnit(bst.empty() && bst.root == nullptr);
+      assertUnit(pairTrees.first.size() == 3);
+      assertUnit(pairTrees.second.size() == 4);
+      assertUnit(pairTrees.first.root->verifyRedBlack(pairTrees.first.root->findDepth()));
+      assertUnit(pairTrees.second.root->verifyRedBlack(pairTrees.second.root->findDepth()));
+      assertUnit(pairTrees.first.pRightmost->data == Spy(40));
+      assertUnit(pairTrees.second.pRightmost->data == Spy(80));
+      assertUnit(pairTrees.second.begin().pNode == pNode50);
+      assertUnit(pairTrees.second.find(Spy(60)) != pairTrees.second.end());
+   }  // teardown
+
+   // a key after everything leaves the right side empty
+   void test_split_pastEnd()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 10; i++)
+         bst.insert(i);
+      // exercise
+      auto pairTrees = bst.split(10);
+      // verify
+      assertUnit(bst.empty());
+      assertUnit(pairTrees.first.size() == 10);
+      assertUnit(pairTrees.second.empty());
+      assertUnit(pairTrees.second.begin() == pairTrees.second.end());
+   }  // teardown
+
+   // a small tree joined to a much taller one
+   void test_join_uneven()
+   {  // setup
+      custom::BST <int> bstLeft;
+      custom::BST <int> bstRight;
+      for (int i = 0; i < 3; i++)
+         bstLeft.insert(i);
+      for (int i = 100; i < 1100; i++)
+         bstRight.insert(i);
+      size_t numPool = custom::BST <int> ::BNode::pool().size();
+      // exercise
+      auto bst = custom::BST <int> ::join(std::move(bstLeft), std::move(bstRight));
+      // verify
+      assertUnit(custom::BST <int> ::BNode::pool().size() == numPool);
+      assertUnit(bstLeft.empty() && bstRight.empty());
+      assertUnit(bst.size() == 1003);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 1003);
+      assertUnit(bst.pRightmost->data == 1099);
+      assertUnit(*bst.begin() == 0);
+      assertUnit(*bst.nth(3) == 100);
+   }  // teardown
+
+   // cut and glue random trees at random keys
+   void test_splitJoin_random()
+   {  // setup
+      using RankedBST = custom::BST <int, std::allocator <int>, custom::Identity, std::less <int>, true>;
+      std::srand(4242);
+      bool valid = true;
+      // exercise
+      for (int round = 0; round < 100; round++)
+      {
+         RankedBST bst;
+         custom::BST <int> bstPlain;
+         int num = std::rand() % 500;
+         for (int i = 0; i < num; i++)
+         {
+            int value = std::rand() % 300;
+            bst.insert(value);
+            bstPlain.insert(value);
+         }
+         int key = std::rand() % 320 - 10;
+         size_t numBefore = bst.rank(key);
+
+         auto pairTrees = bst.split(key);
+         auto pairPlain = bstPlain.split(key);
+         for (auto* pTree : { &pairTrees.first, &pairTrees.second })
+            if (pTree->root)
+               valid = valid && pTree->root->verifyRedBlack(pTree->root->findDepth()) &&
+                       pTree->root->verifySize() && pTree->root->getParent() == nullptr;
+         valid = valid && pairTrees.first.size() == numBefore &&
+                 pairTrees.second.size() == size_t(num) - numBefore &&
+                 pairPlain.first.size() == numBefore &&
+                 pairPlain.second.size() == size_t(num) - numBefore &&
+                 (pairTrees.first.empty() || *pairTrees.first.nth(numBefore - 1) < key) &&
+                 (pairTrees.second.empty() || !(*pairTrees.second.begin() < key));
+
+         auto bstJoined = RankedBST::join(std::move(pairTrees.first), std::move(pairTrees.second));
+         valid = valid && bstJoined.size() == size_t(num) &&
+                 (num == 0 || (bstJoined.root->verifyRedBlack(bstJoined.root->findDepth()) &&
+                               bstJoined.root->verifySize() &&
+                               bstJoined.pRightmost == findRightmostNode(bstJoined.root)));
+         int prev = -1;
+         for (auto it = bstJoined.begin(); it != bstJoined.end(); ++it)
+         {
+            valid = valid && prev <= *it;
+            prev = *it;
+         }
+      }
+      // verify
+      assertUnit(valid);
+   }  // teardown
+
+   /***************************************
+    * SET OPERATIONS
+    *    BST::setUnion(BST &&, BST &&, Combine, unsigned)
+    *    BST::setIntersection(BST &&, BST &&, unsigned)
+    *    BST::setDifference(BST &&, BST &&, unsigned)
+    ***************************************/
+
+   // the standard tree and {10 30 50 90} together
+   void test_setUnion_standard()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      custom::BST <Spy> bstOther;
+      setupStandardFixture(bst);
+      for (int i : { 10, 30, 50, 90 })
+         bstOther.insert(Spy(i));
+      auto pNode50 = bst.root;
+      size_t numSpare = bst.nodes.available();
+      int numCombine = 0;
+      Spy::reset();
+      // exercise
+      auto bstUnion = custom::BST <Spy> ::setUnion(std::move(bst), std::move(bstOther),
+                                                  [&numCombine](Spy&, Spy&) { numCombine++; });
+      // verify
+      assertUnit(numCombine == 2);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 2);
+      assertUnit(bstUnion.nodes.available() == numSpare + 2);  // the union keeps them
+      assertUnit(bst.empty() && bstOther.empty());
+      assertUnit(bstUnion.size() == 9);
+      assertUnit(bstUnion.root->verifyRedBlack(bstUnion.root->findDepth()));
+      assertUnit(bstUnion.pRightmost->data == Spy(90));
+      assertUnit(bstUnion.find(Spy(50)).pNode == pNode50);
+      int expected[] = { 10, 20, 30, 40, 50, 60, 70, 80, 90 };
+      int i = 0;
+      for (auto it = bstUnion.begin(); it != bstUnion.end(); ++it)
+         assertUnit((*it).get() == expected[i++]);
+   }  // teardown
+
+   // only the keys in both trees are left
+   void test_setIntersection_standard()
+   {  // setup
+      custom::BST <Spy> bst;
+      custom::BST <Spy> bstOther;
+      setupStandardFixture(bst);
+      for (int i : { 10, 30, 50, 90 })
+         bstOther.insert(Spy(i));
+      Spy::reset();
+      // exercise
+      auto bstBoth = custom::BST <Spy> ::setIntersection(std::move(bst), std::move(bstOther));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 9);
+      assertUnit(bst.empty() && bstOther.empty());
+      assertUnit(bstBoth.size() == 2);
+      assertUnit(bstBoth.root->verifyRedBlack(bstBoth.root->findDepth()));
+      assertUnit(bstBoth.pRightmost->data == Spy(50));
+      assertUnit((*bstBoth.begin()).get() == 30);
+   }  // teardown
+
+   // the standard tree less {10 30 50 90}
+   void test_setDifference_standard()
+   {  // setup
+      custom::BST <Spy> bst;
+      custom::BST <Spy> bstOther;
+      setupStandardFixture(bst);
+      for (int i : { 10, 30, 50, 90 })
+         bstOther.insert(Spy(i));
+      Spy::reset();
+      // exercise
+      auto bstLess = custom::BST <Spy> ::setDifference(std::move(bst), std::move(bstOther));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 6);
+      assertUnit(bst.empty() && bstOther.empty());
+      assertUnit(bstLess.size() == 5);
+      assertUnit(bstLess.root->verifyRedBlack(bstLess.root->findDepth()));
+      assertUnit(bstLess.pRightmost->data == Spy(80));
+      int expected[] = { 20, 40, 60, 70, 80 };
+      int i = 0;
+      for (auto it = bstLess.begin(); it != bstLess.end(); ++it)
+         assertUnit((*it).get() == expected[i++]);
+   }  // teardown
+
+   // random trees of very different sizes checked against sorted vectors
+   void test_setOperations_random()
+   {  // setup
+      std::srand(1919);
+      bool valid = true;
+      auto fill = [](RankedBST& bst, std::vector <int>& values, int num, int range)
+      {
+         for (int i = 0; i < num; i++)
+            bst.insert(std::rand() % range, true /*keepUnique*/);
+         for (auto it = bst.begin(); it != bst.end(); ++it)
+            values.push_back(*it);
+      };
+      auto check = [&valid](RankedBST& bst, const std::vector <int>& expected)
+      {
+         std::vector <int> values;
+         for (auto it = bst.begin(); it != bst.end(); ++it)
+            values.push_back(*it);
+         valid = valid && bst.size() == expected.size() && values == expected &&
+                 (bst.empty() || (bst.root->verifyRedBlack(bst.root->findDepth()) &&
+                                  bst.root->verifySize() && bst.root->getParent() == nullptr &&
+                                  bst.pRightmost == findRightmostNode(bst.root)));
+      };
+      // exercise
+      for (int round = 0; round < 60; round++)
+      {
+         int range = 1 + std::rand() % 2000;
+         int numLeft = std::rand() % (round % 3 == 0 ? 20 : 1000);
+         int numRight = std::rand() % (round % 3 == 1 ? 20 : 1000);
+         for (int op = 0; op < 3; op++)
+         {
+            std::srand(round * 3 + op);
+            RankedBST bstLeft;
+            RankedBST bstRight;
+            std::vector <int> valuesLeft;
+            std::vector <int> valuesRight;
+            fill(bstLeft, valuesLeft, numLeft, range);
+            fill(bstRight, valuesRight, numRight, range);
+            std::vector <int> expected;
+            if (op == 0)
+            {
+               std::set_union(valuesLeft.begin(), valuesLeft.end(), valuesRight.begin(), valuesRight.end(),
+                              std::back_inserter(expected));
+               auto bst = RankedBST::setUnion(std::move(bstLeft), std::move(bstRight), [](int&, int&) {});
+               check(bst, expected);
+            }
+            else if (op == 1)
+            {
+               std::set_intersection(valuesLeft.begin(), valuesLeft.end(), valuesRight.begin(), valuesRight.end(),
+                                     std::back_inserter(expected));
+               auto bst = RankedBST::setIntersection(std::move(bstLeft), std::move(bstRight));
+               check(bst, expected);
+            }
+            else
+            {
+               std::set_difference(valuesLeft.begin(), valuesLeft.end(), valuesRight.begin(), valuesRight.end(),
+                                   std::back_inserter(expected));
+               auto bst = RankedBST::setDifference(std::move(bstLeft), std::move(bstRight));
+               check(bst, expected);
+            }
+            valid = valid && bstLeft.empty() && bstRight.empty();
+         }
+      }
+      // verify
+      assertUnit(valid);
+   }  // teardown
+
+   // large enough to be split across threads
+   void test_setUnion_parallel()
+   {  // setup
+      custom::BST <int> bstEven;
+      custom::BST <int> bstThree;
+      for (int i = 0; i < 200000; i += 2)
+         bstEven.insert(i);
+      for (int i = 0; i < 200000; i += 3)
+         bstThree.insert(i);
+      std::atomic <int> numCombine(0);
+      // exercise
+      auto bst = custom::BST <int> ::setUnion(std::move(bstEven), std::move(bstThree),
+                                             [&numCombine](int&, int&) { numCombine++; }, 4);
+      // verify
+      assertUnit(numCombine == 33334);
+      assertUnit(bst.size() == 133333);
+      assertUnit(bst.root->verifyRedBlack(bst.root->findDepth()));
+      assertUnit(bst.root->computeSize() == 133333);
+      assertUnit(bst.pRightmost->data == 199998);
+      bool ordered = true;
+      int prev = -1;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+      {
+         ordered = ordered && prev < *it && (*it % 2 == 0 || *it % 3 == 0);
+         prev = *it;
+      }
+      assertUnit(ordered);
+   }  // teardown
+
+   /***************************************
+    * ORDER STATISTICS
+    *    BST::nth(size_t)
+    *    BST::rank(const key_type &)
+    *    BST::countRange(const key_type &, const key_type &)
+    *    distance(iterator, iterator)
+    ***************************************/
+
+   using RankedBST = custom::BST <int, std::allocator <int>, custom::Identity, std::less <int>, true>;
+
+   // find the k-th element of a tree built in scrambled order
+   void test_nth_ranked()
+   {  // setup
+      RankedBST bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert((i * 37) % 100);
+      bool found = true;
+      // exercise
+      for (int k = 0; k < 100; k++)
+         found = found && bst.nth(k) != bst.end() && *bst.nth(k) == k;
+      // verify
+      assertUnit(found);
+      assertUnit(bst.nth(100) == bst.end());
+      assertUnit(bst.root->verifySize());
+      assertUnit(bst.root->numSubtree == 100);
+   }  // teardown
+
+   // without the sizes, nth still works by walking
+   void test_nth_unranked()
+   {  // setup
+      //                (50b)
+      //          +-------+-------+
+      //        (30b)           (70b)
+      //     +----+----+     +----+----+
+      //   (20r)     (40r) (60r)     (80r)
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      // exercise
+      auto it = bst.nth(3);
+      // verify
+      assertUnit(it != bst.end() && *it == Spy(50));
+      assertUnit(bst.nth(0) == bst.begin());
+      assertUnit(bst.nth(7) == bst.end());
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // count the keys below a key, whether it is there or not
+   void test_rank_ranked()
+   {  // setup
+      RankedBST bst;
+      for (int i = 99; i >= 0; i--)
+         bst.insert(i * 2);
+      // exercise
+      // verify
+      assertUnit(bst.rank(-1) == 0);
+      assertUnit(bst.rank(0) == 0);
+      assertUnit(bst.rank(1) == 1);
+      assertUnit(bst.rank(2) == 1);
+      assertUnit(bst.rank(101) == 51);
+      assertUnit(bst.rank(198) == 99);
+      assertUnit(bst.rank(500) == 100);
+   }  // teardown
+
+   // count the keys in [lo, hi)
+   void test_countRange_ranked()
+   {  // setup
+      RankedBST bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(i * 2);
+      // exercise
+      // verify
+      assertUnit(bst.countRange(10, 20) == 5);
+      assertUnit(bst.countRange(11, 21) == 5);
+      assertUnit(bst.countRange(-50, 1000) == 100);
+      assertUnit(bst.countRange(20, 10) == 0);
+      assertUnit(bst.countRange(20, 20) == 0);
+   }  // teardown
+
+   // distance between iterators, including end()
+   void test_distance_ranked()
+   {  // setup
+      RankedBST bst;
+      for (int i = 0; i < 50; i++)
+         bst.insert(i);
+      using std::distance;
+      // exercise
+      // verify
+      assertUnit(distance(bst.begin(), bst.end()) == 50);
+      assertUnit(distance(bst.find(10), bst.find(35)) == 25);
+      assertUnit(distance(bst.find(35), bst.end()) == 15);
+      assertUnit(distance(bst.find(35), bst.find(35)) == 0);
+      assertUnit(distance(bst.end(), bst.end()) == 0);
+   }  // teardown
+
+   // the sizes survive inserts, erases, rotations, copies and moves
+   void test_ranked_randomChurn()
+   {  // setup
+      RankedBST bst;
+      std::vector <int> values;
+      std::srand(91);
+      bool valid = true;
+      // exercise
+      for (int i = 0; i < 3000; i++)
+      {
+         if (values.empty() || std::rand() % 100 < (i < 1000 ? 70 : 50))
+         {
+            int value = std::rand() % 1000;
+            bst.insert(value);
+            values.push_back(value);
+         }
+         else
+         {
+            size_t index = std::rand() % values.size();
+            auto it = bst.find(values[index]);
+            bst.erase(it);
+            values[index] = values.back();
+            values.pop_back();
+         }
+         valid = valid && (bst.root == nullptr || bst.root->verifySize());
+      }
+      RankedBST bstCopy(bst);
+      RankedBST bstOther;
+      bstOther.insert(5000);
+      bstOther.merge(bstCopy);
+      // verify
+      assertUnit(valid);
+      assertUnit(bst.root->numSubtree == values.size());
+      assertUnit(bstCopy.root == nullptr);
+      assertUnit(bstOther.root->verifySize());
+      assertUnit(bstOther.root->numSubtree == values.size() + 1);
+      std::sort(values.begin(), values.end());
+      bool ordered = true;
+      for (size_t k = 0; k < values.size(); k += 7)
+         ordered = ordered && *bst.nth(k) == values[k] &&
+                   bst.rank(values[k]) == size_t(std::lower_bound(values.begin(), values.end(), values[k]) - values.begin());
+      assertUnit(ordered);
+   }  // teardown
+
+   /***************************************
+    * NODE
+    *    BST<T, A>::BNode
+    ***************************************/
+
+   // the color does not cost a word of its own
+   void test_node_size()
+   {  // setup
+      struct ThreePointers { int data; void* pLeft; void* pRight; void* pParent; };
+      struct ThreePointersPair { std::pair <int, int> data; void* pLeft; void* pRight; void* pParent; };
+      // exercise
+      // verify
+      assertUnit(sizeof(custom::BST <int> ::BNode) == sizeof(ThreePointers));
+      assertUnit(sizeof(custom::BST <std::pair <int, int> > ::BNode) == sizeof(ThreePointersPair));
+      assertUnit(sizeof(RankedBST::BNode) == sizeof(ThreePointers) + sizeof(size_t));
+   }  // teardown
+
+   // setting the parent keeps the color and setting the color keeps the parent
+   void test_node_parentAndColor()
+   {  // setup
+      custom::BST <int> ::BNode parent(50);
+      custom::BST <int> ::BNode child(30);
+      assertUnit(child.isRed() == true);
+      assertUnit(child.getParent() == nullptr);
+      // exercise
+      child.setParent(&parent);
+      child.setRed(false);
+      // verify
+      assertUnit(child.getParent() == &parent);
+      assertUnit(child.isRed() == false);
+      child.setRed(true);
+      assertUnit(child.getParent() == &parent);
+      assertUnit(child.isRed() == true);
+      child.setParent(nullptr);
+      assertUnit(child.getParent() == nullptr);
+      assertUnit(child.isRed() == true);
+   }  // teardown
+
+   /***************************************
+    * ALLOCATOR
+    *    BST<T, A>
+    ***************************************/
+
+   // a memory resource that counts what goes through it
+   class CountingResource : public std::pmr::memory_resource
+   {
+   public:
+      int numAllocate = 0;
+      int numDeallocate = 0;
+   private:
+      void* do_allocate(size_t bytes, size_t alignment) override
+      {
+         numAllocate++;
+         return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+      }
+      void do_deallocate(void* p, size_t bytes, size_t alignment) override
+      {
+         numDeallocate++;
+         std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+      }
+      bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override
+      {
+         return this == &rhs;
+      }
+   };
+
+   // every node comes from and goes back to the memory resource
+   void test_allocator_pmrNodes()
+   {  // setup
+      CountingResource resource;
+      custom::pmr::BST <Spy> bst(&resource);
+      // exercise
+      bst.insert(Spy(50));
+      bst.insert(Spy(30));
+      bst.insert(Spy(70));
+      auto it = bst.begin();
+      bst.erase(it);
+      // verify
+      assertUnit(resource.numAllocate == 3);
+      assertUnit(resource.numDeallocate == 1);
+      assertUnit(bst.get_allocator().resource() == &resource);
+      assertUnit(bst.numElements == 2);
+      // teardown
+      bst.clear();
+      assertUnit(resource.numDeallocate == 3);
+   }
+
+   // a polymorphic allocator does not follow a copy
+   void test_allocator_copy()
+   {  // setup
+      CountingResource resource;
+      custom::pmr::BST <int> bstSrc(&resource);
+      bstSrc.insert(50);
+      bstSrc.insert(30);
+      // exercise
+      custom::pmr::BST <int> bstDefault(bstSrc);
+      custom::pmr::BST <int> bstSame(bstSrc, bstSrc.get_allocator());
+      // verify
+      assertUnit(bstDefault.get_allocator().resource() == std::pmr::get_default_resource());
+      assertUnit(bstSame.get_allocator().resource() == &resource);
+      assertUnit(resource.numAllocate == 4);
+      assertUnit(bstDefault.numElements == 2);
+      assertUnit(bstSame.numElements == 2);
+      assertUnit(bstDefault.root != bstSrc.root);
+      assertUnit(bstSame.root != bstSrc.root);
+      // teardown
+   }
+
+   // moving a tree moves the allocator and steals the nodes
+   void test_allocator_move()
+   {  // setup
+      CountingResource resource;
+      custom::pmr::BST <int> bstSrc(&resource);
+      bstSrc.insert(50);
+      bstSrc.insert(30);
+      auto pRoot = bstSrc.root;
+      // exercise
+      custom::pmr::BST <int> bstDest(std::move(bstSrc));
+      // verify
+      assertUnit(bstDest.get_allocator().resource() == &resource);
+      assertUnit(bstDest.root == pRoot);
+      assertUnit(bstSrc.root == nullptr);
+      assertUnit(resource.numAllocate == 2);
+      // teardown
+   }
+
+   // nodes cannot be stolen from a tree with a different resource
+   void test_allocator_moveAssignUnequal()
+   {  // setup
+      CountingResource resourceSrc;
+      CountingResource resourceDest;
+      custom::pmr::BST <Spy> bstSrc(&resourceSrc);
+      custom::pmr::BST <Spy> bstDest(&resourceDest);
+      bstSrc.insert(Spy(50));
+      bstSrc.insert(Spy(30));
+      bstSrc.insert(Spy(70));
+      Spy::reset();
+      // exercise
+      bstDest = std::move(bstSrc);
+      // verify
+      assertUnit(Spy::numCopyMove() == 3);  // move [30][50][70] into new nodes
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(bstDest.get_allocator().resource() == &resourceDest);
+      assertUnit(resourceDest.numAllocate == 3);
+      assertUnit(resourceSrc.numDeallocate == 3);
+      assertUnit(bstDest.numElements == 3);
+      assertUnit(bstSrc.numElements == 0);
+      assertUnit(bstSrc.root == nullptr);
+      // teardown
+   }
+
+   /**************************************************************
+    * SETUP STANDARD FIXTURE
+    *                (50b)
+    *          +-------+-------+
+    *        (30b)           (70b)
+    *     +----+----+     +----+----+
+    *   (20r)     (40r) (60r)     (80r)
     *************************************************************/
    void setupStandardFixture(custom::BST <Spy>& bst)
    {
@@ -3614,16 +5457,26 @@ public:
       p70->pRight = p80;
 
       // hook up the pointers up
-      p20->pParent = p40->pParent = p30;
-      p30->pParent = p70->pParent = p50;
-      p60->pParent = p80->pParent = p70;
+      p20->setParent(p30);
+      p40->setParent(p30);
+      p30->setParent(p50);
+      p70->setParent(p50);
+      p60->setParent(p70);
+      p80->setParent(p70);
 
       // color everything
-      p50->isRed = p30->isRed = p70->isRed = false;
-      p20->isRed = p40->isRed = p60->isRed = p80->isRed = true;
+      p50->setRed(false);
+      p30->setRed(false);
+      p70->setRed(false);
+      p20->setRed(true);
+      p40->setRed(true);
+      p60->setRed(true);
+      p80->setRed(true);
 
       // now assign everything to the bst
       bst.root = p50;
+      bst.pLeftmost = p20;
+      bst.pRightmost = p80;
       bst.numElements = 7;
    }
 
@@ -3655,20 +5508,20 @@ public:
       if (bst.root)
       {
          assertIndirect(bst.root->data == Spy(50));
-         assertIndirect(bst.root->isRed == false);
-         assertIndirect(bst.root->pParent == nullptr);
+         assertIndirect(bst.root->isRed() == false);
+         assertIndirect(bst.root->getParent() == nullptr);
          assertIndirect(bst.root->pLeft != nullptr);
          if (bst.root->pLeft)
          {
             assertIndirect(bst.root->pLeft->data == Spy(30));
-            assertIndirect(bst.root->pLeft->isRed == false);
-            assertIndirect(bst.root->pLeft->pParent == bst.root);
+            assertIndirect(bst.root->pLeft->isRed() == false);
+            assertIndirect(bst.root->pLeft->getParent() == bst.root);
             assertIndirect(bst.root->pLeft->pLeft != nullptr);
             if (bst.root->pLeft->pLeft)
             {
                assertIndirect(bst.root->pLeft->pLeft->data == Spy(20));
-               assertIndirect(bst.root->pLeft->pLeft->isRed == true);
-               assertIndirect(bst.root->pLeft->pLeft->pParent == bst.root->pLeft);
+               assertIndirect(bst.root->pLeft->pLeft->isRed() == true);
+               assertIndirect(bst.root->pLeft->pLeft->getParent() == bst.root->pLeft);
                assertIndirect(bst.root->pLeft->pLeft->pLeft == nullptr);
                assertIndirect(bst.root->pLeft->pLeft->pRight == nullptr);
             }
@@ -3676,8 +5529,8 @@ public:
             if (bst.root->pLeft->pRight)
             {
                assertIndirect(bst.root->pLeft->pRight->data == Spy(40));
-               assertIndirect(bst.root->pLeft->pRight->isRed == true);
-               assertIndirect(bst.root->pLeft->pRight->pParent == bst.root->pLeft);
+               assertIndirect(bst.root->pLeft->pRight->isRed() == true);
+               assertIndirect(bst.root->pLeft->pRight->getParent() == bst.root->pLeft);
                assertIndirect(bst.root->pLeft->pRight->pLeft == nullptr);
                assertIndirect(bst.root->pLeft->pRight->pRight == nullptr);
             }
@@ -3686,14 +5539,14 @@ public:
          if (bst.root->pRight)
          {
             assertIndirect(bst.root->pRight->data == Spy(70));
-            assertIndirect(bst.root->pRight->isRed == false);
-            assertIndirect(bst.root->pRight->pParent == bst.root);
+            assertIndirect(bst.root->pRight->isRed() == false);
+            assertIndirect(bst.root->pRight->getParent() == bst.root);
             assertIndirect(bst.root->pRight->pLeft != nullptr);
             if (bst.root->pRight->pLeft)
             {
                assertIndirect(bst.root->pRight->pLeft->data == Spy(60));
-               assertIndirect(bst.root->pRight->pLeft->isRed == true);
-               assertIndirect(bst.root->pRight->pLeft->pParent == bst.root->pRight);
+               assertIndirect(bst.root->pRight->pLeft->isRed() == true);
+               assertIndirect(bst.root->pRight->pLeft->getParent() == bst.root->pRight);
                assertIndirect(bst.root->pRight->pLeft->pLeft == nullptr);
                assertIndirect(bst.root->pRight->pLeft->pRight == nullptr);
             }
@@ -3701,8 +5554,8 @@ public:
             if (bst.root->pRight->pRight)
             {
                assertIndirect(bst.root->pRight->pRight->data == Spy(80));
-               assertIndirect(bst.root->pRight->pRight->isRed == true);
-               assertIndirect(bst.root->pRight->pRight->pParent == bst.root->pRight);
+               assertIndirect(bst.root->pRight->pRight->isRed() == true);
+               assertIndirect(bst.root->pRight->pRight->getParent() == bst.root->pRight);
                assertIndirect(bst.root->pRight->pRight->pLeft == nullptr);
                assertIndirect(bst.root->pRight->pRight->pRight == nullptr);
             }
@@ -3746,6 +5599,19 @@ public:
       bst.numElements = 0;
    }
 
+   /**************************************************************
+    * COMPUTE HEIGHT
+    * The number of nodes on the longest path from pNode to a leaf
+    *************************************************************/
+   template <class T>
+   int computeHeight(const T* pNode)
+   {
+      if (pNode == nullptr)
+         return 0;
+      int heightLeft = computeHeight(pNode->pLeft);
+      int heightRight = computeHeight(pNode->pRight);
+      return 1 + (heightLeft > heightRight ? heightLeft : heightRight);
+   }
   
 };
 
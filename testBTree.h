@@ -0,0 +1,964 @@
+/***********************************************************************
+ * Header:
+ *    TEST BTREE
+ * Summary:
+ *    Unit tests for the B-tree and for a map kept in one
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "btree.h"      // class under test
+#include "map.h"        // a map can keep its pairs in a btree
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // spy is a mock class to monitor the class under test
+
+#include <set>        // for std::multiset to check against
+#include <map>        // for std::map to check against
+#include <vector>     // for std::vector
+#include <random>     // for std::mt19937
+#include <stdexcept>  // for std::out_of_range
+
+/***********************************************
+ * TEST BTREE
+ * Unit tests for the btree class and for a map
+ * that uses it
+ ***********************************************/
+class TestBTree : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+
+      // Insert
+      test_insert_one();
+      test_insert_splitAppend();
+      test_insert_splitMiddle();
+      test_insert_ascendingPacksNodes();
+      test_insert_duplicateUnique();
+      test_insert_duplicateMulti();
+      test_insert_random();
+
+      // Erase
+      test_erase_internal();
+      test_erase_borrowLeft();
+      test_erase_borrowRight();
+      test_erase_merge();
+      test_erase_range();
+      test_erase_random();
+      test_erase_spyNoLeaks();
+
+      // Verify
+      test_verify_occupancy();
+      test_verify_underfull();
+
+      // Iterate
+      test_iterate_backward();
+      test_decrement_end();
+
+      // Bounds
+      test_bounds_duplicates();
+
+      // Assign
+      test_assign_unsorted();
+      test_assign_sortedUnique();
+
+      // Map
+      test_map_subscript();
+      test_map_at();
+      test_map_tryEmplace();
+      test_map_tryEmplaceDuplicate();
+      test_map_insertOrAssignDuplicate();
+      test_map_eraseIterator();
+      test_map_eraseKey();
+      test_map_extractInsert();
+      test_map_copy();
+      test_map_move();
+      test_map_swap();
+      test_map_clear();
+      test_map_bounds();
+      test_map_range();
+      test_map_random();
+
+      report("BTree");
+   }
+
+   // three values to a node, so a handful of keys makes a tree of several levels
+   using Tree = custom::btree <int, std::allocator <int>, custom::Identity, std::less <int>, 4>;
+   using SpyTree = custom::btree <Spy, std::allocator <Spy>, custom::Identity, std::less <Spy>, 4>;
+   using Map = custom::map <std::string, Spy, std::less <std::string>,
+                            std::allocator <custom::pair <std::string, Spy> >, false,
+                            custom::btree_policy <> >;
+   using SmallMap = custom::map <int, int, std::less <int>,
+                                 std::allocator <custom::pair <int, int> >, false,
+                                 custom::btree_policy <4> >;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new tree has no nodes
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Tree t;
+      // verify
+      assertUnit(t.root == nullptr);
+      assertUnit(t.pLeftmost == nullptr);
+      assertUnit(t.pRightmost == nullptr);
+      assertUnit(t.size() == 0);
+      assertUnit(t.empty());
+      assertUnit(t.begin() == t.end());
+      assertUnit(t.verify());
+   }  // teardown
+
+   // a copy has the same shape in new nodes
+   void test_constructCopy_standard()
+   {  // setup
+      Tree tSrc;
+      setupStandardFixture(tSrc);
+      // exercise
+      Tree tDes(tSrc);
+      // verify
+      assertStandardFixture(tSrc);
+      assertStandardFixture(tDes);
+      assertUnit(tDes.root != tSrc.root);
+      assertUnit(tDes.pLeftmost != tSrc.pLeftmost);
+   }  // teardown
+
+   // a move takes the nodes
+   void test_constructMove_standard()
+   {  // setup
+      Tree tSrc;
+      setupStandardFixture(tSrc);
+      auto pRoot = tSrc.root;
+      // exercise
+      Tree tDes(std::move(tSrc));
+      // verify
+      assertStandardFixture(tDes);
+      assertUnit(tDes.root == pRoot);
+      assertUnit(tSrc.root == nullptr);
+      assertUnit(tSrc.size() == 0);
+      assertUnit(tSrc.verify());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first value makes a leaf that is also the root
+   void test_insert_one()
+   {  // setup
+      Tree t;
+      // exercise
+      auto pairReturn = t.insert(50);
+      // verify
+      assertUnit(pairReturn.second);
+      assertUnit(*pairReturn.first == 50);
+      assertUnit(t.root != nullptr);
+      assertUnit(t.root->isLeaf);
+      assertUnit(t.root->count == 1);
+      assertUnit(t.pLeftmost == t.root);
+      assertUnit(t.pRightmost == t.root);
+      assertUnit(t.size() == 1);
+      assertUnit(t.verify());
+   }  // teardown
+
+   // a fourth value past the end of a full leaf starts a new leaf
+   //   [10 20 30] + 40  =>      [30]
+   //                        [10 20]  [40]
+   void test_insert_splitAppend()
+   {  // setup
+      Tree t;
+      t.insert(10);
+      t.insert(20);
+      t.insert(30);
+      // exercise
+      auto pairReturn = t.insert(40);
+      // verify
+      assertUnit(*pairReturn.first == 40);
+      assertStandardFixture(t);
+   }  // teardown
+
+   // a value in the middle of a full leaf splits it down the middle
+   //   [10 30 40] + 20  =>      [30]
+   //                        [10 20]  [40]
+   void test_insert_splitMiddle()
+   {  // setup
+      Tree t;
+      t.insert(10);
+      t.insert(30);
+      t.insert(40);
+      // exercise
+      auto pairReturn = t.insert(20);
+      // verify
+      assertUnit(*pairReturn.first == 20);
+      assertStandardFixture(t);
+   }  // teardown
+
+   // ascending keys leave every leaf but the last one short of full: the
+   // value that would fill it goes up to separate it from the next
+   void test_insert_ascendingPacksNodes()
+   {  // setup
+      Tree t;
+      int numLeaves = 0;
+      int numPartial = 0;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         t.insert(t.end(), i);
+      // verify
+      assertUnit(t.size() == 100);
+      assertUnit(t.verify());
+      for (auto it = t.begin(); it != t.end(); ++it)
+         if (it.pNode->isLeaf && it.index == 0)
+         {
+            numLeaves++;
+            if (it.pNode->count != 2 && it.pNode != t.pRightmost)
+               numPartial++;
+         }
+      assertUnit(numPartial == 0);
+      assertUnit(numLeaves == 34);   // 2 to a leaf and 1 between each two
+   }  // teardown
+
+   // inserting a key that is already there finds it instead
+   void test_insert_duplicateUnique()
+   {  // setup
+      Tree t;
+      setupStandardFixture(t);
+      // exercise
+      auto pairReturn = t.insert(20, true /*keepUnique*/);
+      // verify
+      assertUnit(pairReturn.second == false);
+      assertUnit(*pairReturn.first == 20);
+      assertStandardFixture(t);
+   }  // teardown
+
+   // without keepUnique, equal keys pile up in insertion order
+   void test_insert_duplicateMulti()
+   {  // setup
+      custom::btree <custom::pair <int, int>, std::allocator <custom::pair <int, int> >,
+                     custom::SelectFirst, std::less <int>, 4> t;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         t.insert(custom::pair <int, int> (i % 2, i));
+      // verify
+      assertUnit(t.size() == 10);
+      assertUnit(t.verify());
+      std::vector <int> order;
+      for (auto it = t.begin(); it != t.end(); ++it)
+         order.push_back((*it).second);
+      assertUnit(order == std::vector <int> ({ 0, 2, 4, 6, 8, 1, 3, 5, 7, 9 }));
+   }  // teardown
+
+   // random keys agree with std::multiset at every step
+   void test_insert_random()
+   {  // setup
+      Tree t;
+      std::multiset <int> reference;
+      std::mt19937 random(7);
+      bool isValid = true;
+      // exercise
+      for (int i = 0; i < 2000; i++)
+      {
+         int value = int(random() % 500);
+         bool keepUnique = (i % 3 == 0);
+         auto pairReturn = t.insert(value, keepUnique);
+         if (!keepUnique || reference.count(value) == 0)
+            reference.insert(value);
+         isValid = isValid && *pairReturn.first == value;
+         if (i % 50 == 0)
+            isValid = isValid && t.verify();
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(t.verify());
+      assertUnit(t.size() == reference.size());
+      assertUnit(std::vector <int> (t.begin(), t.end()) ==
+                 std::vector <int> (reference.begin(), reference.end()));
+   }  // teardown
+
+   /***************************************
+    * ERASE
+    ***************************************/
+
+   // a value in an internal node is replaced by the one before it
+   //        [30]                 [20]
+   //   [10 20]  [40]   =>    [10]    [40]
+   void test_erase_internal()
+   {  // setup
+      Tree t;
+      setupStandardFixture(t);
+      // exercise
+      auto it = t.erase(t.find(30));
+      // verify
+      assertUnit(it != t.end());
+      assertUnit(*it == 40);
+      assertUnit(t.size() == 3);
+      assertUnit(t.verify());
+      assertUnit(t.root->count == 1 && t.root->value(0) == 20);
+      assertUnit(t.pLeftmost->count == 1 && t.pLeftmost->value(0) == 10);
+      assertUnit(t.pRightmost->count == 1 && t.pRightmost->value(0) == 40);
+   }  // teardown
+
+   // an empty leaf borrows through the parent from its left sibling
+   //        [30]                 [20]
+   //   [10 20]  [40]   =>    [10]    [30]
+   void test_erase_borrowLeft()
+   {  // setup
+      Tree t;
+      setupStandardFixture(t);
+      // exercise
+      auto it = t.erase(t.find(40));
+      // verify
+      assertUnit(it == t.end());
+      assertUnit(t.size() == 3);
+      assertUnit(t.verify());
+      assertUnit(t.root->count == 1 && t.root->value(0) == 20);
+      assertUnit(t.pLeftmost->count == 1 && t.pLeftmost->value(0) == 10);
+      assertUnit(t.pRightmost->count == 1 && t.pRightmost->value(0) == 30);
+   }  // teardown
+
+   // an empty leaf borrows through the parent from its right sibling
+   //      [30]                 [40]
+   //   [10]  [40 50]   =>   [30]   [50]
+   void test_erase_borrowRight()
+   {  // setup
+      Tree t;
+      setupStandardFixture(t);
+      t.insert(50);
+      t.erase(t.find(20));
+      // exercise
+      auto it = t.erase(t.find(10));
+      // verify
+      assertUnit(it != t.end());
+      assertUnit(*it == 30);
+      assertUnit(t.size() == 3);
+      assertUnit(t.verify());
+      assertUnit(t.root->count == 1 && t.root->value(0) == 40);
+      assertUnit(t.pLeftmost->count == 1 && t.pLeftmost->value(0) == 30);
+      assertUnit(t.pRightmost->count == 1 && t.pRightmost->value(0) == 50);
+   }  // teardown
+
+   // with nothing to spare, the leaves merge and the root gives way
+   //      [30]
+   //   [10]  [40]   =>   [10 30]
+   void test_erase_merge()
+   {  // setup
+      Tree t;
+      setupStandardFixture(t);
+      t.erase(t.find(20));
+      // exercise
+      auto it = t.erase(t.find(40));
+      // verify
+      assertUnit(it == t.end());
+      assertUnit(t.size() == 2);
+      assertUnit(t.verify());
+      assertUnit(t.root->isLeaf);
+      assertUnit(t.root == t.pLeftmost && t.root == t.pRightmost);
+      assertUnit(t.root->count == 2);
+      assertUnit(t.root->value(0) == 10 && t.root->value(1) == 30);
+   }  // teardown
+
+   // erase the middle of a large tree
+   void test_erase_range()
+   {  // setup
+      Tree t;
+      for (int i = 0; i < 200; i++)
+         t.insert(i);
+      // exercise
+      auto it = t.erase(t.find(50), t.find(150));
+      // verify
+      assertUnit(it != t.end());
+      assertUnit(*it == 150);
+      assertUnit(t.size() == 100);
+      assertUnit(t.verify());
+      assertUnit(t.find(49) != t.end());
+      assertUnit(t.find(50) == t.end());
+      assertUnit(t.find(149) == t.end());
+   }  // teardown
+
+   // random erases agree with std::multiset, returned iterator included
+   void test_erase_random()
+   {  // setup
+      Tree t;
+      std::multiset <int> reference;
+      std::mt19937 random(11);
+      for (int i = 0; i < 3000; i++)
+      {
+         int value = int(random() % 1000);
+         t.insert(value);
+         reference.insert(value);
+      }
+      bool isValid = true;
+      // exercise
+      for (int i = 0; !reference.empty(); i++)
+      {
+         int value = int(random() % 1000);
+         auto itRef = reference.lower_bound(value);
+         if (itRef == reference.end())
+            itRef = reference.begin();
+         auto it = t.lowerBound(*itRef);
+         isValid = isValid && it != t.end() && *it == *itRef;
+         it = t.erase(it);
+         itRef = reference.erase(itRef);
+         isValid = isValid && ((it == t.end()) == (itRef == reference.end()));
+         if (it != t.end() && itRef != reference.end())
+            isValid = isValid && *it == *itRef;
+         if (i % 50 == 0)
+            isValid = isValid && t.verify() && t.size() == reference.size();
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(t.empty());
+      assertUnit(t.root == nullptr);
+      assertUnit(t.verify());
+   }  // teardown
+
+   // every value built is destroyed, through splits, merges and clear
+   void test_erase_spyNoLeaks()
+   {  // setup
+      Spy::reset();
+      {
+         SpyTree t;
+         std::mt19937 random(3);
+         // exercise
+         for (int i = 0; i < 500; i++)
+            t.insert(Spy(int(random() % 200)));
+         for (int i = 0; i < 300; i++)
+         {
+            auto it = t.lowerBound(Spy(int(random() % 200)));
+            if (it != t.end())
+               t.erase(it);
+         }
+         SpyTree tCopy(t);
+         t.clear();
+      }
+      // verify
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+      assertUnit(Spy::numCopy() > 0);
+      assertUnit(Spy::numAssign() == 0);
+   }  // teardown
+
+   /***************************************
+    * VERIFY
+    ***************************************/
+
+   // seven values to a node, an even number, still leaves every node
+   // off the right edge at least numMinValues full through inserts and erases
+   void test_verify_occupancy()
+   {  // setup
+      custom::btree <int, std::allocator <int>, custom::Identity, std::less <int>, 8> t;
+      std::mt19937 random(17);
+      bool isValid = true;
+      // exercise
+      for (int i = 0; i < 6000; i++)
+      {
+         int value = int(random() % 2000);
+         if (i < 3000 || random() % 2)
+            t.insert(value);
+         else
+            t.erase(t.find(value));
+         if (i % 50 == 0)
+            isValid = isValid && t.verify();
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(t.verify());
+   }  // teardown
+
+   // a leaf short of numMinValues is caught, unless it is the last
+   void test_verify_underfull()
+   {  // setup
+      custom::btree <int, std::allocator <int>, custom::Identity, std::less <int>, 8> t;
+      for (int i = 0; t.size() < 100 || t.pRightmost->count != 1; i++)
+         t.insert(t.end(), i);
+      // exercise
+      unsigned short count = t.pLeftmost->count;
+      t.pLeftmost->count = 2;
+      // verify
+      assertUnit(t.pRightmost->count < t.numMinValues);
+      assertUnit(!t.verify());
+      // teardown
+      t.pLeftmost->count = count;
+      assertUnit(t.verify());
+   }
+
+   /***************************************
+    * ITERATE
+    ***************************************/
+
+   // stepping back from end() visits everything in reverse
+   void test_iterate_backward()
+   {  // setup
+      Tree t;
+      std::vector <int> values;
+      for (int i = 0; i < 300; i++)
+      {
+         t.insert((i * 37) % 300);
+         values.push_back(i);
+      }
+      std::vector <int> backward;
+      // exercise
+      for (auto it = t.end(); it != t.begin(); )
+         backward.push_back(*--it);
+      // verify
+      assertUnit(std::vector <int> (backward.rbegin(), backward.rend()) == values);
+      assertUnit(*t.rbegin() == 299);
+   }  // teardown
+
+   // --end() is the largest, and before begin() is end()
+   void test_decrement_end()
+   {  // setup
+      Tree t;
+      setupStandardFixture(t);
+      // exercise
+      auto itLast = --t.end();
+      auto itBefore = --t.begin();
+      // verify
+      assertUnit(*itLast == 40);
+      assertUnit(itBefore == t.end());
+      assertUnit(--Tree().end() == Tree().end());
+   }  // teardown
+
+   /***************************************
+    * BOUNDS
+    ***************************************/
+
+   // lower and upper bound bracket a run of equal keys across nodes
+   void test_bounds_duplicates()
+   {  // setup
+      Tree t;
+      for (int i = 0; i < 20; i++)
+         t.insert(i / 5 * 10);    // five each of 0, 10, 20, 30
+      // exercise
+      auto itLower = t.lowerBound(10);
+      auto itUpper = t.upperBound(10);
+      auto pairRange = t.equalRange(20);
+      auto itMissing = t.lowerBound(15);
+      auto itPast = t.upperBound(30);
+      // verify
+      assertUnit(std::distance(t.begin(), itLower) == 5);
+      assertUnit(std::distance(t.begin(), itUpper) == 10);
+      assertUnit(std::distance(pairRange.first, pairRange.second) == 5);
+      assertUnit(*pairRange.first == 20);
+      assertUnit(*itMissing == 20);
+      assertUnit(itPast == t.end());
+      assertUnit(t.contains(30) && !t.contains(35));
+   }  // teardown
+
+   /***************************************
+    * ASSIGN
+    ***************************************/
+
+   // out of order input with repeats keeps the first of each
+   void test_assign_unsorted()
+   {  // setup
+      Tree t;
+      std::vector <int> values = { 50, 30, 70, 30, 10, 50, 90 };
+      // exercise
+      t.assign(values.begin(), values.end(), true /*keepUnique*/);
+      // verify
+      assertUnit(t.verify());
+      assertUnit(std::vector <int> (t.begin(), t.end()) == std::vector <int> ({ 10, 30, 50, 70, 90 }));
+   }  // teardown
+
+   // sorted input is appended with no search and fills the nodes
+   void test_assign_sortedUnique()
+   {  // setup
+      Tree t;
+      t.insert(999);
+      std::vector <int> values;
+      for (int i = 0; i < 1000; i++)
+         values.push_back(i * 2);
+      // exercise
+      t.assign(custom::sorted_unique, values.begin(), values.end());
+      // verify
+      assertUnit(t.verify());
+      assertUnit(t.size() == 1000);
+      assertUnit(std::vector <int> (t.begin(), t.end()) == values);
+      assertUnit(t.pLeftmost->count == 2);
+   }  // teardown
+
+   /***************************************
+    * MAP
+    *    map <K, V, C, A, false, btree_policy>
+    ***************************************/
+
+   // subscript adds a default value, then finds it
+   void test_map_subscript()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      m["40"] = Spy(40);
+      Spy& s = m["40"];
+      // verify
+      assertUnit(Spy::numDefault() == 1);   // build [40] with no value
+      assertUnit(s.get() == 40);
+      assertUnit(m.size() == 4);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // at finds a key or throws
+   void test_map_at()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      bool isThrown = false;
+      // exercise
+      try
+      {
+         m.at("40");
+      }
+      catch (const std::out_of_range&)
+      {
+         isThrown = true;
+      }
+      // verify
+      assertUnit(isThrown);
+      assertUnit(m.at("50").get() == 50);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // try_emplace builds the value right in the leaf, moving the one after it over
+   void test_map_tryEmplace()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.try_emplace(std::string("60"), 60);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [60] in place
+      assertUnit(Spy::numAlloc() == 1);       // allocate [60]
+      assertUnit(Spy::numCopyMove() == 1);    // [70] moves over one slot
+      assertUnit(Spy::numDestructor() == 1);  // and leaves its old slot behind
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(pairReturn.second == true);
+      assertUnit((*pairReturn.first).first == std::string("60"));
+      assertUnit((*pairReturn.first).second.get() == 60);
+      assertUnit(m.size() == 4);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // try_emplace a key that is already there: nothing is built
+   void test_map_tryEmplaceDuplicate()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.try_emplace(std::string("50"), 99);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(pairReturn.second == false);
+      assertUnit((*pairReturn.first).second.get() == 50);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // insert_or_assign a key that is already there assigns the value
+   void test_map_insertOrAssignDuplicate()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.insert_or_assign(std::string("50"), s);
+      // verify
+      assertUnit(Spy::numAssign() == 1);      // assign [99] over [50]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(pairReturn.second == false);
+      assertUnit((*pairReturn.first).second.get() == 99);
+      assertUnit(m.size() == 3);
+   }  // teardown
+
+   // erasing by iterator returns the next one
+   void test_map_eraseIterator()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it = m.erase(m.find("50"));
+      // verify
+      assertUnit(it != m.end());
+      assertUnit((*it).first == std::string("70"));
+      assertUnit(m.size() == 2);
+      assertUnit(m.find("50") == m.end());
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // erasing by key says how many went
+   void test_map_eraseKey()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      size_t numMissing = m.erase(std::string("40"));
+      size_t numFound = m.erase(std::string("30"));
+      // verify
+      assertUnit(numMissing == 0);
+      assertUnit(numFound == 1);
+      assertUnit(m.size() == 2);
+      assertUnit(!m.contains("30"));
+      assertUnit(m.count("70") == 1);
+   }  // teardown
+
+   // an extracted pair moves into another map without a copy
+   void test_map_extractInsert()
+   {  // setup
+      Map mSrc;
+      Map mDes;
+      setupStandardFixture(mSrc);
+      setupStandardFixture(mDes);
+      mDes.erase(std::string("50"));
+      Spy::reset();
+      // exercise
+      auto nh = mSrc.extract(std::string("50"));
+      nh.mapped() = Spy(55);
+      auto insertReturn = mDes.insert(std::move(nh));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(insertReturn.inserted);
+      assertUnit((*insertReturn.position).second.get() == 55);
+      assertUnit(insertReturn.node.empty());
+      assertUnit(mSrc.size() == 2 && !mSrc.contains("50"));
+      assertUnit(mDes.size() == 3);
+      assertUnit(mDes.bst.verify());
+   }  // teardown
+
+   // a copy copies each pair once
+   void test_map_copy()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Spy::reset();
+      // exercise
+      Map mDes(mSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 3);   // copy [30][50][70]
+      assertUnit(Spy::numCopyMove() == 0);
+      assertStandardFixture(mSrc);
+      assertStandardFixture(mDes);
+      assertUnit(mSrc.bst.root != mDes.bst.root);
+   }  // teardown
+
+   // a move touches no pairs
+   void test_map_move()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Spy::reset();
+      // exercise
+      Map mDes(std::move(mSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(mSrc.empty());
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // swap trades the trees
+   void test_map_swap()
+   {  // setup
+      Map m1;
+      Map m2;
+      setupStandardFixture(m1);
+      m2["99"] = Spy(99);
+      // exercise
+      swap(m1, m2);
+      // verify
+      assertStandardFixture(m2);
+      assertUnit(m1.size() == 1);
+      assertUnit(m1["99"].get() == 99);
+   }  // teardown
+
+   // clear destroys every pair
+   void test_map_clear()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      m.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 3);  // destroy [30][50][70]
+      assertUnit(Spy::numDelete() == 3);
+      assertUnit(m.empty());
+      assertUnit(m.begin() == m.end());
+   }  // teardown
+
+   // the bounds of a key between and on the pairs
+   void test_map_bounds()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto itLower = m.lower_bound("40");
+      auto itUpper = m.upper_bound("50");
+      auto pairRange = m.equal_range("50");
+      // verify
+      assertUnit((*itLower).first == std::string("50"));
+      assertUnit((*itUpper).first == std::string("70"));
+      assertUnit((*pairRange.first).first == std::string("50"));
+      assertUnit(pairRange.second == itUpper);
+      assertUnit(m.upper_bound("70") == m.end());
+   }  // teardown
+
+   // a range for walks the keys in [lo, hi)
+   void test_map_range()
+   {  // setup
+      SmallMap m;
+      for (int i = 0; i < 100; i++)
+         m[i] = i * i;
+      std::vector <int> keys;
+      // exercise
+      for (auto& p : m.range(20, 30))
+         keys.push_back(p.first);
+      // verify
+      assertUnit(keys.size() == 10);
+      assertUnit(keys.front() == 20 && keys.back() == 29);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // random operations agree with std::map
+   void test_map_random()
+   {  // setup
+      SmallMap m;
+      std::map <int, int> reference;
+      std::mt19937 random(5);
+      bool isValid = true;
+      // exercise
+      for (int i = 0; i < 20000; i++)
+      {
+         int key = int(random() % 1500);
+         switch (random() % 5)
+         {
+            case 0:
+            case 1:
+               m[key] = i;
+               reference[key] = i;
+               break;
+            case 2:
+            {
+               auto it = m.find(key);
+               auto itRef = reference.find(key);
+               isValid = isValid && ((it == m.end()) == (itRef == reference.end()));
+               if (it != m.end() && itRef != reference.end())
+               {
+                  it = m.erase(it);
+                  itRef = reference.erase(itRef);
+                  isValid = isValid && ((it == m.end()) == (itRef == reference.end()));
+                  if (it != m.end() && itRef != reference.end())
+                     isValid = isValid && (*it).first == itRef->first;
+               }
+               break;
+            }
+            case 3:
+               isValid = isValid && m.insert(custom::pair <int, int> (key, i)).second ==
+                                    reference.insert(std::make_pair(key, i)).second;
+               break;
+            default:
+            {
+               auto it = m.lower_bound(key);
+               auto itRef = reference.lower_bound(key);
+               isValid = isValid && ((it == m.end()) == (itRef == reference.end()));
+               if (it != m.end() && itRef != reference.end())
+                  isValid = isValid && (*it).first == itRef->first && (*it).second == itRef->second;
+            }
+         }
+         if (i % 500 == 0)
+         {
+            isValid = isValid && m.bst.verify() && m.size() == reference.size();
+            auto itRef = reference.begin();
+            for (auto it = m.begin(); isValid && it != m.end(); ++it, ++itRef)
+               isValid = (*it).first == itRef->first && (*it).second == itRef->second;
+         }
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   The tree is built by inserting 10, 20, 30, 40:
+    *         [30]
+    *     [10 20]  [40]
+    ****************************************************************/
+   void setupStandardFixture(Tree& t)
+   {
+      for (int value : { 10, 20, 30, 40 })
+         t.insert(value);
+   }
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   The map holds "30", "50" and "70", all in the root leaf
+    ****************************************************************/
+   void setupStandardFixture(Map& m)
+   {
+      m.insert(custom::pair <std::string, Spy> (std::string("30"), Spy(30)));
+      m.insert(custom::pair <std::string, Spy> (std::string("50"), Spy(50)));
+      m.insert(custom::pair <std::string, Spy> (std::string("70"), Spy(70)));
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *         [30]
+    *     [10 20]  [40]
+    ****************************************************************/
+   void assertStandardFixtureParameters(const Tree& t, int line, const char* function)
+   {
+      assertIndirect(t.size() == 4);
+      assertIndirect(t.verify());
+      assertIndirect(t.root != nullptr);
+      if (t.root == nullptr || t.root->isLeaf)
+         return;
+      assertIndirect(t.root->count == 1);
+      assertIndirect(t.root->value(0) == 30);
+      assertIndirect(t.pLeftmost == t.root->asInternal()->children[0]);
+      assertIndirect(t.pRightmost == t.root->asInternal()->children[1]);
+      assertIndirect(t.pLeftmost->count == 2);
+      assertIndirect(t.pLeftmost->value(0) == 10);
+      assertIndirect(t.pLeftmost->value(1) == 20);
+      assertIndirect(t.pRightmost->count == 1);
+      assertIndirect(t.pRightmost->value(0) == 40);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *   "30", "50" and "70" in the root leaf
+    ****************************************************************/
+   void assertStandardFixtureParameters(const Map& m, int line, const char* function)
+   {
+      assertIndirect(m.size() == 3);
+      assertIndirect(m.bst.verify());
+      assertIndirect(m.bst.root != nullptr);
+      if (m.bst.root == nullptr)
+         return;
+      assertIndirect(m.bst.root->isLeaf);
+      assertIndirect(m.bst.root->count == 3);
+      assertIndirect(m.bst.root->value(0).first == std::string("30"));
+      assertIndirect(m.bst.root->value(0).second.get() == 30);
+      assertIndirect(m.bst.root->value(1).first == std::string("50"));
+      assertIndirect(m.bst.root->value(1).second.get() == 50);
+      assertIndirect(m.bst.root->value(2).first == std::string("70"));
+      assertIndirect(m.bst.root->value(2).second.get() == 70);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,1181 @@
+/***********************************************************************
+ * Header:
+ *    TEST FLAT TREE
+ * Summary:
+ *    Unit tests for the flat tree and for a flat_map kept in one
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "flatTree.h"   // class under test
+#include "map.h"        // flat_map keeps its pairs in a flat_tree
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // spy is a mock class to monitor the class under test
+
+#include <map>             // for std::map to check against
+#include <vector>          // for std::vector
+#include <random>          // for std::mt19937
+#include <algorithm>       // for std::lower_bound, std::upper_bound and std::reverse_copy
+#include <stdexcept>       // for std::out_of_range
+#include <string_view>     // for std::string_view
+#include <memory_resource> // for std::pmr::monotonic_buffer_resource
+
+/***********************************************
+ * TEST FLAT TREE
+ * Unit tests for the flat_tree class and for
+ * the flat_map that uses it
+ ***********************************************/
+class TestFlatTree : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+      test_constructInit_standard();
+      test_constructRange_duplicates();
+      test_constructRange_sortedUnique();
+
+      // Assign
+      test_assign_standardToNotempty();
+      test_assignMove_standardToNotempty();
+      test_assignInit_standardToNotempty();
+      test_swap_standardToStandard();
+
+      // Iterator
+      test_begin_standard();
+      test_end_decrement();
+      test_iterator_jump();
+      test_iterator_randomAccess();
+
+      // Access
+      test_access_standardRead();
+      test_access_emptyWrite();
+      test_access_standardFrontInsert();
+      test_at_standardWrite();
+      test_at_missing();
+      test_find_standard();
+      test_find_standardMissing();
+
+      // Search
+      test_search_everySize();
+
+      // Insert
+      test_insertCopy_standardMiddle();
+      test_insertMove_standard();
+      test_insert_grows();
+      test_emplace_standardDuplicate();
+      test_tryEmplace_standard();
+      test_tryEmplace_standardDuplicate();
+      test_insertOrAssign_standardDuplicate();
+      test_insertHint_inOrder();
+      test_insertHint_wrong();
+      test_insertRange_unsorted();
+      test_insertRange_pastEnd();
+
+      // Capacity
+      test_reserve_noMove();
+      test_shrinkToFit_standard();
+
+      // Remove
+      test_erase_standardKey();
+      test_erase_standardIterator();
+      test_erase_standardRange();
+      test_clear_standard();
+
+      // Node handles
+      test_extract_insertOtherMap();
+      test_merge_overlap();
+
+      // Bounds
+      test_bounds_standard();
+      test_range_standard();
+      test_transparent_lookupByInt();
+      test_transparent_stringView();
+
+      // Order statistics
+      test_nth_standard();
+      test_rank_countRange();
+      test_distance_standard();
+
+      // Status
+      test_empty_standard();
+
+      // Allocator
+      test_allocator_pmrArena();
+
+      // Random
+      test_map_random();
+
+      report("FlatTree");
+   }
+
+   using Tree = custom::flat_tree <int>;
+   using Map = custom::flat_map <std::string, Spy>;
+   using IntMap = custom::flat_map <int, int>;
+
+   // orders Spy keys and lets a plain int stand in for one
+   struct SpyLess
+   {
+      using is_transparent = void;
+      bool operator () (const Spy& lhs, const Spy& rhs) const { return lhs.get() < rhs.get(); }
+      bool operator () (const Spy& lhs, int rhs)        const { return lhs.get() < rhs;       }
+      bool operator () (int lhs, const Spy& rhs)        const { return lhs < rhs.get();       }
+   };
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new flat map allocates nothing
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      Map m;
+      // verify
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(m.bst.pValues == nullptr);
+      assertUnit(m.bst.numElements == 0);
+      assertUnit(m.bst.numCapacity == 0);
+      assertUnit(m.empty());
+   }  // teardown
+
+   // a copy has an array of its own, just big enough
+   void test_constructCopy_standard()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Spy::reset();
+      // exercise
+      Map mDes(mSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy [30][50][70]
+      assertUnit(Spy::numAlloc() == 3);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(mDes.bst.numCapacity == 3);
+      assertUnit(mDes.bst.pValues != mSrc.bst.pValues);
+      assertStandardFixture(mSrc);
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // a move takes the array and touches no pairs
+   void test_constructMove_standard()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Spy::reset();
+      // exercise
+      Map mDes(std::move(mSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(mSrc.empty());
+      assertUnit(mSrc.bst.pValues == nullptr);
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // an initializer list out of order comes out sorted
+   void test_constructInit_standard()
+   {  // setup
+      Spy::reset();
+      // exercise
+      Map m = { custom::pair <std::string, Spy> (std::string("70"), Spy(70)),
+                custom::pair <std::string, Spy> (std::string("30"), Spy(30)),
+                custom::pair <std::string, Spy> (std::string("50"), Spy(50)) };
+      // verify
+      assertStandardFixture(m);
+   }  // teardown
+
+   // the first of each repeated key is kept, the others are dropped
+   void test_constructRange_duplicates()
+   {  // setup
+      std::vector <custom::pair<std::string, Spy>> v;
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(70)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(50)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(71)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("30"), Spy(30)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(51)));
+      Spy::reset();
+      // exercise
+      Map m(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 5);     // copy-create all five
+      assertUnit(Spy::numDelete() == 2);   // free [71][51]
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(m.bst.numCapacity == 5);  // room for all five was made at once
+      assertStandardFixture(m);
+   }  // teardown
+
+   // sorted input is copied straight in, with nothing moved
+   void test_constructRange_sortedUnique()
+   {  // setup
+      std::vector <custom::pair<std::string, Spy>> v;
+      v.push_back(custom::pair<std::string, Spy>(std::string("30"), Spy(30)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(50)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(70)));
+      Spy::reset();
+      // exercise
+      Map m(custom::sorted_unique, v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy-create [30][50][70]
+      assertUnit(Spy::numAlloc() == 3);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(m.bst.numCapacity == 3);
+      assertStandardFixture(m);
+   }  // teardown
+
+   /***************************************
+    * ASSIGN
+    ***************************************/
+
+   // copying over a map that has room reuses its array
+   void test_assign_standardToNotempty()
+   {  // setup
+      Map mSrc;
+      Map mDes;
+      setupStandardFixture(mSrc);
+      setupStandardFixture(mDes);
+      mDes["99"] = Spy(99);
+      const custom::pair <std::string, Spy>* pValuesOld = mDes.bst.pValues;
+      Spy::reset();
+      // exercise
+      mDes = mSrc;
+      // verify
+      assertUnit(Spy::numDestructor() == 4);  // destroy the old four
+      assertUnit(Spy::numCopy() == 3);        // copy [30][50][70]
+      assertUnit(mDes.bst.pValues == pValuesOld);
+      assertStandardFixture(mSrc);
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // move assignment frees the old pairs and takes the new array
+   void test_assignMove_standardToNotempty()
+   {  // setup
+      Map mSrc;
+      Map mDes;
+      setupStandardFixture(mSrc);
+      mDes["99"] = Spy(99);
+      const custom::pair <std::string, Spy>* pValuesSrc = mSrc.bst.pValues;
+      Spy::reset();
+      // exercise
+      mDes = std::move(mSrc);
+      // verify
+      assertUnit(Spy::numDestructor() == 1);  // destroy [99]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(mDes.bst.pValues == pValuesSrc);
+      assertUnit(mSrc.empty());
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // an initializer list replaces what was there
+   void test_assignInit_standardToNotempty()
+   {  // setup
+      Map m;
+      m["99"] = Spy(99);
+      // exercise
+      m = { custom::pair <std::string, Spy> (std::string("50"), Spy(50)),
+            custom::pair <std::string, Spy> (std::string("70"), Spy(70)),
+            custom::pair <std::string, Spy> (std::string("30"), Spy(30)) };
+      // verify
+      assertStandardFixture(m);
+   }  // teardown
+
+   // swap trades the arrays
+   void test_swap_standardToStandard()
+   {  // setup
+      Map m1;
+      Map m2;
+      setupStandardFixture(m1);
+      m2["99"] = Spy(99);
+      Spy::reset();
+      // exercise
+      swap(m1, m2);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertStandardFixture(m2);
+      assertUnit(m1.size() == 1);
+      assertUnit(m1["99"].get() == 99);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // begin is the smallest key
+   void test_begin_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it = m.begin();
+      // verify
+      assertUnit((*it).first == std::string("30"));
+      assertUnit((*it).second.get() == 30);
+      assertUnit(m.begin() != m.end());
+      assertStandardFixture(m);
+   }  // teardown
+
+   // stepping back from end reaches the largest key
+   void test_end_decrement()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it = m.end();
+      --it;
+      // verify
+      assertUnit((*it).first == std::string("70"));
+      --it;
+      assertUnit((*it).first == std::string("50"));
+      ++it;
+      ++it;
+      assertUnit(it == m.end());
+   }  // teardown
+
+   // the tree's iterator can jump and subtract, as a pointer does
+   void test_iterator_jump()
+   {  // setup
+      Tree t;
+      for (int value : { 40, 10, 30, 20 })
+         t.insert(value);
+      // exercise
+      auto it = t.begin() + 2;
+      // verify
+      assertUnit(*it == 30);
+      assertUnit(it - t.begin() == 2);
+      assertUnit(t.end() - it == 2);
+      assertUnit(*(it - 1) == 20);
+      assertUnit(t.begin() < it);
+   }  // teardown
+
+   // everything a random access iterator promises, so generic code can trust the tag
+   void test_iterator_randomAccess()
+   {  // setup
+      Tree t;
+      for (int value : { 40, 10, 30, 20 })
+         t.insert(value);
+      auto it = t.begin();
+      // exercise
+      it += 3;
+      it -= 2;
+      // verify
+      assertUnit(*it == 20);
+      assertUnit(it[2] == 40);
+      assertUnit(*(2 + it) == 40);
+      assertUnit(it > t.begin());
+      assertUnit(it >= t.begin() + 1);
+      assertUnit(it <= t.begin() + 1);
+      assertUnit(!(it > t.end()));
+      assertUnit(std::lower_bound(t.begin(), t.end(), 30) - t.begin() == 2);
+      std::vector <int> v(4);
+      std::reverse_copy(t.begin(), t.end(), v.begin());
+      assertUnit(v == std::vector <int>({ 40, 30, 20, 10 }));
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // reading with the subscript changes nothing
+   void test_access_standardRead()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      Spy s = m["50"];
+      // verify
+      assertUnit(s.get() == 50);
+      assertUnit(Spy::numCopy() == 1);     // copy [50] out
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // writing to an empty map adds the key
+   void test_access_emptyWrite()
+   {  // setup
+      Map m;
+      Spy::reset();
+      // exercise
+      m["50"] = Spy(50);
+      // verify
+      assertUnit(Spy::numDefault() == 1);  // the new value starts out blank
+      assertUnit(Spy::numAssignMove() == 1);
+      assertUnit(m.size() == 1);
+      assertUnit(m.bst.numCapacity == 4);
+      assertUnit(m["50"].get() == 50);
+   }  // teardown
+
+   // a key before them all moves the others down one slot
+   //    "10"     "30"     "50"     "70"
+   void test_access_standardFrontInsert()
+   {  // setup
+      Spy s(10);
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      m[std::string("10")] = s;
+      // verify
+      assertUnit(Spy::numDefault() == 1);    // the new value starts out blank
+      assertUnit(Spy::numAssign() == 1);     // then [10] is assigned to it
+      assertUnit(Spy::numAlloc() == 1);
+      assertUnit(Spy::numCopyMove() == 1);   // [70] moves into the spare slot
+      assertUnit(Spy::numAssignMove() == 2); // [50][30] move over one
+      assertUnit(Spy::numDestructor() == 1); // the husk where [10] goes
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(m.size() == 4);
+      assertUnit((*m.begin()).first == std::string("10"));
+      assertUnit((*m.begin()).second.get() == 10);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // at can change a value in place
+   void test_at_standardWrite()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      m.at("50") = Spy(55);
+      // verify
+      assertUnit(m.at("50").get() == 55);
+      assertUnit(m.size() == 3);
+   }  // teardown
+
+   // at throws for a key that is not there, and adds nothing
+   void test_at_missing()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      bool isThrown = false;
+      // exercise
+      try
+      {
+         m.at("40");
+      }
+      catch (const std::out_of_range&)
+      {
+         isThrown = true;
+      }
+      // verify
+      assertUnit(isThrown);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // find lands on the pair
+   void test_find_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it30 = m.find("30");
+      auto it70 = m.find("70");
+      // verify
+      assertUnit(it30 == m.begin());
+      assertUnit((*it70).second.get() == 70);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // find for a missing key is end()
+   void test_find_standardMissing()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it = m.find("40");
+      // verify
+      assertUnit(it == m.end());
+      assertUnit(m.find("") == m.end());
+      assertUnit(m.find("99") == m.end());
+      assertStandardFixture(m);
+   }  // teardown
+
+   /***************************************
+    * SEARCH
+    ***************************************/
+
+   // the branch-free search agrees with std::lower_bound and
+   // std::upper_bound at every size, repeats and all
+   void test_search_everySize()
+   {  // setup
+      std::mt19937 random(13);
+      bool isValid = true;
+      // exercise
+      for (int num = 0; num <= 40; num++)
+      {
+         Tree t;
+         std::vector <int> values;
+         for (int i = 0; i < num; i++)
+         {
+            int value = int(random() % 20);
+            t.insert(value);
+            values.push_back(value);
+         }
+         std::sort(values.begin(), values.end());
+         for (int k = -1; k <= 20; k++)
+         {
+            size_t iLower = std::lower_bound(values.begin(), values.end(), k) - values.begin();
+            size_t iUpper = std::upper_bound(values.begin(), values.end(), k) - values.begin();
+            isValid = isValid && t.lowerBoundIndex(k) == iLower && t.upperBoundIndex(k) == iUpper;
+         }
+         isValid = isValid && t.verify();
+      }
+      // verify
+      assertUnit(isValid);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // a copy goes in the middle
+   //    "30"     "50"     "60"     "70"
+   void test_insertCopy_standardMiddle()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      custom::pair <std::string, Spy> pair60(std::string("60"), Spy(60));
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.insert(pair60);
+      // verify
+      assertUnit(Spy::numCopy() == 1);       // copy [60] in
+      assertUnit(Spy::numCopyMove() == 1);   // [70] moves over
+      assertUnit(pairReturn.second);
+      assertUnit((*pairReturn.first).first == std::string("60"));
+      assertUnit(m.rank("60") == 2);
+      assertUnit(m.size() == 4);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // a pair moved in is not copied
+   void test_insertMove_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.insert(custom::pair <std::string, Spy> (std::string("80"), Spy(80)));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 80);
+      assertUnit(m.size() == 4);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // a full array doubles, moving the pairs rather than copying them
+   void test_insert_grows()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      m["90"] = Spy(90);
+      Spy::reset();
+      // exercise
+      m["10"] = Spy(10);
+      // verify
+      assertUnit(m.bst.numCapacity == 8);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 4);    // [30][50][70][90] into the new array
+      assertUnit(Spy::numAssignMove() == 1);  // and [10] into its slot
+      assertUnit(m.size() == 5);
+      assertUnit((*m.begin()).second.get() == 10);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // emplacing a key already there leaves the map alone
+   void test_emplace_standardDuplicate()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto pairReturn = m.emplace(std::string("50"), Spy(99));
+      // verify
+      assertUnit(!pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 50);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // try_emplace builds the value right in its slot
+   void test_tryEmplace_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.try_emplace(std::string("60"), 60);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [60] in place
+      assertUnit(Spy::numCopyMove() == 1);    // [70] moves over one slot
+      assertUnit(Spy::numDestructor() == 1);  // and leaves its old slot behind
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 60);
+      assertUnit(m.size() == 4);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // try_emplace a key that is already there: nothing is built
+   void test_tryEmplace_standardDuplicate()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.try_emplace(std::string("50"), 99);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(!pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 50);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // insert_or_assign a key that is already there assigns the value
+   void test_insertOrAssign_standardDuplicate()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.insert_or_assign(std::string("50"), s);
+      // verify
+      assertUnit(Spy::numAssign() == 1);      // assign [99] over [50]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(!pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 99);
+      assertUnit(m.size() == 3);
+   }  // teardown
+
+   // keys given in order with end() as the hint are simply appended
+   void test_insertHint_inOrder()
+   {  // setup
+      custom::flat_map <int, Spy> m;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         m.insert(m.end(), custom::pair <int, Spy> (i, Spy(i)));
+      // verify
+      assertUnit(m.size() == 100);
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = m.begin(); it != m.end(); ++it, ++expected)
+         inOrder = inOrder && (*it).first == expected && (*it).second.get() == expected;
+      assertUnit(inOrder);
+      assertUnit(expected == 100);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // a hint in the wrong place is ignored
+   void test_insertHint_wrong()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it = m.insert(m.begin(), custom::pair <std::string, Spy> (std::string("80"), Spy(80)));
+      auto itDuplicate = m.insert(m.end(), custom::pair <std::string, Spy> (std::string("30"), Spy(3)));
+      // verify
+      assertUnit((*it).first == std::string("80"));
+      assertUnit(m.rank("80") == 3);
+      assertUnit(itDuplicate == m.begin());
+      assertUnit((*itDuplicate).second.get() == 30);
+      assertUnit(m.size() == 4);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // a range out of order is sorted in. Keys already here keep
+   // their values, and the first of repeats in the range wins.
+   void test_insertRange_unsorted()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      std::vector <custom::pair<std::string, Spy>> v;
+      v.push_back(custom::pair<std::string, Spy>(std::string("60"), Spy(60)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("10"), Spy(10)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(51)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("60"), Spy(61)));
+      Spy::reset();
+      // exercise
+      m.insert(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 4);     // copy all four in
+      assertUnit(Spy::numDelete() == 2);   // free [51][61]
+      assertUnit(m.size() == 5);
+      assertUnit(m.at("10").get() == 10);
+      assertUnit(m.at("50").get() == 50);
+      assertUnit(m.at("60").get() == 60);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // a range past the end in order is appended: no sort, no merge
+   void test_insertRange_pastEnd()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      m.reserve(6);
+      std::vector <custom::pair<std::string, Spy>> v;
+      v.push_back(custom::pair<std::string, Spy>(std::string("80"), Spy(80)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("90"), Spy(90)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("95"), Spy(95)));
+      Spy::reset();
+      // exercise
+      m.insert(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(m.size() == 6);
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   /***************************************
+    * CAPACITY
+    ***************************************/
+
+   // with room reserved, the array never moves
+   void test_reserve_noMove()
+   {  // setup
+      IntMap m;
+      // exercise
+      m.reserve(100);
+      const custom::pair <int, int>* pValues = m.bst.pValues;
+      for (int i = 0; i < 100; i++)
+         m[i] = i;
+      // verify
+      assertUnit(m.bst.pValues == pValues);
+      assertUnit(m.bst.numCapacity == 100);
+      assertUnit(m.size() == 100);
+   }  // teardown
+
+   // shrink_to_fit gives back the spare slots, or the whole array
+   void test_shrinkToFit_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      m.shrink_to_fit();
+      // verify
+      assertUnit(m.bst.numCapacity == 3);
+      assertStandardFixture(m);
+      m.clear();
+      m.shrink_to_fit();
+      assertUnit(m.bst.pValues == nullptr);
+      assertUnit(m.bst.numCapacity == 0);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erasing by key says how many went
+   void test_erase_standardKey()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      size_t numMissing = m.erase(std::string("40"));
+      size_t numFound = m.erase(std::string("30"));
+      // verify
+      assertUnit(numMissing == 0);
+      assertUnit(numFound == 1);
+      assertUnit(m.size() == 2);
+      assertUnit(!m.contains("30"));
+      assertUnit((*m.begin()).second.get() == 50);
+   }  // teardown
+
+   // erasing by iterator returns the next one
+   void test_erase_standardIterator()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it = m.erase(m.find("50"));
+      // verify
+      assertUnit(it != m.end());
+      assertUnit((*it).first == std::string("70"));
+      assertUnit(m.size() == 2);
+      assertUnit(m.erase(m.end()) == m.end());
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   // a range goes with one move of what follows it
+   void test_erase_standardRange()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      auto itFirst = m.begin();
+      auto itLast = m.begin();
+      ++itLast;
+      ++itLast;
+      Spy::reset();
+      // exercise
+      auto itReturn = m.erase(itFirst, itLast);
+      // verify
+      assertUnit(Spy::numDelete() == 2);      // free [30][50]
+      assertUnit(Spy::numAssignMove() == 1);  // [70] moves to the front
+      assertUnit(Spy::numDestructor() == 2);  // the two slots left at the end
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(itReturn == m.begin());
+      assertUnit((*itReturn).first == std::string("70"));
+      assertUnit(m.size() == 1);
+   }  // teardown
+
+   // clear destroys every pair but keeps the array
+   void test_clear_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      m.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 3);  // destroy [30][50][70]
+      assertUnit(Spy::numDelete() == 3);
+      assertUnit(m.empty());
+      assertUnit(m.begin() == m.end());
+      assertUnit(m.bst.numCapacity == 4);
+   }  // teardown
+
+   /***************************************
+    * NODE HANDLES
+    ***************************************/
+
+   // an extracted pair moves into another map without a copy
+   void test_extract_insertOtherMap()
+   {  // setup
+      Map mSrc;
+      Map mDes;
+      setupStandardFixture(mSrc);
+      setupStandardFixture(mDes);
+      mDes.erase(std::string("50"));
+      Spy::reset();
+      // exercise
+      auto nh = mSrc.extract(std::string("50"));
+      nh.mapped() = Spy(55);
+      auto insertReturn = mDes.insert(std::move(nh));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(insertReturn.inserted);
+      assertUnit((*insertReturn.position).second.get() == 55);
+      assertUnit(insertReturn.node.empty());
+      assertUnit(mSrc.size() == 2 && !mSrc.contains("50"));
+      assertUnit(mDes.size() == 3);
+      assertUnit(mDes.bst.verify());
+   }  // teardown
+
+   // merge moves over the keys that are missing and leaves the rest
+   void test_merge_overlap()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Map mSrc;
+      mSrc[std::string("50")] = Spy(5);
+      mSrc[std::string("60")] = Spy(60);
+      mSrc[std::string("80")] = Spy(80);
+      m.reserve(5);
+      Spy::reset();
+      // exercise
+      m.merge(mSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(m.size() == 5);
+      assertUnit(m.at(std::string("50")).get() == 50);
+      assertUnit(m.at(std::string("60")).get() == 60);
+      assertUnit(m.at(std::string("80")).get() == 80);
+      assertUnit(mSrc.size() == 1);
+      assertUnit(mSrc.at(std::string("50")).get() == 5);
+      assertUnit(m.bst.verify());
+      assertUnit(mSrc.bst.verify());
+   }  // teardown
+
+   /***************************************
+    * BOUNDS
+    ***************************************/
+
+   // the bounds of a key between and on the pairs
+   void test_bounds_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto itLower = m.lower_bound("40");
+      auto itUpper = m.upper_bound("50");
+      auto pairRange = m.equal_range("50");
+      // verify
+      assertUnit((*itLower).first == std::string("50"));
+      assertUnit((*itUpper).first == std::string("70"));
+      assertUnit((*pairRange.first).first == std::string("50"));
+      assertUnit(pairRange.second == itUpper);
+      assertUnit(m.upper_bound("70") == m.end());
+      assertUnit(m.lower_bound("10") == m.begin());
+   }  // teardown
+
+   // a range for walks the keys in [lo, hi)
+   void test_range_standard()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 100; i++)
+         m[i] = i * i;
+      std::vector <int> keys;
+      // exercise
+      for (auto& p : m.range(20, 30))
+         keys.push_back(p.first);
+      // verify
+      assertUnit(keys.size() == 10);
+      assertUnit(keys.front() == 20 && keys.back() == 29);
+      assertUnit(m.range(30, 20).begin() == m.range(30, 20).end());
+   }  // teardown
+
+   // look up Spy keys with an int: no key is ever built
+   void test_transparent_lookupByInt()
+   {  // setup
+      custom::flat_map <Spy, int, SpyLess> m;
+      m[Spy(50)] = 5;
+      m[Spy(30)] = 3;
+      m[Spy(70)] = 7;
+      Spy::reset();
+      // exercise
+      auto it = m.find(30);
+      size_t count = m.count(70);
+      bool containsMissing = m.contains(42);
+      auto itLower = m.lower_bound(40);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);  // no key is made from the int
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numLessthan() == 0);    // the comparator does all the work
+      assertUnit(it != m.end());
+      assertUnit((*it).second == 3);
+      assertUnit(count == 1);
+      assertUnit(!containsMissing);
+      assertUnit((*itLower).second == 5);
+   }  // teardown
+
+   // a string_view finds a std::string key with std::less<>
+   void test_transparent_stringView()
+   {  // setup
+      custom::flat_map <std::string, int, std::less <> > m;
+      m[std::string("30")] = 3;
+      m[std::string("50")] = 5;
+      m[std::string("70")] = 7;
+      const char buffer[] = "xx50yy";
+      // exercise
+      auto it = m.find(std::string_view(buffer + 2, 2));
+      int value = (it == m.end()) ? 0 : (*it).second;
+      bool contains70 = m.contains("70");
+      size_t numErased = m.erase(std::string_view("30"));  // it now points to "70"
+      // verify
+      assertUnit(value == 5);
+      assertUnit(contains70);
+      assertUnit(numErased == 1);
+      assertUnit(m.size() == 2);
+      assertUnit(m.find("30") == m.end());
+   }  // teardown
+
+   /***************************************
+    * ORDER STATISTICS
+    ***************************************/
+
+   // nth is an index into the array
+   void test_nth_standard()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 100; i++)
+         m[(i * 37) % 100] = i;
+      // exercise
+      auto it = m.nth(42);
+      // verify
+      assertUnit(it != m.end());
+      assertUnit((*it).first == 42);
+      assertUnit(m.nth(0) == m.begin());
+      assertUnit(m.nth(100) == m.end());
+   }  // teardown
+
+   // rank and count_range are searches, not walks
+   void test_rank_countRange()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 100; i++)
+         m[i * 2] = i;
+      // exercise
+      // verify
+      assertUnit(m.rank(0) == 0);
+      assertUnit(m.rank(50) == 25);
+      assertUnit(m.rank(51) == 26);
+      assertUnit(m.rank(1000) == 100);
+      assertUnit(m.count_range(10, 20) == 5);
+      assertUnit(m.count_range(20, 10) == 0);
+   }  // teardown
+
+   // distance is a subtraction
+   void test_distance_standard()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 100; i++)
+         m[i] = i;
+      using std::distance;
+      // exercise
+      // verify
+      assertUnit(distance(m.begin(), m.end()) == 100);
+      assertUnit(distance(m.find(20), m.find(70)) == 50);
+      assertUnit(std::distance(m.find(70), m.end()) == 30);
+   }  // teardown
+
+   /***************************************
+    * STATUS
+    ***************************************/
+
+   // empty and size follow the inserts and erases
+   void test_empty_standard()
+   {  // setup
+      Map m;
+      // exercise
+      // verify
+      assertUnit(m.empty());
+      assertUnit(m.size() == 0);
+      setupStandardFixture(m);
+      assertUnit(!m.empty());
+      assertUnit(m.size() == 3);
+      m.erase(std::string("50"));
+      assertUnit(m.size() == 2);
+   }  // teardown
+
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+
+   // a flat map with a pmr allocator keeps its array in the arena
+   void test_allocator_pmrArena()
+   {  // setup
+      char buffer[4096];
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                                std::pmr::null_memory_resource());
+      custom::flat_map <int, int, std::less <int>,
+                        std::pmr::polymorphic_allocator <custom::pair <int, int> > > m(&arena);
+      // exercise
+      for (int i = 0; i < 20; i++)
+         m[i] = i * i;
+      // verify
+      assertUnit(m.size() == 20);
+      assertUnit(m.get_allocator().resource() == &arena);
+      assertUnit((char*)m.bst.pValues >= buffer &&
+                 (char*)(m.bst.pValues + m.bst.numCapacity) <= buffer + sizeof(buffer));
+      assertUnit(m.at(7) == 49);
+   }  // teardown
+
+   /***************************************
+    * RANDOM
+    ***************************************/
+
+   // random operations, bulk inserts among them, agree with std::map
+   void test_map_random()
+   {  // setup
+      IntMap m;
+      std::map <int, int> reference;
+      std::mt19937 random(17);
+      bool isValid = true;
+      // exercise
+      for (int i = 0; i < 20000; i++)
+      {
+         int key = int(random() % 1500);
+         switch (random() % 6)
+         {
+            case 0:
+            case 1:
+               m[key] = i;
+               reference[key] = i;
+               break;
+            case 2:
+            {
+               auto it = m.find(key);
+               auto itRef = reference.find(key);
+               isValid = isValid && ((it == m.end()) == (itRef == reference.end()));
+               if (it != m.end() && itRef != reference.end())
+               {
+                  it = m.erase(it);
+                  itRef = reference.erase(itRef);
+                  isValid = isValid && ((it == m.end()) == (itRef == reference.end()));
+                  if (it != m.end() && itRef != reference.end())
+                     isValid = isValid && (*it).first == itRef->first;
+               }
+               break;
+            }
+            case 3:
+            {
+               std::vector <custom::pair <int, int> > v;
+               for (int j = 0; j < 5; j++)
+               {
+                  int keyNew = int(random() % 1500);
+                  v.push_back(custom::pair <int, int> (keyNew, i));
+                  reference.insert(std::make_pair(keyNew, i));
+               }
+               m.insert(v.begin(), v.end());
+               break;
+            }
+            default:
+            {
+               auto it = m.lower_bound(key);
+               auto itRef = reference.lower_bound(key);
+               isValid = isValid && ((it == m.end()) == (itRef == reference.end()));
+               if (it != m.end() && itRef != reference.end())
+                  isValid = isValid && (*it).first == itRef->first && (*it).second == itRef->second;
+            }
+         }
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(m.size() == reference.size());
+      assertUnit(m.bst.verify());
+   }  // teardown
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   "30", "50" and "70" in an array with room for four
+    ****************************************************************/
+   void setupStandardFixture(Map& m)
+   {
+      m.insert(custom::pair <std::string, Spy> (std::string("30"), Spy(30)));
+      m.insert(custom::pair <std::string, Spy> (std::string("50"), Spy(50)));
+      m.insert(custom::pair <std::string, Spy> (std::string("70"), Spy(70)));
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *    +----+----+----+
+    *    | 30 | 50 | 70 |
+    *    +----+----+----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(const Map& m, int line, const char* function)
+   {
+      assertIndirect(m.size() == 3);
+      assertIndirect(m.bst.verify());
+      assertIndirect(m.bst.pValues != nullptr);
+      if (m.bst.pValues == nullptr || m.bst.numElements != 3)
+         return;
+      assertIndirect(m.bst.pValues[0].first == std::string("30"));
+      assertIndirect(m.bst.pValues[0].second.get() == 30);
+      assertIndirect(m.bst.pValues[1].first == std::string("50"));
+      assertIndirect(m.bst.pValues[1].second.get() == 50);
+      assertIndirect(m.bst.pValues[2].first == std::string("70"));
+      assertIndirect(m.bst.pValues[2].second.get() == 70);
+   }
+};
+
+#endif // DEBUG
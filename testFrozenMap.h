@@ -0,0 +1,754 @@
+/***********************************************************************
+ * Header:
+ *    TEST FROZEN MAP
+ * Summary:
+ *    Unit tests for frozen_map and for map::freeze()
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "frozenMap.h"  // class under test
+#include "map.h"        // a frozen map is made by map::freeze()
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // spy is a mock class to monitor the class under test
+
+#include <map>             // for std::map to check against
+#include <vector>          // for std::vector
+#include <random>          // for std::mt19937
+#include <stdexcept>       // for std::out_of_range
+#include <cstdint>         // for uintptr_t
+#include <memory_resource> // for std::pmr::monotonic_buffer_resource
+
+/***********************************************
+ * TEST FROZEN MAP
+ * Unit tests for the frozen_map class and for
+ * freezing each kind of map
+ ***********************************************/
+class TestFrozenMap : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_freeze_empty();
+      test_freeze_standard();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+      test_constructRange_sortedUnique();
+      test_constructRange_singlePass();
+
+      // Assign
+      test_assign_standardToNotempty();
+      test_assignMove_standardToNotempty();
+      test_swap_standardToEmpty();
+
+      // Layout
+      test_layout_seven();
+      test_layout_ten();
+      test_layout_aligned();
+
+      // Iterator
+      test_iterator_everySize();
+
+      // Access
+      test_find_standard();
+      test_find_standardMissing();
+      test_at_standard();
+      test_at_missing();
+      test_bounds_standard();
+      test_bounds_everySize();
+      test_transparent_lookupByInt();
+
+      // Snapshot
+      test_freeze_mapChangesAfter();
+      test_freeze_btreeMap();
+      test_freeze_flatMap();
+
+      // Allocator
+      test_allocator_pmrArena();
+      test_allocator_pmrMoveOtherResource();
+      test_allocator_moveNoexcept();
+
+      // Random
+      test_freeze_random();
+
+      report("FrozenMap");
+   }
+
+   using Map = custom::map <std::string, Spy>;
+   using Frozen = custom::frozen_map <std::string, Spy>;
+   using IntMap = custom::map <int, int>;
+   using IntFrozen = custom::frozen_map <int, int>;
+
+   // orders Spy keys and lets a plain int stand in for one
+   struct SpyLess
+   {
+      using is_transparent = void;
+      bool operator () (const Spy& lhs, const Spy& rhs) const { return lhs.get() < rhs.get(); }
+      bool operator () (const Spy& lhs, int rhs)        const { return lhs.get() < rhs;       }
+      bool operator () (int lhs, const Spy& rhs)        const { return lhs < rhs.get();       }
+   };
+
+   // an input iterator over pairs, counting how often one is read
+   struct SinglePass
+   {
+      using iterator_category = std::input_iterator_tag;
+      using value_type = custom::pair <std::string, Spy>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const value_type*;
+      using reference = const value_type&;
+
+      SinglePass(const value_type* p, size_t* pNumReads) : p(p), pNumReads(pNumReads) {}
+      reference operator * () const { ++*pNumReads; return *p; }
+      SinglePass& operator ++ () { ++p; return *this; }
+      bool operator == (const SinglePass& rhs) const { return p == rhs.p; }
+      bool operator != (const SinglePass& rhs) const { return p != rhs.p; }
+
+      const value_type* p;
+      size_t* pNumReads;
+   };
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new frozen map allocates nothing
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      Frozen f;
+      // verify
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(f.pKeys == nullptr);
+      assertUnit(f.pPairs == nullptr);
+      assertUnit(f.numElements == 0);
+      assertUnit(f.empty());
+      assertUnit(f.begin() == f.end());
+   }  // teardown
+
+   // freezing an empty map allocates nothing either
+   void test_freeze_empty()
+   {  // setup
+      Map m;
+      Spy::reset();
+      // exercise
+      Frozen f = m.freeze();
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(f.pKeys == nullptr);
+      assertUnit(f.empty());
+      assertUnit(f.find("50") == f.end());
+      assertUnit(f.lower_bound("50") == f.end());
+   }  // teardown
+
+   // freezing copies each pair once and leaves the map alone
+   void test_freeze_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      Frozen f = m.freeze();
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy [30][50][70]
+      assertUnit(Spy::numAlloc() == 3);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(m.size() == 3);
+      assertStandardFixture(f);
+   }  // teardown
+
+   // a copy has arrays of its own in the same layout
+   void test_constructCopy_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen fSrc = m.freeze();
+      Spy::reset();
+      // exercise
+      Frozen fDes(fSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy [30][50][70]
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(fDes.pKeys != fSrc.pKeys);
+      assertUnit(fDes.pPairs != fSrc.pPairs);
+      assertStandardFixture(fSrc);
+      assertStandardFixture(fDes);
+   }  // teardown
+
+   // a move takes the arrays and touches no pairs
+   void test_constructMove_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen fSrc = m.freeze();
+      Spy::reset();
+      // exercise
+      Frozen fDes(std::move(fSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(fSrc.empty());
+      assertUnit(fSrc.pKeys == nullptr);
+      assertStandardFixture(fDes);
+   }  // teardown
+
+   // a sorted range needs no map at all
+   void test_constructRange_sortedUnique()
+   {  // setup
+      std::vector <custom::pair <std::string, Spy> > v;
+      v.push_back(custom::pair <std::string, Spy> (std::string("30"), Spy(30)));
+      v.push_back(custom::pair <std::string, Spy> (std::string("50"), Spy(50)));
+      v.push_back(custom::pair <std::string, Spy> (std::string("70"), Spy(70)));
+      Spy::reset();
+      // exercise
+      Frozen f(custom::sorted_unique, v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);
+      assertUnit(Spy::numLessthan() == 0);
+      assertStandardFixture(f);
+   }  // teardown
+
+   // a range that can be read only once is read only once
+   void test_constructRange_singlePass()
+   {  // setup
+      std::vector <custom::pair <std::string, Spy> > v;
+      v.push_back(custom::pair <std::string, Spy> (std::string("30"), Spy(30)));
+      v.push_back(custom::pair <std::string, Spy> (std::string("50"), Spy(50)));
+      v.push_back(custom::pair <std::string, Spy> (std::string("70"), Spy(70)));
+      size_t numReads = 0;
+      SinglePass first(v.data(), &numReads);
+      SinglePass last(v.data() + v.size(), &numReads);
+      Spy::reset();
+      // exercise
+      Frozen f(custom::sorted_unique, first, last);
+      // verify
+      assertUnit(numReads == 3);
+      assertUnit(Spy::numCopy() == 3);     // gathered up
+      assertUnit(Spy::numCopyMove() == 3); // then moved into the slots
+      assertUnit(Spy::numLessthan() == 0);
+      assertStandardFixture(f);
+   }  // teardown
+
+   /***************************************
+    * ASSIGN
+    ***************************************/
+
+   // assignment throws the old pairs away and copies the new ones
+   void test_assign_standardToNotempty()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Frozen fSrc = mSrc.freeze();
+      Map mDes;
+      mDes["20"] = Spy(20);
+      mDes["40"] = Spy(40);
+      Frozen fDes = mDes.freeze();
+      Spy::reset();
+      // exercise
+      fDes = fSrc;
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy [30][50][70]
+      assertUnit(Spy::numDestructor() == 2);  // destroy [20][40]
+      assertUnit(Spy::numDelete() == 2);
+      assertStandardFixture(fSrc);
+      assertStandardFixture(fDes);
+   }  // teardown
+
+   // move assignment takes the arrays
+   void test_assignMove_standardToNotempty()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Frozen fSrc = mSrc.freeze();
+      Map mDes;
+      mDes["20"] = Spy(20);
+      Frozen fDes = mDes.freeze();
+      Spy::reset();
+      // exercise
+      fDes = std::move(fSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 1);  // destroy [20]
+      assertUnit(fSrc.empty());
+      assertStandardFixture(fDes);
+   }  // teardown
+
+   // swap trades the arrays
+   void test_swap_standardToEmpty()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen f1 = m.freeze();
+      Frozen f2;
+      Spy::reset();
+      // exercise
+      f1.swap(f2);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(f1.empty());
+      assertUnit(f1.pKeys == nullptr);
+      assertStandardFixture(f2);
+   }  // teardown
+
+   /***************************************
+    * LAYOUT
+    ***************************************/
+
+   // seven keys make a full tree, laid out a level at a time
+   //                4
+   //           2          6
+   //         1   3      5   7
+   void test_layout_seven()
+   {  // setup
+      IntMap m;
+      for (int i = 7; i >= 1; i--)
+         m[i] = i * 10;
+      // exercise
+      IntFrozen f = m.freeze();
+      // verify
+      int expected[] = { 0, 4, 2, 6, 1, 3, 5, 7 };
+      assertUnit(f.size() == 7);
+      for (size_t k = 1; k <= 7; k++)
+      {
+         assertUnit(f.pKeys[k] == expected[k]);
+         assertUnit(f.pPairs[k].first == expected[k]);
+         assertUnit(f.pPairs[k].second == expected[k] * 10);
+      }
+      assertUnit(f.verify());
+   }  // teardown
+
+   // ten keys fill the bottom level from the left
+   //                    7
+   //            4              9
+   //        2       6       8    10
+   //      1   3   5
+   void test_layout_ten()
+   {  // setup
+      IntMap m;
+      for (int i = 1; i <= 10; i++)
+         m[i] = i;
+      // exercise
+      IntFrozen f = m.freeze();
+      // verify
+      int expected[] = { 0, 7, 4, 9, 2, 6, 8, 10, 1, 3, 5 };
+      for (size_t k = 1; k <= 10; k++)
+         assertUnit(f.pKeys[k] == expected[k]);
+      assertUnit(f.firstSlot(10) == 8);
+      assertUnit(f.nextSlot(4, 10) == 9);    // 2 goes down to 3
+      assertUnit(f.nextSlot(10, 10) == 5);   // 5 goes up to 6
+      assertUnit(f.nextSlot(5, 10) == 1);    // 6 goes up to 7
+      assertUnit(f.nextSlot(7, 10) == 0);    // 10 is last
+      assertUnit(f.verify());
+   }  // teardown
+
+   // slot 0 of the keys starts a cache line
+   void test_layout_aligned()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 100; i++)
+         m[i] = i;
+      // exercise
+      IntFrozen f = m.freeze();
+      // verify
+      assertUnit(reinterpret_cast <uintptr_t> (f.pKeys) % 64 == 0);
+      assertUnit(IntFrozen::numPerLine == 16);
+      assertUnit((custom::frozen_map <long long, int> ::numPerLine == 8));
+      assertUnit(Frozen::numPerLine == 4);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // for every size, the walk visits every pair once and in order
+   void test_iterator_everySize()
+   {  // setup
+      bool isValid = true;
+      for (int num = 0; num <= 70; num++)
+      {
+         IntMap m;
+         for (int i = 0; i < num; i++)
+            m[i * 2] = i;
+         // exercise
+         IntFrozen f = m.freeze();
+         // verify
+         int expected = 0;
+         for (auto it = f.begin(); it != f.end(); it++)
+         {
+            isValid = isValid && it->first == expected * 2 && (*it).second == expected;
+            expected++;
+         }
+         isValid = isValid && expected == num && f.verify();
+      }
+      assertUnit(isValid);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // find lands on the pair with the key
+   void test_find_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen f = m.freeze();
+      Spy::reset();
+      // exercise
+      auto it30 = f.find("30");
+      auto it50 = f.find("50");
+      auto it70 = f.find("70");
+      // verify
+      assertUnit(it30 != f.end() && it30->second.get() == 30);
+      assertUnit(it50 != f.end() && it50->second.get() == 50);
+      assertUnit(it70 != f.end() && it70->second.get() == 70);
+      assertUnit(Spy::numCopy() == 0);
+      assertStandardFixture(f);
+   }  // teardown
+
+   // a key between, before or after the others is not found
+   void test_find_standardMissing()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen f = m.freeze();
+      // exercise and verify
+      assertUnit(f.find("20") == f.end());
+      assertUnit(f.find("40") == f.end());
+      assertUnit(f.find("60") == f.end());
+      assertUnit(f.find("80") == f.end());
+      assertUnit(f.count("40") == 0);
+      assertUnit(f.count("50") == 1);
+      assertUnit(!f.contains("60"));
+      assertUnit(f.contains("70"));
+      assertStandardFixture(f);
+   }  // teardown
+
+   // at returns the value of a key that is there
+   void test_at_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen f = m.freeze();
+      // exercise
+      const Spy& s = f.at("50");
+      // verify
+      assertUnit(s.get() == 50);
+      assertStandardFixture(f);
+   }  // teardown
+
+   // at throws for a key that is not there
+   void test_at_missing()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen f = m.freeze();
+      bool isThrown = false;
+      // exercise
+      try
+      {
+         f.at("60");
+      }
+      catch (const std::out_of_range&)
+      {
+         isThrown = true;
+      }
+      // verify
+      assertUnit(isThrown);
+      assertStandardFixture(f);
+   }  // teardown
+
+   // the bounds of keys that are there and of keys that are not
+   void test_bounds_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen f = m.freeze();
+      // exercise and verify
+      assertUnit(f.lower_bound("20")->first == std::string("30"));
+      assertUnit(f.lower_bound("30")->first == std::string("30"));
+      assertUnit(f.lower_bound("40")->first == std::string("50"));
+      assertUnit(f.lower_bound("70")->first == std::string("70"));
+      assertUnit(f.lower_bound("80") == f.end());
+      assertUnit(f.upper_bound("20")->first == std::string("30"));
+      assertUnit(f.upper_bound("30")->first == std::string("50"));
+      assertUnit(f.upper_bound("50")->first == std::string("70"));
+      assertUnit(f.upper_bound("70") == f.end());
+      assertStandardFixture(f);
+   }  // teardown
+
+   // for every size, the bounds of every key and every gap agree with std::map
+   void test_bounds_everySize()
+   {  // setup
+      bool isValid = true;
+      for (int num = 0; num <= 40; num++)
+      {
+         IntMap m;
+         std::map <int, int> reference;
+         for (int i = 0; i < num; i++)
+         {
+            m[i * 2 + 1] = i;
+            reference[i * 2 + 1] = i;
+         }
+         // exercise
+         IntFrozen f = m.freeze();
+         // verify
+         for (int key = -1; key <= num * 2 + 1; key++)
+         {
+            auto itLower = f.lower_bound(key);
+            auto itLowerRef = reference.lower_bound(key);
+            auto itUpper = f.upper_bound(key);
+            auto itUpperRef = reference.upper_bound(key);
+            isValid = isValid && ((itLower == f.end()) == (itLowerRef == reference.end()));
+            isValid = isValid && ((itUpper == f.end()) == (itUpperRef == reference.end()));
+            if (itLower != f.end() && itLowerRef != reference.end())
+               isValid = isValid && itLower->first == itLowerRef->first;
+            if (itUpper != f.end() && itUpperRef != reference.end())
+               isValid = isValid && itUpper->first == itUpperRef->first;
+            isValid = isValid && f.contains(key) == (reference.count(key) == 1);
+         }
+      }
+      assertUnit(isValid);
+   }  // teardown
+
+   // a transparent comparator lets an int find a Spy key
+   void test_transparent_lookupByInt()
+   {  // setup
+      custom::map <Spy, int, SpyLess> m;
+      m[Spy(30)] = 3;
+      m[Spy(50)] = 5;
+      m[Spy(70)] = 7;
+      custom::frozen_map <Spy, int, SpyLess> f = m.freeze();
+      Spy::reset();
+      // exercise
+      auto it = f.find(50);
+      auto itLower = f.lower_bound(60);
+      auto itUpper = f.upper_bound(70);
+      bool isThere = f.contains(40);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);   // no Spy was made to look up
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it != f.end() && it->second == 5);
+      assertUnit(itLower != f.end() && itLower->second == 7);
+      assertUnit(itUpper == f.end());
+      assertUnit(!isThere);
+   }  // teardown
+
+   /***************************************
+    * SNAPSHOT
+    ***************************************/
+
+   // changing the map afterwards does not change what was frozen
+   void test_freeze_mapChangesAfter()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Frozen f = m.freeze();
+      // exercise
+      m["40"] = Spy(40);
+      m["50"] = Spy(55);
+      m.erase("70");
+      // verify
+      assertUnit(f.find("40") == f.end());
+      assertUnit(m.find("70") == m.end());
+      assertStandardFixture(f);
+   }  // teardown
+
+   // a map in a B-tree freezes the same way
+   void test_freeze_btreeMap()
+   {  // setup
+      custom::map <int, int, std::less <int>, std::allocator <custom::pair <int, int> >,
+                   false, custom::btree_policy <4> > m;
+      for (int i = 100; i > 0; i--)
+         m[i] = -i;
+      // exercise
+      IntFrozen f = m.freeze();
+      // verify
+      assertUnit(f.size() == 100);
+      assertUnit(f.verify());
+      assertUnit(f.at(1) == -1);
+      assertUnit(f.at(64) == -64);
+      assertUnit(f.at(100) == -100);
+      assertUnit(f.begin()->first == 1);
+   }  // teardown
+
+   // so does a flat map
+   void test_freeze_flatMap()
+   {  // setup
+      custom::flat_map <int, int> m;
+      for (int i = 1; i <= 7; i++)
+         m[i] = i * 10;
+      // exercise
+      IntFrozen f = m.freeze();
+      // verify
+      assertUnit(f.size() == 7);
+      assertUnit(f.pKeys[1] == 4);
+      assertUnit(f.pKeys[7] == 7);
+      assertUnit(f.at(3) == 30);
+      assertUnit(f.verify());
+   }  // teardown
+
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+
+   // a map with a pmr allocator freezes into the same arena
+   void test_allocator_pmrArena()
+   {  // setup
+      char buffer[16384];
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                                std::pmr::null_memory_resource());
+      custom::map <int, int, std::less <int>,
+                   std::pmr::polymorphic_allocator <custom::pair <int, int> > > m(&arena);
+      for (int i = 0; i < 20; i++)
+         m[i] = i * i;
+      // exercise
+      auto f = m.freeze();
+      // verify
+      assertUnit(f.size() == 20);
+      assertUnit(f.get_allocator().resource() == &arena);
+      assertUnit((char*)f.pKeys >= buffer &&
+                 (char*)(f.pKeys + 21) <= buffer + sizeof(buffer));
+      assertUnit((char*)f.pPairs >= buffer &&
+                 (char*)(f.pPairs + 21) <= buffer + sizeof(buffer));
+      assertUnit(f.at(7) == 49);
+      // exercise
+      custom::frozen_map <int, int, std::less <int>,
+                          std::pmr::polymorphic_allocator <custom::pair <int, int> > > fCopy(&arena);
+      fCopy = f;
+      // verify
+      assertUnit(fCopy.size() == 20);
+      assertUnit(fCopy.at(7) == 49);
+      assertUnit(fCopy.get_allocator().resource() == &arena);
+      // exercise
+      m[20] = 400;
+      fCopy = m.freeze();
+      // verify
+      assertUnit(fCopy.size() == 21);
+      assertUnit(fCopy.at(20) == 400);
+      assertUnit(fCopy.get_allocator().resource() == &arena);
+   }  // teardown
+
+   // a move between different resources copies the pairs into ours
+   void test_allocator_pmrMoveOtherResource()
+   {  // setup
+      char buffer[8192];
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                                std::pmr::null_memory_resource());
+      custom::map <int, int, std::less <int>,
+                   std::pmr::polymorphic_allocator <custom::pair <int, int> > > m;
+      for (int i = 0; i < 20; i++)
+         m[i] = i * i;
+      auto fSrc = m.freeze();
+      custom::frozen_map <int, int, std::less <int>,
+                          std::pmr::polymorphic_allocator <custom::pair <int, int> > > fDes(&arena);
+      // exercise
+      fDes = std::move(fSrc);
+      // verify
+      assertUnit(fDes.size() == 20);
+      assertUnit(fDes.at(7) == 49);
+      assertUnit(fDes.get_allocator().resource() == &arena);
+      assertUnit((char*)fDes.pPairs >= buffer &&
+                 (char*)(fDes.pPairs + 21) <= buffer + sizeof(buffer));
+   }  // teardown
+
+   // moving only throws when the allocators may differ and stay put
+   void test_allocator_moveNoexcept()
+   {  // setup
+      using PmrFrozen = custom::frozen_map <int, int, std::less <int>,
+                                            std::pmr::polymorphic_allocator <custom::pair <int, int> > >;
+      // exercise
+      // verify
+      assertUnit(std::is_nothrow_move_constructible <Frozen> ::value);
+      assertUnit(std::is_nothrow_move_assignable <Frozen> ::value);
+      assertUnit(std::is_nothrow_move_constructible <PmrFrozen> ::value);
+      assertUnit(!std::is_nothrow_move_assignable <PmrFrozen> ::value);
+   }  // teardown
+
+   /***************************************
+    * RANDOM
+    ***************************************/
+
+   // random maps, frozen, agree with std::map on every lookup
+   void test_freeze_random()
+   {  // setup
+      std::mt19937 random(23);
+      bool isValid = true;
+      for (int round = 0; round < 20; round++)
+      {
+         IntMap m;
+         std::map <int, int> reference;
+         int num = int(random() % 3000);
+         for (int i = 0; i < num; i++)
+         {
+            int key = int(random() % 10000);
+            m[key] = i;
+            reference[key] = i;
+         }
+         // exercise
+         IntFrozen f = m.freeze();
+         // verify
+         isValid = isValid && f.size() == reference.size() && f.verify();
+         for (int i = 0; i < 500; i++)
+         {
+            int key = int(random() % 10100) - 50;
+            auto it = f.lower_bound(key);
+            auto itRef = reference.lower_bound(key);
+            isValid = isValid && ((it == f.end()) == (itRef == reference.end()));
+            if (it != f.end() && itRef != reference.end())
+               isValid = isValid && it->first == itRef->first && it->second == itRef->second;
+            isValid = isValid && (f.find(key) != f.end()) == (reference.count(key) == 1);
+         }
+      }
+      assertUnit(isValid);
+   }  // teardown
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   "30", "50" and "70" in a map, ready to be frozen
+    ****************************************************************/
+   void setupStandardFixture(Map& m)
+   {
+      m["30"] = Spy(30);
+      m["50"] = Spy(50);
+      m["70"] = Spy(70);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *    slot:   1    2    3
+    *         +----+----+----+
+    *         | 50 | 30 | 70 |
+    *         +----+----+----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(const Frozen& f, int line, const char* function)
+   {
+      assertIndirect(f.size() == 3);
+      assertIndirect(f.verify());
+      assertIndirect(f.pKeys != nullptr);
+      assertIndirect(f.pPairs != nullptr);
+      if (f.pKeys == nullptr || f.pPairs == nullptr || f.numElements != 3)
+         return;
+      assertIndirect(f.pKeys[1] == std::string("50"));
+      assertIndirect(f.pPairs[1].second.get() == 50);
+      assertIndirect(f.pKeys[2] == std::string("30"));
+      assertIndirect(f.pPairs[2].second.get() == 30);
+      assertIndirect(f.pKeys[3] == std::string("70"));
+      assertIndirect(f.pPairs[3].second.get() == 70);
+   }
+};
+
+#endif // DEBUG
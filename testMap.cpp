@@ -14,8 +14,14 @@
 
 #include "testSpy.h"       // for the spy unit tests
 #include "testPair.h"      // for the pair unit tests
+#include "testPool.h"      // for the pool unit tests
 #include "testBST.h"       // for the BST unit tests
 #include "testMap.h"       // for the map unit tests
+#include "testBTree.h"     // for the B-tree unit tests
+#include "testSimd.h"      // for the SIMD search unit tests
+#include "testFlatTree.h"  // for the flat tree unit tests
+#include "testUnorderedMap.h" // for the unordered map unit tests
+#include "testFrozenMap.h"    // for the frozen map unit tests
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -28,8 +34,14 @@ int main()
    // unit tests
    TestSpy().run();
    TestPair().run();
+   TestPool().run();
    TestBST().run();
    TestMap().run();
+   TestBTree().run();
+   TestSimd().run();
+   TestFlatTree().run();
+   TestUnorderedMap().run();
+   TestFrozenMap().run();
 #endif // DEBUG
    
    return 0;
@@ -16,6 +16,8 @@
 
 #include <map>
 #include <vector>
+#include <memory_resource>
+#include <string_view>
 
 /***********************************************
  * TEST MAP
@@ -36,12 +38,16 @@ public:
       test_constructMove_empty();
       test_constructMove_one();
       test_constructMove_standard();
+      test_constructMove_noexcept();
       test_constructInit_empty();
       test_constructInit_one();
       test_constructInit_standard();
       test_constructRange_empty();
       test_constructRange_one();
       test_constructRange_standard();
+      test_constructRange_duplicates();
+      test_constructRange_duplicatesLong();
+      test_constructRange_sortedUnique();
       test_destructor_empty();
       test_destructor_standard();
 
@@ -58,6 +64,7 @@ public:
       test_assignInit_standardToEmpty();
       test_assignInit_emptyToStandard();
       test_assignInit_standardToNotempty();
+      test_assignParallel_large();
       test_swap_emptyToEmpty();
       test_swap_standardToEmpty();
       test_swap_emptyToStandard();
@@ -67,6 +74,7 @@ public:
       test_begin_empty();
       test_begin_standard();
       test_end_standard();
+      test_end_decrement();
       test_iterator_increment_standardToChild();
       test_iterator_increment_standardToParent();
       test_iterator_dereference_standardRead();
@@ -101,6 +109,14 @@ public:
       test_insertCopy_standardMiddle();
       test_insertMove_empty();
       test_insertMove_standard();
+      test_emplace_standard();
+      test_emplace_standardDuplicate();
+      test_tryEmplace_standard();
+      test_tryEmplace_standardDuplicate();
+      test_insertOrAssign_standard();
+      test_insertOrAssign_standardDuplicate();
+      test_insertHint_inOrder();
+      test_emplaceHint_standard();
 
       // Remove
       test_erase_emptyKey();
@@ -111,8 +127,39 @@ public:
       test_erase_standardIteratorMissing();
       test_erase_emptyRange();
       test_erase_standardRange();
+      test_erase_largeRange();
       test_clear_empty();
       test_clear_standard();
+      test_clear_deferred();
+
+      // Node handles
+      test_extract_standardKey();
+      test_extract_missingKey();
+      test_insertNode_otherMap();
+      test_insertNode_duplicate();
+      test_merge_overlap();
+      test_split_half();
+      test_join_shards();
+
+      // Set operations
+      test_union_combine();
+      test_union_keepLeft();
+      test_intersection_standard();
+      test_difference_standard();
+      test_union_parallel();
+
+      // Bounds
+      test_lowerBound_standard();
+      test_upperBound_standard();
+      test_equalRange_standard();
+      test_range_standard();
+      test_transparent_lowerBound();
+
+      // Order statistics
+      test_nth_ranked();
+      test_rank_ranked();
+      test_countRange_ranked();
+      test_distance_ranked();
 
       // Status
       test_empty_empty();
@@ -120,6 +167,15 @@ public:
       test_size_empty();
       test_size_standard();
 
+      // Transparent comparator
+      test_transparent_lookupByInt();
+      test_transparent_eraseByInt();
+      test_transparent_stringView();
+
+      // Allocator
+      test_allocator_pmrArena();
+      test_allocator_swap();
+
       report("Map");
    }
 
@@ -185,8 +241,8 @@ public:
       //   +----+
       custom::map<std::string, Spy> mSrc;
       custom::pair<std::string, Spy> p50(std::string("50"), Spy(50));
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode50;
-      bnode50 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(p50);
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode50;
+      bnode50 = new custom::map <std::string, Spy> ::Tree ::BNode(p50);
       mSrc.bst.root = bnode50;
       mSrc.bst.numElements = 1;
       Spy::reset();
@@ -216,7 +272,7 @@ public:
          assertUnit(mSrc.bst.root->data.second == Spy(50));
          assertUnit(mSrc.bst.root->pLeft == nullptr);
          assertUnit(mSrc.bst.root->pRight == nullptr);
-         assertUnit(mSrc.bst.root->pParent == nullptr);
+         assertUnit(mSrc.bst.root->getParent() == nullptr);
       }
       //    "50"
       //   +----+
@@ -230,7 +286,7 @@ public:
          assertUnit(mDes.bst.root->data.second == Spy(50));
          assertUnit(mDes.bst.root->pLeft == nullptr);
          assertUnit(mDes.bst.root->pRight == nullptr);
-         assertUnit(mDes.bst.root->pParent == nullptr);
+         assertUnit(mDes.bst.root->getParent() == nullptr);
       }
       // teardown
       teardownStandardFixture(mSrc);
@@ -308,8 +364,8 @@ public:
       //   +----+
       custom::map<std::string, Spy> mSrc;
       custom::pair<std::string, Spy> p50(std::string("50"), Spy(50));
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode50;
-      bnode50 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(p50);
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode50;
+      bnode50 = new custom::map <std::string, Spy> ::Tree ::BNode(p50);
       mSrc.bst.root = bnode50;
       mSrc.bst.numElements = 1;
       Spy::reset();
@@ -339,7 +395,7 @@ public:
          assertUnit(mDes.bst.root->data.second == Spy(50));
          assertUnit(mDes.bst.root->pLeft == nullptr);
          assertUnit(mDes.bst.root->pRight == nullptr);
-         assertUnit(mDes.bst.root->pParent == nullptr);
+         assertUnit(mDes.bst.root->getParent() == nullptr);
       }
       assertEmptyFixture(mSrc);
       // teardown
@@ -380,6 +436,25 @@ public:
       teardownStandardFixture(mDes);
    }
 
+   // moving never throws, whichever tree is underneath
+   void test_constructMove_noexcept()
+   {  // verify
+      using RedBlackMap = custom::map<std::string, Spy>;
+      using BTreeMap = custom::map<int, Spy, std::less<int>, std::allocator<custom::pair<int, Spy>>, false,
+                                   custom::btree_policy<>>;
+      using FlatMap = custom::flat_map<int, Spy>;
+      using PmrMap = custom::pmr::map<int, Spy>;
+      assertUnit(std::is_nothrow_move_constructible <RedBlackMap> ::value);
+      assertUnit(std::is_nothrow_move_assignable <RedBlackMap> ::value);
+      assertUnit(std::is_nothrow_move_constructible <BTreeMap> ::value);
+      assertUnit(std::is_nothrow_move_assignable <BTreeMap> ::value);
+      assertUnit(std::is_nothrow_move_constructible <FlatMap> ::value);
+      assertUnit(std::is_nothrow_move_assignable <FlatMap> ::value);
+      assertUnit(std::is_nothrow_move_constructible <PmrMap> ::value);
+      // a polymorphic allocator stays behind, so the pairs may have to move one at a time
+      assertUnit(!std::is_nothrow_move_assignable <PmrMap> ::value);
+   }
+
    /***************************************
     * INITIALIZER LIST CONSTRUCTOR
     *     map::map(const initializer_list &)
@@ -439,7 +514,7 @@ public:
          assertUnit(m.bst.root->data.second == Spy(50));
          assertUnit(m.bst.root->pLeft == nullptr);
          assertUnit(m.bst.root->pRight == nullptr);
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
       }
       // teardown
       teardownStandardFixture(m);
@@ -539,7 +614,7 @@ public:
          assertUnit(m.bst.root->data.second == Spy(50));
          assertUnit(m.bst.root->pLeft == nullptr);
          assertUnit(m.bst.root->pRight == nullptr);
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
       }
       // teardown
       teardownStandardFixture(m);
@@ -578,6 +653,70 @@ public:
       teardownStandardFixture(m);
    }
 
+   // out of order input with repeated keys keeps the first of each, just like insert
+   void test_constructRange_duplicates()
+   {  // setup
+      std::vector <custom::pair<std::string, Spy>> v;
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(70)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(50)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(71)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("30"), Spy(30)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(51)));
+      Spy::reset();
+      // exercise
+      custom::map<std::string, Spy> m(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy-create [70][50][30]
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      //    "30"     "50"     "70" 
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      assertStandardFixture(m);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // a range too long to insert one at a time is sorted, still keeping the first of each key
+   void test_constructRange_duplicatesLong()
+   {  // setup
+      std::vector <custom::pair<int, Spy>> v;
+      for (int i = 0; i < 40; i++)
+         v.push_back(custom::pair<int, Spy>((i * 7) % 20, Spy(i)));
+      Spy::reset();
+      // exercise
+      custom::map<int, Spy> m(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 40);       // copy-create all forty
+      assertUnit(Spy::numDestructor() == 20); // destroy the second of each key
+      assertUnit(m.size() == 20);
+      bool isFirstKept = true;
+      for (auto it = m.begin(); it != m.end(); ++it)
+         isFirstKept = isFirstKept && (*it).second.get() < 20;
+      assertUnit(isFirstKept);
+   }  // teardown
+
+   // the caller promises the range is sorted and unique
+   void test_constructRange_sortedUnique()
+   {  // setup
+      std::vector <custom::pair<std::string, Spy>> v;
+      v.push_back(custom::pair<std::string, Spy>(std::string("30"), Spy(30)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(50)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(70)));
+      Spy::reset();
+      // exercise
+      custom::map<std::string, Spy> m(custom::sorted_unique, v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy-create [30][50][70]
+      assertUnit(Spy::numAlloc() == 3);    // allocate    [30][50][70]
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertStandardFixture(m);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
    /***************************************
     * DESTRUCTOR
     ***************************************/
@@ -858,14 +997,14 @@ public:
       custom::map<std::string, Spy> mDes;
       custom::pair<std::string, Spy> pair40(std::string("40"), Spy(40));
       custom::pair<std::string, Spy> pair60(std::string("60"), Spy(60));
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode40;
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode60;
-      bnode40 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair40);
-      bnode60 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair60);
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode40;
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode60;
+      bnode40 = new custom::map <std::string, Spy> ::Tree ::BNode(pair40);
+      bnode60 = new custom::map <std::string, Spy> ::Tree ::BNode(pair60);
       bnode40->pRight = bnode60;
-      bnode60->pParent = bnode40;
-      bnode40->isRed = false;
-      bnode60->isRed = true;
+      bnode60->setParent(bnode40);
+      bnode40->setRed(false);
+      bnode60->setRed(true);
       mDes.bst.root = bnode40;
       mDes.bst.numElements = 2;
       Spy::reset();
@@ -1006,14 +1145,14 @@ public:
       custom::map<std::string, Spy> mDes;
       custom::pair<std::string, Spy> pair40(std::string("40"), Spy(40));
       custom::pair<std::string, Spy> pair60(std::string("60"), Spy(60));
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode40;
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode60;
-      bnode40 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair40);
-      bnode60 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair60);
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode40;
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode60;
+      bnode40 = new custom::map <std::string, Spy> ::Tree ::BNode(pair40);
+      bnode60 = new custom::map <std::string, Spy> ::Tree ::BNode(pair60);
       bnode40->pRight = bnode60;
-      bnode60->pParent = bnode40;
-      bnode40->isRed = false;
-      bnode60->isRed = true;
+      bnode60->setParent(bnode40);
+      bnode40->setRed(false);
+      bnode60->setRed(true);
       mDes.bst.root = bnode40;
       mDes.bst.numElements = 2;
       Spy::reset();
@@ -1149,14 +1288,14 @@ public:
       custom::map<std::string, Spy> m;
       custom::pair<std::string, Spy> pair40(std::string("40"), Spy(40));
       custom::pair<std::string, Spy> pair60(std::string("60"), Spy(60));
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode40;
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode60;
-      bnode40 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair40);
-      bnode60 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair60);
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode40;
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode60;
+      bnode40 = new custom::map <std::string, Spy> ::Tree ::BNode(pair40);
+      bnode60 = new custom::map <std::string, Spy> ::Tree ::BNode(pair60);
       bnode40->pRight = bnode60;
-      bnode60->pParent = bnode40;
-      bnode40->isRed = false;
-      bnode60->isRed = true;
+      bnode60->setParent(bnode40);
+      bnode40->setRed(false);
+      bnode60->setRed(true);
       m.bst.root = bnode40;
       m.bst.numElements = 2;
       Spy::reset();
@@ -1183,6 +1322,27 @@ public:
       teardownStandardFixture(m);
    }
 
+   // a large map copied on several threads holds the same pairs
+   void test_assignParallel_large()
+   {  // setup
+      custom::map <int, int> mSrc;
+      for (int i = 0; i < 70000; i++)
+         mSrc[(i * 7919) % 70001] = i;
+      custom::map <int, int> mDest;
+      mDest[-1] = -1;
+      // exercise
+      mDest.assign_parallel(mSrc, 3);
+      // verify
+      assertUnit(mDest.size() == 70000);
+      bool same = true;
+      auto itSrc = mSrc.begin();
+      for (auto itDest = mDest.begin(); itDest != mDest.end(); ++itDest, ++itSrc)
+         same = same && (*itDest).first == (*itSrc).first && (*itDest).second == (*itSrc).second;
+      assertUnit(same);
+      assertUnit(mDest.find(-1) == mDest.end());
+      assertUnit(mDest.bst.root->verifyRedBlack(mDest.bst.root->findDepth()));
+   }  // teardown
+
    /***************************************
     * SWAP
     *    swap(lhs, rhs)
@@ -1296,14 +1456,14 @@ public:
       custom::map<std::string, Spy> mRHS;
       custom::pair<std::string, Spy> pair40(std::string("40"), Spy(40));
       custom::pair<std::string, Spy> pair60(std::string("60"), Spy(60));
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode40;
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode60;
-      bnode40 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair40);
-      bnode60 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair60);
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode40;
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode60;
+      bnode40 = new custom::map <std::string, Spy> ::Tree ::BNode(pair40);
+      bnode60 = new custom::map <std::string, Spy> ::Tree ::BNode(pair60);
       bnode40->pRight = bnode60;
-      bnode60->pParent = bnode40;
-      bnode40->isRed = false;
-      bnode60->isRed = true;
+      bnode60->setParent(bnode40);
+      bnode40->setRed(false);
+      bnode60->setRed(true);
       mRHS.bst.root = bnode40;
       mRHS.bst.numElements = 2;
       Spy::reset();
@@ -1340,14 +1500,14 @@ public:
       {
          assertUnit(mLHS.bst.root->data.first == std::string("40"));
          assertUnit(mLHS.bst.root->data.second == Spy(40));
-         assertUnit(mLHS.bst.root->pParent == nullptr);
+         assertUnit(mLHS.bst.root->getParent() == nullptr);
          assertUnit(mLHS.bst.root->pLeft == nullptr);
          assertUnit(mLHS.bst.root->pRight != nullptr);
          if (mLHS.bst.root->pRight)
          {
             assertUnit(mLHS.bst.root->pRight->data.first == std::string("60"));
             assertUnit(mLHS.bst.root->pRight->data.second == Spy(60));
-            assertUnit(mLHS.bst.root->pRight->pParent == mLHS.bst.root);
+            assertUnit(mLHS.bst.root->pRight->getParent() == mLHS.bst.root);
             assertUnit(mLHS.bst.root->pRight->pLeft == nullptr);
             assertUnit(mLHS.bst.root->pRight->pRight == nullptr);
          }
@@ -1413,6 +1573,26 @@ public:
    }  // teardown
 
 
+   // a deferred clear leaves the freeing to the reclaimer's thread
+   void test_clear_deferred()
+   {  // setup
+      custom::map<int, Spy> m;
+      for (int i = 0; i < 100; i++)
+         m[i] = Spy(i);
+      m.defer_reclaim();
+      Spy::reset();
+      // exercise
+      m.clear();
+      // verify
+      assertUnit(m.empty());
+      assertUnit(m.bst.root == nullptr);
+      // exercise
+      m.flush_reclaim();
+      // verify
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(Spy::numDelete() == 100);
+   }  // teardown
+
    /***************************************
     * ITERATOR
     *     map::begin()
@@ -1494,6 +1674,36 @@ public:
       teardownStandardFixture(m);
    }
 
+   // one step back from end() is the largest key
+   void test_end_decrement()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      auto it = m.end();
+      Spy::reset();
+      // exercise
+      --it;
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it.it.pNode == m.bst.root->pRight);
+      assertUnit((*it).first == std::string("70"));
+      --it;
+      assertUnit((*it).first == std::string("50"));
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      //              it
+      assertStandardFixture(m);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
    // iterator increment to the parent from the standard fixture
    void test_iterator_increment_standardToParent()
    {  // setup
@@ -1643,8 +1853,8 @@ public:
       // exercise
       it = m.find(s50);
       // verify
-      assertUnit(Spy::numDefault() == 1); // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);     
@@ -1680,8 +1890,8 @@ public:
       // exercise
       it = m.find(s30);
       // verify
-      assertUnit(Spy::numDefault() == 1); // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
@@ -1717,8 +1927,8 @@ public:
       // exercise
       it = m.find(s70);
       // verify
-      assertUnit(Spy::numDefault() == 1); // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
@@ -1754,8 +1964,8 @@ public:
       // exercise
       it = m.find(s99);
       // verify
-      assertUnit(Spy::numDefault() == 1); // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
@@ -1812,7 +2022,7 @@ public:
          assertUnit(m.bst.root->data.second == Spy(50));
          assertUnit(m.bst.root->pLeft == nullptr);
          assertUnit(m.bst.root->pRight == nullptr);
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
       }
       // teardown
       teardownStandardFixture(m);
@@ -1864,20 +2074,20 @@ public:
       {
          assertUnit(m.bst.root->data.first == std::string("50"));
          assertUnit(m.bst.root->data.second == Spy(50));
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
          assertUnit(m.bst.root->pLeft != nullptr);
          if (m.bst.root->pLeft)
          {
             assertUnit(m.bst.root->pLeft->data.first == std::string("30"));
             assertUnit(m.bst.root->pLeft->data.second == Spy(30));
-            assertUnit(m.bst.root->pLeft->pParent == m.bst.root);
+            assertUnit(m.bst.root->pLeft->getParent() == m.bst.root);
             assertUnit(m.bst.root->pLeft->pLeft != nullptr);
             assertUnit(m.bst.root->pLeft->pRight == nullptr);
             if (m.bst.root->pLeft->pLeft)
             {
                assertUnit(m.bst.root->pLeft->pLeft->data.first == std::string("10"));
                assertUnit(m.bst.root->pLeft->pLeft->data.second == Spy(10));
-               assertUnit(m.bst.root->pLeft->pLeft->pParent == m.bst.root->pLeft);
+               assertUnit(m.bst.root->pLeft->pLeft->getParent() == m.bst.root->pLeft);
                assertUnit(m.bst.root->pLeft->pLeft->pLeft == nullptr);
                assertUnit(m.bst.root->pLeft->pLeft->pRight == nullptr);
             }
@@ -1887,7 +2097,7 @@ public:
          {
             assertUnit(m.bst.root->pRight->data.first == std::string("70"));
             assertUnit(m.bst.root->pRight->data.second == Spy(70));
-            assertUnit(m.bst.root->pRight->pParent == m.bst.root);
+            assertUnit(m.bst.root->pRight->getParent() == m.bst.root);
             assertUnit(m.bst.root->pRight->pLeft == nullptr);
             assertUnit(m.bst.root->pRight->pRight == nullptr);
          }
@@ -1942,13 +2152,13 @@ public:
       {
          assertUnit(m.bst.root->data.first == std::string("50"));
          assertUnit(m.bst.root->data.second == Spy(50));
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
          assertUnit(m.bst.root->pLeft != nullptr);
          if (m.bst.root->pLeft)
          {
             assertUnit(m.bst.root->pLeft->data.first == std::string("30"));
             assertUnit(m.bst.root->pLeft->data.second == Spy(30));
-            assertUnit(m.bst.root->pLeft->pParent == m.bst.root);
+            assertUnit(m.bst.root->pLeft->getParent() == m.bst.root);
             assertUnit(m.bst.root->pLeft->pLeft == nullptr);
             assertUnit(m.bst.root->pLeft->pRight == nullptr);
          }
@@ -1957,13 +2167,13 @@ public:
          {
             assertUnit(m.bst.root->pRight->data.first == std::string("70"));
             assertUnit(m.bst.root->pRight->data.second == Spy(70));
-            assertUnit(m.bst.root->pRight->pParent == m.bst.root);
+            assertUnit(m.bst.root->pRight->getParent() == m.bst.root);
             assertUnit(m.bst.root->pRight->pLeft != nullptr);
             if (m.bst.root->pRight->pLeft)
             {
                assertUnit(m.bst.root->pRight->pLeft->data.first == std::string("60"));
                assertUnit(m.bst.root->pRight->pLeft->data.second == Spy(60));
-               assertUnit(m.bst.root->pRight->pLeft->pParent == m.bst.root->pRight);
+               assertUnit(m.bst.root->pRight->pLeft->getParent() == m.bst.root->pRight);
                assertUnit(m.bst.root->pRight->pLeft->pLeft == nullptr);
                assertUnit(m.bst.root->pRight->pLeft->pRight == nullptr);
             }
@@ -2010,7 +2220,7 @@ public:
          assertUnit(m.bst.root->data.second == Spy(50));
          assertUnit(m.bst.root->pLeft == nullptr);
          assertUnit(m.bst.root->pRight == nullptr);
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
       }
       // teardown
       teardownStandardFixture(m);
@@ -2063,13 +2273,13 @@ public:
       {
          assertUnit(m.bst.root->data.first == std::string("50"));
          assertUnit(m.bst.root->data.second == Spy(50));
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
          assertUnit(m.bst.root->pLeft != nullptr);
          if (m.bst.root->pLeft)
          {
             assertUnit(m.bst.root->pLeft->data.first == std::string("30"));
             assertUnit(m.bst.root->pLeft->data.second == Spy(30));
-            assertUnit(m.bst.root->pLeft->pParent == m.bst.root);
+            assertUnit(m.bst.root->pLeft->getParent() == m.bst.root);
             assertUnit(m.bst.root->pLeft->pLeft == nullptr);
             assertUnit(m.bst.root->pLeft->pRight == nullptr);
          }
@@ -2078,13 +2288,13 @@ public:
          {
             assertUnit(m.bst.root->pRight->data.first == std::string("70"));
             assertUnit(m.bst.root->pRight->data.second == Spy(70));
-            assertUnit(m.bst.root->pRight->pParent == m.bst.root);
+            assertUnit(m.bst.root->pRight->getParent() == m.bst.root);
             assertUnit(m.bst.root->pRight->pLeft != nullptr);
             if (m.bst.root->pRight->pLeft)
             {
                assertUnit(m.bst.root->pRight->pLeft->data.first == std::string("60"));
                assertUnit(m.bst.root->pRight->pLeft->data.second == Spy(60));
-               assertUnit(m.bst.root->pRight->pLeft->pParent == m.bst.root->pRight);
+               assertUnit(m.bst.root->pRight->pLeft->getParent() == m.bst.root->pRight);
                assertUnit(m.bst.root->pRight->pLeft->pLeft == nullptr);
                assertUnit(m.bst.root->pRight->pLeft->pRight == nullptr);
             }
@@ -2096,6 +2306,221 @@ public:
    }
 
 
+   /***************************************
+    * EMPLACE
+    *    map::emplace(Args &&...)
+    *    map::try_emplace(const K &, Args &&...)
+    *    map::insert_or_assign(const K &, M &&)
+    ***************************************/
+
+   // emplace a new key: the value is built right in the node
+   void test_emplace_standard()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      custom::pair<custom::map<std::string, Spy>::iterator, bool> pReturn;
+      Spy::reset();
+      // exercise
+      pReturn = m.emplace(std::string("60"), 60);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [60] in place
+      assertUnit(Spy::numAlloc() == 1);       // allocate [60]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(pReturn.second == true);
+      assertUnit((*pReturn.first).first == std::string("60"));
+      assertUnit((*pReturn.first).second.get() == 60);
+      assertUnit(m.size() == 4);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // emplace a key that is already there: the new pair is discarded
+   void test_emplace_standardDuplicate()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      custom::pair<custom::map<std::string, Spy>::iterator, bool> pReturn;
+      Spy::reset();
+      // exercise
+      pReturn = m.emplace(std::string("50"), 99);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [99] before its key is known
+      assertUnit(Spy::numDestructor() == 1);  // then throw it away
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(pReturn.second == false);
+      assertUnit((*pReturn.first).second.get() == 50);
+      assertStandardFixture(m);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // try_emplace a new key: the value is built right in the node
+   void test_tryEmplace_standard()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      custom::pair<custom::map<std::string, Spy>::iterator, bool> pReturn;
+      std::string key("60");
+      Spy::reset();
+      // exercise
+      pReturn = m.try_emplace(key, 60);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [60] in place
+      assertUnit(Spy::numAlloc() == 1);       // allocate [60]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(pReturn.second == true);
+      assertUnit((*pReturn.first).first == std::string("60"));
+      assertUnit((*pReturn.first).second.get() == 60);
+      assertUnit(m.size() == 4);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // try_emplace a key that is already there: nothing is built
+   void test_tryEmplace_standardDuplicate()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      custom::pair<custom::map<std::string, Spy>::iterator, bool> pReturn;
+      Spy::reset();
+      // exercise
+      pReturn = m.try_emplace(std::string("50"), 99);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(pReturn.second == false);
+      assertUnit((*pReturn.first).second.get() == 50);
+      assertStandardFixture(m);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // insert_or_assign a new key
+   void test_insertOrAssign_standard()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      custom::pair<custom::map<std::string, Spy>::iterator, bool> pReturn;
+      Spy s(60);
+      Spy::reset();
+      // exercise
+      pReturn = m.insert_or_assign(std::string("60"), std::move(s));
+      // verify
+      assertUnit(Spy::numCopyMove() == 1);    // move [60] straight into the node
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(pReturn.second == true);
+      assertUnit((*pReturn.first).second.get() == 60);
+      assertUnit(m.size() == 4);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // insert_or_assign a key that is already there: the value is assigned
+   void test_insertOrAssign_standardDuplicate()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      custom::pair<custom::map<std::string, Spy>::iterator, bool> pReturn;
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      pReturn = m.insert_or_assign(std::string("50"), s);
+      // verify
+      assertUnit(Spy::numAssign() == 1);      // assign [99] over [50]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);       // [50] already had a buffer
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(pReturn.second == false);
+      assertUnit((*pReturn.first).second.get() == 99);
+      assertUnit(m.size() == 3);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // in-order keys with end() as the hint
+   void test_insertHint_inOrder()
+   {  // setup
+      custom::map <int, Spy> m;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         m.insert(m.end(), custom::pair <int, Spy> (i, Spy(i)));
+      // verify
+      assertUnit(m.size() == 100);
+      int expected = 0;
+      bool inOrder = true;
+      for (auto it = m.begin(); it != m.end(); ++it, ++expected)
+         inOrder = inOrder && (*it).first == expected && (*it).second.get() == expected;
+      assertUnit(inOrder);
+      assertUnit(expected == 100);
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+   }  // teardown
+
+   // emplace with a hint builds the value in place
+   void test_emplaceHint_standard()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      auto itHint = m.find(std::string("70"));
+      Spy::reset();
+      // exercise
+      auto it = m.emplace_hint(itHint, std::string("60"), 60);
+      auto itDuplicate = m.emplace_hint(itHint, std::string("50"), 99);
+      // verify
+      assertUnit(Spy::numNondefault() == 2);  // build [60] and [99] in place
+      assertUnit(Spy::numDestructor() == 1);  // [99] is a duplicate
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit((*it).second.get() == 60);
+      assertUnit((*itDuplicate).second.get() == 50);
+      assertUnit(m.size() == 4);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
    /***************************************
     * SQUARE BRACKET
     *     map::operator[](const T &)
@@ -2116,8 +2541,8 @@ public:
       s = m[std::string("50")];
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [50]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);     
       assertUnit(Spy::numDelete() == 0);
@@ -2151,8 +2576,8 @@ public:
       s = m[std::string("30")];
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [30]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2186,8 +2611,8 @@ public:
       s = m[std::string("70")];
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [70]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2221,8 +2646,8 @@ public:
       m[std::string("50")] = s;
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [55]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2262,8 +2687,8 @@ public:
       m[std::string("30")] = s;
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [33]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2304,8 +2729,8 @@ public:
       m[std::string("70")] = s;
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [77]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2340,13 +2765,13 @@ public:
       // exercise
       m[std::string("50")] = s;
       // verify
-      assertUnit(Spy::numCopy() == 1);       // copy-create [50]
+      assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 1);      // allocate    [50]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 1);    // the new value starts out blank
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numAssign() == 1);     // use the assignment operator for [50]
       assertUnit(Spy::numNondefault() == 0);
-      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numCopyMove() == 0);  // the pair is built right in its node
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numLessthan() == 0);
@@ -2362,7 +2787,7 @@ public:
          assertUnit(m.bst.root->data.second == Spy(50));
          assertUnit(m.bst.root->pLeft == nullptr);
          assertUnit(m.bst.root->pRight == nullptr);
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
       }
       // teardown 
       teardownStandardFixture(m);
@@ -2382,14 +2807,14 @@ public:
       // exercise
       m[std::string("10")] = s;
       // verify
-      assertUnit(Spy::numCopy() == 1);       // copy-create [10]
+      assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 1);      // allocate    [10]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 1);    // the new value starts out blank
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numAssign() == 1);     // use the assignment operator for [50]
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numNondefault() == 0);
-      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numCopyMove() == 0);  // the pair is built right in its node
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numLessthan() == 0);
@@ -2408,20 +2833,20 @@ public:
       {
          assertUnit(m.bst.root->data.first == std::string("50"));
          assertUnit(m.bst.root->data.second == Spy(50));
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
          assertUnit(m.bst.root->pLeft != nullptr);
          if (m.bst.root->pLeft)
          {
             assertUnit(m.bst.root->pLeft->data.first == std::string("30"));
             assertUnit(m.bst.root->pLeft->data.second == Spy(30));
-            assertUnit(m.bst.root->pLeft->pParent == m.bst.root);
+            assertUnit(m.bst.root->pLeft->getParent() == m.bst.root);
             assertUnit(m.bst.root->pLeft->pLeft != nullptr);
             assertUnit(m.bst.root->pLeft->pRight == nullptr);
             if (m.bst.root->pLeft->pLeft)
             {
                assertUnit(m.bst.root->pLeft->pLeft->data.first == std::string("10"));
                assertUnit(m.bst.root->pLeft->pLeft->data.second == Spy(10));
-               assertUnit(m.bst.root->pLeft->pLeft->pParent == m.bst.root->pLeft);
+               assertUnit(m.bst.root->pLeft->pLeft->getParent() == m.bst.root->pLeft);
                assertUnit(m.bst.root->pLeft->pLeft->pLeft == nullptr);
                assertUnit(m.bst.root->pLeft->pLeft->pRight == nullptr);
             }
@@ -2431,7 +2856,7 @@ public:
          {
             assertUnit(m.bst.root->pRight->data.first == std::string("70"));
             assertUnit(m.bst.root->pRight->data.second == Spy(70));
-            assertUnit(m.bst.root->pRight->pParent == m.bst.root);
+            assertUnit(m.bst.root->pRight->getParent() == m.bst.root);
             assertUnit(m.bst.root->pRight->pLeft == nullptr);
             assertUnit(m.bst.root->pRight->pRight == nullptr);
          }
@@ -2455,14 +2880,14 @@ public:
       // exercise
       m[std::string("60")] = s;
       // verify
-      assertUnit(Spy::numCopy() == 1);       // copy-create [60]
+      assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 1);      // allocate    [60]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 1);    // the new value starts out blank
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numAssign() == 1);     // use the assignment operator for [60]
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numNondefault() == 0);
-      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numCopyMove() == 0);  // the pair is built right in its node
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numEquals() == 0);
       assertUnit(Spy::numLessthan() == 0);
@@ -2481,13 +2906,13 @@ public:
       {
          assertUnit(m.bst.root->data.first == std::string("50"));
          assertUnit(m.bst.root->data.second == Spy(50));
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
          assertUnit(m.bst.root->pLeft != nullptr);
          if (m.bst.root->pLeft)
          {
             assertUnit(m.bst.root->pLeft->data.first == std::string("30"));
             assertUnit(m.bst.root->pLeft->data.second == Spy(30));
-            assertUnit(m.bst.root->pLeft->pParent == m.bst.root);
+            assertUnit(m.bst.root->pLeft->getParent() == m.bst.root);
             assertUnit(m.bst.root->pLeft->pLeft == nullptr);
             assertUnit(m.bst.root->pLeft->pRight == nullptr);
          }
@@ -2496,13 +2921,13 @@ public:
          {
             assertUnit(m.bst.root->pRight->data.first == std::string("70"));
             assertUnit(m.bst.root->pRight->data.second == Spy(70));
-            assertUnit(m.bst.root->pRight->pParent == m.bst.root);
+            assertUnit(m.bst.root->pRight->getParent() == m.bst.root);
             assertUnit(m.bst.root->pRight->pLeft != nullptr);
             if (m.bst.root->pRight->pLeft)
             {
                assertUnit(m.bst.root->pRight->pLeft->data.first == std::string("60"));
                assertUnit(m.bst.root->pRight->pLeft->data.second == Spy(60));
-               assertUnit(m.bst.root->pRight->pLeft->pParent == m.bst.root->pRight);
+               assertUnit(m.bst.root->pRight->pLeft->getParent() == m.bst.root->pRight);
                assertUnit(m.bst.root->pRight->pLeft->pLeft == nullptr);
                assertUnit(m.bst.root->pRight->pLeft->pRight == nullptr);
             }
@@ -2534,8 +2959,8 @@ public:
       s = m.at(std::string("50"));
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [50]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2569,8 +2994,8 @@ public:
       s = m.at(std::string("30"));
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [30]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2604,8 +3029,8 @@ public:
       s = m.at(std::string("70"));
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [70]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2639,8 +3064,8 @@ public:
       m.at(std::string("50")) = s;
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [55]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2680,8 +3105,8 @@ public:
       m.at(std::string("30")) = s;
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [33]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2722,8 +3147,8 @@ public:
       m.at(std::string("70")) = s;
       // verify
       assertUnit(Spy::numAssign() == 1);     // assign [77]
-      assertUnit(Spy::numDefault() == 1);    // a blank Spy is created for comparison
-      assertUnit(Spy::numDestructor() == 1); // destroy it and the move-copy when done
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDelete() == 0);
@@ -2766,8 +3191,8 @@ public:
       {
          assertUnit(e.what() == std::string("invalid map<K, T> key"));
       }
-      assertUnit(Spy::numDefault() == 1);    // create a default value during search
-      assertUnit(Spy::numDestructor() == 1); // create a default value during search
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);     
       assertUnit(Spy::numAssign() == 0);    
@@ -2803,8 +3228,8 @@ public:
       {
          assertUnit(e.what() == std::string("invalid map<K, T> key"));
       }
-      assertUnit(Spy::numDefault() == 1);    // create a default value during search
-      assertUnit(Spy::numDestructor() == 1); // create a default value during search
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2833,8 +3258,8 @@ public:
       // exercise
       size = m.erase(key);
       // verify
-      assertUnit(Spy::numDefault() == 1);      // create a default value for find
-      assertUnit(Spy::numDestructor() == 1);   // destroy the default value for find
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
+      assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
@@ -2864,9 +3289,9 @@ public:
       // exercise
       size = m.erase(key);
       // verify
-      assertUnit(Spy::numDestructor() == 2);   // destroy [50] and default for find
+      assertUnit(Spy::numDestructor() == 1); // destroy [50]
       assertUnit(Spy::numDelete() == 1);       // delete  [50]  
-      assertUnit(Spy::numDefault() == 1);      // create default for find
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -2889,13 +3314,13 @@ public:
       {
          assertUnit(m.bst.root->data.first == std::string("70"));
          assertUnit(m.bst.root->data.second == Spy(70));
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
          assertUnit(m.bst.root->pLeft != nullptr);
          if (m.bst.root->pLeft)
          {
             assertUnit(m.bst.root->pLeft->data.first == std::string("30"));
             assertUnit(m.bst.root->pLeft->data.second == Spy(30));
-            assertUnit(m.bst.root->pLeft->pParent == m.bst.root);
+            assertUnit(m.bst.root->pLeft->getParent() == m.bst.root);
             assertUnit(m.bst.root->pLeft->pLeft == nullptr);
             assertUnit(m.bst.root->pLeft->pRight == nullptr);
          }
@@ -2920,8 +3345,8 @@ public:
       // exercise
       size = m.erase(key);
       // verify
-      assertUnit(Spy::numDestructor() == 1);   // default for find
-      assertUnit(Spy::numDefault() == 1);      // create default for find
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDefault() == 0);    // the key is searched without a probe
       assertUnit(Spy::numDelete() == 0);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
@@ -3011,14 +3436,14 @@ public:
       {
          assertUnit(m.bst.root->data.first == std::string("50"));
          assertUnit(m.bst.root->data.second == Spy(50));
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
          assertUnit(m.bst.root->pLeft == nullptr);
          assertUnit(m.bst.root->pRight != nullptr);
          if (m.bst.root->pRight)
          {
             assertUnit(m.bst.root->pRight->data.first == std::string("70"));
             assertUnit(m.bst.root->pRight->data.second == Spy(70));
-            assertUnit(m.bst.root->pRight->pParent == m.bst.root);
+            assertUnit(m.bst.root->pRight->getParent() == m.bst.root);
             assertUnit(m.bst.root->pRight->pLeft == nullptr);
             assertUnit(m.bst.root->pRight->pRight == nullptr);
          }
@@ -3132,11 +3557,625 @@ public:
          assertUnit(m.bst.root->data.second == Spy(70));
          assertUnit(m.bst.root->pLeft == nullptr);
          assertUnit(m.bst.root->pRight == nullptr);
-         assertUnit(m.bst.root->pParent == nullptr);
+         assertUnit(m.bst.root->getParent() == nullptr);
+      }
+      // teardown
+      teardownStandardFixture(m);
+   }
+   // retention: drop the oldest third of a large map in one go
+   void test_erase_largeRange()
+   {  // setup
+      custom::map<int, Spy> m;
+      for (int i = 0; i < 3000; i++)
+         m[i] = Spy(i);
+      size_t numSpare = m.bst.nodes.available();
+      Spy::reset();
+      // exercise
+      auto itReturn = m.erase(m.begin(), m.find(1000));
+      // verify
+      assertUnit(Spy::numDestructor() == 1000);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(m.bst.nodes.available() == numSpare + 1000);
+      assertUnit(itReturn == m.begin());
+      assertUnit(m.size() == 2000);
+      assertUnit((*m.begin()).first == 1000);
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+      assertUnit(m.bst.root->computeSize() == 2000);
+   }  // teardown
+
+   /***************************************
+    * NODE HANDLES
+    *    map::extract(const K &)
+    *    map::insert(node_type &&)
+    *    map::merge(map &)
+    ***************************************/
+
+   // take a pair out by its key
+   void test_extract_standardKey()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      //   +----+   +----+   +----+
+      //   | 30 | - | 50 | - | 70 |
+      //   +----+   +----+   +----+
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      auto& pool = custom::map<std::string, Spy>::Tree::BNode::pool();
+      size_t numPool = pool.size();
+      Spy::reset();
+      // exercise
+      auto nh = m.extract(std::string("30"));
+      // verify
+      for (int i = 0; i < NUM_MARKERS; i++)
+         assertUnit(Spy::counters[i] == 0);
+      assertUnit(pool.size() == numPool);
+      assertUnit(!nh.empty());
+      assertUnit(nh.key() == std::string("30"));
+      assertUnit(nh.mapped().get() == 30);
+      assertUnit(m.size() == 2);
+      assertUnit(m.find(std::string("30")) == m.end());
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // extracting a key that is not there gives an empty handle
+   void test_extract_missingKey()
+   {  // setup
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto nh = m.extract(std::string("99"));
+      // verify
+      assertUnit(nh.empty());
+      assertUnit(Spy::numLessthan() == 0);
+      assertStandardFixture(m);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // move a pair to another map, renaming it on the way
+   void test_insertNode_otherMap()
+   {  // setup
+      custom::map<std::string, Spy> mSrc;
+      setupStandardFixture(mSrc);
+      custom::map<std::string, Spy> mDest;
+      auto nh = mSrc.extract(std::string("50"));
+      nh.key() = std::string("55");
+      auto& pool = custom::map<std::string, Spy>::Tree::BNode::pool();
+      size_t numPool = pool.size();
+      Spy::reset();
+      // exercise
+      auto result = mDest.insert(std::move(nh));
+      // verify
+      for (int i = 0; i < NUM_MARKERS; i++)
+         assertUnit(Spy::counters[i] == 0);
+      assertUnit(pool.size() == numPool);
+      assertUnit(result.inserted == true);
+      assertUnit(result.node.empty());
+      assertUnit(nh.empty());
+      assertUnit(result.position == mDest.find(std::string("55")));
+      assertUnit((*result.position).second.get() == 50);
+      assertUnit(mDest.size() == 1);
+      assertUnit(mSrc.size() == 2);
+      // teardown
+      teardownStandardFixture(mSrc);
+   }
+
+   // a key that is already there leaves the pair in the returned node
+   void test_insertNode_duplicate()
+   {  // setup
+      custom::map<std::string, Spy> mSrc;
+      setupStandardFixture(mSrc);
+      custom::map<std::string, Spy> mDest;
+      mDest[std::string("70")] = Spy(7);
+      auto nh = mSrc.extract(std::string("70"));
+      Spy::reset();
+      // exercise
+      auto result = mDest.insert(std::move(nh));
+      // verify
+      assertUnit(result.inserted == false);
+      assertUnit(!result.node.empty());
+      assertUnit(result.node.mapped().get() == 70);
+      assertUnit((*result.position).second.get() == 7);
+      assertUnit(mDest.size() == 1);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      // teardown
+      teardownStandardFixture(mSrc);
+   }
+
+   // merging moves the pairs with new keys and leaves the rest
+   void test_merge_overlap()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      custom::map<std::string, Spy> mSrc;
+      mSrc[std::string("50")] = Spy(5);
+      mSrc[std::string("60")] = Spy(60);
+      mSrc[std::string("80")] = Spy(80);
+      auto& pool = custom::map<std::string, Spy>::Tree::BNode::pool();
+      size_t numPool = pool.size();
+      Spy::reset();
+      // exercise
+      m.merge(mSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(pool.size() == numPool);
+      assertUnit(m.size() == 5);
+      assertUnit(m.at(std::string("50")).get() == 50);
+      assertUnit(m.at(std::string("60")).get() == 60);
+      assertUnit(mSrc.size() == 1);
+      assertUnit(mSrc.at(std::string("50")).get() == 5);
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+   }  // teardown
+
+   // cut a map in half at its middle key
+   void test_split_half()
+   {  // setup
+      custom::map <int, int, std::less <int>, std::allocator <custom::pair <int, int> >, true> m;
+      for (int i = 0; i < 1000; i++)
+         m[i] = i * 2;
+      int keyMiddle = (*m.nth(m.size() / 2)).first;
+      // exercise
+      auto pairMaps = m.split(keyMiddle);
+      // verify
+      assertUnit(m.empty());
+      assertUnit(pairMaps.first.size() == 500);
+      assertUnit(pairMaps.second.size() == 500);
+      assertUnit((*pairMaps.second.begin()).first == 500);
+      assertUnit(pairMaps.first.at(499) == 998);
+      assertUnit(pairMaps.first.find(500) == pairMaps.first.end());
+      assertUnit(pairMaps.second.bst.root->verifySize());
+   }  // teardown
+
+   // put two shards back together
+   void test_join_shards()
+   {  // setup
+      custom::map<std::string, Spy> mLeft;
+      setupStandardFixture(mLeft);
+      custom::map<std::string, Spy> mRight;
+      mRight[std::string("80")] = Spy(80);
+      mRight[std::string("90")] = Spy(90);
+      Spy::reset();
+      // exercise
+      auto m = custom::map<std::string, Spy>::join(std::move(mLeft), std::move(mRight));
+      // verify
+      for (int i = 0; i < NUM_MARKERS; i++)
+         assertUnit(Spy::counters[i] == 0);
+      assertUnit(m.size() == 5);
+      assertUnit(mLeft.empty() && mRight.empty());
+      assertUnit(m.at(std::string("90")).get() == 90);
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+   }  // teardown
+
+   /***************************************
+    * SET OPERATIONS
+    *    map_union(map, map, Combine, unsigned)
+    *    map_union(map, map)
+    *    map_intersection(map, map, unsigned)
+    *    map_difference(map, map, unsigned)
+    ***************************************/
+
+   // add up the counts of two word tallies
+   void test_union_combine()
+   {  // setup
+      custom::map<std::string, int> mLeft;
+      custom::map<std::string, int> mRight;
+      mLeft[std::string("apple")] = 3;
+      mLeft[std::string("pear")] = 1;
+      mRight[std::string("apple")] = 4;
+      mRight[std::string("fig")] = 2;
+      // exercise
+      auto m = custom::map_union(std::move(mLeft), std::move(mRight),
+                                 [](int kept, int other) { return kept + other; });
+      // verify
+      assertUnit(mLeft.empty() && mRight.empty());
+      assertUnit(m.size() == 3);
+      assertUnit(m.at(std::string("apple")) == 7);
+      assertUnit(m.at(std::string("fig")) == 2);
+      assertUnit(m.at(std::string("pear")) == 1);
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+   }  // teardown
+
+   // without a combine, the value from the left wins and nothing is copied
+   void test_union_keepLeft()
+   {  // setup
+      //    "30"     "50"     "70"   = mLeft
+      custom::map<std::string, Spy> mLeft;
+      setupStandardFixture(mLeft);
+      custom::map<std::string, Spy> mRight;
+      mRight[std::string("50")] = Spy(55);
+      mRight[std::string("90")] = Spy(90);
+      Spy::reset();
+      // exercise
+      auto m = custom::map_union(std::move(mLeft), std::move(mRight));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(m.size() == 4);
+      assertUnit(m.at(std::string("50")).get() == 50);
+      assertUnit(m.at(std::string("90")).get() == 90);
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+   }  // teardown
+
+   // the keys both maps have, with the values of the left
+   void test_intersection_standard()
+   {  // setup
+      custom::map<std::string, Spy> mLeft;
+      setupStandardFixture(mLeft);
+      custom::map<std::string, Spy> mRight;
+      mRight[std::string("30")] = Spy(33);
+      mRight[std::string("70")] = Spy(77);
+      mRight[std::string("90")] = Spy(99);
+      Spy::reset();
+      // exercise
+      auto m = custom::map_intersection(std::move(mLeft), std::move(mRight));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(m.size() == 2);
+      assertUnit(m.at(std::string("30")).get() == 30);
+      assertUnit(m.at(std::string("70")).get() == 70);
+      assertUnit(m.find(std::string("50")) == m.end());
+   }  // teardown
+
+   // take out the keys the right map has
+   void test_difference_standard()
+   {  // setup
+      custom::map<std::string, Spy> mLeft;
+      setupStandardFixture(mLeft);
+      custom::map<std::string, Spy> mRight;
+      mRight[std::string("30")] = Spy(33);
+      mRight[std::string("90")] = Spy(99);
+      Spy::reset();
+      // exercise
+      auto m = custom::map_difference(std::move(mLeft), std::move(mRight));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 3);
+      assertUnit(m.size() == 2);
+      assertUnit((*m.begin()).first == std::string("50"));
+      assertUnit(m.at(std::string("70")).get() == 70);
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+   }  // teardown
+
+   // big ranked maps merged on several threads
+   void test_union_parallel()
+   {  // setup
+      using RankedMap = custom::map <int, int, std::less <int>, std::allocator <custom::pair <int, int> >, true>;
+      RankedMap mLeft;
+      RankedMap mRight;
+      for (int i = 0; i < 100000; i++)
+      {
+         mLeft[i * 2] = 1;
+         mRight[i * 3] = 2;
       }
+      // exercise
+      auto m = custom::map_union(std::move(mLeft), std::move(mRight),
+                                 [](int kept, int other) { return kept + other; }, 4);
+      // verify
+      assertUnit(m.size() == 166666);
+      assertUnit(m.at(0) == 3);
+      assertUnit(m.at(3) == 2);
+      assertUnit(m.at(4) == 1);
+      assertUnit(m.at(199998) == 3);
+      assertUnit(m.at(299997) == 2);
+      assertUnit(m.rank(150000) == 100000);
+      assertUnit(m.bst.root->verifySize());
+      assertUnit(m.bst.root->verifyRedBlack(m.bst.root->findDepth()));
+   }  // teardown
+
+   /***************************************
+    * BOUNDS
+    *    map::lower_bound(const K &)
+    *    map::upper_bound(const K &)
+    *    map::equal_range(const K &)
+    *    map::range(const K &, const K &)
+    ***************************************/
+
+   // the first key not before the one asked for
+   void test_lowerBound_standard()
+   {  // setup
+      //    "30"     "50"     "70"   = m
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto it50 = m.lower_bound(std::string("50"));
+      auto it55 = m.lower_bound(std::string("55"));
+      // verify
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(it50 == m.find(std::string("50")));
+      assertUnit(it55 == m.find(std::string("70")));
+      assertUnit(m.lower_bound(std::string("80")) == m.end());
+      assertStandardFixture(m);
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // the first key after the one asked for
+   void test_upperBound_standard()
+   {  // setup
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      // exercise
+      auto it50 = m.upper_bound(std::string("50"));
+      auto it10 = m.upper_bound(std::string("10"));
+      // verify
+      assertUnit(it50 == m.find(std::string("70")));
+      assertUnit(it10 == m.begin());
+      assertUnit(m.upper_bound(std::string("70")) == m.end());
       // teardown
       teardownStandardFixture(m);
    }
+
+   // the key, and the one after it
+   void test_equalRange_standard()
+   {  // setup
+      custom::map<std::string, Spy> m;
+      setupStandardFixture(m);
+      // exercise
+      auto pairFound = m.equal_range(std::string("30"));
+      auto pairMissing = m.equal_range(std::string("40"));
+      // verify
+      assertUnit(pairFound.first == m.find(std::string("30")));
+      assertUnit(pairFound.second == m.find(std::string("50")));
+      assertUnit(pairMissing.first == pairMissing.second);
+      assertUnit(pairMissing.first == m.find(std::string("50")));
+      // teardown
+      teardownStandardFixture(m);
+   }
+
+   // a time window: every key in [lo, hi)
+   void test_range_standard()
+   {  // setup
+      custom::map<int, int> m;
+      for (int i = 0; i < 100; i++)
+         m[i * 10] = i;
+      int sum = 0;
+      int num = 0;
+      // exercise
+      for (auto& p : m.range(195, 300))
+      {
+         sum += p.second;
+         num++;
+      }
+      // verify
+      assertUnit(num == 10);
+      assertUnit(sum == 20 + 21 + 22 + 23 + 24 + 25 + 26 + 27 + 28 + 29);
+      assertUnit(m.range(2000, 3000).empty());
+   }  // teardown
+
+   // the bounds take anything a transparent comparator can compare
+   void test_transparent_lowerBound()
+   {  // setup
+      custom::map <Spy, int, SpyLess> m;
+      m[Spy(50)] = 5;
+      m[Spy(30)] = 3;
+      m[Spy(70)] = 7;
+      Spy::reset();
+      // exercise
+      auto it = m.lower_bound(40);
+      auto pairRange = m.equal_range(70);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(it != m.end() && (*it).second == 5);
+      assertUnit(pairRange.first != m.end() && (*pairRange.first).second == 7);
+      assertUnit(pairRange.second == m.end());
+   }  // teardown
+
+   /***************************************
+    * ORDER STATISTICS
+    *    map::nth(size_t)
+    *    map::rank(const K &)
+    *    map::count_range(const K &, const K &)
+    *    distance(iterator, iterator)
+    ***************************************/
+
+   using RankedMap = custom::map <int, int, std::less <int>, std::allocator <custom::pair <int, int> >, true>;
+
+   // the k-th smallest key
+   void test_nth_ranked()
+   {  // setup
+      RankedMap m;
+      for (int i = 0; i < 100; i++)
+         m[(i * 37) % 100] = i;
+      // exercise
+      auto it = m.nth(42);
+      // verify
+      assertUnit(it != m.end());
+      assertUnit((*it).first == 42);
+      assertUnit(m.nth(0) == m.begin());
+      assertUnit(m.nth(100) == m.end());
+      assertUnit(m.bst.root->verifySize());
+   }  // teardown
+
+   // how many keys are below a key
+   void test_rank_ranked()
+   {  // setup
+      RankedMap m;
+      for (int i = 0; i < 100; i++)
+         m[i * 10] = i;
+      m.erase(500);
+      // exercise
+      // verify
+      assertUnit(m.rank(0) == 0);
+      assertUnit(m.rank(5) == 1);
+      assertUnit(m.rank(500) == 50);
+      assertUnit(m.rank(510) == 50);
+      assertUnit(m.rank(2000) == 99);
+      assertUnit(m.bst.root->verifySize());
+   }  // teardown
+
+   // how many keys fall in [lo, hi)
+   void test_countRange_ranked()
+   {  // setup
+      RankedMap m;
+      for (int i = 0; i < 100; i++)
+         m[i * 10] = i;
+      // exercise
+      // verify
+      assertUnit(m.count_range(100, 200) == 10);
+      assertUnit(m.count_range(95, 205) == 11);
+      assertUnit(m.count_range(200, 100) == 0);
+   }  // teardown
+
+   // distance between map iterators comes from the subtree sizes
+   void test_distance_ranked()
+   {  // setup
+      RankedMap m;
+      for (int i = 0; i < 100; i++)
+         m[i] = i;
+      using std::distance;
+      // exercise
+      // verify
+      assertUnit(distance(m.begin(), m.end()) == 100);
+      assertUnit(distance(m.find(20), m.find(70)) == 50);
+      assertUnit(distance(m.find(70), m.end()) == 30);
+      assertUnit(std::distance(m.find(70), m.end()) == 30);
+   }  // teardown
+
+   /***************************************
+    * TRANSPARENT COMPARATOR
+    *    map::find(const KK &)
+    *    map::count(const KK &)
+    *    map::contains(const KK &)
+    *    map::erase(const KK &)
+    ***************************************/
+
+   // orders Spy keys and lets a plain int stand in for one
+   struct SpyLess
+   {
+      using is_transparent = void;
+      bool operator () (const Spy& lhs, const Spy& rhs) const { return lhs.get() < rhs.get(); }
+      bool operator () (const Spy& lhs, int rhs)        const { return lhs.get() < rhs;       }
+      bool operator () (int lhs, const Spy& rhs)        const { return lhs < rhs.get();       }
+   };
+
+   // look up Spy keys with an int: no key is ever built
+   void test_transparent_lookupByInt()
+   {  // setup
+      custom::map <Spy, int, SpyLess> m;
+      m[Spy(50)] = 5;
+      m[Spy(30)] = 3;
+      m[Spy(70)] = 7;
+      Spy::reset();
+      // exercise
+      auto it = m.find(30);
+      size_t count = m.count(70);
+      bool containsMissing = m.contains(42);
+      auto itMissing = m.find(42);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);  // no key is made from the int
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numLessthan() == 0);    // the comparator does all the work
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(it != m.end());
+      assertUnit((*it).first.get() == 30);
+      assertUnit((*it).second == 3);
+      assertUnit(count == 1);
+      assertUnit(containsMissing == false);
+      assertUnit(itMissing == m.end());
+   }  // teardown
+
+   // erase a Spy key with an int
+   void test_transparent_eraseByInt()
+   {  // setup
+      custom::map <Spy, int, SpyLess> m;
+      m[Spy(50)] = 5;
+      m[Spy(30)] = 3;
+      m[Spy(70)] = 7;
+      Spy::reset();
+      // exercise
+      size_t numErased = m.erase(50);
+      size_t numMissing = m.erase(42);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);  // no key is made from the int
+      assertUnit(Spy::numDestructor() == 1); // destroy [50]
+      assertUnit(Spy::numDelete() == 1);     // delete  [50]
+      assertUnit(numErased == 1);
+      assertUnit(numMissing == 0);
+      assertUnit(m.size() == 2);
+      assertUnit(m.contains(30) && m.contains(70) && !m.contains(50));
+   }  // teardown
+
+   // std::less<> lets a string map be searched with string_views and C strings
+   void test_transparent_stringView()
+   {  // setup
+      custom::map <std::string, int, std::less <> > m;
+      m[std::string("30")] = 3;
+      m[std::string("50")] = 5;
+      m[std::string("70")] = 7;
+      const char buffer[] = "xx50yy";
+      // exercise
+      auto it = m.find(std::string_view(buffer + 2, 2));
+      bool contains70 = m.contains("70");
+      size_t numErased = m.erase(std::string_view("30"));
+      // verify
+      assertUnit(it != m.end());
+      assertUnit((*it).second == 5);
+      assertUnit(contains70);
+      assertUnit(numErased == 1);
+      assertUnit(m.size() == 2);
+      assertUnit(m.find("30") == m.end());
+   }  // teardown
+
+   /***************************************
+    * ALLOCATOR
+    *    custom::pmr::map
+    ***************************************/
+
+   // a request-scoped map lives entirely inside its arena
+   void test_allocator_pmrArena()
+   {  // setup
+      char buffer[4096];
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                                std::pmr::null_memory_resource());
+      custom::pmr::map <int, int> m(&arena);
+      // exercise
+      for (int i = 0; i < 20; i++)
+         m[i] = i * i;
+      // verify
+      assertUnit(m.size() == 20);
+      assertUnit(m.get_allocator().resource() == &arena);
+      bool inArena = true;
+      for (auto it = m.bst.begin(); it != m.bst.end(); ++it)
+         inArena = inArena && (char*)it.pNode >= buffer &&
+                              (char*)it.pNode < buffer + sizeof(buffer);
+      assertUnit(inArena);
+      assertUnit(m.at(7) == 49);
+      // teardown
+   }
+
+   // swapping maps with the same arena swaps the trees
+   void test_allocator_swap()
+   {  // setup
+      std::pmr::monotonic_buffer_resource arena;
+      custom::pmr::map <int, int> m1(&arena);
+      custom::pmr::map <int, int> m2(&arena);
+      m1[1] = 1;
+      m2[2] = 2;
+      m2[3] = 3;
+      auto pRoot1 = m1.bst.root;
+      auto pRoot2 = m2.bst.root;
+      // exercise
+      swap(m1, m2);
+      // verify
+      assertUnit(m1.bst.root == pRoot2);
+      assertUnit(m2.bst.root == pRoot1);
+      assertUnit(m1.size() == 2);
+      assertUnit(m2.size() == 1);
+      assertUnit(m1.get_allocator().resource() == &arena);
+      // teardown
+   }
+
    /****************************************************************
     * Setup Standard Fixture
     *    "30"     "50"     "70"
@@ -3159,22 +4198,26 @@ public:
       //               (50)b
       //           +-----+-----+
       //         (30)r        (70)r
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode30;
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode50;
-      custom::BST < custom::pair<std::string, Spy> > ::BNode* bnode70;
-      bnode30 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair30);
-      bnode50 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair50);
-      bnode70 = new custom::BST < custom::pair<std::string, Spy> > ::BNode(pair70);
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode30;
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode50;
+      custom::map <std::string, Spy> ::Tree ::BNode* bnode70;
+      bnode30 = new custom::map <std::string, Spy> ::Tree ::BNode(pair30);
+      bnode50 = new custom::map <std::string, Spy> ::Tree ::BNode(pair50);
+      bnode70 = new custom::map <std::string, Spy> ::Tree ::BNode(pair70);
 
       // hook up the links and stuff
       bnode50->pLeft  = bnode30;
       bnode50->pRight = bnode70;
-      bnode30->pParent = bnode70->pParent = bnode50;
-      bnode50->isRed = false;
-      bnode30->isRed = bnode70->isRed = false;
+      bnode30->setParent(bnode50);
+      bnode70->setParent(bnode50);
+      bnode50->setRed(false);
+      bnode30->setRed(false);
+      bnode70->setRed(false);
 
       // place the nodes in the bst
       m.bst.root = bnode50;
+      m.bst.pLeftmost = bnode30;
+      m.bst.pRightmost = bnode70;
       m.bst.numElements = 3;
    }
 
@@ -3214,7 +4257,7 @@ public:
       assertIndirect(m.bst.root->data.second == Spy(50));
       assertIndirect(m.bst.root->pLeft != nullptr);
       assertIndirect(m.bst.root->pRight != nullptr);
-      assertIndirect(m.bst.root->pParent == nullptr);
+      assertIndirect(m.bst.root->getParent() == nullptr);
 
       // check left branch
       if (m.bst.root->pLeft)
@@ -3223,7 +4266,7 @@ public:
          assertIndirect(m.bst.root->pLeft->data.second == Spy(30));
          assertIndirect(m.bst.root->pLeft->pLeft == nullptr);
          assertIndirect(m.bst.root->pLeft->pRight == nullptr);
-         assertIndirect(m.bst.root->pLeft->pParent == m.bst.root);
+         assertIndirect(m.bst.root->pLeft->getParent() == m.bst.root);
       }
 
       // check right branch
@@ -3233,7 +4276,7 @@ public:
          assertIndirect(m.bst.root->pRight->data.second == Spy(70));
          assertIndirect(m.bst.root->pRight->pLeft == nullptr);
          assertIndirect(m.bst.root->pRight->pRight == nullptr);
-         assertIndirect(m.bst.root->pRight->pParent == m.bst.root);
+         assertIndirect(m.bst.root->pRight->getParent() == m.bst.root);
       }
    }
 
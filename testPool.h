@@ -0,0 +1,386 @@
+/***********************************************************************
+ * Header:
+ *    TEST POOL
+ * Summary:
+ *    Unit tests for the node pool
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "pool.h"       // class under test
+#include "bst.h"        // the pool is used by the BST nodes
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // spy is a mock class to monitor the class under test
+
+#include <vector>     // for std::vector
+#include <algorithm>  // for std::sort and std::adjacent_find
+#include <thread>     // for std::thread
+
+/***********************************************
+ * TEST POOL
+ * Unit tests for the NodePool and NodeCache classes
+ ***********************************************/
+class TestPool : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Allocate
+      test_allocate_one();
+      test_allocate_recycle();
+      test_allocate_manyChunks();
+
+      // Capacity
+      test_reserve_empty();
+      test_reserve_partial();
+      test_shrinkToFit_allFree();
+      test_shrinkToFit_inUse();
+
+      // Cache
+      test_cache_batchesDouble();
+      test_cache_recycle();
+      test_cache_release();
+
+      // BST
+      test_bst_eraseRecycles();
+      test_bst_eraseKeepsOwn();
+      test_bst_reserve();
+      test_bst_reserveOwn();
+      test_bst_threads();
+
+      report("Pool");
+   }
+
+   using Pool = custom::NodePool <24, 8>;
+
+   // a node type no container uses, so its pool is ours alone
+   struct Block
+   {
+      void* p[3];
+   };
+   using Cache = custom::NodeCache <Block>;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new pool does not touch the heap
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Pool pool;
+      // verify
+      assertUnit(pool.chunks.empty());
+      assertUnit(pool.pFree == nullptr);
+      assertUnit(pool.size() == 0);
+      assertUnit(pool.available() == 0);
+      assertUnit(pool.capacity() == 0);
+   }  // teardown
+
+   /***************************************
+    * ALLOCATE
+    ***************************************/
+
+   // the first allocation grabs a chunk
+   void test_allocate_one()
+   {  // setup
+      Pool pool;
+      // exercise
+      void* p = pool.allocate();
+      // verify
+      assertUnit(p != nullptr);
+      assertUnit(pool.chunks.size() == 1);
+      assertUnit(pool.size() == 1);
+      assertUnit(pool.capacity() == Pool::numSlotsMin);
+      assertUnit(reinterpret_cast <size_t> (p) % 8 == 0);
+      // teardown
+      pool.deallocate(p);
+   }
+
+   // a freed block is the next one handed out
+   void test_allocate_recycle()
+   {  // setup
+      Pool pool;
+      void* p1 = pool.allocate();
+      void* p2 = pool.allocate();
+      pool.deallocate(p1);
+      // exercise
+      void* p3 = pool.allocate();
+      // verify
+      assertUnit(p3 == p1);
+      assertUnit(p3 != p2);
+      assertUnit(pool.size() == 2);
+      assertUnit(pool.chunks.size() == 1);
+      // teardown
+      pool.deallocate(p2);
+      pool.deallocate(p3);
+   }
+
+   // every block is distinct even across chunks
+   void test_allocate_manyChunks()
+   {  // setup
+      Pool pool;
+      std::vector <void*> blocks;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         blocks.push_back(pool.allocate());
+      // verify
+      std::vector <void*> sorted(blocks);
+      std::sort(sorted.begin(), sorted.end());
+      assertUnit(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+      assertUnit(pool.size() == 1000);
+      assertUnit(pool.chunks.size() > 1);
+      assertUnit(pool.chunks.size() < 10);
+      // teardown
+      for (auto p : blocks)
+         pool.deallocate(p);
+      assertUnit(pool.size() == 0);
+   }
+
+   /***************************************
+    * RESERVE and SHRINK TO FIT
+    ***************************************/
+
+   // reserve allocates one chunk big enough for everything
+   void test_reserve_empty()
+   {  // setup
+      Pool pool;
+      // exercise
+      pool.reserve(5000);
+      // verify
+      assertUnit(pool.chunks.size() == 1);
+      assertUnit(pool.available() == 5000);
+      assertUnit(pool.size() == 0);
+   }  // teardown
+
+   // reserve only asks for what is missing
+   void test_reserve_partial()
+   {  // setup
+      Pool pool;
+      void* p = pool.allocate();
+      size_t available = pool.available();
+      // exercise
+      pool.reserve(available);
+      pool.reserve(available + 100);
+      // verify
+      assertUnit(pool.chunks.size() == 2);
+      assertUnit(pool.available() == available + 100);
+      assertUnit(pool.size() == 1);
+      // teardown
+      pool.deallocate(p);
+   }
+
+   // chunks with nothing in use are given back
+   void test_shrinkToFit_allFree()
+   {  // setup
+      Pool pool;
+      std::vector <void*> blocks;
+      for (int i = 0; i < 200; i++)
+         blocks.push_back(pool.allocate());
+      for (auto p : blocks)
+         pool.deallocate(p);
+      // exercise
+      pool.shrink_to_fit();
+      // verify
+      assertUnit(pool.chunks.empty());
+      assertUnit(pool.pFree == nullptr);
+      assertUnit(pool.capacity() == 0);
+   }  // teardown
+
+   // a chunk with a block in use stays
+   void test_shrinkToFit_inUse()
+   {  // setup
+      Pool pool;
+      void* pKeep = pool.allocate();
+      pool.reserve(pool.available() + 1000);
+      assertUnit(pool.chunks.size() == 2);
+      // exercise
+      pool.shrink_to_fit();
+      // verify
+      assertUnit(pool.chunks.size() == 1);
+      assertUnit(pool.size() == 1);
+      assertUnit(pool.capacity() == Pool::numSlotsMin);
+      void* p = pool.allocate();
+      assertUnit(p != pKeep);
+      // teardown
+      pool.deallocate(p);
+      pool.deallocate(pKeep);
+   }
+
+   /***************************************
+    * CACHE
+    ***************************************/
+
+   // each time the cache runs dry it takes twice as many as before
+   void test_cache_batchesDouble()
+   {  // setup
+      Cache cache;
+      size_t numInUse = Cache::pool().size();
+      // exercise
+      void* p1 = cache.allocate();
+      void* p2 = cache.allocate();
+      void* p3 = cache.allocate();
+      void* p4 = cache.allocate();
+      // verify
+      assertUnit(p1 != p2 && p2 != p3 && p3 != p4);
+      assertUnit(cache.available() == 3);                  // 1 + 2 + 4 taken
+      assertUnit(Cache::pool().size() == numInUse + 7);
+      // teardown
+      for (void* p : { p1, p2, p3, p4 })
+         cache.deallocate(p);
+      cache.release();
+      assertUnit(Cache::pool().size() == numInUse);
+   }
+
+   // a freed block stays with the cache and is the next one handed out
+   void test_cache_recycle()
+   {  // setup
+      Cache cache;
+      void* p1 = cache.allocate();
+      size_t numInUse = Cache::pool().size();
+      // exercise
+      cache.deallocate(p1);
+      void* p2 = cache.allocate();
+      // verify
+      assertUnit(p2 == p1);
+      assertUnit(Cache::pool().size() == numInUse);
+      // teardown
+      cache.deallocate(p2);
+   }
+
+   // release gives the whole list back in one go
+   void test_cache_release()
+   {  // setup
+      size_t numInUse = Cache::pool().size();
+      Cache cache;
+      cache.reserve(100);
+      assertUnit(cache.available() == 100);
+      assertUnit(Cache::pool().size() == numInUse + 100);
+      // exercise
+      cache.release();
+      // verify
+      assertUnit(cache.available() == 0);
+      assertUnit(cache.pFree == nullptr && cache.pLast == nullptr);
+      assertUnit(Cache::pool().size() == numInUse);
+   }  // teardown
+
+   /***************************************
+    * BST
+    ***************************************/
+
+   // an insert after an erase reuses the erased node
+   void test_bst_eraseRecycles()
+   {  // setup
+      custom::BST <int> bst;
+      bst.insert(50);
+      bst.insert(30);
+      bst.insert(70);
+      auto it = bst.find(30);
+      const void* pErased = it.pNode;
+      bst.erase(it);
+      // exercise
+      auto pairReturn = bst.insert(40);
+      // verify
+      assertUnit(pairReturn.first.pNode == pErased);
+      assertUnit(*pairReturn.first == 40);
+   }  // teardown
+
+   // an erased node goes to the tree it came from, not to another
+   void test_bst_eraseKeepsOwn()
+   {  // setup
+      custom::BST <int> bst1;
+      custom::BST <int> bst2;
+      for (int i = 0; i < 10; i++)
+         bst1.insert(i);
+      bst2.insert(100);
+      size_t numSpare1 = bst1.nodes.available();
+      size_t numSpare2 = bst2.nodes.available();
+      auto it = bst1.find(5);
+      const void* pErased = it.pNode;
+      // exercise
+      bst1.erase(it);
+      // verify
+      assertUnit(bst1.nodes.available() == numSpare1 + 1);
+      assertUnit(bst2.nodes.available() == numSpare2);
+      assertUnit(bst1.nodes.pFree == pErased);
+   }  // teardown
+
+   // reserve sizes the pool so that inserts do not grow it
+   void test_bst_reserve()
+   {  // setup
+      custom::BST <Spy> bst;
+      auto& pool = custom::BST <Spy> ::BNode::pool();
+      // exercise
+      bst.reserve(10000);
+      size_t capacity = pool.capacity();
+      size_t numChunks = pool.chunks.size();
+      for (int i = 0; i < 10000; i++)
+         bst.insert(Spy(i));
+      // verify
+      assertUnit(pool.capacity() == capacity);
+      assertUnit(pool.chunks.size() == numChunks);
+      assertUnit(bst.nodes.available() == 0);
+      // teardown
+      bst.clear();
+      bst.shrink_to_fit();
+      assertUnit(pool.size() == 0);
+      assertUnit(pool.capacity() == 0);
+   }
+
+   // reserving for one tree leaves nothing spare for another
+   void test_bst_reserveOwn()
+   {  // setup
+      custom::BST <int> bst1;
+      custom::BST <int> bst2;
+      // exercise
+      bst1.reserve(1000);
+      // verify
+      assertUnit(bst1.nodes.available() == 1000);
+      assertUnit(bst2.nodes.available() == 0);
+      // exercise
+      bst1.shrink_to_fit();
+      // verify
+      assertUnit(bst1.nodes.available() == 0);
+   }  // teardown
+
+   // trees on different threads share the pool safely
+   void test_bst_threads()
+   {  // setup
+      const int num = 20000;
+      size_t numInUse = custom::BST <int> ::BNode::pool().size();
+      bool isValid[2] = { false, false };
+      auto work = [&isValid, num](int iThread)
+      {
+         custom::BST <int> bst;
+         for (int i = 0; i < num; i++)
+            bst.insert(i * 7919 % num);
+         for (int i = 0; i < num; i += 2)
+         {
+            auto it = bst.find(i);
+            bst.erase(it);
+         }
+         for (int i = 0; i < num; i += 2)
+            bst.insert(i);
+         isValid[iThread] = bst.size() == size_t(num) &&
+                            bst.root->verifyRedBlack(bst.root->findDepth());
+      };
+      // exercise
+      std::thread thread(work, 1);
+      work(0);
+      thread.join();
+      // verify
+      assertUnit(isValid[0]);
+      assertUnit(isValid[1]);
+      assertUnit(custom::BST <int> ::BNode::pool().size() == numInUse);
+   }  // teardown
+};
+
+#endif // DEBUG
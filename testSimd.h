@@ -0,0 +1,424 @@
+/***********************************************************************
+ * Header:
+ *    TEST SIMD
+ * Summary:
+ *    Unit tests for searching a block of keys several at a time, for
+ *    the B-tree nodes that keep their keys in such a block, and for
+ *    matching the control bytes of a hash table 16 at a time
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "simd.h"       // class under test
+#include "btree.h"      // a B-tree searches its nodes this way
+#include "unitTest.h"   // unit test baseclass
+
+#include <set>        // for std::multiset to check against
+#include <vector>     // for std::vector
+#include <string>     // for std::string
+#include <random>     // for std::mt19937
+#include <limits>     // for std::numeric_limits
+#include <algorithm>  // for std::sort, std::lower_bound and std::upper_bound
+#include <cstdint>    // for int32_t, uint32_t, int64_t and uint64_t
+
+/***********************************************
+ * TEST SIMD
+ * Unit tests for simd::countLess, simd::countNotGreater,
+ * simd::matchGroup and the KeyBlock of a btree node
+ ***********************************************/
+class TestSimd : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Traits
+      test_isSearchable();
+      test_setLevel_clamped();
+
+      // Count
+      test_count_empty();
+      test_count_duplicates();
+      test_count_smallBlock();
+      test_count_unsignedHalves();
+      test_count_signedNegatives();
+      test_count_random <int32_t> ();
+      test_count_random <uint32_t> ();
+      test_count_random <int64_t> ();
+      test_count_random <uint64_t> ();
+
+      // Group
+      test_matchGroup_everyLevel();
+
+      // B-tree
+      test_btree_hasKeyBlock();
+      test_btree_vectorOnlyLarge <11> ();   // the default for a map of uint64_t pairs
+      test_btree_vectorOnlyLarge <33> ();
+      test_btree_vectorOnlyLarge <65> ();
+      test_btree_keysFollowValues();
+      test_btree_everyLevel <17> ();
+      test_btree_everyLevel <33> ();
+      test_btree_everyLevel <65> ();
+
+      report("SIMD");
+   }
+
+   using Level = custom::simd::Level;
+
+   // every level this CPU can run, scalar first
+   static std::vector <Level> levels()
+   {
+      std::vector <Level> levels;
+      for (Level level : { Level::scalar, Level::sse42, Level::avx2 })
+         if (level <= custom::simd::supported())
+            levels.push_back(level);
+      return levels;
+   }
+
+   template <size_t Fanout>
+   using Tree = custom::btree <uint64_t, std::allocator <uint64_t>, custom::Identity,
+                               std::less <uint64_t>, Fanout>;
+
+   /***************************************
+    * TRAITS
+    ***************************************/
+
+   // only 4 and 8 byte integers in their natural order
+   void test_isSearchable()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit((custom::simd::isSearchable <int, std::less <int> > ::value));
+      assertUnit((custom::simd::isSearchable <uint64_t, std::less <uint64_t> > ::value));
+      assertUnit((custom::simd::isSearchable <long long, std::less <> > ::value));
+      assertUnit(!(custom::simd::isSearchable <int, std::greater <int> > ::value));
+      assertUnit(!(custom::simd::isSearchable <short, std::less <short> > ::value));
+      assertUnit(!(custom::simd::isSearchable <bool, std::less <bool> > ::value));
+      assertUnit(!(custom::simd::isSearchable <double, std::less <double> > ::value));
+      assertUnit(!(custom::simd::isSearchable <std::string, std::less <std::string> > ::value));
+   }  // teardown
+
+   // asking for more than the CPU has gets what it has
+   void test_setLevel_clamped()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      // exercise
+      custom::simd::setLevel(Level::avx2);
+      // verify
+      assertUnit(custom::simd::active == custom::simd::supported());
+      custom::simd::setLevel(Level::scalar);
+      assertUnit(custom::simd::active == Level::scalar);
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   /***************************************
+    * COUNT
+    ***************************************/
+
+   // no keys, nothing before or after
+   void test_count_empty()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      int64_t keys[1] = { 5 };
+      for (Level level : levels())
+      {
+         custom::simd::setLevel(level);
+         // exercise
+         // verify
+         assertUnit(custom::simd::countLess(keys, 0, int64_t(9)) == 0);
+         assertUnit(custom::simd::countNotGreater(keys, 0, int64_t(9)) == 0);
+      }
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   // equal keys are after a lower bound and before an upper bound
+   //    1 2 2 2 2 2 3 4 5 6 7
+   void test_count_duplicates()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      int32_t keys[11] = { 1, 2, 2, 2, 2, 2, 3, 4, 5, 6, 7 };
+      for (Level level : levels())
+      {
+         custom::simd::setLevel(level);
+         // exercise
+         // verify
+         assertUnit(custom::simd::countLess(keys, 11, 2) == 1);
+         assertUnit(custom::simd::countNotGreater(keys, 11, 2) == 6);
+         assertUnit(custom::simd::countLess(keys, 11, 0) == 0);
+         assertUnit(custom::simd::countNotGreater(keys, 11, 7) == 11);
+         assertUnit(custom::simd::countLess(keys, 11, 8) == 11);
+      }
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   // a block too small for the vectors to pay off gets the same answers one key at a time
+   //    1 2 2 2 2 2 3 4 5 6 7
+   void test_count_smallBlock()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      int32_t keys[11] = { 1, 2, 2, 2, 2, 2, 3, 4, 5, 6, 7 };
+      for (Level level : levels())
+      {
+         custom::simd::setLevel(level);
+         // exercise
+         // verify
+         assertUnit(custom::simd::countLess(keys, 11, 2, 11) == 1);
+         assertUnit(custom::simd::countNotGreater(keys, 11, 2, 11) == 6);
+         assertUnit(custom::simd::countLess(keys, 11, 8, 11) == 11);
+         assertUnit(custom::simd::countNotGreater(keys, 11, 0, 11) == 0);
+      }
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   // unsigned keys on both sides of the top bit, which a signed
+   // compare would put in the wrong order
+   void test_count_unsignedHalves()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      const uint64_t half = uint64_t(1) << 63;
+      uint64_t keys[6] = { 0, 1, half - 1, half, half + 1, ~uint64_t(0) };
+      uint32_t keys32[6] = { 0, 1, 0x7fffffffu, 0x80000000u, 0x80000001u, 0xffffffffu };
+      for (Level level : levels())
+      {
+         custom::simd::setLevel(level);
+         // exercise
+         // verify
+         assertUnit(custom::simd::countLess(keys, 6, half) == 3);
+         assertUnit(custom::simd::countNotGreater(keys, 6, half) == 4);
+         assertUnit(custom::simd::countLess(keys, 6, ~uint64_t(0)) == 5);
+         assertUnit(custom::simd::countLess(keys32, 6, 0x80000000u) == 3);
+         assertUnit(custom::simd::countNotGreater(keys32, 6, 0xffffffffu) == 6);
+      }
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   // signed keys below zero come first
+   void test_count_signedNegatives()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      const int64_t lowest = std::numeric_limits <int64_t> ::min();
+      int64_t keys[7] = { lowest, -5, -1, 0, 1, 5, std::numeric_limits <int64_t> ::max() };
+      for (Level level : levels())
+      {
+         custom::simd::setLevel(level);
+         // exercise
+         // verify
+         assertUnit(custom::simd::countLess(keys, 7, int64_t(0)) == 3);
+         assertUnit(custom::simd::countNotGreater(keys, 7, int64_t(-1)) == 3);
+         assertUnit(custom::simd::countLess(keys, 7, lowest) == 0);
+         assertUnit(custom::simd::countNotGreater(keys, 7, lowest) == 1);
+      }
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   // blocks of every size up to 64 agree with a scalar binary search
+   // at every level, probing each key, its neighbors and the extremes
+   template <class K>
+   void test_count_random()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      std::mt19937_64 random(sizeof(K) * 10 + std::is_signed <K> ::value);
+      bool isValid = true;
+      for (int num = 0; num <= 64; num++)
+      {
+         // narrow ranges make duplicates, wide ones cover the sign bit
+         std::vector <K> keys(num);
+         for (K& key : keys)
+            key = num % 2 ? K(random() % 8) : K(random());
+         std::sort(keys.begin(), keys.end());
+         std::vector <K> probes = { std::numeric_limits <K> ::min(),
+                                    std::numeric_limits <K> ::max(), K(random()) };
+         for (K key : keys)
+         {
+            probes.push_back(key);
+            probes.push_back(K(key - 1));
+            probes.push_back(K(key + 1));
+         }
+
+         // exercise
+         for (Level level : levels())
+         {
+            custom::simd::setLevel(level);
+            for (K k : probes)
+            {
+               int numLess = int(std::lower_bound(keys.begin(), keys.end(), k) - keys.begin());
+               int numNotGreater = int(std::upper_bound(keys.begin(), keys.end(), k) - keys.begin());
+               isValid = isValid &&
+                         custom::simd::countLess(keys.data(), num, k) == numLess &&
+                         custom::simd::countNotGreater(keys.data(), num, k) == numNotGreater;
+            }
+         }
+      }
+      // verify
+      assertUnit(isValid);
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   /***************************************
+    * GROUP
+    ***************************************/
+
+   // every level finds the same tags and empty slots in random groups,
+   // read from every offset so none of them is aligned
+   void test_matchGroup_everyLevel()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      std::mt19937 random(16);
+      bool isValid = true;
+      for (int trial = 0; trial < 200; trial++)
+      {
+         int8_t bytes[32];
+         for (int8_t& byte : bytes)
+            byte = random() % 4 ? int8_t(random() % 8) : int8_t(-128);
+         int8_t tag = int8_t(random() % 8);
+         const int8_t* pGroup = bytes + trial % 16;
+         uint32_t matchesExpected = 0;
+         uint32_t emptiesExpected = 0;
+         for (int i = 0; i < 16; i++)
+         {
+            matchesExpected |= uint32_t(pGroup[i] == tag) << i;
+            emptiesExpected |= uint32_t(pGroup[i] < 0) << i;
+         }
+
+         // exercise
+         for (Level level : levels())
+         {
+            custom::simd::setLevel(level);
+            uint32_t empties;
+            uint32_t matches = custom::simd::matchGroup(pGroup, tag, empties);
+            isValid = isValid && matches == matchesExpected && empties == emptiesExpected;
+         }
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(custom::simd::lowestBit(1) == 0);
+      assertUnit(custom::simd::lowestBit(0x8000) == 15);
+      assertUnit(custom::simd::lowestBit(0x0600) == 9);
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   /***************************************
+    * B-TREE
+    ***************************************/
+
+   // integer keys get a block, anything else does not
+   void test_btree_hasKeyBlock()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit(Tree <17> ::hasKeyBlock);
+      assertUnit((custom::btree <int, std::allocator <int>, custom::Identity, std::less <int>, 4> ::hasKeyBlock));
+      assertUnit(!(custom::btree <int, std::allocator <int>, custom::Identity, std::greater <int>, 4> ::hasKeyBlock));
+      assertUnit(!(custom::btree <std::string, std::allocator <std::string>, custom::Identity,
+                                  std::less <std::string>, 4> ::hasKeyBlock));
+   }  // teardown
+
+   // a full node, searched one key at a time if it is small and with
+   // vectors if it is large, agrees with the scalar count at every level
+   template <size_t Fanout>
+   void test_btree_vectorOnlyLarge()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      Tree <Fanout> t;
+      std::mt19937_64 random(Fanout);
+      while (t.size() < Fanout - 1)
+         t.insert(random() % 1000 * 0x0100000000000001ull);
+      const uint64_t* pKeys = t.root->keys;
+      int num = int(t.root->count);
+      bool isValid = t.root->pParent == nullptr && num == Tree <Fanout> ::numMaxValues;
+      // exercise
+      for (Level level : levels())
+      {
+         custom::simd::setLevel(level);
+         for (int i = 0; i < 2000; i++)
+         {
+            uint64_t key = random() % 1010 * 0x0100000000000001ull;
+            isValid = isValid &&
+               t.lowerBoundIndex(t.root, key) == custom::simd::countScalar <uint64_t, false> (pKeys, num, key) &&
+               t.upperBoundIndex(t.root, key) == num - custom::simd::countScalar <uint64_t, true> (pKeys, num, key);
+         }
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit((Tree <Fanout> ::numMaxValues >= custom::simd::numVectorMin) == (Fanout >= 65));
+      // teardown
+      custom::simd::active = levelSave;
+   }
+
+   // every split, borrow and merge leaves the block matching the values
+   void test_btree_keysFollowValues()
+   {  // setup
+      Tree <17> t;
+      std::mt19937_64 random(3);
+      bool isValid = true;
+      // exercise
+      for (int i = 0; i < 20000; i++)
+      {
+         uint64_t key = random() % 3000;
+         if (random() % 3)
+            t.insert(key);
+         else
+            t.erase(t.find(key));
+         if (i % 97 == 0)
+            isValid = isValid && t.verify();
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(t.verify());
+      Tree <17> tCopy(t);
+      assertUnit(tCopy.verify());
+   }  // teardown
+
+   // a tree built once finds the same things at every level
+   template <size_t Fanout>
+   void test_btree_everyLevel()
+   {  // setup
+      Level levelSave = custom::simd::active;
+      Tree <Fanout> t;
+      std::multiset <uint64_t> reference;
+      std::mt19937_64 random(Fanout);
+      for (int i = 0; i < 5000; i++)
+      {
+         uint64_t key = random() % 4000 * 0x0100000000000001ull;
+         t.insert(key);
+         reference.insert(key);
+      }
+      bool isValid = t.verify();
+      // exercise
+      for (Level level : levels())
+      {
+         custom::simd::setLevel(level);
+         for (int i = 0; i < 5000; i++)
+         {
+            uint64_t key = random() % 4100 * 0x0100000000000001ull;
+            auto it = t.lowerBound(key);
+            auto itRef = reference.lower_bound(key);
+            isValid = isValid && (it == t.end()) == (itRef == reference.end()) &&
+                      (it == t.end() || *it == *itRef);
+            it = t.upperBound(key);
+            itRef = reference.upper_bound(key);
+            isValid = isValid && (it == t.end()) == (itRef == reference.end()) &&
+                      (it == t.end() || *it == *itRef);
+            isValid = isValid && t.contains(key) == (reference.count(key) != 0);
+         }
+      }
+      // verify
+      assertUnit(isValid);
+      // teardown
+      custom::simd::active = levelSave;
+   }
+};
+
+#endif // DEBUG
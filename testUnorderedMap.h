@@ -0,0 +1,909 @@
+/***********************************************************************
+ * Header:
+ *    TEST UNORDERED MAP
+ * Summary:
+ *    Unit tests for the open-addressing unordered_map
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "unorderedMap.h" // class under test
+#include "unitTest.h"     // unit test baseclass
+#include "spy.h"          // spy is a mock class to monitor the class under test
+
+#include <set>             // for std::set
+#include <vector>          // for std::vector
+#include <random>          // for std::mt19937
+#include <string>          // for std::string
+#include <string_view>     // for std::string_view
+#include <stdexcept>       // for std::out_of_range
+#include <unordered_map>   // for std::unordered_map to check against
+#include <memory_resource> // for std::pmr::monotonic_buffer_resource
+
+/***********************************************
+ * TEST UNORDERED MAP
+ * Unit tests for the unordered_map class
+ ***********************************************/
+class TestUnorderedMap : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_buckets();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+      test_constructMove_noexcept();
+      test_constructRange_duplicates();
+      test_constructInit_standard();
+
+      // Assign
+      test_assign_standardToNotempty();
+      test_assignMove_standardToNotempty();
+      test_swap_standardToStandard();
+
+      // Iterator
+      test_iterate_everyPair();
+      test_iterate_empty();
+      test_iterate_eraseWrapped();
+
+      // Access
+      test_access_emptyWrite();
+      test_access_standardRead();
+      test_at_missing();
+      test_find_standard();
+      test_find_standardMissing();
+
+      // Insert
+      test_insertCopy_standard();
+      test_insert_duplicateNotCopied();
+      test_emplace_standard();
+      test_tryEmplace_standard();
+      test_tryEmplace_standardDuplicate();
+      test_insertOrAssign_standardDuplicate();
+      test_insert_grows();
+
+      // Buckets
+      test_reserve_noMove();
+      test_rehash_shrink();
+
+      // Remove
+      test_erase_standardKey();
+      test_erase_backwardShift();
+      test_erase_backwardShiftStays();
+      test_erase_iteratorNext();
+      test_erase_range();
+      test_erase_rangeWrapped();
+      test_clear_standard();
+
+      // Transparent
+      test_transparent_stringView();
+
+      // Allocator
+      test_allocator_pmrArena();
+
+      // Random
+      test_map_random();
+
+      report("UnorderedMap");
+   }
+
+   // the key is its own hash, so tests can pick where the keys go
+   struct RawHash
+   {
+      size_t operator () (int k) const { return size_t(k); }
+   };
+
+   // hashes a std::string and anything that can view one the same way
+   struct StringHash
+   {
+      using is_transparent = void;
+      size_t operator () (std::string_view s) const { return std::hash <std::string_view> () (s); }
+   };
+
+   using Map = custom::unordered_map <std::string, Spy>;
+   using IntMap = custom::unordered_map <int, int>;
+   using SpyMap = custom::unordered_map <int, Spy, RawHash>;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new table allocates nothing, and finds nothing
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      Map m;
+      // verify
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(m.pSlots == nullptr);
+      assertUnit(m.pControl == nullptr);
+      assertUnit(m.bucket_count() == 0);
+      assertUnit(m.empty());
+      assertUnit(m.begin() == m.end());
+      assertUnit(m.find("50") == m.end());
+      assertUnit(m.count("50") == 0);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // asking for buckets gets a power of two at least that many
+   void test_construct_buckets()
+   {  // setup
+      // exercise
+      IntMap m(100);
+      const custom::pair <int, int>* pSlots = m.pSlots;
+      for (int i = 0; i < 112; i++)
+         m[i] = i;
+      // verify
+      assertUnit(m.bucket_count() == 128);
+      assertUnit(m.pSlots == pSlots);        // 7/8 of 128 fit
+      m[112] = 112;
+      assertUnit(m.bucket_count() == 256);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // a copy puts each pair in the same slot of a table the same size
+   void test_constructCopy_standard()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Spy::reset();
+      // exercise
+      Map mDes(mSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy [30][50][70]
+      assertUnit(Spy::numAlloc() == 3);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(mDes.bucket_count() == mSrc.bucket_count());
+      assertUnit(mDes.pSlots != mSrc.pSlots);
+      assertUnit(std::memcmp(mDes.pControl, mSrc.pControl, mSrc.bucket_count() + 16) == 0);
+      assertStandardFixture(mSrc);
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // a move takes the arrays and touches no pairs
+   void test_constructMove_standard()
+   {  // setup
+      Map mSrc;
+      setupStandardFixture(mSrc);
+      Spy::reset();
+      // exercise
+      Map mDes(std::move(mSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(mSrc.empty());
+      assertUnit(mSrc.pSlots == nullptr);
+      assertUnit(mSrc.verify());
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // moving never throws, so containers of tables move them rather than copy
+   void test_constructMove_noexcept()
+   {  // verify
+      using PmrMap = custom::pmr::unordered_map <int, Spy>;
+      static_assert(std::is_nothrow_move_constructible <Map> ::value, "moving a table cannot throw");
+      static_assert(std::is_nothrow_move_assignable <Map> ::value, "moving a table cannot throw");
+      assertUnit(std::is_nothrow_move_constructible <PmrMap> ::value);
+      // a polymorphic allocator stays behind, so the pairs may have to move one at a time
+      assertUnit(!std::is_nothrow_move_assignable <PmrMap> ::value);
+   }
+
+   // the first of each repeated key is kept, and the others are never copied
+   void test_constructRange_duplicates()
+   {  // setup
+      std::vector <custom::pair<std::string, Spy>> v;
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(70)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(50)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("70"), Spy(71)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("30"), Spy(30)));
+      v.push_back(custom::pair<std::string, Spy>(std::string("50"), Spy(51)));
+      Spy::reset();
+      // exercise
+      Map m(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);     // copy [70][50][30] only
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // an initializer list
+   void test_constructInit_standard()
+   {  // setup
+      // exercise
+      Map m = { custom::pair <std::string, Spy> (std::string("70"), Spy(70)),
+                custom::pair <std::string, Spy> (std::string("30"), Spy(30)),
+                custom::pair <std::string, Spy> (std::string("50"), Spy(50)) };
+      // verify
+      assertStandardFixture(m);
+   }  // teardown
+
+   /***************************************
+    * ASSIGN
+    ***************************************/
+
+   // copying over a table the same size reuses its arrays
+   void test_assign_standardToNotempty()
+   {  // setup
+      Map mSrc;
+      Map mDes;
+      setupStandardFixture(mSrc);
+      mDes["99"] = Spy(99);
+      const custom::pair <std::string, Spy>* pSlotsOld = mDes.pSlots;
+      Spy::reset();
+      // exercise
+      mDes = mSrc;
+      // verify
+      assertUnit(Spy::numDestructor() == 1);  // destroy [99]
+      assertUnit(Spy::numCopy() == 3);        // copy [30][50][70]
+      assertUnit(mDes.pSlots == pSlotsOld);
+      assertUnit(!mDes.contains("99"));
+      assertStandardFixture(mSrc);
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // move assignment frees the old pairs and takes the new arrays
+   void test_assignMove_standardToNotempty()
+   {  // setup
+      Map mSrc;
+      Map mDes;
+      setupStandardFixture(mSrc);
+      mDes["99"] = Spy(99);
+      const custom::pair <std::string, Spy>* pSlotsSrc = mSrc.pSlots;
+      Spy::reset();
+      // exercise
+      mDes = std::move(mSrc);
+      // verify
+      assertUnit(Spy::numDestructor() == 1);  // destroy [99]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(mDes.pSlots == pSlotsSrc);
+      assertUnit(mSrc.empty());
+      assertStandardFixture(mDes);
+   }  // teardown
+
+   // swap trades the arrays
+   void test_swap_standardToStandard()
+   {  // setup
+      Map m1;
+      Map m2;
+      setupStandardFixture(m1);
+      m2["99"] = Spy(99);
+      Spy::reset();
+      // exercise
+      swap(m1, m2);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertStandardFixture(m2);
+      assertUnit(m1.size() == 1);
+      assertUnit(m1.at("99").get() == 99);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // a walk sees every pair once
+   void test_iterate_everyPair()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 1000; i++)
+         m[i * 7] = i;
+      std::set <int> keys;
+      size_t num = 0;
+      // exercise
+      for (auto it = m.begin(); it != m.end(); ++it, ++num)
+         keys.insert((*it).first);
+      // verify
+      assertUnit(num == 1000);
+      assertUnit(keys.size() == 1000);
+      assertUnit(*keys.begin() == 0 && *keys.rbegin() == 999 * 7);
+   }  // teardown
+
+   // nothing to walk
+   void test_iterate_empty()
+   {  // setup
+      IntMap m;
+      m[1] = 1;
+      // exercise
+      m.clear();
+      // verify
+      assertUnit(m.begin() == m.end());
+      assertUnit(m.bucket_count() == 16);
+   }  // teardown
+
+   // a run of full slots wraps from the last slot to the first. Erasing
+   // while walking shifts pairs back, but the walk still sees each once.
+   //    slot: 0  1  2  3  4  5  6  7  8 ... 14 15
+   //          k6 k7 k8 k9 .  .  .  .  .      k0 k1 ...
+   void test_iterate_eraseWrapped()
+   {  // setup
+      SpyMap m(16);
+      std::vector <int> keys = keysHomedAt(14, 10);
+      for (int key : keys)
+         m.try_emplace(key, key);
+      bool isWrapped = m.pControl[0] >= 0 && m.pControl[15] >= 0;
+      std::multiset <int> seen;
+      // exercise
+      for (auto it = m.begin(); it != m.end(); )
+      {
+         int key = (*it).first;
+         seen.insert(key);
+         if (key % 2 == 0)
+            it = m.erase(it);
+         else
+            ++it;
+      }
+      // verify
+      assertUnit(isWrapped);
+      assertUnit(seen.size() == 10);
+      assertUnit(std::set <int> (seen.begin(), seen.end()).size() == 10);
+      bool isRight = true;
+      for (int key : keys)
+         isRight = isRight && m.contains(key) == (key % 2 != 0);
+      assertUnit(isRight);
+      assertUnit(m.verify());
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // writing to an empty table adds the key and the first slots
+   void test_access_emptyWrite()
+   {  // setup
+      Map m;
+      Spy::reset();
+      // exercise
+      m["50"] = Spy(50);
+      // verify
+      assertUnit(Spy::numDefault() == 1);     // the new value starts out blank
+      assertUnit(Spy::numAssignMove() == 1);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(m.size() == 1);
+      assertUnit(m.bucket_count() == 16);
+      assertUnit(m.at("50").get() == 50);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // reading with the subscript changes nothing
+   void test_access_standardRead()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      Spy s = m["50"];
+      // verify
+      assertUnit(s.get() == 50);
+      assertUnit(Spy::numCopy() == 1);        // copy [50] out
+      assertUnit(Spy::numDefault() == 0);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // at throws for a key that is not there, and adds nothing
+   void test_at_missing()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      bool isThrown = false;
+      // exercise
+      try
+      {
+         m.at("40");
+      }
+      catch (const std::out_of_range&)
+      {
+         isThrown = true;
+      }
+      // verify
+      assertUnit(isThrown);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // find lands on the pair
+   void test_find_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      auto it = m.find("70");
+      // verify
+      assertUnit(it != m.end());
+      assertUnit((*it).first == std::string("70"));
+      assertUnit(it->second.get() == 70);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // find for a missing key is end()
+   void test_find_standardMissing()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto it = m.find("40");
+      // verify
+      assertUnit(it == m.end());
+      assertUnit(!m.contains(""));
+      assertUnit(m.count("99") == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertStandardFixture(m);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // a copy goes right in its slot: nothing else moves
+   void test_insertCopy_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      custom::pair <std::string, Spy> pair60(std::string("60"), Spy(60));
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.insert(pair60);
+      // verify
+      assertUnit(Spy::numCopy() == 1);       // copy [60] in
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 60);
+      assertUnit(m.size() == 4);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // a key already here is found before anything is copied
+   void test_insert_duplicateNotCopied()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      custom::pair <std::string, Spy> pair50(std::string("50"), Spy(99));
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.insert(pair50);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(!pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 50);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // emplace a key and a value
+   void test_emplace_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.emplace(std::string("60"), Spy(60));
+      auto pairDuplicate = m.emplace(std::string("30"), Spy(31));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 60);
+      assertUnit(!pairDuplicate.second);
+      assertUnit(m.at("30").get() == 30);
+      assertUnit(m.size() == 4);
+   }  // teardown
+
+   // try_emplace builds the value right in its slot
+   void test_tryEmplace_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.try_emplace(std::string("60"), 60);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);  // build [60] in place
+      assertUnit(Spy::numCopyMove() == 0);    // and nothing moves
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 60);
+      assertUnit(m.size() == 4);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // try_emplace a key that is already there: nothing is built
+   void test_tryEmplace_standardDuplicate()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.try_emplace(std::string("50"), 99);
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(!pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 50);
+      assertStandardFixture(m);
+   }  // teardown
+
+   // insert_or_assign a key that is already there assigns the value
+   void test_insertOrAssign_standardDuplicate()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      auto pairReturn = m.insert_or_assign(std::string("50"), s);
+      // verify
+      assertUnit(Spy::numAssign() == 1);      // assign [99] over [50]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(!pairReturn.second);
+      assertUnit((*pairReturn.first).second.get() == 99);
+      assertUnit(m.size() == 3);
+   }  // teardown
+
+   // the fifteenth pair in 16 slots doubles the table, moving the
+   // others rather than copying them
+   void test_insert_grows()
+   {  // setup
+      SpyMap m;
+      for (int i = 0; i < 14; i++)
+         m.try_emplace(i, i);
+      assertUnit(m.bucket_count() == 16);
+      Spy::reset();
+      // exercise
+      m.try_emplace(14, 14);
+      // verify
+      assertUnit(m.bucket_count() == 32);
+      assertUnit(Spy::numNondefault() == 1);  // build [14] in the new table
+      assertUnit(Spy::numCopyMove() == 14);   // move the others over
+      assertUnit(Spy::numDestructor() == 14); // and leave their old slots behind
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(m.size() == 15);
+      assertUnit(m.verify());
+   }  // teardown
+
+   /***************************************
+    * BUCKETS
+    ***************************************/
+
+   // with room reserved, the slots never move
+   void test_reserve_noMove()
+   {  // setup
+      IntMap m;
+      // exercise
+      m.reserve(1000);
+      const custom::pair <int, int>* pSlots = m.pSlots;
+      for (int i = 0; i < 1000; i++)
+         m[i] = i;
+      // verify
+      assertUnit(m.pSlots == pSlots);
+      assertUnit(m.bucket_count() == 2048);   // 7/8 of 1024 is too few
+      assertUnit(m.size() == 1000);
+      assertUnit(m.load_factor() <= m.max_load_factor());
+      assertUnit(m.verify());
+   }  // teardown
+
+   // rehash can shrink a table, and gives back an empty one
+   void test_rehash_shrink()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 1000; i++)
+         m[i] = i;
+      for (int i = 10; i < 1000; i++)
+         m.erase(i);
+      // exercise
+      m.rehash(0);
+      // verify
+      assertUnit(m.bucket_count() == 16);
+      assertUnit(m.size() == 10);
+      assertUnit(m.at(9) == 9);
+      assertUnit(m.verify());
+      m.clear();
+      m.rehash(0);
+      assertUnit(m.pSlots == nullptr);
+      assertUnit(m.bucket_count() == 0);
+      assertUnit(m.verify());
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erasing by key says how many went
+   void test_erase_standardKey()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      // exercise
+      size_t numMissing = m.erase(std::string("40"));
+      size_t numFound = m.erase(std::string("30"));
+      // verify
+      assertUnit(numMissing == 0);
+      assertUnit(numFound == 1);
+      assertUnit(m.size() == 2);
+      assertUnit(!m.contains("30"));
+      assertUnit(m.at("50").get() == 50);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // three keys with the same home: erasing the first shifts the
+   // other two back, and the last slot is left empty, not a tombstone
+   //    slot: 3  4  5           slot: 3  4  5
+   //          a  b  c     ->          b  c  .
+   void test_erase_backwardShift()
+   {  // setup
+      SpyMap m(16);
+      std::vector <int> keys = keysHomedAt(3, 3);
+      for (int key : keys)
+         m.try_emplace(key, key);
+      bool isSetup = m.pSlots[3].first == keys[0] && m.pSlots[5].first == keys[2];
+      Spy::reset();
+      // exercise
+      m.erase(keys[0]);
+      // verify
+      assertUnit(isSetup);
+      assertUnit(Spy::numDelete() == 1);       // free a
+      assertUnit(Spy::numCopyMove() == 2);     // b and c move back
+      assertUnit(Spy::numDestructor() == 3);   // a, and the slots b and c left
+      assertUnit(m.pSlots[3].first == keys[1]);
+      assertUnit(m.pSlots[4].first == keys[2]);
+      assertUnit(m.pControl[5] == SpyMap::controlEmpty);
+      assertUnit(m.size() == 2);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // a key whose home is after the hole stays where it is
+   //    slot: 3  4           slot: 3  4
+   //          a  b     ->          .  b
+   void test_erase_backwardShiftStays()
+   {  // setup
+      SpyMap m(16);
+      int a = keysHomedAt(3, 1)[0];
+      int b = keysHomedAt(4, 1)[0];
+      m.try_emplace(a, a);
+      m.try_emplace(b, b);
+      Spy::reset();
+      // exercise
+      m.erase(a);
+      // verify
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(m.pControl[3] == SpyMap::controlEmpty);
+      assertUnit(m.pSlots[4].first == b);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // erasing by iterator returns the next one; erasing them all empties it
+   void test_erase_iteratorNext()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 500; i++)
+         m[i] = i;
+      size_t num = 0;
+      // exercise
+      for (auto it = m.begin(); it != m.end(); num++)
+         it = m.erase(it);
+      // verify
+      assertUnit(num == 500);
+      assertUnit(m.empty());
+      assertUnit(m.begin() == m.end());
+      assertUnit(m.erase(m.end()) == m.end());
+      assertUnit(m.verify());
+   }  // teardown
+
+   // a range in the middle of a walk goes, and nothing else
+   void test_erase_range()
+   {  // setup
+      IntMap m;
+      for (int i = 0; i < 200; i++)
+         m[i * 3] = i;
+      std::vector <int> order;
+      for (auto it = m.begin(); it != m.end(); ++it)
+         order.push_back((*it).first);
+      auto itFirst = m.find(order[50]);
+      auto itLast = m.find(order[150]);
+      // exercise
+      auto itReturn = m.erase(itFirst, itLast);
+      // verify
+      assertUnit(itReturn != m.end());
+      assertUnit((*itReturn).first == order[150]);
+      assertUnit(m.size() == 100);
+      bool isRight = true;
+      for (size_t i = 0; i < order.size(); i++)
+         isRight = isRight && m.contains(order[i]) == (i < 50 || i >= 150);
+      assertUnit(isRight);
+      assertUnit(m.verify());
+   }  // teardown
+
+   // a range inside a run that wraps, with pairs after it that shift back
+   void test_erase_rangeWrapped()
+   {  // setup
+      SpyMap m(16);
+      std::vector <int> keys = keysHomedAt(13, 8);
+      for (int key : keys)
+         m.try_emplace(key, key);
+      std::vector <int> order;
+      for (auto it = m.begin(); it != m.end(); ++it)
+         order.push_back((*it).first);
+      // exercise
+      auto itReturn = m.erase(m.find(order[1]), m.find(order[6]));
+      // verify
+      assertUnit(order.size() == 8);
+      assertUnit(itReturn != m.end());
+      assertUnit((*itReturn).first == order[6]);
+      assertUnit(m.size() == 3);
+      assertUnit(m.contains(order[0]) && m.contains(order[6]) && m.contains(order[7]));
+      assertUnit(m.verify());
+   }  // teardown
+
+   // clear destroys every pair but keeps the slots
+   void test_clear_standard()
+   {  // setup
+      Map m;
+      setupStandardFixture(m);
+      Spy::reset();
+      // exercise
+      m.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 3);  // destroy [30][50][70]
+      assertUnit(Spy::numDelete() == 3);
+      assertUnit(m.empty());
+      assertUnit(m.begin() == m.end());
+      assertUnit(m.bucket_count() == 16);
+      assertUnit(m.verify());
+   }  // teardown
+
+   /***************************************
+    * TRANSPARENT
+    ***************************************/
+
+   // a string_view finds a std::string key without making one
+   void test_transparent_stringView()
+   {  // setup
+      custom::unordered_map <std::string, int, StringHash, std::equal_to <> > m;
+      m[std::string("30")] = 3;
+      m[std::string("50")] = 5;
+      m[std::string("70")] = 7;
+      const char buffer[] = "xx50yy";
+      // exercise
+      auto it = m.find(std::string_view(buffer + 2, 2));
+      int value = (it == m.end()) ? 0 : (*it).second;
+      bool contains70 = m.contains("70");
+      size_t numErased = m.erase(std::string_view("30"));
+      // verify
+      assertUnit(value == 5);
+      assertUnit(contains70);
+      assertUnit(numErased == 1);
+      assertUnit(m.size() == 2);
+      assertUnit(m.find("30") == m.end());
+   }  // teardown
+
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+
+   // a pmr table keeps both its slots and its control bytes in the arena
+   void test_allocator_pmrArena()
+   {  // setup
+      char buffer[4096];
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                                std::pmr::null_memory_resource());
+      custom::pmr::unordered_map <int, int> m(&arena);
+      // exercise
+      for (int i = 0; i < 20; i++)
+         m[i] = i * i;
+      // verify
+      assertUnit(m.size() == 20);
+      assertUnit(m.get_allocator().resource() == &arena);
+      assertUnit((char*)m.pSlots >= buffer &&
+                 (char*)(m.pSlots + m.bucket_count()) <= buffer + sizeof(buffer));
+      assertUnit((char*)m.pControl >= buffer &&
+                 (char*)(m.pControl + m.bucket_count()) <= buffer + sizeof(buffer));
+      assertUnit(m.at(7) == 49);
+   }  // teardown
+
+   /***************************************
+    * RANDOM
+    ***************************************/
+
+   // random inserts, erases and lookups agree with std::unordered_map
+   void test_map_random()
+   {  // setup
+      IntMap m;
+      std::unordered_map <int, int> reference;
+      std::mt19937 random(23);
+      bool isValid = true;
+      // exercise
+      for (int i = 0; i < 30000; i++)
+      {
+         int key = int(random() % 2000);
+         switch (random() % 5)
+         {
+            case 0:
+            case 1:
+               m[key] = i;
+               reference[key] = i;
+               break;
+            case 2:
+               isValid = isValid && m.erase(key) == reference.erase(key);
+               break;
+            case 3:
+            {
+               auto it = m.find(key);
+               if (it != m.end())
+                  m.erase(it);
+               reference.erase(key);
+               break;
+            }
+            default:
+            {
+               auto it = m.find(key);
+               auto itRef = reference.find(key);
+               isValid = isValid && ((it == m.end()) == (itRef == reference.end()));
+               if (it != m.end() && itRef != reference.end())
+                  isValid = isValid && (*it).second == itRef->second;
+            }
+         }
+         if (i % 1000 == 0)
+            isValid = isValid && m.verify();
+      }
+      // verify
+      assertUnit(isValid);
+      assertUnit(m.size() == reference.size());
+      bool isSame = true;
+      for (auto it = m.begin(); it != m.end(); ++it)
+         isSame = isSame && reference.count((*it).first) && reference[(*it).first] == (*it).second;
+      assertUnit(isSame);
+      assertUnit(m.verify());
+   }  // teardown
+
+   /****************************************************************
+    * Keys Homed At
+    *   The first num keys whose home is slot iHome of 16
+    ****************************************************************/
+   static std::vector <int> keysHomedAt(size_t iHome, size_t num)
+   {
+      SpyMap probe(16);
+      std::vector <int> keys;
+      for (int key = 0; keys.size() < num; key++)
+         if (probe.homeOf(probe.hashOf(key)) == iHome)
+            keys.push_back(key);
+      return keys;
+   }
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   "30", "50" and "70" in a table of 16 slots
+    ****************************************************************/
+   void setupStandardFixture(Map& m)
+   {
+      m.insert(custom::pair <std::string, Spy> (std::string("30"), Spy(30)));
+      m.insert(custom::pair <std::string, Spy> (std::string("50"), Spy(50)));
+      m.insert(custom::pair <std::string, Spy> (std::string("70"), Spy(70)));
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *   "30", "50" and "70", each where a lookup will find it
+    ****************************************************************/
+   void assertStandardFixtureParameters(const Map& m, int line, const char* function)
+   {
+      assertIndirect(m.size() == 3);
+      assertIndirect(m.bucket_count() == 16);
+      assertIndirect(m.verify());
+      if (m.size() != 3)
+         return;
+      assertIndirect(m.at("30").get() == 30);
+      assertIndirect(m.at("50").get() == 50);
+      assertIndirect(m.at("70").get() == 70);
+   }
+};
+
+#endif // DEBUG
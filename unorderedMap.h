@@ -0,0 +1,1156 @@
+/***********************************************************************
+ * Header:
+ *    UNORDERED MAP
+ * Summary:
+ *    A hash map for tables that are only ever looked up by key, never
+ *    walked in order. The pairs sit side by side in one array of slots
+ *    with a control byte for each: empty, or 7 bits of the hash of the
+ *    key in it. A lookup checks the control bytes of 16 slots at once
+ *    and only compares keys where they match.
+ *
+ *    This will contain the class definition of:
+ *        unordered_map           : A class that represents a hash map
+ *        unordered_map::iterator : An iterator through an unordered_map
+ * Author
+ *    <your names here>
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>         // for uint64_t, uint32_t and int8_t
+#include <cstring>         // for std::memset and std::memcpy
+#include <functional>      // for std::hash and std::equal_to
+#include <memory>          // for std::allocator and std::allocator_traits
+#include <memory_resource> // for std::pmr::polymorphic_allocator
+#include <stdexcept>       // for std::out_of_range
+#include <utility>         // for std::pair, std::move, std::forward and std::swap
+#include <iterator>        // for std::forward_iterator_tag
+#include <vector>          // for std::vector, marking the pairs a range erase takes
+#include "pair.h"          // for pair
+#include "simd.h"          // for matching 16 control bytes at a time
+
+class TestUnorderedMap; // forward declaration for unit tests
+
+namespace custom
+{
+   /*****************************************************************
+    * UNORDERED MAP
+    * Create a hash map. A pair goes in the first empty slot at or after
+    * the home slot its hash picks, so the pairs that share a home sit in
+    * one run of full slots, and a lookup reads 16 slots of that run at a
+    * time until it meets an empty slot.
+    *
+    * An erase leaves no tombstone. The pairs after the hole that may go
+    * there are shifted back into it, so lookups do not slow down as keys
+    * come and go, and the table only grows when it is 7/8 full.
+    *
+    * An insert or an erase invalidates every iterator, as a flat map's
+    * does, except for the one erase() returns: walking the table and
+    * erasing as we go sees every pair once. K and V must not throw when
+    * they are moved.
+    *****************************************************************/
+   template <class K, class V, class Hash = std::hash <K>, class KeyEqual = std::equal_to <K>,
+             class A = std::allocator <custom::pair <K, V> > >
+   class unordered_map
+   {
+      friend class ::TestUnorderedMap; // give unit tests access to the privates
+   public:
+      using Pairs = custom::pair <K, V>;
+      using allocator_type = A;
+      using hasher = Hash;
+      using key_equal = KeyEqual;
+
+      //
+      // Construct
+      //
+
+      unordered_map();
+      explicit unordered_map(size_t numBuckets, const Hash& hash = Hash(),
+                             const KeyEqual& equal = KeyEqual(), const A& a = A());
+      explicit unordered_map(const A& a);
+      unordered_map(const unordered_map& rhs);
+      unordered_map(const unordered_map& rhs, const A& a);
+      unordered_map(unordered_map&& rhs) noexcept;
+      template <class Iterator>
+      unordered_map(Iterator first, Iterator last, const A& a = A());
+      unordered_map(const std::initializer_list <Pairs>& il, const A& a = A());
+     ~unordered_map();
+
+      //
+      // Assign
+      //
+
+      unordered_map& operator = (const unordered_map& rhs);
+      unordered_map& operator = (unordered_map&& rhs) noexcept(isMoveAssignNoexcept);
+      unordered_map& operator = (const std::initializer_list <Pairs>& il);
+      void swap(unordered_map& rhs);
+
+      //
+      // Iterator
+      //
+
+      class iterator;
+      iterator begin() const;
+      iterator end()   const noexcept { return iterator(this, iEnd); }
+
+      //
+      // Access
+      //
+
+      V& operator [] (const K& k);
+      V& operator [] (K&& k);
+      const V& at(const K& k) const;
+            V& at(const K& k);
+      iterator find(const K& k) const { return iterator(this, findIndex(k)); }
+      size_t count(const K& k) const { return findIndex(k) != iEnd ? 1 : 0; }
+      bool contains(const K& k) const { return findIndex(k) != iEnd; }
+
+      // when both Hash and KeyEqual are transparent, anything they take will do
+      template <class KK, class HH = Hash, class EE = KeyEqual,
+                class = typename HH::is_transparent, class = typename EE::is_transparent>
+      iterator find(const KK& k) const { return iterator(this, findIndex(k)); }
+      template <class KK, class HH = Hash, class EE = KeyEqual,
+                class = typename HH::is_transparent, class = typename EE::is_transparent>
+      size_t count(const KK& k) const { return findIndex(k) != iEnd ? 1 : 0; }
+      template <class KK, class HH = Hash, class EE = KeyEqual,
+                class = typename HH::is_transparent, class = typename EE::is_transparent>
+      bool contains(const KK& k) const { return findIndex(k) != iEnd; }
+
+      //
+      // Insert
+      //
+
+      // a key already here keeps its value, and nothing is copied
+      custom::pair <iterator, bool> insert(const Pairs& rhs) { return insertValue(rhs); }
+      custom::pair <iterator, bool> insert(Pairs&& rhs)      { return insertValue(std::move(rhs)); }
+      template <class Iterator>
+      void insert(Iterator first, Iterator last);
+      void insert(const std::initializer_list <Pairs>& il) { insert(il.begin(), il.end()); }
+
+      template <class ... Args>
+      custom::pair <iterator, bool> emplace(Args&& ... args);
+
+      // build the value only if k is not here yet, right in its slot
+      template <class ... Args>
+      custom::pair <iterator, bool> try_emplace(const K& k, Args&& ... args)
+      {
+         return tryEmplace(k, std::forward <Args> (args)...);
+      }
+      template <class ... Args>
+      custom::pair <iterator, bool> try_emplace(K&& k, Args&& ... args)
+      {
+         return tryEmplace(std::move(k), std::forward <Args> (args)...);
+      }
+      template <class M>
+      custom::pair <iterator, bool> insert_or_assign(const K& k, M&& m)
+      {
+         return insertOrAssign(k, std::forward <M> (m));
+      }
+      template <class M>
+      custom::pair <iterator, bool> insert_or_assign(K&& k, M&& m)
+      {
+         return insertOrAssign(std::move(k), std::forward <M> (m));
+      }
+
+      //
+      // Remove
+      //
+
+      size_t erase(const K& k) { return eraseKey(k); }
+      template <class KK, class HH = Hash, class EE = KeyEqual,
+                class = typename HH::is_transparent, class = typename EE::is_transparent,
+                class = std::enable_if_t <!std::is_convertible <const KK&, iterator> ::value> >
+      size_t erase(const KK& k) { return eraseKey(k); }
+      iterator erase(iterator it);
+      iterator erase(iterator first, iterator last);
+      void clear() noexcept;
+
+      //
+      // Status
+      //
+
+      bool   empty() const noexcept { return numElements == 0; }
+      size_t size()  const noexcept { return numElements; }
+
+      //
+      // Buckets: there is one pair to a slot, so a bucket is a slot
+      //
+
+      size_t bucket_count() const noexcept { return numCapacity; }
+      float  load_factor() const noexcept { return numCapacity ? float(numElements) / float(numCapacity) : 0.0f; }
+      float  max_load_factor() const noexcept { return 0.875f; }
+
+      // room for num pairs without growing, or at least num slots
+      void reserve(size_t num);
+      void rehash(size_t numBuckets);
+
+      A get_allocator() const noexcept { return alloc; }
+      Hash hash_function() const { return hash; }
+      KeyEqual key_eq() const { return equal; }
+
+   private:
+
+      using Traits = std::allocator_traits <A>;
+      using ControlAlloc = typename Traits::template rebind_alloc <int8_t>;
+      using ControlTraits = std::allocator_traits <ControlAlloc>;
+
+      // only a move between allocators that differ moves pairs one at a time
+      static constexpr bool isMoveAssignNoexcept = Traits::propagate_on_container_move_assignment::value ||
+                                                   Traits::is_always_equal::value;
+
+      static constexpr int8_t controlEmpty = -128;    // top bit set: nothing here
+      static constexpr size_t numMinimum = simd::groupWidth;
+
+      // the hash of a key with its bits spread out: the low 7 go in the
+      // control byte, the ones above them pick the home slot
+      template <class KK>
+      uint64_t hashOf(const KK& k) const { return mix(hash(k)); }
+      static uint64_t mix(size_t h) noexcept
+      {
+         uint64_t x = uint64_t(h) * 0x9E3779B97F4A7C15ull;
+         return x ^ (x >> 32);
+      }
+      size_t homeOf(uint64_t x) const noexcept { return size_t(x >> 7) & (numCapacity - 1); }
+      static int8_t tagOf(uint64_t x) noexcept { return int8_t(x & 0x7F); }
+      static size_t maxLoad(size_t num) noexcept { return num - num / 8; }
+
+      // finding a key, or the slot it would go in
+      template <class KK>
+      size_t findIndex(const KK& k) const;
+      template <class KK>
+      size_t findSlot(const KK& k, uint64_t x, size_t& iEmpty) const;
+      size_t findEmpty(uint64_t x) const noexcept;
+      size_t nextEmpty(size_t i) const noexcept;
+      void setControl(size_t i, int8_t control) noexcept;
+
+      // adding and removing pairs
+      template <class ... Args>
+      size_t constructAt(size_t iEmpty, uint64_t x, Args&& ... args);
+      template <class U>
+      custom::pair <iterator, bool> insertValue(U&& rhs);
+      template <class KK, class ... Args>
+      custom::pair <iterator, bool> tryEmplace(KK&& k, Args&& ... args);
+      template <class KK, class M>
+      custom::pair <iterator, bool> insertOrAssign(KK&& k, M&& m);
+      template <class KK>
+      size_t eraseKey(const KK& k);
+      template <class Moved>
+      void eraseAt(size_t i, Moved moved) noexcept;
+
+      // the arrays themselves
+      void allocate(size_t num);
+      void resize(size_t num);
+      void relocateFrom(Pairs* pSlotsOld, int8_t* pControlOld, size_t numOld) noexcept;
+      void copyFrom(const unordered_map& rhs);
+      void deallocate() noexcept;
+      void release(Pairs* pSlotsOld, int8_t* pControlOld, size_t numOld) noexcept;
+
+#ifdef DEBUG
+      //
+      // Verify
+      //
+      bool verify() const;
+#endif // DEBUG
+
+      Pairs* pSlots;        // the pairs, each in its slot. nullptr with no capacity
+      int8_t* pControl;     // a byte per slot, then the first 16 again so a group can wrap
+      size_t numElements;   // number of pairs in the table
+      size_t numCapacity;   // number of slots: zero, or a power of two no less than 16
+      size_t iEnd;          // an empty slot, where a walk through the table starts and stops
+      Hash hash;            // hashes the keys
+      KeyEqual equal;       // tells the keys apart
+      A alloc;              // where the slots come from
+   };
+
+   /**********************************************************
+    * UNORDERED MAP ITERATOR
+    * Forward iterator through the full slots of an unordered_map.
+    * A walk starts and stops at an empty slot, so no run of full
+    * slots straddles it: the pairs an erase shifts back are ones
+    * the walk has not reached yet.
+    *********************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   class unordered_map <K, V, Hash, KeyEqual, A> ::iterator
+   {
+      friend class ::TestUnorderedMap; // give unit tests access to the privates
+      friend class unordered_map <K, V, Hash, KeyEqual, A>;
+   public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type        = Pairs;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const Pairs*;
+      using reference         = const Pairs&;
+
+      iterator() : pTable(nullptr), i(0) {}
+
+      bool operator == (const iterator& rhs) const { return i == rhs.i && pTable == rhs.pTable; }
+      bool operator != (const iterator& rhs) const { return !(*this == rhs); }
+
+      const Pairs& operator * () const { return pTable->pSlots[i]; }
+      const Pairs* operator -> () const { return pTable->pSlots + i; }
+
+      iterator& operator ++ ()
+      {
+         do
+            i = (i + 1) & (pTable->numCapacity - 1);
+         while (i != pTable->iEnd && pTable->pControl[i] < 0);
+         return *this;
+      }
+      iterator operator ++ (int)
+      {
+         iterator itReturn = *this;
+         ++(*this);
+         return itReturn;
+      }
+
+   private:
+      iterator(const unordered_map* pTable, size_t i) : pTable(pTable), i(i) {}
+
+      const unordered_map* pTable;   // the table we walk through
+      size_t i;                      // the slot we are on
+   };
+
+
+   /*********************************************
+    *********************************************
+    *********************************************
+    *************** UNORDERED MAP ***************
+    *********************************************
+    *********************************************
+    *********************************************/
+
+
+   /*********************************************
+    * UNORDERED MAP :: DEFAULT CONSTRUCTOR
+    * Nothing is allocated until the first pair
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map()
+      : pSlots(nullptr), pControl(nullptr), numElements(0), numCapacity(0), iEnd(0),
+        hash(), equal(), alloc()
+   {
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: BUCKET CONSTRUCTOR
+    * An empty table with at least numBuckets slots
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map(size_t numBuckets, const Hash& hash,
+                                                           const KeyEqual& equal, const A& a)
+      : pSlots(nullptr), pControl(nullptr), numElements(0), numCapacity(0), iEnd(0),
+        hash(hash), equal(equal), alloc(a)
+   {
+      rehash(numBuckets);
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: ALLOCATOR CONSTRUCTOR
+    * An empty table drawing its slots from a given allocator
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map(const A& a)
+      : pSlots(nullptr), pControl(nullptr), numElements(0), numCapacity(0), iEnd(0),
+        hash(), equal(), alloc(a)
+   {
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: COPY CONSTRUCTOR
+    * Copy each pair into the same slot of a table the same size
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map(const unordered_map& rhs)
+      : pSlots(nullptr), pControl(nullptr), numElements(0), numCapacity(0), iEnd(0),
+        hash(rhs.hash), equal(rhs.equal),
+        alloc(Traits::select_on_container_copy_construction(rhs.alloc))
+   {
+      copyFrom(rhs);
+   }
+
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map(const unordered_map& rhs, const A& a)
+      : pSlots(nullptr), pControl(nullptr), numElements(0), numCapacity(0), iEnd(0),
+        hash(rhs.hash), equal(rhs.equal), alloc(a)
+   {
+      copyFrom(rhs);
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: MOVE CONSTRUCTOR
+    * Take the arrays of another table
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map(unordered_map&& rhs) noexcept
+      : pSlots(rhs.pSlots), pControl(rhs.pControl), numElements(rhs.numElements),
+        numCapacity(rhs.numCapacity), iEnd(rhs.iEnd),
+        hash(std::move(rhs.hash)), equal(std::move(rhs.equal)), alloc(std::move(rhs.alloc))
+   {
+      rhs.pSlots = nullptr;
+      rhs.pControl = nullptr;
+      rhs.numElements = rhs.numCapacity = rhs.iEnd = 0;
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: RANGE CONSTRUCTOR
+    * The first of each key in [first, last) is kept
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class Iterator>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map(Iterator first, Iterator last, const A& a)
+      : pSlots(nullptr), pControl(nullptr), numElements(0), numCapacity(0), iEnd(0),
+        hash(), equal(), alloc(a)
+   {
+      insert(first, last);
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: INITIALIZER LIST CONSTRUCTOR
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> ::unordered_map(const std::initializer_list <Pairs>& il, const A& a)
+      : pSlots(nullptr), pControl(nullptr), numElements(0), numCapacity(0), iEnd(0),
+        hash(), equal(), alloc(a)
+   {
+      insert(il.begin(), il.end());
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: DESTRUCTOR
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A> :: ~unordered_map()
+   {
+      deallocate();
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: ASSIGNMENT OPERATOR
+    * Copy one table to another. The arrays are reused if they are
+    * the same size.
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A>& unordered_map <K, V, Hash, KeyEqual, A> :: operator = (const unordered_map& rhs)
+   {
+      if (this == &rhs)
+         return *this;
+
+      // the old arrays go back to the old allocator before it is replaced
+      if constexpr (Traits::propagate_on_container_copy_assignment::value)
+      {
+         deallocate();
+         alloc = rhs.alloc;
+      }
+      hash = rhs.hash;
+      equal = rhs.equal;
+      copyFrom(rhs);
+      return *this;
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: ASSIGN-MOVE OPERATOR
+    * Move one table to another
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A>& unordered_map <K, V, Hash, KeyEqual, A> :: operator = (unordered_map&& rhs)
+      noexcept(isMoveAssignNoexcept)
+   {
+      if (this == &rhs)
+         return *this;
+
+      hash = rhs.hash;
+      equal = rhs.equal;
+
+      // the allocator comes along, or is the same anyway: steal the arrays
+      if (Traits::propagate_on_container_move_assignment::value || alloc == rhs.alloc)
+      {
+         deallocate();
+         if constexpr (Traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+         std::swap(rhs.pSlots, pSlots);
+         std::swap(rhs.pControl, pControl);
+         std::swap(rhs.numElements, numElements);
+         std::swap(rhs.numCapacity, numCapacity);
+         std::swap(rhs.iEnd, iEnd);
+      }
+
+      // different allocators: move the pairs one at a time into our slots
+      else
+      {
+         clear();
+         reserve(rhs.numElements);
+         for (size_t i = 0; i < rhs.numCapacity; i++)
+            if (rhs.pControl[i] >= 0)
+               insertValue(std::move(rhs.pSlots[i]));
+         rhs.clear();
+      }
+
+      return *this;
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: ASSIGNMENT OPERATOR with INITIALIZATION LIST
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   unordered_map <K, V, Hash, KeyEqual, A>& unordered_map <K, V, Hash, KeyEqual, A> :: operator = (const std::initializer_list <Pairs>& il)
+   {
+      clear();
+      insert(il.begin(), il.end());
+      return *this;
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: SWAP
+    * Swap two tables
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::swap(unordered_map& rhs)
+   {
+      std::swap(rhs.pSlots, pSlots);
+      std::swap(rhs.pControl, pControl);
+      std::swap(rhs.numElements, numElements);
+      std::swap(rhs.numCapacity, numCapacity);
+      std::swap(rhs.iEnd, iEnd);
+      std::swap(rhs.hash, hash);
+      std::swap(rhs.equal, equal);
+
+      // without propagation, swapping is only defined for equal allocators
+      if constexpr (Traits::propagate_on_container_swap::value)
+         std::swap(rhs.alloc, alloc);
+      else
+         assert(alloc == rhs.alloc);
+   }
+
+   /*********************************************
+    * UNORDERED MAP :: BEGIN
+    * The first full slot after the empty one a walk starts from
+    ********************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   typename unordered_map <K, V, Hash, KeyEqual, A> ::iterator unordered_map <K, V, Hash, KeyEqual, A> ::begin() const
+   {
+      iterator it = end();
+      if (numElements != 0)
+         ++it;
+      return it;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: SUBSCRIPT
+    * The value of k, added with a default value if it is not there
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   V& unordered_map <K, V, Hash, KeyEqual, A> :: operator [] (const K& k)
+   {
+      // the slots may move when k goes in, so find where it went first
+      size_t i = tryEmplace(k).first.i;
+      return pSlots[i].second;
+   }
+
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   V& unordered_map <K, V, Hash, KeyEqual, A> :: operator [] (K&& k)
+   {
+      size_t i = tryEmplace(std::move(k)).first.i;
+      return pSlots[i].second;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: AT
+    * The value of k, which must be there
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   V& unordered_map <K, V, Hash, KeyEqual, A> ::at(const K& k)
+   {
+      size_t i = findIndex(k);
+      if (i == iEnd)
+         throw std::out_of_range("invalid unordered_map<K, T> key");
+      return pSlots[i].second;
+   }
+
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   const V& unordered_map <K, V, Hash, KeyEqual, A> ::at(const K& k) const
+   {
+      size_t i = findIndex(k);
+      if (i == iEnd)
+         throw std::out_of_range("invalid unordered_map<K, T> key");
+      return pSlots[i].second;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: INSERT RANGE
+    * Each pair of [first, last) whose key is not here yet
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class Iterator>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::insert(Iterator first, Iterator last)
+   {
+      for (; first != last; ++first)
+         insertValue(*first);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: EMPLACE
+    * Build a pair from args and put it in if its key is not here. The
+    * key is not known until the pair is built, so it is built on the
+    * side and moved in.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class ... Args>
+   custom::pair <typename unordered_map <K, V, Hash, KeyEqual, A> ::iterator, bool> unordered_map <K, V, Hash, KeyEqual, A> ::emplace(Args&& ... args)
+   {
+      // a key and a value: build each of them right in the pair
+      if constexpr (sizeof...(Args) == 2)
+         return insertValue(Pairs(std::in_place, std::forward <Args> (args)...));
+      else
+         return insertValue(Pairs(std::forward <Args> (args)...));
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: ERASE
+    * Take out the pair it is on, and return the one a walk
+    * would come to next
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   typename unordered_map <K, V, Hash, KeyEqual, A> ::iterator unordered_map <K, V, Hash, KeyEqual, A> ::erase(iterator it)
+   {
+      if (it == end())
+         return it;
+
+      // a pair shifted back into the slot is one we have not come to yet
+      eraseAt(it.i, [](size_t, size_t) {});
+      if (pControl[it.i] < 0)
+         ++it;
+      return it;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: ERASE RANGE
+    * Take out the pairs in [first, last). Each erase can shift the
+    * pairs after it back, last among them, so the pairs in the range
+    * are marked first and the marks move along with them. The pairs
+    * only ever move back toward the start of the walk, so one walk
+    * from first finds every mark.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   typename unordered_map <K, V, Hash, KeyEqual, A> ::iterator unordered_map <K, V, Hash, KeyEqual, A> ::erase(iterator first,
+                                                                                                             iterator last)
+   {
+      if (first == last)
+         return last;
+      if (first == begin() && last == end())
+      {
+         clear();
+         return end();
+      }
+
+      std::vector <bool> isMarked(numCapacity, false);
+      for (iterator it = first; it != last; ++it)
+         isMarked[it.i] = true;
+
+      size_t iLast = last.i;
+      auto moved = [&isMarked, &iLast](size_t iFrom, size_t iTo)
+      {
+         isMarked[iTo] = isMarked[iFrom];
+         isMarked[iFrom] = false;
+         if (iFrom == iLast)
+            iLast = iTo;
+      };
+      for (size_t i = first.i; i != iEnd; i = (i + 1) & (numCapacity - 1))
+         while (isMarked[i])
+         {
+            isMarked[i] = false;
+            eraseAt(i, moved);
+         }
+
+      return iterator(this, iLast);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: CLEAR
+    * Destroy every pair, but keep the slots for the next ones
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::clear() noexcept
+   {
+      if (numCapacity == 0)
+         return;
+      for (size_t i = 0; i < numCapacity; i++)
+         if (pControl[i] >= 0)
+            Traits::destroy(alloc, pSlots + i);
+      std::memset(pControl, controlEmpty, numCapacity + simd::groupWidth);
+      numElements = 0;
+      iEnd = 0;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: RESERVE
+    * Grow so that num pairs fit without growing again
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::reserve(size_t num)
+   {
+      if (num <= maxLoad(numCapacity))
+         return;
+      size_t numNew = numCapacity ? numCapacity : numMinimum;
+      while (maxLoad(numNew) < num)
+         numNew *= 2;
+      resize(numNew);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: REHASH
+    * Move to a table of at least numBuckets slots that still holds
+    * every pair. This is the one way to shrink it, and rehash(0) on
+    * an empty table gives back its arrays.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::rehash(size_t numBuckets)
+   {
+      if (numBuckets == 0 && numElements == 0)
+      {
+         deallocate();
+         return;
+      }
+      size_t numNew = numMinimum;
+      while (numNew < numBuckets || maxLoad(numNew) < numElements)
+         numNew *= 2;
+      if (numNew != numCapacity)
+         resize(numNew);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: FIND INDEX
+    * The slot holding k, or iEnd when k is not here
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class KK>
+   size_t unordered_map <K, V, Hash, KeyEqual, A> ::findIndex(const KK& k) const
+   {
+      size_t iEmpty;
+      return findSlot(k, hashOf(k), iEmpty);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: FIND SLOT
+    * Walk the run of full slots from the home of x, 16 at a time,
+    * comparing k only with the keys whose control byte matches. The
+    * run ends at the first empty slot; nothing after it is ours, and
+    * that is where k would go. Returns the slot holding k, or iEnd
+    * with iEmpty set when k is not here.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class KK>
+   size_t unordered_map <K, V, Hash, KeyEqual, A> ::findSlot(const KK& k, uint64_t x, size_t& iEmpty) const
+   {
+      iEmpty = 0;
+      if (numCapacity == 0)
+         return iEnd;
+
+      size_t mask = numCapacity - 1;
+      int8_t tag = tagOf(x);
+      for (size_t pos = homeOf(x); ; pos = (pos + simd::groupWidth) & mask)
+      {
+         uint32_t empties;
+         uint32_t matches = simd::matchGroup(pControl + pos, tag, empties);
+         if (empties)
+            matches &= (empties & (0u - empties)) - 1;   // only the slots before the first empty
+         for (; matches; matches &= matches - 1)
+         {
+            size_t i = (pos + simd::lowestBit(matches)) & mask;
+            if (equal(pSlots[i].first, k))
+               return i;
+         }
+         if (empties)
+         {
+            iEmpty = (pos + simd::lowestBit(empties)) & mask;
+            return iEnd;
+         }
+      }
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: FIND EMPTY
+    * The first empty slot at or after the home of x
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   size_t unordered_map <K, V, Hash, KeyEqual, A> ::findEmpty(uint64_t x) const noexcept
+   {
+      size_t mask = numCapacity - 1;
+      for (size_t pos = homeOf(x); ; pos = (pos + simd::groupWidth) & mask)
+      {
+         uint32_t empties;
+         simd::matchGroup(pControl + pos, 0, empties);
+         if (empties)
+            return (pos + simd::lowestBit(empties)) & mask;
+      }
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: NEXT EMPTY
+    * The first empty slot after slot i, wrapping around
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   size_t unordered_map <K, V, Hash, KeyEqual, A> ::nextEmpty(size_t i) const noexcept
+   {
+      size_t mask = numCapacity - 1;
+      do
+         i = (i + 1) & mask;
+      while (pControl[i] >= 0);
+      return i;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: SET CONTROL
+    * Set the control byte of slot i. The first 16 are also kept
+    * after the last slot, so a group read near the end wraps.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::setControl(size_t i, int8_t control) noexcept
+   {
+      pControl[i] = control;
+      if (i < size_t(simd::groupWidth))
+         pControl[numCapacity + i] = control;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: CONSTRUCT AT
+    * Build a pair with hash x in slot iEmpty and return where it
+    * went. A table that would be too full is replaced by one twice
+    * the size, and the pair is built there before the others move,
+    * since args may be one of them. If building it throws, nothing
+    * has changed.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class ... Args>
+   size_t unordered_map <K, V, Hash, KeyEqual, A> ::constructAt(size_t iEmpty, uint64_t x, Args&& ... args)
+   {
+      if (numElements < maxLoad(numCapacity))
+      {
+         Traits::construct(alloc, pSlots + iEmpty, std::forward <Args> (args)...);
+         setControl(iEmpty, tagOf(x));
+         if (iEmpty == iEnd)
+            iEnd = nextEmpty(iEnd);
+      }
+      else
+      {
+         Pairs* pSlotsOld = pSlots;
+         int8_t* pControlOld = pControl;
+         size_t numOld = numCapacity;
+         size_t iEndOld = iEnd;
+         allocate(numCapacity ? numCapacity * 2 : numMinimum);
+
+         // in an empty table, the new pair goes right in its home slot
+         iEmpty = homeOf(x);
+         try
+         {
+            Traits::construct(alloc, pSlots + iEmpty, std::forward <Args> (args)...);
+         }
+         catch (...)
+         {
+            release(pSlots, pControl, numCapacity);
+            pSlots = pSlotsOld;
+            pControl = pControlOld;
+            numCapacity = numOld;
+            iEnd = iEndOld;
+            throw;
+         }
+         setControl(iEmpty, tagOf(x));
+         relocateFrom(pSlotsOld, pControlOld, numOld);
+      }
+      numElements++;
+      return iEmpty;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: INSERT VALUE
+    * Copy or move rhs in unless its key is already here
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class U>
+   custom::pair <typename unordered_map <K, V, Hash, KeyEqual, A> ::iterator, bool> unordered_map <K, V, Hash, KeyEqual, A> ::insertValue(U&& rhs)
+   {
+      uint64_t x = hashOf(rhs.first);
+      size_t iEmpty;
+      size_t i = findSlot(rhs.first, x, iEmpty);
+      if (i != iEnd)
+         return custom::pair <iterator, bool> (iterator(this, i), false);
+      i = constructAt(iEmpty, x, std::forward <U> (rhs));
+      return custom::pair <iterator, bool> (iterator(this, i), true);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: TRY EMPLACE
+    * Add a pair built in place from k and args, but only if k is not
+    * already here. Nothing is built when it is.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class KK, class ... Args>
+   custom::pair <typename unordered_map <K, V, Hash, KeyEqual, A> ::iterator, bool> unordered_map <K, V, Hash, KeyEqual, A> ::tryEmplace(KK&& k, Args&& ... args)
+   {
+      uint64_t x = hashOf(k);
+      size_t iEmpty;
+      size_t i = findSlot(k, x, iEmpty);
+      if (i != iEnd)
+         return custom::pair <iterator, bool> (iterator(this, i), false);
+      i = constructAt(iEmpty, x, std::in_place, std::forward <KK> (k), std::forward <Args> (args)...);
+      return custom::pair <iterator, bool> (iterator(this, i), true);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: INSERT OR ASSIGN
+    * Assign m to the value of k, adding k if it is not already here
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class KK, class M>
+   custom::pair <typename unordered_map <K, V, Hash, KeyEqual, A> ::iterator, bool> unordered_map <K, V, Hash, KeyEqual, A> ::insertOrAssign(KK&& k, M&& m)
+   {
+      uint64_t x = hashOf(k);
+      size_t iEmpty;
+      size_t i = findSlot(k, x, iEmpty);
+      if (i != iEnd)
+      {
+         pSlots[i].second = std::forward <M> (m);
+         return custom::pair <iterator, bool> (iterator(this, i), false);
+      }
+      i = constructAt(iEmpty, x, std::in_place, std::forward <KK> (k), std::forward <M> (m));
+      return custom::pair <iterator, bool> (iterator(this, i), true);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: ERASE KEY
+    * Take out the pair with key k, if there is one
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class KK>
+   size_t unordered_map <K, V, Hash, KeyEqual, A> ::eraseKey(const KK& k)
+   {
+      size_t i = findIndex(k);
+      if (i == iEnd)
+         return 0;
+      eraseAt(i, [](size_t, size_t) {});
+      return 1;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: ERASE AT
+    * Destroy the pair in slot i, then walk the run of full slots
+    * after it. A pair whose home is not between the hole and itself
+    * would be lost behind an empty slot, so it moves back into the
+    * hole, and the hole moves to where it was. The last hole becomes
+    * an empty slot: no tombstones. moved(iFrom, iTo) hears of each move.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   template <class Moved>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::eraseAt(size_t i, Moved moved) noexcept
+   {
+      size_t mask = numCapacity - 1;
+      Traits::destroy(alloc, pSlots + i);
+      for (size_t j = (i + 1) & mask; pControl[j] >= 0; j = (j + 1) & mask)
+      {
+         size_t iHome = homeOf(hashOf(pSlots[j].first));
+         if (((j - iHome) & mask) >= ((j - i) & mask))
+         {
+            Traits::construct(alloc, pSlots + i, std::move(pSlots[j]));
+            Traits::destroy(alloc, pSlots + j);
+            setControl(i, pControl[j]);
+            moved(j, i);
+            i = j;
+         }
+      }
+      setControl(i, controlEmpty);
+      numElements--;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: ALLOCATE
+    * New, empty arrays of num slots. The old ones are the caller's.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::allocate(size_t num)
+   {
+      assert(num >= numMinimum && (num & (num - 1)) == 0);
+      Pairs* pSlotsNew = Traits::allocate(alloc, num);
+      int8_t* pControlNew;
+      try
+      {
+         ControlAlloc allocControl(alloc);
+         pControlNew = ControlTraits::allocate(allocControl, num + simd::groupWidth);
+      }
+      catch (...)
+      {
+         Traits::deallocate(alloc, pSlotsNew, num);
+         throw;
+      }
+      std::memset(pControlNew, controlEmpty, num + simd::groupWidth);
+      pSlots = pSlotsNew;
+      pControl = pControlNew;
+      numCapacity = num;
+      iEnd = 0;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: RESIZE
+    * Move every pair into a table of num slots
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::resize(size_t num)
+   {
+      Pairs* pSlotsOld = pSlots;
+      int8_t* pControlOld = pControl;
+      size_t numOld = numCapacity;
+      allocate(num);
+      relocateFrom(pSlotsOld, pControlOld, numOld);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: RELOCATE FROM
+    * Move the pairs of the old arrays into their slots in ours,
+    * then give the old arrays back
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::relocateFrom(Pairs* pSlotsOld, int8_t* pControlOld,
+                                                               size_t numOld) noexcept
+   {
+      for (size_t i = 0; i < numOld; i++)
+         if (pControlOld[i] >= 0)
+         {
+            size_t iNew = findEmpty(hashOf(pSlotsOld[i].first));
+            Traits::construct(alloc, pSlots + iNew, std::move(pSlotsOld[i]));
+            Traits::destroy(alloc, pSlotsOld + i);
+            setControl(iNew, pControlOld[i]);
+         }
+      release(pSlotsOld, pControlOld, numOld);
+      iEnd = nextEmpty(numCapacity - 1);
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: COPY FROM
+    * Copy the pairs of rhs into the same slots of ours, reusing
+    * our arrays when they are the same size. Same hash, same slots.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::copyFrom(const unordered_map& rhs)
+   {
+      if (numCapacity == rhs.numCapacity)
+         clear();
+      else
+      {
+         deallocate();
+         if (rhs.numCapacity == 0)
+            return;
+         allocate(rhs.numCapacity);
+      }
+
+      for (size_t i = 0; i < rhs.numCapacity; i++)
+         if (rhs.pControl[i] >= 0)
+         {
+            try
+            {
+               Traits::construct(alloc, pSlots + i, rhs.pSlots[i]);
+            }
+            catch (...)
+            {
+               clear();
+               throw;
+            }
+            setControl(i, rhs.pControl[i]);
+            numElements++;
+         }
+      iEnd = rhs.iEnd;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: DEALLOCATE
+    * Destroy every pair and give back the arrays
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::deallocate() noexcept
+   {
+      clear();
+      release(pSlots, pControl, numCapacity);
+      pSlots = nullptr;
+      pControl = nullptr;
+      numCapacity = 0;
+      iEnd = 0;
+   }
+
+   /*****************************************************
+    * UNORDERED MAP :: RELEASE
+    * Give back arrays of num slots holding no pairs
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void unordered_map <K, V, Hash, KeyEqual, A> ::release(Pairs* pSlotsOld, int8_t* pControlOld,
+                                                          size_t numOld) noexcept
+   {
+      if (numOld == 0)
+         return;
+      Traits::deallocate(alloc, pSlotsOld, numOld);
+      ControlAlloc allocControl(alloc);
+      ControlTraits::deallocate(allocControl, pControlOld, numOld + simd::groupWidth);
+   }
+
+#ifdef DEBUG
+   /*****************************************************
+    * UNORDERED MAP :: VERIFY
+    * Every pair can be found from its home: the slots from there
+    * to it are full, and its control byte has its hash. The copy of
+    * the first group matches, and the walk starts on an empty slot.
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   bool unordered_map <K, V, Hash, KeyEqual, A> ::verify() const
+   {
+      if (numCapacity == 0)
+         return numElements == 0 && pSlots == nullptr && pControl == nullptr;
+      if ((numCapacity & (numCapacity - 1)) != 0 || numCapacity < numMinimum)
+         return false;
+      if (numElements > maxLoad(numCapacity) || pControl[iEnd] >= 0)
+         return false;
+      if (std::memcmp(pControl, pControl + numCapacity, simd::groupWidth) != 0)
+         return false;
+
+      size_t mask = numCapacity - 1;
+      size_t num = 0;
+      for (size_t i = 0; i < numCapacity; i++)
+      {
+         if (pControl[i] < 0)
+         {
+            if (pControl[i] != controlEmpty)
+               return false;
+            continue;
+         }
+         num++;
+         uint64_t x = hashOf(pSlots[i].first);
+         if (pControl[i] != tagOf(x))
+            return false;
+         for (size_t j = homeOf(x); j != i; j = (j + 1) & mask)
+            if (pControl[j] < 0)
+               return false;
+         if (findIndex(pSlots[i].first) != i)
+            return false;
+      }
+      return num == numElements;
+   }
+#endif // DEBUG
+
+   /*****************************************************
+    * SWAP
+    * Swap two tables
+    ****************************************************/
+   template <class K, class V, class Hash, class KeyEqual, class A>
+   void swap(unordered_map <K, V, Hash, KeyEqual, A>& lhs, unordered_map <K, V, Hash, KeyEqual, A>& rhs)
+   {
+      lhs.swap(rhs);
+   }
+
+   /*****************************************************************
+    * PMR UNORDERED MAP
+    * An unordered_map drawing its slots from a memory resource
+    *****************************************************************/
+   namespace pmr
+   {
+      template <class K, class V, class Hash = std::hash <K>, class KeyEqual = std::equal_to <K> >
+      using unordered_map = custom::unordered_map <K, V, Hash, KeyEqual,
+                                                   std::pmr::polymorphic_allocator <custom::pair <K, V> > >;
+   }
+
+} // namespace custom